@@ -164,6 +164,13 @@ namespace PeterDB {
                     code = error("I expect <tableName>");
             }
 
+                ////////////////////////////////////////////
+                // vacuum <tableName>
+                ////////////////////////////////////////////
+            else if (expect(tokenizer, "vacuum") || expect(tokenizer, "reorganize")) {
+                code = vacuum();
+            }
+
                 ///////////////////////////////////////////////////////////////
                 // insert into <tableName> tuple(attr1=val1, attr2=value2, ...)
                 ///////////////////////////////////////////////////////////////
@@ -708,6 +715,7 @@ namespace PeterDB {
         // parse columnNames and types
         std::vector <Attribute> table_attrs;
         Attribute attr;
+        PageLayout pageLayout = PAGE_LAYOUT_ROW;
         while (tokenizer != NULL) {
             // get name if there is
             tokenizer = next();
@@ -717,6 +725,11 @@ namespace PeterDB {
             attr.name = std::string(tokenizer);
 
             tokenizer = next(); // eat =
+            // a trailing "pax" picks the column-grouped page layout
+            if (tokenizer == NULL && attr.name == "pax") {
+                pageLayout = PAGE_LAYOUT_PAX;
+                break;
+            }
 
             // get type
             tokenizer = next();
@@ -744,13 +757,13 @@ namespace PeterDB {
         //    std::cout << ' ' << it->length;
         //  cout << endl;
 
-        RC ret = rm.createTable(name, table_attrs);
+        RC ret = rm.createTable(name, table_attrs, pageLayout);
         if (ret != 0)
             return ret;
 
         // add table to cli catalogs
         std::string file_url = std::string(DATABASE_FOLDER) + '/' + name;
-        ret = this->addTableToCatalog(name, file_url, "heap");
+        ret = this->addTableToCatalog(name, file_url, pageLayout == PAGE_LAYOUT_PAX ? "pax" : "heap");
         if (ret != 0)
             return ret;
 
@@ -1482,9 +1495,17 @@ namespace PeterDB {
         return this->printOutputBuffer(outputBuffer, attributes.size());
     }
 
+    RC CLI::vacuum() {
+        char *tokenizer = next();
+        if (tokenizer == NULL)
+            return error("I expect <tableName> to be reorganized");
+
+        return rm.reorganizeTable(std::string(tokenizer));
+    }
+
     RC CLI::help(const std::string& input) {
         if (input == "create") {
-            std::cout << "\tcreate table <tableName> (col1 = type1, col2 = type2, ...): creates table with given properties"
+            std::cout << "\tcreate table <tableName> (col1 = type1, col2 = type2, ...) [pax]: creates table with given properties, pax stores it column-grouped"
                  << std::endl;
             std::cout << "\tcreate index <columnName> on <tableName>: creates index for <columnName> in table <tableName>"
                  << std::endl;
@@ -1506,6 +1527,9 @@ namespace PeterDB {
         } else if (input == "load") {
             std::cout << "\tload <tableName> \"fileName\"";
             std::cout << ": loads given filName to given table" << std::endl;
+        } else if (input == "vacuum") {
+            std::cout << "\tvacuum <tableName>: rewrites tableName into compact pages and rebuilds its indexes";
+            std::cout << std::endl;
         } else if (input == "help") {
             std::cout << "\thelp <commandName>: print help for given command" << std::endl;
             std::cout << "\thelp: show help for all commands" << std::endl;
@@ -1538,6 +1562,7 @@ namespace PeterDB {
             help("print");
             help("insert");
             help("load");
+            help("vacuum");
             help("help");
             help("query");
             help("quit");
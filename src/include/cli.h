@@ -67,6 +67,8 @@ namespace PeterDB {
 
         RC load();
 
+        RC vacuum();
+
         RC printTable(const std::string& tableName);
 
         RC printAttributes();
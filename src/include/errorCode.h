@@ -19,6 +19,36 @@ namespace PeterDB {
         FILE_NO_ENOUGH_PAGE,
         FILE_READ_FAIL,
         FILE_READ_ONE_PAGE_FAIL,
+        FILE_NO_FREE_PAGE,
+        FILE_PAGE_SIZE_INVALID,
+        FILE_IN_USE,
+        FILE_RENAME_FAIL,
+        FILE_FORMAT_UNSUPPORTED,
+    };
+    // for BufferPool
+    enum class BUFFER_ERROR:int{
+        NO_FREE_FRAME = 1,
+        FILE_OPEN_FAIL,
+        READ_PAGE_FAIL,
+        WRITE_PAGE_FAIL,
+        PAGE_NOT_RESIDENT,
+        FRAME_PINNED,
+        MAP_FILE_FAIL,
+        IO_ENGINE_FAIL,
+        IO_QUEUE_FULL,
+        EXTENT_SIZE_INVALID,
+    };
+    // for LogManager
+    enum class LOG_ERROR:int{
+        LOG_ALREADY_OPEN = 1,
+        LOG_NOT_OPEN,
+        LOG_OPEN_FAIL,
+        LOG_READ_FAIL,
+        LOG_WRITE_FAIL,
+        LOG_SYNC_FAIL,
+        LOG_REPLAY_FAIL,
+        OPERATION_IN_PROGRESS,
+        FILE_MAPPED,
     };
     // PageHelper & RecordHelper
     enum class PAGE_ERROR:int{
@@ -31,6 +61,7 @@ namespace PeterDB {
         RECORD_FLAG_WRONG,
         WRITE_PAGE_FAIL,
         ATTR_IS_NULL,
+        RECORD_TOO_LARGE,
     };
 
     enum class RBFM_ERROR:int{
@@ -40,6 +71,7 @@ namespace PeterDB {
         PAGE_EXCEEDED,
         SLOT_INVALID,
         CATALOG_NOT_OPEN,
+        LAYOUT_NOT_SUPPORTED,
     };
 
     enum class RM_ERROR:int{
@@ -86,6 +118,9 @@ namespace PeterDB {
         MOVE_FAIL,
         LEAF_SPLIT_ENTRY_FAIL,
         NODE_TYPE_INVALID,
+        BULK_LOAD_INDEX_NOT_EMPTY,
+        BULK_LOAD_RUN_FAIL,
+        PAGE_SIZE_INVALID,
         };
 }
 
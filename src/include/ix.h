@@ -18,8 +18,8 @@ namespace PeterDB {
     class IXFileHandle;
 
     namespace IX{
-        const int32_t File_Header_Page_Size = 4096;
         const int32_t NULL_PTR = -1;
+        const int32_t METADATA_LEN = 20;              // counters, root and page size at the file start
 
         const int32_t NODE_TYPE_LEN = 2;
         const int32_t FREEBYTEPOINTER_LEN = 2;
@@ -29,11 +29,17 @@ namespace PeterDB {
         const int16_t INTERNAL_NODE = 1;
         const int16_t LEAF_NODE = 2;
 
+        const unsigned NODE_CACHE_CAPACITY = 256;     // # of internal nodes kept resident per index file
+
+        const float DEFAULT_FILL_FACTOR = 0.9;        // share of a node filled by bulk loading
+        const size_t BULK_LOAD_RUN_SIZE = 4 << 20;    // bytes of entries sorted in memory per run
+        const unsigned BULK_LOAD_WRITE_PAGES = 64;    // new nodes appended by a single write
+
     }
     struct internalEntry {
         int32_t indicator;
 
-        int16_t getKeyLength(AttrType type) const {
+        int32_t getKeyLength(AttrType type) const {
             if (type == TypeVarChar){
                 return indicator + sizeof(int32_t);
             }else{
@@ -42,12 +48,12 @@ namespace PeterDB {
         }
 
         //| KEY |RID |
-        int16_t getCompositeKeyLength(AttrType type) const {
+        int32_t getCompositeKeyLength(AttrType type) const {
             return getKeyLength(type) + sizeof(uint32_t) + sizeof(uint16_t);
         }
 
 
-        int16_t getEntryLength(AttrType type) const{
+        int32_t getEntryLength(AttrType type) const{
             return getCompositeKeyLength(type) + sizeof(int32_t) ;
         }
 
@@ -103,7 +109,7 @@ namespace PeterDB {
     struct leafEntry {
         int32_t indicator;
 
-        int16_t getKeyLength(AttrType type) {
+        int32_t getKeyLength(AttrType type) {
             if (type == TypeVarChar){
                 return indicator + sizeof(int32_t);
             }else{
@@ -111,9 +117,9 @@ namespace PeterDB {
             }
         }
 
-        int16_t getEntryLength(AttrType type) {
+        int32_t getEntryLength(AttrType type) {
             // key | rid.page| rid.slot
-            return getKeyLength(type) + sizeof(int32_t) + sizeof(int16_t);
+            return getKeyLength(type) + sizeof(int32_t) + sizeof(uint16_t);
         }
 
         leafEntry *getNextEntry(AttrType type) {
@@ -147,6 +153,27 @@ namespace PeterDB {
             memcpy((uint8_t *) this + getKeyLength(type) + sizeof(uint32_t), &slotNum, sizeof(uint16_t));
         }
     };
+    // Offsets of the entries of a node, so that searching a node is a binary search.
+    // Int/Real entries have a fixed stride and are located arithmetically, VarChar
+    // entries get their offsets collected in one pass that compares no keys.
+    class EntryDirectory {
+    public:
+        EntryDirectory(const uint8_t *page, int32_t start, uint16_t entryCounter, AttrType type, int16_t nodeType);
+
+        // index == size() gives the end of the last entry
+        int32_t operator[](uint16_t index) const {
+            return stride ? (int32_t) (start + index * stride) : offsets[index];
+        }
+
+        uint16_t size() const { return entryCounter; }
+
+    private:
+        int32_t start;
+        int32_t stride;                                 // 0 for VarChar keys
+        uint16_t entryCounter;
+        std::vector<int32_t> offsets;
+    };
+
     template <>
     inline std::string internalEntry::getKey() const {
         auto *size = (int32_t *)this;
@@ -166,11 +193,14 @@ namespace PeterDB {
         static IndexManager &instance();
 
         // Create an index file.
-        RC createFile(const std::string &fileName);
+        RC createFile(const std::string &fileName, unsigned pageSize = PAGE_SIZE);
 
         // Delete an index file.
         RC destroyFile(const std::string &fileName);
 
+        // Replace a closed index file with another one.
+        RC renameFile(const std::string &fromFileName, const std::string &toFileName);
+
         // Open an index and return an ixFileHandle.
         RC openFile(const std::string &fileName, IXFileHandle &ixFileHandle);
 
@@ -202,12 +232,31 @@ namespace PeterDB {
 
         static bool isFileExists(const std::string fileName);
 
+        // Internal node at pageNum if it is resident in the node cache, nullptr otherwise
+        const uint8_t *getCachedNode(IXFileHandle &ixFileHandle, uint32_t pageNum);
+
+        // Keep an internal node resident, nothing is cached once the file reaches NODE_CACHE_CAPACITY
+        void cacheNode(IXFileHandle &ixFileHandle, uint32_t pageNum, const uint8_t *data);
+
+        // A page of the file has been written, refresh the cached copy if there is one
+        void refreshCachedNode(IXFileHandle &ixFileHandle, uint32_t pageNum, const uint8_t *data);
+
     protected:
         IndexManager() = default;                                                   // Prevent construction
         ~IndexManager() = default;                                                  // Prevent unwanted destruction
         IndexManager(const IndexManager &) = default;                               // Prevent construction by copying
         IndexManager &operator=(const IndexManager &) = default;                    // Prevent assignment
 
+    private:
+        // root and internal levels of one index file, shared by every handle of the file
+        struct NodeCache {
+            uint64_t generation;                                                    // see BufferPool::getFileGeneration
+            std::unordered_map<uint32_t, std::vector<uint8_t>> nodes;
+        };
+
+        std::unordered_map<FileId, NodeCache> nodeCaches;
+
+        NodeCache &getNodeCache(IXFileHandle &ixFileHandle);
     };
 
     class IX_ScanIterator {
@@ -220,7 +269,7 @@ namespace PeterDB {
         bool highKeyInclusive;
 
         int32_t curLeafPage;
-        int16_t remainDataLen;
+        int32_t remainDataLen;
         bool entryExceedUpperBound;
 
         // Constructor
@@ -246,6 +295,60 @@ namespace PeterDB {
         RC close();
     };
 
+    // Builds an empty index bottom-up from (key, rid) pairs given in any order:
+    // - the pairs are sorted externally, runs of runSize bytes are sorted in memory and spilled to temp files
+    // - the merged pairs are packed into consecutive leaves up to fillFactor
+    // - internal levels are built on top of the leaves until a single root is left
+    class IXBulkLoader {
+    public:
+        IXBulkLoader(IXFileHandle &ixFileHandle, const Attribute &attr, float fillFactor = IX::DEFAULT_FILL_FACTOR,
+                     size_t runSize = IX::BULK_LOAD_RUN_SIZE);
+        ~IXBulkLoader();
+
+        RC addEntry(const void *key, const RID &rid);
+        RC finish();                                    // Sort, then write the whole tree
+
+        unsigned getNumberOfRuns() const;               // # of runs spilled to disk so far
+
+    private:
+        // a child of the level being built with the smallest composite key of its subtree
+        struct ChildRef {
+            int32_t pageNum;
+            std::vector<uint8_t> minEntry;
+        };
+
+        IXFileHandle &ixFileHandle;
+        Attribute attr;
+        float fillFactor;
+        size_t runSize;
+        unsigned pageSize;                              // of the index file
+
+        std::vector<uint8_t> runData;                   // entries of the current run back to back
+        std::vector<uint32_t> runEntries;               // offsets in runData
+        std::vector<FILE *> runFiles;
+
+        std::vector<uint8_t> leafPage;
+        uint16_t leafFreeBytePointer;
+        uint16_t leafKeyCounter;
+        std::vector<ChildRef> leaves;
+        std::vector<uint8_t> pendingPages;              // new nodes not appended to the file yet
+
+        int32_t getEntryLength(const uint8_t *entry) const;
+        bool isEntryLess(const uint8_t *entry1, const uint8_t *entry2) const;
+        void sortRun();
+        RC spillRun();
+        RC readRunEntry(FILE *run, uint8_t *entry);
+        RC mergeRuns();
+
+        RC packEntry(const uint8_t *entry);
+        RC flushLeaf(bool isLastLeaf);
+        RC buildInternalLevels();
+        RC writeInternalNode(const std::vector<ChildRef> &children, size_t begin, size_t end, int32_t &pageNum);
+        int32_t getNextPageNum() const;
+        RC appendNode(const uint8_t *page);
+        RC flushPendingPages();
+    };
+
     class IXFileHandle {
     public:
 
@@ -254,9 +357,20 @@ namespace PeterDB {
         unsigned ixWritePageCounter;
         unsigned ixAppendPageCounter;
         int32_t rootPagePtr;
+        unsigned pageSize;                      // chosen at createFile
 
         std::string fileName;
-        FILE *fileInMemory;
+        bool fileOpen;
+
+        FileId fileId;                          // id of this file in the buffer pool
+        BufferCounter bufferCounter;
+
+        bool metadataDirty;                     // read/write counters changed since last flush
+        unsigned metadataFlushInterval;
+        unsigned pendingMetadataOps;
+
+        unsigned nodeCacheHitCounter;           // internal nodes served from the node cache
+        unsigned nodeCacheMissCounter;          // internal nodes read from the buffer pool
 
         // Constructor
         IXFileHandle();
@@ -267,12 +381,24 @@ namespace PeterDB {
         RC close();
 
         RC readPage(uint32_t pageNum, void* data);
+        // Read a node for a root-to-leaf descent, internal nodes come from the node cache.
+        // node points to the cached page, or to page if the node is not cached
+        RC readNode(uint32_t pageNum, uint8_t *page, const uint8_t *&node, uint16_t &nodeType);
         RC writePage(uint32_t pageNum, const void* data);
         RC appendPage(const void* data);
+        RC appendPages(unsigned numPages, const void* data);
         RC appendEmptyPage();
         RC initHiddenPage();
         RC readMetaData();
         RC flushMetaData();
+        RC flushCounters();
+        RC markMetaDataDirty();
+        RC checkpoint();
+        void setMetadataFlushInterval(unsigned interval);
+        // Page I/O through mmap, descents then read nodes in place instead of copying them
+        RC setMapped(bool mapped);
+        bool isMapped();
+        RC prefetchPages(uint32_t startPage, unsigned numPages);   // Start reading pages into the buffer pool
 
         RC createRootPage();
 
@@ -285,12 +411,19 @@ namespace PeterDB {
 
         uint32_t getNumberOfPages() const;
         uint32_t getLastPageIndex() const;
+        unsigned getPageSize() const;
 
 
 
         // Put the current counter values of associated PF FileHandles into variables
         RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount);
-
+        // Also put the buffer pool hit/miss/eviction counters of this handle into variables
+        RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount,
+                                unsigned &hitCount, unsigned &missCount, unsigned &evictCount);
+        // Also put the node cache hit/miss counters of this handle into variables
+        RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount,
+                                unsigned &hitCount, unsigned &missCount, unsigned &evictCount,
+                                unsigned &nodeCacheHitCount, unsigned &nodeCacheMissCount);
 
     };
 
@@ -303,15 +436,18 @@ namespace PeterDB {
         uint16_t keyCounter;
         uint16_t nodeType;
 
-        uint8_t data[PAGE_SIZE];
+        unsigned pageSize;
+        std::vector<uint8_t> buffer;            // data, origin and checkEntryKey back to back
+        uint8_t *data;
         // for sanity
-        uint8_t origin[PAGE_SIZE];
-        uint8_t checkEntryKey[PAGE_SIZE];
+        uint8_t *origin;
+        uint8_t *checkEntryKey;
 
         // existing node
         IXNode(IXFileHandle &ixFileHandle, uint32_t pageNum) : ixFileHandle(ixFileHandle), pageNum(pageNum) {
+            allocate();
             ixFileHandle.readPage(pageNum, data);
-            memcpy(origin, data, PAGE_SIZE);
+            memcpy(origin, data, pageSize);
 
             freeBytePointer = getFreeBytePointerFromData();
             nodeType = getNodeTypeFromData();
@@ -322,21 +458,23 @@ namespace PeterDB {
         IXNode(IXFileHandle &ixFileHandle, uint32_t page, uint16_t type, uint16_t freeByte, uint16_t counter) :
                 ixFileHandle(ixFileHandle), pageNum(page), nodeType(type), freeBytePointer(freeByte),
                 keyCounter(counter) {
+            allocate();
             ixFileHandle.readPage(pageNum, data);
-            memcpy(origin, data, PAGE_SIZE);
+            memcpy(origin, data, pageSize);
         }
 
         // new node when splitting
-        IXNode(uint8_t *newData, int16_t dataLen, IXFileHandle &ixFileHandle, uint32_t page, uint16_t type,
+        IXNode(uint8_t *newData, int32_t dataLen, IXFileHandle &ixFileHandle, uint32_t page, uint16_t type,
                uint16_t freeByte, uint16_t counter) :
                 ixFileHandle(ixFileHandle), pageNum(page), nodeType(type), freeBytePointer(freeByte),
                 keyCounter(counter) {
+            allocate();
             memcpy(data, newData, dataLen);
         }
 
         ~IXNode() {
             flushHeader();
-            if (memcmp(origin, data, PAGE_SIZE) != 0) {
+            if (memcmp(origin, data, pageSize) != 0) {
                 ixFileHandle.writePage(pageNum, data);
             }
         };
@@ -351,25 +489,32 @@ namespace PeterDB {
         uint32_t getPageNum() const { return this->pageNum; }
 
         uint16_t getNodeTypeFromData() const {
+            return getNodeTypeFromData(data, pageSize);
+        }
+
+        static uint16_t getNodeTypeFromData(const uint8_t *page, unsigned pageSize) {
             uint16_t type;
-            memcpy(&type, data + PAGE_SIZE - IX::NODE_TYPE_LEN,
+            memcpy(&type, page + pageSize - IX::NODE_TYPE_LEN,
                    IX::NODE_TYPE_LEN);
             return type;
         }
 
         uint16_t getFreeBytePointerFromData() {
             uint16_t ptr;
-            memcpy(&ptr, data + PAGE_SIZE - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN,
+            memcpy(&ptr, data + pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN,
                    IX::FREEBYTEPOINTER_LEN);
             return ptr;
         };
 
         uint16_t getkeyCounterFromData() const {
+            return getkeyCounterFromData(data, pageSize);
+        }
+
+        static uint16_t getkeyCounterFromData(const uint8_t *page, unsigned pageSize) {
             uint16_t counter;
-            memcpy(&counter, data + PAGE_SIZE - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN,
+            memcpy(&counter, page + pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN,
                    IX::KEY_COUNTER_LEN);
             return counter;
-
         }
 
         // setter
@@ -377,17 +522,17 @@ namespace PeterDB {
             if (type != IX::LEAF_NODE && type != IX::INTERNAL_NODE){
                 std::cout<<"s"<<std::endl;
             }
-            memcpy(data + PAGE_SIZE - IX::NODE_TYPE_LEN, &type, IX::NODE_TYPE_LEN);
+            memcpy(data + pageSize - IX::NODE_TYPE_LEN, &type, IX::NODE_TYPE_LEN);
             this->nodeType = type;
         }
 
         void setFreeBytePointer(uint16_t pointer) {
-            memcpy(data + PAGE_SIZE - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN, &pointer, IX::FREEBYTEPOINTER_LEN);
+            memcpy(data + pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN, &pointer, IX::FREEBYTEPOINTER_LEN);
             this->freeBytePointer = pointer;
         }
 
         void setkeyCounter(uint16_t counter) {
-            memcpy(data + PAGE_SIZE - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN,
+            memcpy(data + pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN,
                    &counter, IX::KEY_COUNTER_LEN);
             this->keyCounter = counter;
         }
@@ -398,9 +543,9 @@ namespace PeterDB {
             setFreeBytePointer(freeBytePointer);
         }
 
-        RC shiftDataLeft(int16_t dataNeedShiftStartPos, int16_t dist);
+        RC shiftDataLeft(int32_t dataNeedShiftStartPos, int32_t dist);
 
-        RC shiftDataRight(int16_t dataNeedMoveStartPos, int16_t dist);
+        RC shiftDataRight(int32_t dataNeedMoveStartPos, int32_t dist);
 
         bool isRoot(){
             if (getPageNum() == ixFileHandle.getRoot())return true;
@@ -414,9 +559,22 @@ namespace PeterDB {
             return str;
         }
 
-        bool isCompositeKeyMeetCompCondition(const uint8_t* key1, const uint8_t* key2, const Attribute& attr, const CompOp op);
-        bool isKeyMeetCompCondition(const uint8_t* key1, const uint8_t* key2, const Attribute& attr, const CompOp op);
-        bool isRidMeetCompCondition(const RID& rid1, const RID& rid2, const CompOp op);
+        static bool isCompositeKeyMeetCompCondition(const uint8_t* key1, const uint8_t* key2, const Attribute& attr, const CompOp op);
+        static bool isKeyMeetCompCondition(const uint8_t* key1, const uint8_t* key2, const Attribute& attr, const CompOp op);
+        static bool isRidMeetCompCondition(const RID& rid1, const RID& rid2, const CompOp op);
+        // Binary search for the first entry meeting GT_OP/GE_OP against key, size() if none does.
+        // Entries are sorted, so the condition flips from false to true only once
+        static uint16_t findFirstEntryMeetCompCondition(const uint8_t *page, const EntryDirectory &directory,
+                                                        const uint8_t *key, const Attribute &attr, CompOp op);
+
+    private:
+        void allocate() {
+            pageSize = ixFileHandle.getPageSize();
+            buffer.resize(3 * pageSize);
+            data = buffer.data();
+            origin = data + pageSize;
+            checkEntryKey = origin + pageSize;
+        }
     };
 
     class InternalNode : public IXNode {
@@ -427,11 +585,11 @@ namespace PeterDB {
         // Initialize new page containing one entry
         InternalNode(IXFileHandle &ixfileHandle, uint32_t page, uint32_t leftPage, internalEntry *key,
                      const Attribute &attr) : IXNode(ixfileHandle, page, IX::INTERNAL_NODE, 0, 1) {
-            int16_t pos = 0;
+            int32_t pos = 0;
             // Write left page pointer
             memcpy(data + pos, &leftPage, IX::NEXT_POINTER_LEN);
             pos += IX::NEXT_POINTER_LEN;
-            int16_t entryLen = key->getEntryLength(attr.type);
+            int32_t entryLen = key->getEntryLength(attr.type);
             memcpy(data + pos, (uint8_t *) key, entryLen);
             pos += entryLen;
 
@@ -440,24 +598,31 @@ namespace PeterDB {
         }
 
         // Initialize new page with existing entries
-        InternalNode(uint8_t *entryData, int16_t dataLen, IXFileHandle &ixfileHandle, uint32_t page,
-                     int16_t entryCounter) : IXNode(entryData, dataLen, ixfileHandle, page, IX::INTERNAL_NODE, dataLen,
+        InternalNode(uint8_t *entryData, int32_t dataLen, IXFileHandle &ixfileHandle, uint32_t page,
+                     int32_t entryCounter) : IXNode(entryData, dataLen, ixfileHandle, page, IX::INTERNAL_NODE, dataLen,
                                                     entryCounter) {};
 
         ~InternalNode() = default;
 
         // Get target child page, if not exist, append one
         RC getTargetChild(leafEntry *key, const Attribute &attr, int32_t & childPage);
+        // Same on a page image, used with nodes from the node cache
+        static RC getTargetChild(const uint8_t *page, unsigned pageSize, leafEntry *key, const Attribute &attr,
+                                 int32_t &childPage);
         // start from first key
         RC
         findPosToInsertKey(internalEntry *firstGEEntry, leafEntry *key, const Attribute &attr);
 
         RC
-        findPosToInsertKey(int16_t& curPos, internalEntry *key, const Attribute &attr);
+        findPosToInsertKey(int32_t& curPos, internalEntry *key, const Attribute &attr);
+
+        static RC
+        findPosToInsertKey(const uint8_t *page, uint16_t keyCounter, int32_t &curPos, internalEntry *key,
+                           const Attribute &attr);
 
         RC insertEntry(internalEntry* key, const Attribute &attr);
 
-        RC writeEntry(internalEntry *key, const Attribute &attribute, int16_t pos);
+        RC writeEntry(internalEntry *key, const Attribute &attribute, int32_t pos);
 
         RC splitNode(internalEntry *key, const Attribute &attr, internalEntry *newChildEntry);
 
@@ -466,7 +631,7 @@ namespace PeterDB {
         RC print(const Attribute &attr, std::ostream &out);
 
         uint16_t getFreeSpace() const {
-            return PAGE_SIZE - freeBytePointer - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
+            return pageSize - freeBytePointer - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
                    IX::NEXT_POINTER_LEN;
         }
 
@@ -491,8 +656,8 @@ namespace PeterDB {
         };
 
         // Initialize new page with existing entries
-        LeafNode(uint8_t *entryData, int16_t dataLen, IXFileHandle &ixFileHandle, uint32_t page, int32_t next,
-                 int16_t entryCounter) : IXNode(entryData, dataLen, ixFileHandle, page, IX::LEAF_NODE, dataLen,
+        LeafNode(uint8_t *entryData, int32_t dataLen, IXFileHandle &ixFileHandle, uint32_t page, int32_t next,
+                 int32_t entryCounter) : IXNode(entryData, dataLen, ixFileHandle, page, IX::LEAF_NODE, dataLen,
                                                 entryCounter) {
             setNextPtr(next);
         };
@@ -506,32 +671,32 @@ namespace PeterDB {
 
         int32_t getNextPtrFromData() const {
             int32_t ptr;
-            memcpy(&ptr, data + PAGE_SIZE - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
+            memcpy(&ptr, data + pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
                          IX::NEXT_POINTER_LEN,
                    IX::NEXT_POINTER_LEN);
             return ptr;
         }
 
         uint16_t getFreeSpace() const {
-            return PAGE_SIZE - freeBytePointer - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
+            return pageSize - freeBytePointer - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
                    IX::NEXT_POINTER_LEN;
         }
 
         uint16_t getMaxFreeSpace() const {
-            return PAGE_SIZE  - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
+            return pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
                    IX::NEXT_POINTER_LEN;
         }
 
-        RC getEntry(int16_t pos, leafEntry* leaf, Attribute attr);
+        RC getEntry(int32_t pos, leafEntry* leaf, Attribute attr);
         //setter
         void setNextPtr(int32_t ptr) {
-            memcpy(data + PAGE_SIZE - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
+            memcpy(data + pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
                    IX::NEXT_POINTER_LEN,
                    &ptr, IX::NEXT_POINTER_LEN);
             this->nextPtr = ptr;
         }
 
-        RC writeEntry(leafEntry *key, const Attribute &attribute, int16_t pos);
+        RC writeEntry(leafEntry *key, const Attribute &attribute, int32_t pos);
 
         RC insertEntry(leafEntry *key, const Attribute &attribute);
 
@@ -541,13 +706,13 @@ namespace PeterDB {
 
         RC insertOrSplitEntry(leafEntry *key, const Attribute &attribute, internalEntry * newChild, bool& isNewChildExist);
 
-        RC findFirstKeyMeetCompCondition(int16_t& pos, const uint8_t* key, const Attribute& attr, CompOp op);
+        RC findFirstKeyMeetCompCondition(int32_t& pos, const uint8_t* key, const Attribute& attr, CompOp op);
 
         bool isEmpty(){ return keyCounter == 0;}
 
         RC print(const Attribute &attr, std::ostream &out);
 
-        RC checkKey(int16_t pos, Attribute attr, leafEntry *key);
+        RC checkKey(int32_t pos, Attribute attr, leafEntry *key);
     };
 }// namespace PeterDB
 #endif // _ix_h_
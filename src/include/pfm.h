@@ -1,41 +1,632 @@
 #ifndef _pfm_h_
 #define _pfm_h_
 
-#define PAGE_SIZE 4096
+#define PAGE_SIZE 4096                                                  // page size of files created by default
+#define MIN_PAGE_SIZE 4096
+#define MAX_PAGE_SIZE 65536
 
 #include <string>
+#include <cstdio>
 #include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <sys/types.h>
+#include <sys/uio.h>
 #include "src/include/errorCode.h"
 
+struct io_uring_sqe;
+struct io_uring_cqe;
+
 namespace PeterDB {
 
     typedef unsigned PageNum;
     typedef int RC;
+    // "PD" in the high half marks a paged file, the low half is bumped whenever the header page layout changes;
+    // a file of another format is not opened, it has to be recreated
+    const unsigned FILE_FORMAT_VERSION = 0x50440002;
+
     // metadata of one file
     struct FileHeader{
         unsigned pageCounter;
         unsigned readPageCounter;
         unsigned writePageCounter;
         unsigned appendPageCounter;
+        unsigned pageSize;                                                  // chosen at createFile
+        unsigned pageFormat;                                                // chosen at createFile, for the layer above
+        unsigned formatVersion;                                             // FILE_FORMAT_VERSION at createFile
     };
 
+    // free-space map kept in the header page right after FileHeader, one byte per data page
+    // holding the free bytes of that page in 1/256 page units (rounded down), 16 bytes with 4 KB pages
+    const unsigned FSM_BUCKETS_PER_PAGE = 256;
+    const unsigned FSM_OFFSET = sizeof(FileHeader);
+
+    // Pages past those the header map covers get chained FSM pages, one byte per data page. Each FSM page
+    // sits in the file right before the run of data pages it covers; the buffer pool counts it as a page,
+    // the page numbers of FileHandle skip it.
+    inline unsigned getHeaderMapSize(unsigned pageSize) {
+        return pageSize - FSM_OFFSET;
+    }
+
+    // buffer pool page of a data page
+    inline PageNum getFilePageNum(PageNum pageNum, unsigned pageSize) {
+        unsigned headerMapSize = getHeaderMapSize(pageSize);
+        if (pageNum < headerMapSize) return pageNum;
+        return pageNum + 1 + (pageNum - headerMapSize) / pageSize;
+    }
+
+    // buffer pool page of the idx-th chained FSM page
+    inline PageNum getFsmFilePageNum(unsigned idx, unsigned pageSize) {
+        return getFilePageNum(getHeaderMapSize(pageSize) + idx * pageSize, pageSize) - 1;
+    }
+
     class FileHandle;
 
+/********************************************************************
+* Definition for write-ahead log *
+********************************************************************/
+    typedef uint64_t LSN;                                                   // log sequence number, 0 is none
+
+    // what a logged operation does, every record it logs carries it
+    typedef enum {
+        LOG_OP_NONE = 0, LOG_OP_RBFM_INSERT, LOG_OP_RBFM_UPDATE, LOG_OP_RBFM_DELETE, LOG_OP_IX_INSERT, LOG_OP_IX_DELETE,
+        LOG_OP_RM_INSERT, LOG_OP_RM_UPDATE, LOG_OP_RM_DELETE
+    } LogOperationType;
+
+    typedef enum {
+        LOG_PAGE_WRITE = 1, LOG_HEADER_WRITE, LOG_FILE_CREATE, LOG_FILE_DESTROY, LOG_COMMIT,
+        LOG_COMPENSATION, LOG_ABORT
+    } LogRecordType;
+
+    const size_t DEFAULT_CHECKPOINT_LOG_SIZE = (size_t) 64 << 20;           // checkpoint once the log is 64 MB
+    const unsigned DEFAULT_CHECKPOINT_INTERVAL = 30000;                     // ms, 0 checkpoints on the committer
+    const unsigned LOG_RUN_GAP = 8;                                         // closer changes form one run
+
+    // fixed part of every log record, followed by the file name and a body depending on the type:
+    // - page/header write: # of runs, then offset in the file, length, before and after bytes of every run
+    // - compensation: same as a page write, it puts back the before images of a page write of its operation
+    // - file create: page size, length and bytes of the initial header
+    struct LogRecordHeader {
+        uint32_t length;                                                    // whole record
+        uint32_t checksum;                                                  // of the bytes after this field
+        LSN lsn;
+        uint64_t opId;                                                      // 0 outside of any operation
+        uint8_t type;                                                       // LogRecordType
+        uint8_t opType;                                                     // LogOperationType
+        uint16_t nameLength;
+        PageNum pageNum;
+    };
+
+    //  LogManager keeps a write-ahead log of every change made through the buffer pool while it is open.
+    //  - RBFM record operations and IX entry operations run as logged operations, the pages and headers
+    //    they write are logged as runs of changed bytes with both their before and after images
+    //  - RM tuple operations wrap the record operation and its index entries into one logged operation
+    //  - an operation ends with a commit record and waits until the log is on disk; committers arriving
+    //    while a sync is running are written out together by the next sync (group commit)
+    //  - a failed operation is rolled back at once: the before images of its page writes go back through the
+    //    buffer pool newest first, each logged as a compensation record, and an abort record ends it; nested
+    //    ones leave it to the outermost
+    //  - dirty frames are still written back lazily, but never before the log covering them is on disk
+    //  - a checkpoint writes back and syncs every file, then empties the log; a checkpointer thread runs one
+    //    every checkpoint interval and whenever the log outgrows the size limit, so commits never wait for it
+    //  - open replays a log left behind by a crash: every change is redone in log order, then the changes
+    //    of operations that neither committed nor aborted are undone in reverse order, except the page
+    //    writes their compensation records took back already
+    //  Files are not mapped while the log is open, changes made in place through a mapping cannot be logged.
+    class LogManager {
+    public:
+        static LogManager &instance();                                      // Access to the singleton instance
+
+        RC open(const std::string &logFileName);                            // Recover, then log every change
+        RC close();                                                         // Checkpoint and stop logging
+        bool isOpen() const;
+
+        void beginOperation(LogOperationType type);                         // Nested operations join the outer one
+        RC commitOperation();                                               // The operation is durable on return
+        RC abortOperation();                                                // Ends it without a commit record
+
+        // Log the bytes of [fileOffset, fileOffset + length) changing from before to after,
+        // lsn is 0 if nothing changed
+        RC logChange(LogRecordType type, const std::string &fileName, PageNum pageNum, uint64_t fileOffset,
+                     const uint8_t *before, const uint8_t *after, unsigned length, LSN &lsn);
+        RC logFileCreate(const std::string &fileName, unsigned pageSize, const void *header, unsigned length);
+        RC logFileDestroy(const std::string &fileName);
+        RC flush(LSN lsn);                                                  // Until lsn is on disk
+        RC checkpoint();                                                    // Waits for running operations
+
+        void setCheckpointLogSize(size_t size);
+        void setCheckpointInterval(unsigned millis);                        // 0 stops the checkpointer thread
+        void setGroupCommitDelay(unsigned micros);                          // A sync waits for more committers
+        size_t getLogSize() const;                                          // Bytes written and buffered
+        RC collectCounterValues(unsigned &commitCount, unsigned &syncCount, unsigned &checkpointCount) const;
+        void getRecoveryCounts(unsigned &redoCount, unsigned &undoCount) const;  // Records replayed by open
+    protected:
+        LogManager();                                                       // Prevent construction
+        ~LogManager();                                                      // Prevent unwanted destruction
+        LogManager(const LogManager &);                                     // Prevent construction by copying
+        LogManager &operator=(const LogManager &);                          // Prevent assignment
+
+    private:
+        std::atomic<bool> enabled;
+        int fd;
+        std::string logFileName;
+
+        mutable std::mutex latch;                                           // buffer, LSNs and counters
+        std::condition_variable flushDone;
+        std::vector<uint8_t> buffer;                                        // records not written yet
+        LSN nextLSN;
+        LSN flushedLSN;
+        bool flushing;                                                      // a committer is syncing the log
+        size_t logSize;                                                     // bytes in the log file
+        uint64_t nextOpId;
+        size_t checkpointLogSize;
+        unsigned groupCommitDelay;
+        unsigned commitCounter;
+        unsigned syncCounter;
+        unsigned checkpointCounter;
+        unsigned redoCounter;
+        unsigned undoCounter;
+
+        std::mutex gateLatch;                                               // running operations vs. checkpoint
+        std::condition_variable gateChanged;
+        unsigned activeOperations;
+        bool checkpointing;
+
+        std::thread checkpointer;                                           // running while the log is open
+        std::mutex checkpointerLatch;
+        std::condition_variable checkpointerWake;
+        bool checkpointerStopping;
+        unsigned checkpointInterval;
+
+        RC appendRecord(LogRecordType type, const std::string &fileName, PageNum pageNum,
+                        const std::vector<uint8_t> &body, LSN &lsn);
+        RC endOperation(bool commit);                                       // The outermost one decides
+        RC rollback();                                                      // Of the operation of this thread
+        RC truncate();
+        RC recover();
+        void startCheckpointer();
+        void stopCheckpointer();
+        void runCheckpointer();
+        static uint32_t getChecksum(const uint8_t *data, size_t length);
+    };
+
+    // runs its scope as one logged operation, commit() makes it durable
+    // a scope left without commit(), e.g. an early return on failure, ends it without a commit record
+    class LogOperation {
+    public:
+        explicit LogOperation(LogOperationType type) : ended(false) { LogManager::instance().beginOperation(type); }
+        ~LogOperation() { if (!ended) LogManager::instance().abortOperation(); }
+        RC commit() {
+            ended = true;
+            return LogManager::instance().commitOperation();
+        }
+    private:
+        bool ended;
+    };
+
+/********************************************************************
+* Definition for buffer pool *
+********************************************************************/
+    typedef uint32_t FrameId;
+    typedef uint32_t FileId;
+
+    typedef enum {
+        REPLACE_LRU = 0, REPLACE_CLOCK, REPLACE_LRU_K
+    } ReplacementPolicy;
+
+    const unsigned DEFAULT_BUFFER_POOL_SIZE = 1024;                         // # of frames, 4 MB with 4 KB pages
+    const ReplacementPolicy DEFAULT_REPLACEMENT_POLICY = REPLACE_LRU;
+    const unsigned DEFAULT_LRU_K = 2;
+    const FileId FILE_ID_INVALID = UINT32_MAX;
+    // header counters are persisted every N page operations, 0 defers them to closeFile/checkpoint
+    const unsigned DEFAULT_METADATA_FLUSH_INTERVAL = 0;
+    // a mapped file reserves this much address space up front so that pages never move when it grows
+    const size_t MMAP_RESERVE_SIZE = (size_t) 1 << 34;                      // 16 GB
+    const size_t MMAP_CHUNK_SIZE = (size_t) 1 << 20;                        // the mapping grows 1 MB at a time
+    // a single preadv/pwritev moves at most this many pages, 256 KB with 4 KB pages
+    const unsigned MAX_VECTORED_IO_PAGES = 64;
+    // files grow on disk in extents reserved with fallocate, each as large as the file so far within these bounds
+    const size_t DEFAULT_MIN_EXTENT_SIZE = (size_t) 1 << 20;                // 1 MB
+    const size_t DEFAULT_MAX_EXTENT_SIZE = (size_t) 64 << 20;               // 64 MB
+    // ms between rounds of the background writer, 0 leaves write back to eviction and flushes
+    const unsigned DEFAULT_WRITER_INTERVAL = 0;
+
+    typedef enum {
+        IO_ENGINE_SYNC = 0, IO_ENGINE_URING, IO_ENGINE_THREAD_POOL
+    } IOEngineType;
+
+    // io_uring falls back to the thread pool where the kernel does not allow it
+    const IOEngineType DEFAULT_IO_ENGINE = IO_ENGINE_URING;
+    const unsigned IO_QUEUE_DEPTH = 64;                                     // requests in flight per engine
+    const unsigned IO_THREAD_POOL_SIZE = 4;
+
+    // hit/miss/eviction counters kept by the pool and by every file handle
+    struct BufferCounter {
+        unsigned hitCounter;
+        unsigned missCounter;
+        unsigned evictCounter;
+    };
+
+    // decides which unpinned frame gives up its page when the pool is full
+    class Replacer {
+    public:
+        virtual ~Replacer() = default;
+
+        // the page in this frame has just been pinned
+        virtual void recordAccess(FrameId frameId) = 0;
+
+        // only frames with a pin count of 0 are evictable
+        virtual void setEvictable(FrameId frameId, bool evictable) = 0;
+
+        // pick a victim and stop tracking it, false if every frame is pinned
+        virtual bool evict(FrameId &frameId) = 0;
+
+        // the frame is released without eviction, e.g. its file is destroyed
+        virtual void remove(FrameId frameId) = 0;
+    };
+
+    class LRUReplacer : public Replacer {
+    public:
+        explicit LRUReplacer(unsigned numFrames);
+
+        void recordAccess(FrameId frameId) override;
+        void setEvictable(FrameId frameId, bool evictable) override;
+        bool evict(FrameId &frameId) override;
+        void remove(FrameId frameId) override;
+    private:
+        // front is the least recently used frame
+        std::list<FrameId> lruList;
+        std::vector<std::list<FrameId>::iterator> position;
+        std::vector<bool> tracked;
+        std::vector<bool> evictable;
+    };
+
+    class ClockReplacer : public Replacer {
+    public:
+        explicit ClockReplacer(unsigned numFrames);
+
+        void recordAccess(FrameId frameId) override;
+        void setEvictable(FrameId frameId, bool evictable) override;
+        bool evict(FrameId &frameId) override;
+        void remove(FrameId frameId) override;
+    private:
+        FrameId hand;
+        std::vector<bool> referenced;
+        std::vector<bool> tracked;
+        std::vector<bool> evictable;
+    };
+
+    // evicts the frame whose K-th most recent access is the oldest,
+    // frames with less than K accesses go first (ordered by their first access)
+    class LRUKReplacer : public Replacer {
+    public:
+        LRUKReplacer(unsigned numFrames, unsigned k);
+
+        void recordAccess(FrameId frameId) override;
+        void setEvictable(FrameId frameId, bool evictable) override;
+        bool evict(FrameId &frameId) override;
+        void remove(FrameId frameId) override;
+    private:
+        unsigned k;
+        uint64_t currentTimestamp;
+        std::vector<std::deque<uint64_t>> history;
+        std::vector<bool> tracked;
+        std::vector<bool> evictable;
+    };
+
+    // one vectored read or write, iov has to stay valid until the request completes
+    struct IORequest {
+        int fd;
+        const struct iovec *iov;
+        int iovCount;
+        off_t offset;
+        bool isWrite;
+        uint64_t tag;                                                       // handed back with the completion
+    };
+
+    struct IOCompletion {
+        uint64_t tag;
+        ssize_t result;                                                     // bytes transferred, or -errno
+    };
+
+    // submits page reads/writes without waiting for them, completions are collected in any order
+    class IOEngine {
+    public:
+        // nullptr for IO_ENGINE_SYNC, io_uring falls back to the thread pool if it cannot be set up
+        static IOEngine *create(IOEngineType type, unsigned queueDepth = IO_QUEUE_DEPTH);
+        virtual ~IOEngine() = default;
+
+        // IO_QUEUE_FULL while queueDepth requests are in flight, reap a completion first
+        virtual RC submit(const IORequest &request) = 0;
+        virtual RC waitCompletion(IOCompletion &completion) = 0;             // Block until a request completes
+        virtual bool pollCompletion(IOCompletion &completion) = 0;          // false if none has completed yet
+        virtual unsigned getNumberOfInFlight() const = 0;
+        virtual IOEngineType getType() const = 0;
+    };
+
+    // a single io_uring driven through the raw syscalls, the caller serializes access
+    class URingEngine : public IOEngine {
+    public:
+        URingEngine();
+        ~URingEngine() override;
+
+        RC init(unsigned queueDepth);
+        RC submit(const IORequest &request) override;
+        RC waitCompletion(IOCompletion &completion) override;
+        bool pollCompletion(IOCompletion &completion) override;
+        unsigned getNumberOfInFlight() const override;
+        IOEngineType getType() const override;
+    private:
+        int ringFd;
+        unsigned queueDepth;
+        unsigned inFlight;
+        void *sqRing, *cqRing;
+        size_t sqRingSize, cqRingSize;
+        struct io_uring_sqe *sqes;
+        size_t sqesSize;
+        unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+        unsigned *cqHead, *cqTail, *cqMask;
+        struct io_uring_cqe *cqes;
+    };
+
+    // blocking preadv/pwritev on a few worker threads
+    class ThreadPoolEngine : public IOEngine {
+    public:
+        ThreadPoolEngine(unsigned numThreads, unsigned queueDepth);
+        ~ThreadPoolEngine() override;
+
+        RC submit(const IORequest &request) override;
+        RC waitCompletion(IOCompletion &completion) override;
+        bool pollCompletion(IOCompletion &completion) override;
+        unsigned getNumberOfInFlight() const override;
+        IOEngineType getType() const override;
+    private:
+        unsigned queueDepth;
+        unsigned inFlight;
+        bool stopping;
+        std::deque<IORequest> requests;
+        std::deque<IOCompletion> completions;
+        mutable std::mutex mutex;
+        std::condition_variable requestReady;
+        std::condition_variable completionReady;
+        std::vector<std::thread> workers;
+
+        void run();
+    };
+
+    //  BufferPool caches pages of every paged file in a fixed number of frames.
+    //  FileHandle and IXFileHandle go through it for all page I/O:
+    //  - readPage/writePage copy a page out of/into a frame, writes only mark the frame dirty
+    //  - appendPage is written through so the file grows on disk right away, into space reserved an extent
+    //    at a time past the end of the file; the file size and the page count only cover written pages
+    //  - dirty frames are written back on eviction, closeFile, flushFile or pool destruction
+    //  - a background writer can trickle dirty frames out in page order ahead of eviction, one pwritev
+    //    per run of pages, releasing the latch between runs
+    //  Callers that want to work on the frame directly use fetchPage/unpinPage.
+    //  All disk access is positional (pread/pwrite), runs of pages take one preadv/pwritev, and every
+    //  public method holds the pool latch, so several threads may read through the same file.
+    //  With an IOEngine, prefetchPages only submits its reads: the frames stay pinned until the read
+    //  completes and fetching such a page waits for it.
+    //  A file can be switched to mapped mode instead: its pages are then read and written in place
+    //  through a shared mmap of the file and never take a frame.
+    //  With a LogManager set, page and header writes are logged before they change a frame or the disk,
+    //  and a frame is only written back once the log is on disk up to its last change.
+    class BufferPool {
+    public:
+        static BufferPool &instance();                                      // Access to the singleton instance
+
+        RC setPoolSize(unsigned numFrames);                                 // Flush and rebuild with numFrames frames
+        unsigned getPoolSize() const;
+        RC setReplacementPolicy(ReplacementPolicy policy, unsigned k = DEFAULT_LRU_K);
+        ReplacementPolicy getReplacementPolicy() const;
+        RC setIOEngine(IOEngineType type);                                  // Waits for reads in flight first
+        IOEngineType getIOEngine() const;                                   // The engine actually in use
+        RC setLogManager(LogManager *logManager);                           // nullptr stops logging
+        RC setWriterInterval(unsigned millis);                              // 0 stops the background writer
+        RC setExtentSize(size_t minSize, size_t maxSize);                   // 0 reserves nothing ahead
+        unsigned getWriterInterval() const;
+
+        FileId registerFile(const std::string &fileName);                   // Same name always maps to the same id
+        // Pages of a file are PAGE_SIZE bytes until its header has been read, resident pages are dropped on a change
+        RC setFilePageSize(FileId fileId, unsigned pageSize);
+        unsigned getFilePageSize(FileId fileId) const;
+
+        // Pin a page, a miss loads it from disk unless the caller is going to overwrite the whole page
+        RC fetchPage(FileId fileId, PageNum pageNum, bool loadFromDisk, uint8_t *&page, BufferCounter &counter);
+        RC unpinPage(FileId fileId, PageNum pageNum, bool isDirty);
+
+        RC readPage(FileId fileId, PageNum pageNum, void *data, BufferCounter &counter);
+        RC writePage(FileId fileId, PageNum pageNum, const void *data, BufferCounter &counter);
+        RC appendPage(FileId fileId, PageNum pageNum, const void *data, BufferCounter &counter);
+        // Load pages that are not resident yet, each run of missing pages takes a single read,
+        // issued asynchronously when an IOEngine is set
+        RC prefetchPages(FileId fileId, PageNum startPage, unsigned numPages, BufferCounter &counter);
+        // Copy numPages consecutive pages into data, resident pages come from their frames and the
+        // others are read from disk in one call per run without taking a frame
+        RC readPages(FileId fileId, PageNum firstPage, unsigned numPages, void *data, BufferCounter &counter);
+        // Write numPages consecutive pages through to disk in one call, may extend the file
+        RC writePages(FileId fileId, PageNum firstPage, unsigned numPages, const void *data);
+        // Bumped on every page write of the file, lets readers tell if a copy of a page is stale
+        uint64_t getFileVersion(FileId fileId) const;
+        // Bumped only when the cached pages of the file are dropped, i.e. the file is created or destroyed,
+        // or when an aborted operation rolls its pages back
+        uint64_t getFileGeneration(FileId fileId) const;
+        void bumpFileGeneration(FileId fileId);
+
+        // The header page is not cached in frames, it goes straight through the file's descriptor
+        RC readFileHeader(FileId fileId, unsigned offset, void *data, unsigned length);
+        RC writeFileHeader(FileId fileId, unsigned offset, const void *data, unsigned length);
+
+        // Map the file, the random access hint is set by default and read-ahead asks for the pages it needs
+        RC setFileMapped(FileId fileId, bool mapped);
+        bool isFileMapped(FileId fileId) const;
+
+        RC flushFile(FileId fileId);                                        // Write back dirty frames of one file
+        RC closeFile(FileId fileId);                                        // Write back and close the descriptor
+        RC flushAll();
+        RC syncFiles();                                                     // fdatasync files written since last sync
+        RC writeBackDirtyPages();                                           // One round of the background writer
+        RC dropFile(const std::string &fileName);                           // Discard frames without write back
+
+        RC collectCounterValues(unsigned &hitCount, unsigned &missCount, unsigned &evictCount);
+        RC collectWriterCounterValues(unsigned &roundCount, unsigned &writeCount, unsigned &dirtyEvictCount);
+    protected:
+        BufferPool();                                                       // Prevent construction
+        ~BufferPool();                                                      // Prevent unwanted destruction
+        BufferPool(const BufferPool &);                                     // Prevent construction by copying
+        BufferPool &operator=(const BufferPool &);                          // Prevent assignment
+
+    private:
+        struct Frame {
+            FileId fileId;
+            PageNum pageNum;
+            uint32_t pinCount;
+            bool isDirty;
+            bool isValid;
+            uint64_t ioTag;                                                 // read in flight, 0 if none
+            LSN pageLSN;                                                    // last logged change not written back
+        };
+
+        // an asynchronous read of consecutive pages into the frames pinned for them
+        struct PendingRead {
+            std::vector<FrameId> frameIds;
+            std::vector<struct iovec> iov;
+        };
+
+        unsigned poolSize;
+        ReplacementPolicy policy;
+        unsigned lruK;
+
+        std::vector<Frame> frames;
+        std::vector<std::vector<uint8_t>> frameData;                        // sized to the page of the frame
+        std::vector<FrameId> freeFrames;
+        std::unordered_map<uint64_t, FrameId> pageTable;                    // (fileId, pageNum) -> frame
+        Replacer *replacer;
+
+        std::unordered_map<std::string, FileId> fileIds;
+        std::vector<std::string> fileNames;                                 // indexed by FileId
+        std::vector<int> fds;                                               // opened lazily, -1 if closed
+        std::vector<uint64_t> fileVersions;
+        std::vector<uint64_t> fileGenerations;
+        std::vector<unsigned> pageSizes;
+        std::vector<bool> unsyncedFiles;                                    // written since the last syncFiles
+        std::vector<size_t> reservedSizes;                                  // bytes allocated on disk, known so far
+        size_t minExtentSize;
+        size_t maxExtentSize;
+
+        struct Mapping {
+            uint8_t *base;                                                  // nullptr if the file is not mapped
+            size_t mappedSize;                                              // bytes backed by the file so far
+        };
+        std::vector<Mapping> mappings;                                      // indexed by FileId
+
+        BufferCounter counter;
+        mutable std::recursive_mutex latch;                                 // public methods call each other
+
+        IOEngine *ioEngine;                                                 // nullptr reads synchronously
+        uint64_t nextIOTag;
+        std::unordered_map<uint64_t, PendingRead> pendingReads;
+
+        LogManager *logManager;                                             // nullptr if changes are not logged
+
+        std::thread writer;
+        std::mutex writerLatch;
+        std::condition_variable writerWake;
+        bool writerStopping;
+        unsigned writerInterval;
+        unsigned writerRoundCounter;
+        unsigned writerPageCounter;                                         // pages written by the writer
+        unsigned dirtyEvictCounter;                                         // evictions that had to write
+
+        static uint64_t getPageKey(FileId fileId, PageNum pageNum);
+        long getPageOffset(FileId fileId, PageNum pageNum) const;
+        uint8_t *getFrameData(FrameId frameId);
+
+        Replacer *createReplacer() const;
+        int getFd(FileId fileId);
+        static ssize_t readFully(int fd, void *data, size_t length, off_t offset);
+        static bool writeFully(int fd, const void *data, size_t length, off_t offset);
+        RC getFreeFrame(FileId fileId, FrameId &frameId, BufferCounter &handleCounter);
+        RC writeBackFrame(FrameId frameId);
+        RC writeBackFrames(std::vector<FrameId> &frameIds);
+        RC logWriteThrough(FileId fileId, PageNum firstPage, unsigned numPages, const uint8_t *data);
+        RC reserveExtent(FileId fileId, size_t end);
+        RC submitRead(FileId fileId, PageNum firstPage, unsigned numPages, BufferCounter &handleCounter);
+        void completeRead(const IOCompletion &completion);
+        RC waitForRead(uint64_t tag);
+        RC drainReads();
+        void stopWriter();
+        void runWriter();
+        void releaseFrame(FrameId frameId);
+        RC growMapping(FileId fileId, size_t size);
+        void unmapFile(FileId fileId);
+    };
+
+    // files closed by every handle stay cached until more than this many files are open
+    const unsigned DEFAULT_MAX_OPEN_FILES = 64;
+
+    // header state of one open file, shared by every FileHandle of that file
+    struct FileState {
+        FileId fileId;                                                      // id of this file in the buffer pool
+        FileHeader header;
+        bool metadataDirty;                                                 // counters changed since last flush
+        unsigned pendingMetadataOps;
+        std::vector<uint8_t> freeSpaceMap;                                  // one bucket per page, header map first
+        unsigned fsmBucketSize;                                             // bytes per bucket
+        bool freeSpaceMapDirty;                                             // the part in the header page
+        std::vector<bool> fsmPagesDirty;                                    // one per chained FSM page
+        uint64_t lastUsed;                                                  // registry tick of the last open/close
+        std::mutex latch;                                                   // page I/O and counters of this file
+    };
+
+    //  PagedFileManager keeps a registry of open files so that opening a file again is only a lookup.
+    //  - every FileHandle of a file points to the same FileState, page count and counters are shared
+    //  - closing the last handle writes back pages and header, the descriptor stays open until eviction
+    //  - idle files beyond maxOpenFiles are evicted least recently used first, their descriptor is closed
     class PagedFileManager {
+        friend class FileHandle;
+        friend class LogManager;
     public:
         static PagedFileManager &instance();                                // Access to the singleton instance
 
-        RC createFile(const std::string &fileName);                         // Create a new file
+        RC createFile(const std::string &fileName, unsigned pageSize = PAGE_SIZE,
+                      unsigned pageFormat = 0);                             // Create a new file
         RC destroyFile(const std::string &fileName);                        // Destroy a file
+        // Give a closed file the name of another closed file, replacing it in one step
+        RC renameFile(const std::string &fromFileName, const std::string &toFileName);
         RC openFile(const std::string &fileName, FileHandle &fileHandle);   // Open a file
         RC closeFile(FileHandle &fileHandle);                               // Close a file
         bool isFileExists(const std::string fileName);
+        static bool isValidPageSize(unsigned pageSize);                     // Power of two in [MIN, MAX]_PAGE_SIZE
+
+        RC setMaxOpenFiles(unsigned numFiles);                              // Evicts idle files above the cap
+        unsigned getMaxOpenFiles() const;
+        unsigned getNumberOfOpenFiles() const;                              // Files with a cached header state
+        RC flushAll();                                                      // Write back pages and headers of every file
     protected:
         PagedFileManager();                                                 // Prevent construction
         ~PagedFileManager();                                                // Prevent unwanted destruction
         PagedFileManager(const PagedFileManager &);                         // Prevent construction by copying
         PagedFileManager &operator=(const PagedFileManager &);              // Prevent assignment
 
+    private:
+        std::unordered_map<std::string, std::shared_ptr<FileState>> fileStates;
+        mutable std::recursive_mutex registryLatch;                         // the checkpointer flushes concurrently
+        unsigned maxOpenFiles;
+        uint64_t clock;
+
+        RC acquireFileState(const std::string &fileName, std::shared_ptr<FileState> &state);
+        RC releaseFileState(std::shared_ptr<FileState> &state);
+        RC evictIdleFiles();
+        RC writeBackFileState(FileState &state);
+        RC writeFreeSpaceMap(FileState &state);                             // Dirty parts only, latch held
+        void forgetFile(const std::string &fileName);                       // Drop the state without write back
     };
 
     class FileHandle {
@@ -51,25 +642,43 @@ namespace PeterDB {
         RC readPage(PageNum pageNum, void *data);                           // Get a specific page
         RC writePage(PageNum pageNum, const void *data);                    // Write a specific page
         RC appendPage(const void *data);                                    // Append a specific page
+        RC readPages(PageNum firstPage, unsigned numPages, void *data);     // Get consecutive pages
+        RC writePages(PageNum firstPage, unsigned numPages, const void *data);  // Overwrite consecutive pages
+        RC appendPages(unsigned numPages, const void *data);                // Append consecutive pages
+        RC pinPage(PageNum pageNum, const uint8_t *&page);                  // Read a page in place until unpinPage
+        RC unpinPage(PageNum pageNum);
         unsigned getNumberOfPages();                                        // Get the number of pages in the file
+        unsigned getPageSize();                                             // Chosen when the file was created
+        unsigned getPageFormat();                                           // Chosen when the file was created
         RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount,
                                 unsigned &appendPageCount);                 // Put current counter values into variables
+        RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount,
+                                unsigned &hitCount, unsigned &missCount,
+                                unsigned &evictCount);                      // Also put buffer pool counters
+        RC checkpoint();                                                    // Persist dirty pages and counters
+        RC getPageFreeSpace(PageNum pageNum, unsigned &freeBytes);          // Lower bound from the free-space map
+        RC setPageFreeSpace(PageNum pageNum, unsigned freeBytes);
+        RC findPageWithFreeSpace(unsigned freeBytes, PageNum startPage,
+                                 PageNum &pageNum);                         // First tracked page from startPage
+        RC prefetchPages(PageNum startPage, unsigned numPages);             // Read ahead into the buffer pool
+        uint64_t getFileVersion();                                          // Changes whenever a page is written
+        void setMetadataFlushInterval(unsigned interval);                   // Persist counters every N operations
+        RC setMapped(bool mapped);                                          // Page I/O through mmap, per file
+        bool isMapped();
+        uint8_t *getMappedPage(PageNum pageNum);                            // Page in the mapping, nullptr if unmapped
         bool isFileOpen();
     private:
-        uint32_t pageCounter;
-        uint32_t readPageCounter;
-        uint32_t writePageCounter;
-        uint32_t appendPageCounter;
-
-        FILE *fileInMemory;                                                 // in memory file
-        std::string fileName;
-        bool fileIsOpen;
+        std::shared_ptr<FileState> state;                                   // null while the handle is closed
+        BufferCounter bufferCounter;
+        unsigned metadataFlushInterval;
 
         RC flushMetadata();
-        RC readMetadata();
+        RC flushCounters();
+        RC flushFreeSpaceMap();
+        RC markMetadataDirty();
+        RC appendFsmPageIfNeeded();                                         // Before the page at pageCounter
+        unsigned getContiguousPages(PageNum pageNum, unsigned numPages);    // Run without an FSM page inside
     };
-
-    const int File_Header_Page_Size = PAGE_SIZE;
 } // namespace PeterDB
 
-#endif // _pfm_h_
\ No newline at end of file
+#endif // _pfm_h_
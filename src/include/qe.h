@@ -11,6 +11,9 @@
 namespace PeterDB {
 
 #define QE_EOF (-1)  // end of the index scan
+
+    const unsigned GHJOIN_BUILD_PAGES = 256;    // a partition pair is joined in memory once its build side fits
+    const unsigned GHJOIN_MAX_LEVEL = 3;        // stop repartitioning, e.g. when a single key fills a partition
     typedef enum AggregateOp {
         MIN = 0, MAX, COUNT, SUM, AVG
     } AggregateOp;
@@ -40,6 +43,12 @@ namespace PeterDB {
 
         virtual RC getAttributes(std::vector<Attribute> &attrs) const = 0;
 
+        // the next tuple read in place on its page, for inputs that scan a row table; the others return
+        // LAYOUT_NOT_SUPPORTED without moving on, and are read with getNextTuple
+        virtual RC getNextTupleView(RecordView &view) {
+            return RC(RBFM_ERROR::LAYOUT_NOT_SUPPORTED);
+        }
+
         virtual ~Iterator() = default;
     };
 
@@ -83,6 +92,10 @@ namespace PeterDB {
             return iter.getNextTuple(rid, data);
         };
 
+        RC getNextTupleView(RecordView &view) override {
+            return iter.getNextTupleView(rid, view);
+        };
+
         RC getAttributes(std::vector<Attribute> &attributes) const override {
             attributes.clear();
             attributes = this->attrs;
@@ -161,6 +174,13 @@ namespace PeterDB {
         Iterator *iter;
         Condition cond;
         std::vector<Attribute> attrs;
+        // the condition is checked on the page bytes while the input can read in place
+        bool readInPlace;
+        int16_t lhsAttrIdx;
+        std::vector<uint16_t> allAttrIdx;
+        RecordView view;
+
+        bool isViewMeetCondition(const RecordView &record) const;
     public:
         Filter(Iterator *input,               // Iterator of input R
                const Condition &condition     // Selection condition
@@ -198,29 +218,38 @@ namespace PeterDB {
 
     class BNLJoin : public Iterator {
         // Block nested-loop join operator
+        // header of an outer tuple copied into the block arena, the tuple follows it
+        struct BlockEntry {
+            uint32_t next;                      // offset of the next tuple with the same key
+            uint16_t keyOffset;                 // join key position inside the tuple
+            uint16_t keyLen;
+        };
+        static const uint32_t NO_ENTRY = UINT32_MAX;
+
         Iterator* outer;
         TableScan* inner;
         Condition cond;
-        uint32_t hashTableMaxSize, remainSize;
-        // if has a pointer points to a linked list with a matched key
-        bool hasPointer;
-        int32_t matchedIntKey;
-        float matchedFloatKey;
-        std::string matchedStrKey;
-        int32_t hashLinkedListPos = INT16_MAX;
 
         std::vector<Attribute> outerAttrs, innerAttrs;
         std::vector<Attribute> joinedAttrs;
         Attribute outerJoinAttr;
         Attribute innerJoinAttr;
+        int16_t outerJoinIdx, innerJoinIdx;
 
         uint8_t innerReadBuffer[PAGE_SIZE];
         uint8_t outerReadBuffer[PAGE_SIZE];
+        bool hasPendingOuter;                   // outerReadBuffer holds a tuple that did not fit in the last block
+        bool isOuterDone;
+
+        // outer block: tuples back to back in one arena of numPages * PAGE_SIZE bytes,
+        // indexed by an open addressing table holding the first arena offset of every key
+        std::vector<uint8_t> arena;
+        uint32_t arenaUsed;
+        std::vector<uint32_t> slots;
+        uint32_t slotMask;
+        uint32_t matchPos;                      // next outer tuple matching the current inner tuple
 
-        // for outer table block load
-        std::unordered_map<int32_t, std::vector<std::vector<uint8_t>>> intHash;
-        std::unordered_map<float, std::vector<std::vector<uint8_t>>> floatHash;
-        std::unordered_map<std::string, std::vector<std::vector<uint8_t>>> strHash;
+        uint32_t findSlot(const uint8_t *key, uint16_t keyLen) const;
 
     public:
         BNLJoin(Iterator *leftIn,            // Iterator of input R
@@ -272,14 +301,91 @@ namespace PeterDB {
         RC getAttributes(std::vector<Attribute> &attrs) const override;
     };
 
-    // 10 extra-credit points
+    class PartitionScan : public Iterator {
+        // A wrapper inheriting Iterator over a partition file written by GHJoin
+    private:
+        FileHandle fileHandle;
+        RBFM_ScanIterator iter;
+        std::vector<Attribute> attrs;
+        RID rid;
+    public:
+        PartitionScan(const std::string &fileName, const std::vector<Attribute> &attrs) {
+            RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+            this->attrs = attrs;
+            std::vector<std::string> attrNames;
+            for (const Attribute &attr : attrs) {
+                attrNames.push_back(attr.name);
+            }
+            rbfm.openFile(fileName, fileHandle);
+            rbfm.scan(fileHandle, attrs, "", NO_OP, NULL, attrNames, iter);
+        };
+
+        RC getNextTuple(void *data) override {
+            return iter.getNextRecord(rid, data);
+        };
+
+        RC getAttributes(std::vector<Attribute> &attributes) const override {
+            attributes = this->attrs;
+            return 0;
+        };
+
+        ~PartitionScan() override {
+            iter.close();
+            RecordBasedFileManager::instance().closeFile(fileHandle);
+        };
+    };
+
     class GHJoin : public Iterator {
         // Grace hash join operator
+        struct PartitionPair {
+            std::string leftFile, rightFile;
+            size_t leftSize, rightSize;             // bytes of tuples in each file
+            unsigned level;                         // # of times the tuples have been partitioned
+        };
+
+        Iterator *left;
+        Iterator *right;
+        Condition cond;
+        unsigned numPartitions;
+        size_t buildMaxSize;
+
+        std::vector<Attribute> leftAttrs, rightAttrs;
+        std::vector<Attribute> joinedAttrs;
+        int16_t leftJoinIdx, rightJoinIdx;
+        AttrType joinType;
+
+        std::string filePrefix;                     // unique per process and operator
+        unsigned nextFileNum;                       // partition files are never named twice
+        std::vector<std::string> partitionFiles;    // every file created, destroyed with the operator
+        std::vector<PartitionPair> pendingPairs;
+        RC partitionRc;                             // error of the partition phase, returned by getNextTuple
+
+        // in-memory join of the current partition pair, the build side is loaded in blocks of at most
+        // buildMaxSize bytes and the probe side is scanned once per block
+        bool buildOnLeft;
+        std::unordered_map<std::string, std::vector<std::vector<uint8_t>>> buildHash;
+        PartitionScan *build;                       // open while build tuples are left for another block
+        bool hasPendingBuild;                       // buildBuffer holds a tuple that did not fit in the last block
+        std::string probeFile;
+        PartitionScan *probe;
+        const std::vector<std::vector<uint8_t>> *matches;
+        size_t matchPos;
+        uint8_t readBuffer[PAGE_SIZE];
+        uint8_t buildBuffer[PAGE_SIZE];
+
+        bool getKey(const uint8_t *data, bool isLeft, std::string &key) const;
+        RC partition(Iterator *input, bool isLeft, unsigned level, std::vector<std::string> &files,
+                     std::vector<size_t> &sizes);
+        RC repartition(const PartitionPair &pair);
+        RC buildAndProbe(const PartitionPair &pair);
+        RC loadBuildBlock();
+
     public:
         GHJoin(Iterator *leftIn,               // Iterator of input R
                Iterator *rightIn,               // Iterator of input S
                const Condition &condition,      // Join condition (CompOp is always EQ)
-               const unsigned numPartitions     // # of partitions for each relation (decided by the optimizer)
+               const unsigned numPartitions,    // # of partitions for each relation (decided by the optimizer)
+               const unsigned buildPages = GHJOIN_BUILD_PAGES   // memory for the hash table of one partition
         );
 
         ~GHJoin() override;
@@ -339,6 +445,20 @@ namespace PeterDB {
 
     class QEHelper {
     public:
+        static uint16_t getKeyLength(const uint8_t *key, AttrType type) {
+            if (type == TypeVarChar) return sizeof(int32_t) + *(const int32_t *) key;
+            return sizeof(int32_t);
+        }
+
+        // FNV-1a over the key bytes
+        static uint32_t hashKey(const uint8_t *key, uint16_t keyLen) {
+            uint32_t hash = 2166136261u;
+            for (uint16_t i = 0; i < keyLen; i++) {
+                hash = (hash ^ key[i]) * 16777619u;
+            }
+            return hash;
+        }
+
         static bool isSameKey(uint8_t* key1, uint8_t* key2, AttrType& type){
             switch (type) {
                 case TypeInt:
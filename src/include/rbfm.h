@@ -39,11 +39,19 @@ namespace PeterDB {
     typedef uint16_t AttrNum;
     typedef int16_t AttrDir;
 
-    // type for page
+    // type for page, unsigned 16 bit offsets cover pages up to MAX_PAGE_SIZE
     typedef uint16_t FreeBytePointer;
     typedef uint16_t SlotCounter;
-    typedef int16_t SlotOffset;
-    typedef int16_t SlotLen;
+    typedef uint16_t FragmentedBytes;           // bytes of dead records below the free byte pointer
+    typedef uint16_t FreeSlotHead;              // first empty slot, each empty slot keeps the next one in its length
+    typedef uint16_t SlotOffset;
+    typedef int16_t SlotLen;                    // negative for a record that is not at its original rid
+
+    // how the records of a file are laid out in its pages, chosen at createFile
+    typedef enum {
+        PAGE_LAYOUT_ROW = 0,        // slotted pages holding whole records, see PageHelper
+        PAGE_LAYOUT_PAX             // one minipage per attribute, see PaxPageHelper
+    } PageLayout;
 
     // constant value for record
     const Flag RECORD_FLAG_DATA = 0;
@@ -53,17 +61,21 @@ namespace PeterDB {
     const int16_t FLAG_DATA = 0;
     const int16_t FLAG_POINTER = 1;
 
-    const SlotOffset SLOT_OFFSET_EMPTY = -1;
+    const SlotOffset SLOT_OFFSET_EMPTY = UINT16_MAX;    // never a valid offset, the page ends with its footer
     const SlotLen SLOT_LEN_EMPTY = 0;
-
-    const int8_t SHIFT_LEFT = 1;
-    const int8_t SHIFT_RIGHT = 2;
+    const FreeSlotHead FREE_SLOT_END = 0;               // slots start from 1
 
     const AttrDir ATTR_DIR_EMPTY = -1;
 
     const int32_t CONDITION_ATTR_IDX_INVALID = -1;
     const int32_t ATTR_IDX_INVALID = -1;
 
+    // # of pages a scan asks the buffer pool to load ahead of the page it is on
+    const unsigned DEFAULT_SCAN_READ_AHEAD = 8;
+
+    // records keep 16 bit offsets in their directory and slot, whatever the page size
+    const int32_t MAX_RECORD_SIZE = INT16_MAX;
+
 /********************************************************************
 * Definition for record struct *
 ********************************************************************/
@@ -194,8 +206,7 @@ namespace PeterDB {
             short bitNumber = idx % 8;
             uint8_t mask = 0x01;
             // move to the bit that need to set
-            uint8_t tmp = *((uint8_t *) this + byteNumber) >> (7 - bitNumber);
-            tmp |= mask;
+            *((uint8_t *) this + byteNumber) |= mask << (7 - bitNumber);
         }
 
         void * dataSection(const int AttrNum) const {
@@ -253,6 +264,17 @@ namespace PeterDB {
         NO_OP       // no condition
     } CompOp;
 
+    // One condition of a scan, a record is returned if it meets all of them.
+    // "value" has no null indicator, a VarChar value starts with its 4 byte length.
+    typedef struct ScanCondition {
+        std::string attrName;
+        CompOp op;
+        const void *value;
+    } ScanCondition;
+
+    // a comparison specialized for one type and operator, run on the value bytes inside the page
+    typedef bool (*FieldPredicate)(const uint8_t *field, int16_t fieldLen, const uint8_t *value, int32_t valueLen);
+
 
 
 # define RBFM_EOF (-1)  // end of a scan operator
@@ -270,6 +292,82 @@ namespace PeterDB {
 /********************************************************************
 * Definition for RBFM class *
 ********************************************************************/
+    class PageHelper;
+    class PaxPageHelper;
+
+    // A record read in place: its page stays pinned in the buffer pool (or mapped) while the view is open,
+    // and fields are decoded from the page bytes without copying the record out.
+    // The view is valid until it is released or reopened, and must not outlive writes to its page.
+    class RecordView {
+    public:
+        RecordView() = default;
+
+        ~RecordView();
+
+        RecordView(const RecordView &) = delete;                            // owns a pin
+
+        RecordView &operator=(const RecordView &) = delete;
+
+        // unpin the page, the view is closed afterwards
+        RC release();
+
+        bool isOpen() const {
+            return record != nullptr;
+        }
+
+        int16_t getAttrNum() const;
+
+        // attributes added after the record was written read as null
+        bool isNull(int16_t attrIdx) const;
+
+        // value bytes inside the page, a VarChar has no length prefix; nullptr for a null field
+        const uint8_t *getFieldPtr(int16_t attrIdx) const;
+
+        int16_t getFieldLength(int16_t attrIdx) const;
+
+        // both of the above with one pass over the directory, false for a null field
+        bool readField(int16_t attrIdx, const uint8_t *&field, int16_t &fieldLen) const;
+
+        // TypeInt and TypeReal fields, and TypeVarChar as std::string; a null field reads as zero or empty,
+        // check isNull to tell the two apart
+        template<typename T>
+        T getField(int16_t attrIdx) const {
+            T value = T();
+            const uint8_t *field;
+            int16_t fieldLen;
+            if (readField(attrIdx, field, fieldLen)) memcpy(&value, field, sizeof(T));
+            return value;
+        }
+
+        // copy the selected fields out in the format of readRecord
+        RC toRawData(const std::vector<Attribute> &recordDescriptor, std::vector<uint16_t> &selectedAttrIdx,
+                     void *data) const;
+
+    private:
+        friend class RecordBasedFileManager;
+        friend class RBFM_ScanIterator;
+
+        FileHandle *fileHandle = nullptr;
+        PageNum pageNum = 0;
+        const uint8_t *record = nullptr;
+        int16_t recordLen = 0;
+        bool ownsPin = false;                   // false for a view into a page pinned by its caller
+
+        // pin the page of the record at (pageNum, slotNum), following a moved record to its data
+        RC open(FileHandle &fileHandle, PageNum pageNum, uint16_t slotNum);
+
+        // a record on a page the caller keeps pinned while the view is open, release leaves the pin alone
+        void openInPage(const uint8_t *record, int16_t recordLen);
+    };
+
+    template<>
+    inline std::string RecordView::getField(int16_t attrIdx) const {
+        const uint8_t *field;
+        int16_t fieldLen;
+        if (!readField(attrIdx, field, fieldLen)) return std::string();
+        return std::string((const char *) field, fieldLen);
+    }
+
     class RBFM_ScanIterator {
     private:
         // init local data
@@ -281,38 +379,72 @@ namespace PeterDB {
         int32_t curPageNum;
         int16_t curSlotNum;
 
-        // select condition
-        CompOp compOp;
-        Attribute conditionAttr;
-        // to store which element in recordDescriptor is a condition
-        int32_t conditionAttrIdx;
-        uint8_t *conditionVal;
-        RawDataStrLen conditionStrLen;
+        // select conditions, compiled by begin() and checked in order, fixed-width ones first
+        struct CompiledCondition {
+            int16_t attrIdx;
+            FieldPredicate predicate;
+            std::vector<uint8_t> value;     // VarChar without its length
+        };
+        std::vector<CompiledCondition> conditions;
+
+        // the record returned last, its page is unpinned when the scan moves on
+        RecordView curView;
+
+        // the page being scanned is read in place, it stays pinned until all of its slots are visited
+        // and is decoded again only if the file got written in between; views of its records share the pin
+        PageHelper *curPage;
+        uint64_t curPageVersion;
+        unsigned readAheadPages;
+        PageNum prefetchedUntil;
 
-        uint8_t recordData[PAGE_SIZE];
+        // a PAX page is read in place, it stays pinned until the scan moves on
+        bool paxLayout;
+        PaxPageHelper *curPaxPage;
 
-        bool compareInt(int a, int b);
+        RC loadPage(PageNum pageNum);
 
-        bool compareFloat(float a, float b);
+        RC loadPaxPage(PageNum pageNum);
 
-        bool compareStr(std::string a, std::string b);
+        void readAhead(PageNum pageNum);
+
+        RC getNextPaxRecord(RID &rid, void *data);
+
+        // read the record a forwarded slot of the current page points at, if it meets the conditions
+        RC readForwardedPaxRecord(uint16_t slotNum, void *data, bool &meetsConditions);
 
     public:
         RBFM_ScanIterator();
 
         ~RBFM_ScanIterator();
 
+        RBFM_ScanIterator(const RBFM_ScanIterator &) = delete;              // owns the current page
+
+        RBFM_ScanIterator &operator=(const RBFM_ScanIterator &) = delete;
+
+        // 0 disables read-ahead
+        void setReadAhead(unsigned numPages);
+
         RC begin(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                  const std::string &conditionAttribute, const CompOp compOp, const void *value,
                  const std::vector<std::string> &selectedAttrNames);
 
+        // scan for records meeting all of the conditions
+        RC begin(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                 const std::vector<ScanCondition> &conditions, const std::vector<std::string> &selectedAttrNames);
+
         // Never keep the results in the memory. When getNextRecord() is called,
         // a satisfying record needs to be fetched from the file.
         // "data" follows the same format as RecordBasedFileManager::insertRecord().
         RC getNextRecord(RID &rid, void *data);
 
-        // use this method to check if the attribute of current record meet the conditions
-        bool recordMeetCondition(uint8_t *attr, int16_t attrLen);
+        // the next satisfying record read in place, for callers that only look at a few fields;
+        // the view stays valid until the next call or close()
+        RC getNextRecordView(RID &rid, RecordView &view);
+
+        // use this method to check if the current record meets the conditions, a null attribute meets none
+        bool recordMeetConditions(const RecordView &view) const;
+
+        bool recordMeetConditions(PaxPageHelper &page, uint16_t slotNum) const;
 
         std::vector<std::uint16_t> getSelectedAttrIdx(){
             return selectedAttrIdx;
@@ -322,17 +454,23 @@ namespace PeterDB {
             return recordDescriptor;
         }
 
-        RC close() { return SUCCESS; };
+        RC close();
     };
 
     class RecordBasedFileManager {
     public:
         static RecordBasedFileManager &instance();                          // Access to the singleton instance
 
-        RC createFile(const std::string &fileName);                         // Create a new record-based file
+        RC createFile(const std::string &fileName,                          // Create a new record-based file
+                      unsigned pageSize = PAGE_SIZE,
+                      PageLayout pageLayout = PAGE_LAYOUT_ROW);
+
+        PageLayout getPageLayout(FileHandle &fileHandle);
 
         RC destroyFile(const std::string &fileName);                        // Destroy a record-based file
 
+        RC renameFile(const std::string &fromFileName, const std::string &toFileName);  // Replace a closed file
+
         RC openFile(const std::string &fileName, FileHandle &fileHandle);   // Open a record-based file
 
         RC closeFile(FileHandle &fileHandle);                               // Close a record-based file
@@ -356,10 +494,18 @@ namespace PeterDB {
         RC insertRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const void *data,
                         RID &rid);
 
+        // Insert many records, rids[i] is the rid of data[i]. The records fill the last page and then new
+        // pages in memory, every page is written once. On failure rids only covers the records written.
+        RC insertRecords(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                         const std::vector<const void *> &data, std::vector<RID> &rids);
+
         // Read a record identified by the given rid.
         RC
         readRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid, void *data);
 
+        // Read a record in place, the page stays pinned until the view is released. Row layout only.
+        RC readRecordView(FileHandle &fileHandle, const RID &rid, RecordView &view);
+
         // read a record in internal format
         RC readInternalRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                               const RID &rid, void *data, short &recByteLen);
@@ -374,6 +520,10 @@ namespace PeterDB {
 
         RC getAvailablePage(FileHandle &fileHandle, int16_t recLength, PageNum &availablePageNum);
 
+        // a PAX page with a free slot and heapLength bytes for the VarChars of a record
+        RC getAvailablePaxPage(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                               int32_t heapLength, PageNum &availablePageNum);
+
         /*****************************************************************************************************
         * IMPORTANT, PLEASE READ: All methods below this comment (other than the constructor and destructor) *
         * are NOT required to be implemented for Project 1                                                   *
@@ -398,29 +548,63 @@ namespace PeterDB {
                 const std::vector<std::string> &attributeNames, // a list of projected attributes
                 RBFM_ScanIterator &rbfm_ScanIterator);
 
+        // Scan for records meeting all of the conditions.
+        RC scan(FileHandle &fileHandle,
+                const std::vector<Attribute> &recordDescriptor,
+                const std::vector<ScanCondition> &conditions,
+                const std::vector<std::string> &attributeNames,
+                RBFM_ScanIterator &rbfm_ScanIterator);
+
     protected:
         RecordBasedFileManager();                                                   // Prevent construction
         ~RecordBasedFileManager();                                                  // Prevent unwanted destruction
         RecordBasedFileManager(const RecordBasedFileManager &);                     // Prevent construction by copying
         RecordBasedFileManager &operator=(const RecordBasedFileManager &);          // Prevent assignment
 
+    private:
+        RC insertPaxRecords(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                            const std::vector<const void *> &data, std::vector<RID> &rids);
+
+        RC readPaxRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid,
+                         const std::vector<uint16_t> &selectedAttrIndex, void *data);
+
+        // like the row layout, a record that outgrows its page moves and its home slot points at it
+        RC updatePaxRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                           const uint8_t *data, const RID &rid);
+
     };
 
-    //slot n|...|slot 1|N|F
+    //slot n|...|slot 1|H|D|N|F
+    // deletes and shrinks only mark their bytes dead (D), the page is compacted once an insert or
+    // a grow needs more contiguous space than is left past F
+    // empty slots are chained from H, so an insert reuses one without scanning the directory
     class PageHelper {
     public:
         FileHandle &fh;
         PageNum pageNum;
+        unsigned pageSize;
         FreeBytePointer freeBytePointer;
         SlotCounter slotCounter;
-        //page data
-        uint8_t dataSeq[PAGE_SIZE] = {};
+        FragmentedBytes fragmentedBytes;
+        FreeSlotHead freeSlotHead;
+        //page data, points into the mapping if the file is mapped and to pageBuffer otherwise
+        uint8_t *dataSeq;
+        std::vector<uint8_t> pageBuffer;
 
         bool IsFreeSpaceEnough(int32_t recLength);
 
+        // bytes left for one more record together with its slot
+        int32_t getFreeSpaceForRecord();
+
+        // largest record an empty page of this size can hold
+        static int32_t getMaxRecordLength(unsigned pageSize);
+
         // insert record Data
         RC insertRecordInByte(uint8_t byteSeq[], int16_t recLength, RID &rid, bool setUnoriginal);
 
+        // insert record Data without writing the page, flushPage then writes many records at once
+        RC addRecordInByte(uint8_t byteSeq[], int16_t recLength, RID &rid, bool setUnoriginal);
+
         // read record Data
         RC getRecordByte(int16_t slotIndex, uint8_t *byteSeq, int16_t &recLength);
 
@@ -451,29 +635,47 @@ namespace PeterDB {
 
         PageHelper(FileHandle &fileHandle, PageNum pageNum);
 
+        // work on a page held by the caller (pinned, or new with pageNum the number of pages in the file)
+        PageHelper(FileHandle &fileHandle, PageNum pageNum, uint8_t *page);
+
         ~PageHelper();
 
         int16_t getRecordLen(int16_t slotIndex);
 
+        int32_t getRecordBeginPos(int16_t slotIndex);
+
         // get next original record with real data, this function will cause slotIndex increase by 1 !!
         RC getNextRecordData(int16_t &slotIndex, uint8_t *byteSeq, int16_t &recordLen);
 
+        // free bytes between the last record and the slot directory
+        int32_t getContiguousFreeSpace();
+
+        // move every live record down so that all dead bytes become contiguous free space
+        void compact();
+
+        // write the page back, or append it if it is new, and refresh its free-space map entry
+        RC flushPage();
+
     private:
+
         //getter
         int16_t getFlagsLength();
 
         int16_t getSlotSize();
 
-        int16_t getHeaderLength();
+        int32_t getHeaderLength();
+
+        int32_t getSlotCounterOffset();
+
+        int32_t getFreeBytePointerOffset();
 
-        int16_t getSlotCounterOffset();
+        int32_t getFragmentedBytesOffset();
 
-        int16_t getFreeBytePointerOffset();
+        int32_t getFreeSlotHeadOffset();
 
-        int16_t getSlotOffset(int16_t slotNum); // start from 1
+        int32_t getSlotOffset(int16_t slotNum); // start from 1
         // get the present available slot offset and it might change slotCounter
         int16_t getAvlSlotOffsetIdx(); // todo test
-        int16_t getRecordBeginPos(int16_t slotIndex);
 
         int8_t getRecordFlag(int16_t slotIndex);
 
@@ -492,17 +694,147 @@ namespace PeterDB {
 
         void setSlotCounter(SlotCounter sc);
 
+        void setFragmentedBytes(FragmentedBytes fb);
+
+        void setFreeSlotHead(FreeSlotHead head);
+
         // checker
         bool isAttrNull(int16_t slotIndex, int16_t attrIndex);
 
-        RC shiftRecord(int16_t dataStartPos, int16_t distance, int8_t direction);
-
         int8_t getRecordAttrNum(int16_t slotIndex);
 
         int16_t getAttrLen(int16_t slotIndex, int16_t attrIndex);
 
     };
 
+    // capacity C, highest used slot N and heap pointer H at the end of a PAX page
+    typedef uint16_t PaxCapacity;
+    typedef uint16_t PaxHeapPointer;
+    // the place of a VarChar value in the heap
+    typedef struct {
+        uint16_t offset;
+        uint16_t length;
+    } PaxHeapEntry;
+
+    // a forwarded slot keeps the rid of its record in the heap, page number then slot number
+    const uint16_t PAX_FORWARD_LENGTH = sizeof(PageNum) + sizeof(uint16_t);
+
+    //live bitmap|forward bitmap|moved bitmap|attr 1 minipage|...|attr n minipage|heap -> ...free...|C|N|H
+    // every minipage is a null bitmap followed by C values, a 4 byte Int or Real or the PaxHeapEntry of a
+    // VarChar, so a scan only decodes the minipages it projects. C is fixed when the page is first used.
+    // Slots start from 1, a deleted slot is reused and its VarChar bytes are reclaimed once the heap is full.
+    // A record that outgrows its page moves to another one as a moved record, and its home slot is forwarded
+    // to it through a PaxHeapEntry in the first minipage. Every live record of a descriptor with a VarChar is
+    // counted as PAX_FORWARD_LENGTH heap bytes at least, so the forward rid always fits.
+    class PaxPageHelper {
+    public:
+        FileHandle &fh;
+        PageNum pageNum;
+        unsigned pageSize;
+        const std::vector<Attribute> &recordDescriptor;
+        PaxCapacity capacity;
+        SlotCounter slotCounter;
+        PaxHeapPointer heapPointer;
+        //page data, points into the mapping if the file is mapped and to pageBuffer otherwise
+        uint8_t *dataSeq;
+        std::vector<uint8_t> pageBuffer;
+
+        PaxPageHelper(FileHandle &fileHandle, PageNum pageNum, const std::vector<Attribute> &recordDescriptor);
+
+        // work on a page held by the caller, like PageHelper
+        PaxPageHelper(FileHandle &fileHandle, PageNum pageNum, const std::vector<Attribute> &recordDescriptor,
+                      uint8_t *page);
+
+        ~PaxPageHelper();
+
+        // slots of a new page, VarChars are expected to fill half of their length; fewer, down to one,
+        // if a first record of heapLength bytes would not fit next to the minipages otherwise
+        static PaxCapacity getCapacity(unsigned pageSize, const std::vector<Attribute> &recordDescriptor,
+                                       int32_t heapLength = 0);
+
+        // heap bytes of a record in the format of insertRecord
+        static int32_t getHeapLength(const uint8_t *rawData, const std::vector<Attribute> &recordDescriptor);
+
+        // a free slot and heapLength bytes, counting the heap bytes of deleted values
+        bool IsFreeSpaceEnough(int32_t heapLength);
+
+        // heapLength bytes for the record in slotNum, counting the bytes it takes now
+        bool IsFreeSpaceEnoughToUpdate(uint16_t slotNum, int32_t heapLength);
+
+        // insert a record without writing the page, setUnoriginal for a record moved from its home slot
+        RC addRecord(const uint8_t *rawData, RID &rid, bool setUnoriginal = false);
+
+        RC insertRecord(const uint8_t *rawData, RID &rid, bool setUnoriginal = false);
+
+        // the record must fit, see IsFreeSpaceEnoughToUpdate; a forwarded slot gets its record back
+        RC updateRecord(uint16_t slotNum, const uint8_t *rawData);
+
+        // drop the values of a slot and forward it to the record at newRid
+        RC setRecordPointToNewRID(uint16_t slotNum, const RID &newRid);
+
+        void getRecordPointer(uint16_t slotNum, RID &rid);
+
+        RC deleteRecord(uint16_t slotNum);
+
+        // the selected attributes in the format of readRecord
+        RC readRecord(uint16_t slotNum, const std::vector<uint16_t> &selectedAttrIdx, uint8_t *rawData);
+
+        // the value bytes of a field inside the page, a VarChar has no length prefix; false for null
+        bool readField(uint16_t slotNum, int16_t attrIdx, const uint8_t *&field, int16_t &fieldLen);
+
+        bool isRecordValid(uint16_t slotNum);
+
+        bool isRecordForwarded(uint16_t slotNum);
+
+        // false for a record moved here from its home slot, it is only reached through that slot
+        bool isOriginal(uint16_t slotNum);
+
+        // write the page back, or append it if it is new, and refresh its free-space map entry
+        RC flushPage();
+
+    private:
+        std::vector<uint16_t> minipageOffsets;
+        bool isNewPage;                                     // laid out for its first record
+        int32_t minHeapLength;                              // heap bytes a live record is counted as at least
+        int32_t liveHeapLength;                             // cached, -1 until counted
+
+        int32_t getFooterOffset();
+
+        int32_t getBitmapSize();
+
+        int32_t getHeapBegin();
+
+        // heap bytes of the live records, each counted as minHeapLength at least
+        int32_t getLiveHeapLength();
+
+        // heap bytes of a live record, or of its forward rid
+        int32_t getSlotHeapLength(uint16_t slotNum);
+
+        bool hasFreeSlot();
+
+        // lay a new page out, or locate the minipages of a used one
+        void initLayout();
+
+        void layoutMinipages();
+
+        void writeFooter();
+
+        bool getBit(int32_t bitmapOffset, uint16_t slotNum);
+
+        void setBit(int32_t bitmapOffset, uint16_t slotNum, bool value);
+
+        uint8_t *getValuePtr(int16_t attrIdx, uint16_t slotNum);
+
+        // write a record into a slot, the heap must have room for it
+        void writeRecord(uint16_t slotNum, const uint8_t *rawData, bool setUnoriginal);
+
+        // free the slot and compact the heap if it lacks heapLength bytes at its end
+        void dropRecordForRewrite(uint16_t slotNum, int32_t heapLength);
+
+        // move the live VarChar values to the heap begin
+        void compactHeap();
+    };
+
     class RecordHelper {
     public:
         static RC
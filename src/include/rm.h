@@ -38,6 +38,8 @@ namespace PeterDB {
     const std::string CATALOG_INDEXES_ATTRNAME = "attribute-name";
     const std::string CATALOG_INDEXES_FILENAME = "file-name";
 
+    const std::string REORGANIZE_FILE_SUFFIX = ".reorg";      // scratch copy of a table while it is reorganized
+
     const int32_t DEFAULT_COLUMN_INT = -1;
     const int32_t INVALID_TABLEID = -1;
 
@@ -125,9 +127,15 @@ namespace PeterDB {
         RC begin(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                  const std::string &conditionAttribute, const CompOp compOp, const void *value,
                  const std::vector<std::string> &selectedAttrNames);
+
+        RC begin(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                 const std::vector<ScanCondition> &conditions, const std::vector<std::string> &selectedAttrNames);
         // "data" follows the same format as RelationManager::insertTuple()
         RC getNextTuple(RID &rid, void *data);
 
+        // the next tuple read in place, valid until the next call or close(); LAYOUT_NOT_SUPPORTED on a PAX table
+        RC getNextTupleView(RID &rid, RecordView &view);
+
         RC close();
     };
 
@@ -157,6 +165,20 @@ namespace PeterDB {
         std::vector<IXFileHandle*> ixScanFHList;
         std::unordered_map<std::string, IXFileHandle*> ixFHMap;
 
+        // catalog rows of one table, kept until a DDL call on that table erases them
+        struct CatalogCacheEntry {
+            int32_t tableID;
+            std::vector<Attribute> attrs;
+            std::unordered_map<std::string, std::string> indexes;     // attribute name -> index file name
+        };
+        std::unordered_map<std::string, CatalogCacheEntry> catalogCache;
+        uint64_t catalogVersion = 0;                    // bumped by every DDL call
+        unsigned catalogCacheHitCounter = 0;
+        unsigned catalogCacheMissCounter = 0;
+
+        bool indexBulkLoad = true;                      // createIndex sorts the table and builds the tree bottom-up
+        float indexFillFactor = IX::DEFAULT_FILL_FACTOR;
+
         bool isTableNameEmpty(const std::string name);
         bool isTableIdValid(int32_t tableID);
         bool isTableAccessible(const std::string name);
@@ -171,8 +193,20 @@ namespace PeterDB {
 
         std::string getIndexFileName(const std::string& tableName, const std::string& attrName);
         RC getIndexes(const std::string& tableName, std::unordered_map<std::string, std::string>& indexedAttrAndFileName);
-        RC buildIndex(const std::string &tableName, const std::string &ixName, const std::string &attributeName);
+        RC getCatalogCacheEntry(const std::string &tableName, const CatalogCacheEntry *&entry);
+        RC loadCatalogCacheEntry(const std::string &tableName, CatalogCacheEntry &entry);
+        void invalidateCatalogCache(const std::string &tableName);
+        void clearCatalogCache();
+        void closeIndexHandle(const std::string &ixFileName);
+        // tableFileName holds the tuples of tableName, a scratch copy while the table is reorganized
+        RC buildIndex(const std::string &tableName, const std::string &tableFileName, const std::string &ixName,
+                      const std::string &attributeName);
+        RC copyTableFile(const std::string &fromFileName, const std::string &toFileName,
+                         const std::vector<Attribute> &attrs);
         RC insertIndex(const std::string &tableName, const void *data, const std::vector<Attribute>recordDescriptor, RID &rid);
+        RC insertIndexes(const std::string &tableName, const std::vector<const void *> &data,
+                         const std::vector<Attribute> &recordDescriptor, const std::vector<RID> &rids);
+        RC getIndexHandle(const std::string &ixFileName, IXFileHandle *&ixFileHandle);
         RC deleteIndex(const std::string &tableName, const void *data, const std::vector<Attribute>recordDescriptor, RID &rid);
         RC updateIndex(const std::string &tableName, const void *oldData, const void *newData, const std::vector<Attribute>recordDescriptor, RID &rid);
 
@@ -183,10 +217,14 @@ namespace PeterDB {
         RC createCatalog();
         RC openCatalog();
         RC deleteCatalog();
-        RC createTable(const std::string &tableName, const std::vector<Attribute> &attrs);
+        // pageLayout picks row pages or PAX pages for the tuples of the table
+        RC createTable(const std::string &tableName, const std::vector<Attribute> &attrs,
+                       PageLayout pageLayout = PAGE_LAYOUT_ROW);
         RC deleteTable(const std::string &tableName);
         RC getAttributes(const std::string &tableName, std::vector<Attribute> &attrs);
         RC insertTuple(const std::string &tableName, const void *data, RID &rid);
+        // Insert a batch of tuples, rids[i] is the rid of data[i]; pages and index handles are touched once per call
+        RC insertTuples(const std::string &tableName, const std::vector<const void *> &data, std::vector<RID> &rids);
         RC deleteTuple(const std::string &tableName, const RID &rid);
         RC updateTuple(const std::string &tableName, const void *data, const RID &rid);
         RC readTuple(const std::string &tableName, const RID &rid, void *data);
@@ -203,6 +241,12 @@ namespace PeterDB {
                 const std::vector<std::string> &attributeNames, // a list of projected attributes
                 RM_ScanIterator &rm_ScanIterator);
 
+        // Scan for tuples meeting all of the conditions.
+        RC scan(const std::string &tableName,
+                const std::vector<ScanCondition> &conditions,
+                const std::vector<std::string> &attributeNames,
+                RM_ScanIterator &rm_ScanIterator);
+
         // Extra credit work (10 points)
         RC addAttribute(const std::string &tableName, const Attribute &attr);
 
@@ -211,6 +255,16 @@ namespace PeterDB {
         // QE IX related
         RC createIndex(const std::string &tableName, const std::string &attributeName);
         RC destroyIndex(const std::string &tableName, const std::string &attributeName);
+        // Choose how createIndex fills a new index: bulk loading with the given leaf fill factor,
+        // or inserting the tuples one at a time
+        void setIndexBulkLoad(bool enable, float fillFactor = IX::DEFAULT_FILL_FACTOR);
+        // VACUUM: rewrite the table into compact pages, moved records are stored in line again,
+        // then rebuild its indexes for the new rids
+        RC reorganizeTable(const std::string &tableName);
+
+        // Catalog cache: the version changes whenever a table or index is created or dropped
+        uint64_t getCatalogVersion() const;
+        void collectCatalogCacheCounters(unsigned &hitCount, unsigned &missCount) const;
         // indexScan returns an iterator to allow the caller to go through qualified entries in index
         RC indexScan(const std::string &tableName,
                      const std::string &attributeName,
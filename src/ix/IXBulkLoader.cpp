@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <queue>
+#include "src/include/ix.h"
+
+namespace PeterDB {
+    IXBulkLoader::IXBulkLoader(IXFileHandle &ixFileHandle, const Attribute &attr, float fillFactor, size_t runSize)
+            : ixFileHandle(ixFileHandle), attr(attr), fillFactor(fillFactor), runSize(runSize),
+              pageSize(ixFileHandle.getPageSize()), leafPage(pageSize, 0) {
+        leafFreeBytePointer = 0;
+        leafKeyCounter = 0;
+    }
+
+    IXBulkLoader::~IXBulkLoader() {
+        // temp files are removed on close
+        for (FILE *run: runFiles) fclose(run);
+    }
+
+    unsigned IXBulkLoader::getNumberOfRuns() const {
+        return runFiles.size();
+    }
+
+    int32_t IXBulkLoader::getEntryLength(const uint8_t *entry) const {
+        return ((leafEntry *) entry)->getEntryLength(attr.type);
+    }
+
+    bool IXBulkLoader::isEntryLess(const uint8_t *entry1, const uint8_t *entry2) const {
+        return IXNode::isCompositeKeyMeetCompCondition(entry1, entry2, attr, LT_OP);
+    }
+
+    RC IXBulkLoader::addEntry(const void *key, const RID &rid) {
+        std::vector<uint8_t> entry(pageSize);
+        IndexManager::instance().genCompositeEntry(attr, key, rid, entry.data());
+        int32_t entryLen = getEntryLength(entry.data());
+        if (!runData.empty() && runData.size() + entryLen > runSize) {
+            RC rc = spillRun();
+            if (rc) return rc;
+        }
+        runEntries.push_back(runData.size());
+        runData.insert(runData.end(), entry.begin(), entry.begin() + entryLen);
+        return SUCCESS;
+    }
+
+    void IXBulkLoader::sortRun() {
+        const uint8_t *base = runData.data();
+        std::stable_sort(runEntries.begin(), runEntries.end(), [&](uint32_t a, uint32_t b) {
+            return isEntryLess(base + a, base + b);
+        });
+    }
+
+    RC IXBulkLoader::spillRun() {
+        sortRun();
+        FILE *run = tmpfile();
+        if (!run) {
+            LOG(ERROR) << "Fail to create a run file @ IXBulkLoader::spillRun" << std::endl;
+            return RC(IX_ERROR::BULK_LOAD_RUN_FAIL);
+        }
+        runFiles.push_back(run);
+        for (uint32_t offset: runEntries) {
+            const uint8_t *entry = runData.data() + offset;
+            if (fwrite(entry, getEntryLength(entry), 1, run) != 1) return RC(IX_ERROR::BULK_LOAD_RUN_FAIL);
+        }
+        fflush(run);
+        rewind(run);
+        runData.clear();
+        runEntries.clear();
+        return SUCCESS;
+    }
+
+    // read the next entry of a spilled run, IX_EOF once the run is exhausted
+    RC IXBulkLoader::readRunEntry(FILE *run, uint8_t *entry) {
+        if (fread(entry, sizeof(int32_t), 1, run) != 1) return IX_EOF;
+        int32_t restLen = getEntryLength(entry) - sizeof(int32_t);
+        if (fread(entry + sizeof(int32_t), restLen, 1, run) != 1) return RC(IX_ERROR::BULK_LOAD_RUN_FAIL);
+        return SUCCESS;
+    }
+
+    RC IXBulkLoader::mergeRuns() {
+        RC rc;
+        // everything fit in one run, no need to go through disk
+        if (runFiles.empty()) {
+            sortRun();
+            for (uint32_t offset: runEntries) {
+                rc = packEntry(runData.data() + offset);
+                if (rc) return rc;
+            }
+            return SUCCESS;
+        }
+        if (!runEntries.empty()) {
+            rc = spillRun();
+            if (rc) return rc;
+        }
+
+        // k-way merge, heads holds the current entry of every run
+        std::vector<std::vector<uint8_t>> heads(runFiles.size(), std::vector<uint8_t>(pageSize));
+        auto greater = [&](size_t a, size_t b) {
+            return isEntryLess(heads[b].data(), heads[a].data());
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> queue(greater);
+        for (size_t i = 0; i < runFiles.size(); i++) {
+            rc = readRunEntry(runFiles[i], heads[i].data());
+            if (rc == SUCCESS) queue.push(i);
+            else if (rc != IX_EOF) return rc;
+        }
+        while (!queue.empty()) {
+            size_t i = queue.top();
+            queue.pop();
+            rc = packEntry(heads[i].data());
+            if (rc) return rc;
+            rc = readRunEntry(runFiles[i], heads[i].data());
+            if (rc == SUCCESS) queue.push(i);
+            else if (rc != IX_EOF) return rc;
+        }
+        return SUCCESS;
+    }
+
+    RC IXBulkLoader::finish() {
+        if (!ixFileHandle.isRootNull()) return RC(IX_ERROR::BULK_LOAD_INDEX_NOT_EMPTY);
+        if (runEntries.empty() && runFiles.empty()) return SUCCESS;
+
+        // the first leaf goes into the root page, the following ones are appended right after it
+        RC rc = ixFileHandle.createRootPage();
+        if (rc) return rc;
+        leaves.clear();
+        leaves.push_back({(int32_t) ixFileHandle.getRoot(), {}});
+        std::fill(leafPage.begin(), leafPage.end(), 0);
+        leafFreeBytePointer = 0;
+        leafKeyCounter = 0;
+
+        rc = mergeRuns();
+        if (rc) return rc;
+        rc = flushLeaf(true);
+        if (rc) return rc;
+        return buildInternalLevels();
+    }
+
+    RC IXBulkLoader::packEntry(const uint8_t *entry) {
+        int32_t entryLen = getEntryLength(entry);
+        int32_t maxSpace = pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
+                           IX::NEXT_POINTER_LEN;
+        int32_t limit = std::min(maxSpace, (int32_t) (maxSpace * fillFactor));
+        if (leafKeyCounter > 0 && (leafFreeBytePointer + entryLen > limit)) {
+            RC rc = flushLeaf(false);
+            if (rc) return rc;
+            leaves.push_back({leaves.back().pageNum + 1, {}});
+            std::fill(leafPage.begin(), leafPage.end(), 0);
+            leafFreeBytePointer = 0;
+            leafKeyCounter = 0;
+        }
+        if (leafKeyCounter == 0) {
+            // first entry of a leaf is the separator pushed up to its parent
+            leaves.back().minEntry.assign(entry, entry + entryLen);
+        }
+        memcpy(leafPage.data() + leafFreeBytePointer, entry, entryLen);
+        leafFreeBytePointer += entryLen;
+        leafKeyCounter++;
+        return SUCCESS;
+    }
+
+    RC IXBulkLoader::flushLeaf(bool isLastLeaf) {
+        int32_t pageNum = leaves.back().pageNum;
+        int32_t next = isLastLeaf ? IX::NULL_PTR : pageNum + 1;
+        uint16_t nodeType = IX::LEAF_NODE;
+        uint8_t *tail = leafPage.data() + pageSize;
+        memcpy(tail - IX::NODE_TYPE_LEN, &nodeType, IX::NODE_TYPE_LEN);
+        memcpy(tail - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN, &leafFreeBytePointer, IX::FREEBYTEPOINTER_LEN);
+        memcpy(tail - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN, &leafKeyCounter,
+               IX::KEY_COUNTER_LEN);
+        memcpy(tail - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN - IX::NEXT_POINTER_LEN, &next,
+               IX::NEXT_POINTER_LEN);
+        if (pageNum == (int32_t) ixFileHandle.getRoot()) return ixFileHandle.writePage(pageNum, leafPage.data());
+        assert(pageNum == getNextPageNum());
+        return appendNode(leafPage.data());
+    }
+
+    RC IXBulkLoader::buildInternalLevels() {
+        int32_t maxSpace = pageSize - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN -
+                           IX::NEXT_POINTER_LEN;
+        int32_t limit = std::min(maxSpace, (int32_t) (maxSpace * fillFactor));
+        std::vector<ChildRef> children = leaves;
+        while (children.size() > 1) {
+            // group children into nodes: | child | key, rid, child | key, rid, child | ...
+            std::vector<size_t> nodeBegins;
+            int32_t freeBytePointer = 0;
+            for (size_t i = 0; i < children.size(); i++) {
+                int32_t entryLen = getEntryLength(children[i].minEntry.data()) + IX::NEXT_POINTER_LEN;
+                bool isFirstChild = nodeBegins.empty() || freeBytePointer + entryLen > limit;
+                // a node needs at least one key
+                if (!nodeBegins.empty() && i == nodeBegins.back() + 1) isFirstChild = false;
+                if (isFirstChild) {
+                    nodeBegins.push_back(i);
+                    freeBytePointer = IX::NEXT_POINTER_LEN;
+                } else {
+                    freeBytePointer += entryLen;
+                }
+            }
+            // the last node got a single child, take one over from its left sibling
+            size_t n = nodeBegins.size();
+            if (n > 1 && nodeBegins[n - 1] == children.size() - 1 && nodeBegins[n - 1] - nodeBegins[n - 2] > 2) {
+                nodeBegins.back()--;
+            }
+            nodeBegins.push_back(children.size());
+
+            std::vector<ChildRef> parents;
+            for (size_t n = 0; n + 1 < nodeBegins.size(); n++) {
+                int32_t pageNum;
+                RC rc = writeInternalNode(children, nodeBegins[n], nodeBegins[n + 1], pageNum);
+                if (rc) return rc;
+                parents.push_back({pageNum, children[nodeBegins[n]].minEntry});
+            }
+            children.swap(parents);
+        }
+        RC rc = flushPendingPages();
+        if (rc) return rc;
+        if (children[0].pageNum != (int32_t) ixFileHandle.getRoot()) return ixFileHandle.setRoot(children[0].pageNum);
+        return SUCCESS;
+    }
+
+    RC IXBulkLoader::writeInternalNode(const std::vector<ChildRef> &children, size_t begin, size_t end,
+                                       int32_t &pageNum) {
+        std::vector<uint8_t> buffer(pageSize, 0);
+        uint8_t *page = buffer.data();
+        uint16_t pos = 0;
+        memcpy(page + pos, &children[begin].pageNum, IX::NEXT_POINTER_LEN);
+        pos += IX::NEXT_POINTER_LEN;
+        for (size_t i = begin + 1; i < end; i++) {
+            // separator is the smallest composite key of the right child
+            auto key = (internalEntry *) (page + pos);
+            key->setCompositeKey(attr.type, (uint8_t *) children[i].minEntry.data());
+            key->setRightChild(attr.type, children[i].pageNum);
+            pos += key->getEntryLength(attr.type);
+        }
+        uint16_t nodeType = IX::INTERNAL_NODE;
+        uint16_t keyCounter = end - begin - 1;
+        uint8_t *tail = page + pageSize;
+        memcpy(tail - IX::NODE_TYPE_LEN, &nodeType, IX::NODE_TYPE_LEN);
+        memcpy(tail - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN, &pos, IX::FREEBYTEPOINTER_LEN);
+        memcpy(tail - IX::NODE_TYPE_LEN - IX::FREEBYTEPOINTER_LEN - IX::KEY_COUNTER_LEN, &keyCounter,
+               IX::KEY_COUNTER_LEN);
+        pageNum = getNextPageNum();
+        return appendNode(page);
+    }
+
+    // page number the next appended node gets, counting the ones still buffered
+    int32_t IXBulkLoader::getNextPageNum() const {
+        return (int32_t) (ixFileHandle.getNumberOfPages() + pendingPages.size() / pageSize);
+    }
+
+    RC IXBulkLoader::appendNode(const uint8_t *page) {
+        pendingPages.insert(pendingPages.end(), page, page + pageSize);
+        if (pendingPages.size() < (size_t) IX::BULK_LOAD_WRITE_PAGES * pageSize) return SUCCESS;
+        return flushPendingPages();
+    }
+
+    RC IXBulkLoader::flushPendingPages() {
+        RC rc = ixFileHandle.appendPages(pendingPages.size() / pageSize, pendingPages.data());
+        if (rc) return rc;
+        pendingPages.clear();
+        return SUCCESS;
+    }
+}
@@ -1,6 +1,7 @@
 //
 // Created by Fan Zhao on 2/19/23.
 //
+#include <algorithm>
 #include "src/include/ix.h"
 
 namespace PeterDB{
@@ -9,11 +10,21 @@ namespace PeterDB{
         ixWritePageCounter = 0;
         ixAppendPageCounter = 0;
         rootPagePtr = IX::NULL_PTR;
-        fileInMemory = nullptr;
+        pageSize = PAGE_SIZE;
+        fileOpen = false;
+        fileId = FILE_ID_INVALID;
+        bufferCounter = {0, 0, 0};
+        metadataDirty = false;
+        metadataFlushInterval = DEFAULT_METADATA_FLUSH_INTERVAL;
+        pendingMetadataOps = 0;
+        nodeCacheHitCounter = 0;
+        nodeCacheMissCounter = 0;
     }
 
     IXFileHandle::~IXFileHandle() {
-        flushMetaData();
+        if (!isOpen()) return;
+        BufferPool::instance().flushFile(fileId);
+        if (metadataDirty) flushCounters();
     }
 
     RC
@@ -24,66 +35,177 @@ namespace PeterDB{
         return SUCCESS;
     }
 
+    RC IXFileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount,
+                                          unsigned &hitCount, unsigned &missCount, unsigned &evictCount) {
+        collectCounterValues(readPageCount, writePageCount, appendPageCount);
+        hitCount = bufferCounter.hitCounter;
+        missCount = bufferCounter.missCounter;
+        evictCount = bufferCounter.evictCounter;
+        return SUCCESS;
+    }
+
+    RC IXFileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount,
+                                          unsigned &hitCount, unsigned &missCount, unsigned &evictCount,
+                                          unsigned &nodeCacheHitCount, unsigned &nodeCacheMissCount) {
+        collectCounterValues(readPageCount, writePageCount, appendPageCount, hitCount, missCount, evictCount);
+        nodeCacheHitCount = nodeCacheHitCounter;
+        nodeCacheMissCount = nodeCacheMissCounter;
+        return SUCCESS;
+    }
+
     RC IXFileHandle::open(const std::string &filename) {
         if (isOpen()) return RC(IX_ERROR::ERR_FILE_ALREADY_OPEN);
-        // open file as binary
-        fileInMemory = fopen(filename.c_str(), "r+b");
-        if (!isOpen())return RC(IX_ERROR::ERR_FILE_OPEN_FAIL);
+        // the buffer pool owns the descriptor, the handle only needs the metadata
+        fileId = BufferPool::instance().registerFile(filename);
+        fileOpen = true;
         this->fileName = filename;
-        return readMetaData();
+        bufferCounter = {0, 0, 0};
+        metadataDirty = false;
+        pendingMetadataOps = 0;
+        nodeCacheHitCounter = 0;
+        nodeCacheMissCounter = 0;
+        if (readMetaData() != SUCCESS) {
+            fileOpen = false;
+            return RC(IX_ERROR::ERR_FILE_OPEN_FAIL);
+        }
+        return SUCCESS;
     }
 
     RC IXFileHandle::close() {
         if (!isOpen()) return SUCCESS;
-        flushMetaData();
-        fclose(fileInMemory);
-        fileInMemory = NULL;
+        if (metadataDirty) flushCounters();
+        BufferPool::instance().closeFile(fileId);
+        fileOpen = false;
         return SUCCESS;
     }
 
     bool IXFileHandle::isOpen() {
-        if (this->fileInMemory == NULL) return false;
-        return true;
+        return fileOpen;
     }
 
     RC IXFileHandle::readMetaData() {
         if(!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
-        fseek(fileInMemory, 0, SEEK_SET);
-        clearerr(PeterDB::IXFileHandle::fileInMemory);
+        uint8_t header[IX::METADATA_LEN];
+        RC rc = BufferPool::instance().readFileHeader(fileId, 0, header, IX::METADATA_LEN);
+        if (rc) return rc;
+
+        memcpy(&ixReadPageCounter, header, sizeof(unsigned));
+        memcpy(&ixWritePageCounter, header + sizeof(unsigned), sizeof(unsigned));
+        memcpy(&ixAppendPageCounter, header + 2 * sizeof(unsigned), sizeof(unsigned));
+        memcpy(&rootPagePtr, header + 3 * sizeof(unsigned), sizeof(int32_t));
+        memcpy(&pageSize, header + 4 * sizeof(unsigned), sizeof(unsigned));
+        if (!PagedFileManager::isValidPageSize(pageSize)) {
+            LOG(ERROR) << "Page size " << pageSize << " is not supported @ IXFileHandle::readMetaData" << std::endl;
+            return RC(IX_ERROR::PAGE_SIZE_INVALID);
+        }
+        return BufferPool::instance().setFilePageSize(fileId, pageSize);
+    }
 
-        fread(&ixReadPageCounter, sizeof(unsigned), 1, fileInMemory);
-        fread(&ixWritePageCounter, sizeof(unsigned), 1, fileInMemory);
-        fread(&ixAppendPageCounter, sizeof(unsigned), 1, fileInMemory);
-        fread(&rootPagePtr, sizeof(int32_t), 1, fileInMemory);
+    RC IXFileHandle::flushMetaData() {
+        if(!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
+        uint8_t header[IX::METADATA_LEN];
+        memcpy(header, &ixReadPageCounter, sizeof(unsigned));
+        memcpy(header + sizeof(unsigned), &ixWritePageCounter, sizeof(unsigned));
+        memcpy(header + 2 * sizeof(unsigned), &ixAppendPageCounter, sizeof(unsigned));
+        memcpy(header + 3 * sizeof(unsigned), &rootPagePtr, sizeof(int32_t));
+        memcpy(header + 4 * sizeof(unsigned), &pageSize, sizeof(unsigned));
+        RC rc = BufferPool::instance().writeFileHeader(fileId, 0, header, IX::METADATA_LEN);
+        if (rc) return rc;
 
+        metadataDirty = false;
+        pendingMetadataOps = 0;
         return SUCCESS;
     }
 
-    RC IXFileHandle::flushMetaData() {
+    // write read/write counters only, append counter and root are written as soon as they change
+    RC IXFileHandle::flushCounters() {
         if(!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
-        clearerr(PeterDB::IXFileHandle::fileInMemory);
-        fseek(fileInMemory, 0, SEEK_SET);
+        unsigned counters[2] = {ixReadPageCounter, ixWritePageCounter};
+        RC rc = BufferPool::instance().writeFileHeader(fileId, 0, counters, sizeof(counters));
+        if (rc) return rc;
+
+        metadataDirty = false;
+        pendingMetadataOps = 0;
+        return SUCCESS;
+    }
 
-        fwrite(&ixReadPageCounter, sizeof(unsigned), 1, fileInMemory);
-        fwrite(&ixWritePageCounter, sizeof(unsigned), 1, fileInMemory);
-        fwrite(&ixAppendPageCounter, sizeof(unsigned), 1, fileInMemory);
-        fwrite(&rootPagePtr, sizeof(int32_t), 1, fileInMemory);
+    RC IXFileHandle::markMetaDataDirty() {
+        metadataDirty = true;
+        pendingMetadataOps++;
+        if (metadataFlushInterval && pendingMetadataOps >= metadataFlushInterval) return flushCounters();
+        return SUCCESS;
+    }
 
-        fflush(fileInMemory);
+    RC IXFileHandle::checkpoint() {
+        if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
+        RC rc = BufferPool::instance().flushFile(fileId);
+        if (rc) return rc;
+        if (metadataDirty) return flushCounters();
         return SUCCESS;
     }
 
+    void IXFileHandle::setMetadataFlushInterval(unsigned interval) {
+        metadataFlushInterval = interval;
+    }
+
+    RC IXFileHandle::setMapped(bool mapped) {
+        if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
+        return BufferPool::instance().setFileMapped(fileId, mapped);
+    }
+
+    bool IXFileHandle::isMapped() {
+        return isOpen() && BufferPool::instance().isFileMapped(fileId);
+    }
+
+    RC IXFileHandle::prefetchPages(uint32_t startPage, unsigned numPages) {
+        if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
+        if (startPage >= getNumberOfPages()) return SUCCESS;
+        numPages = std::min(numPages, getNumberOfPages() - startPage);
+        return BufferPool::instance().prefetchPages(fileId, startPage, numPages, bufferCounter);
+    }
+
     RC IXFileHandle::readPage(uint32_t pageNum, void *data) {
         if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
         if (getNumberOfPages() <= pageNum) {
             return RC(IX_ERROR::FILE_NO_ENOUGH_PAGE);
         }
-        clearerr(PeterDB::IXFileHandle::fileInMemory);
-        fseek(fileInMemory, IX::File_Header_Page_Size + PAGE_SIZE * pageNum, SEEK_SET);
-        size_t result = fread(data, PAGE_SIZE, 1, fileInMemory);
-        assert(result == 1);
+        RC rc = BufferPool::instance().readPage(fileId, pageNum, data, bufferCounter);
+        assert(rc == SUCCESS);
         ixReadPageCounter = ixReadPageCounter + 1;
-        return flushMetaData();
+        return markMetaDataDirty();
+    }
+
+    RC IXFileHandle::readNode(uint32_t pageNum, uint8_t *page, const uint8_t *&node, uint16_t &nodeType) {
+        if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
+        if (isMapped()) {
+            // the mapping already keeps every node resident, hand it out without a copy
+            if (getNumberOfPages() <= pageNum) return RC(IX_ERROR::FILE_NO_ENOUGH_PAGE);
+            uint8_t *mapped;
+            RC rc = BufferPool::instance().fetchPage(fileId, pageNum, true, mapped, bufferCounter);
+            if (rc) return rc;
+            node = mapped;
+            nodeType = IXNode::getNodeTypeFromData(mapped, pageSize);
+            ixReadPageCounter = ixReadPageCounter + 1;
+            return markMetaDataDirty();
+        }
+        IndexManager &ix = IndexManager::instance();
+        node = ix.getCachedNode(*this, pageNum);
+        if (node) {
+            // still a logical page read, it just does not go to the buffer pool
+            nodeCacheHitCounter++;
+            nodeType = IX::INTERNAL_NODE;
+            ixReadPageCounter = ixReadPageCounter + 1;
+            return markMetaDataDirty();
+        }
+        RC rc = readPage(pageNum, page);
+        if (rc) return rc;
+        node = page;
+        nodeType = IXNode::getNodeTypeFromData(page, pageSize);
+        if (nodeType == IX::INTERNAL_NODE) {
+            nodeCacheMissCounter++;
+            ix.cacheNode(*this, pageNum, page);
+        }
+        return SUCCESS;
     }
 
     RC IXFileHandle::writePage(uint32_t pageNum, const void *data) {
@@ -91,34 +213,42 @@ namespace PeterDB{
         if (getNumberOfPages() <= pageNum) {
             return RC(IX_ERROR::FILE_NO_ENOUGH_PAGE);
         }
-        fseek(fileInMemory, IX::File_Header_Page_Size + PAGE_SIZE * pageNum, SEEK_SET);
-        fwrite(data, PAGE_SIZE, 1, fileInMemory);
-        fflush(fileInMemory);
+        RC rc = BufferPool::instance().writePage(fileId, pageNum, data, bufferCounter);
+        if (rc) return rc;
+        // internal nodes only change on a split below them, keep their cached copy in sync
+        IndexManager::instance().refreshCachedNode(*this, pageNum, (const uint8_t *) data);
         ixWritePageCounter = ixWritePageCounter + 1;
-        return flushMetaData();
+        return markMetaDataDirty();
     }
 
     RC IXFileHandle::appendPage(const void *data) {
         if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
-        fseek(fileInMemory, IX::File_Header_Page_Size + PAGE_SIZE * getNumberOfPages(), SEEK_SET);
-        fwrite(data, PAGE_SIZE, 1, fileInMemory);
+        RC rc = BufferPool::instance().appendPage(fileId, getNumberOfPages(), data, bufferCounter);
+        if (rc) return rc;
         ixAppendPageCounter = ixAppendPageCounter + 1;
         return flushMetaData();
     }
 
+    RC IXFileHandle::appendPages(unsigned numPages, const void *data) {
+        if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
+        if (numPages == 0) return SUCCESS;
+        RC rc = BufferPool::instance().writePages(fileId, getNumberOfPages(), numPages, data);
+        if (rc) return rc;
+        ixAppendPageCounter = ixAppendPageCounter + numPages;
+        return flushMetaData();
+    }
+
     RC IXFileHandle::appendEmptyPage() {
         if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
-        uint8_t emptyPage[PAGE_SIZE];
-        memset(emptyPage, 0, PAGE_SIZE);
-        return appendPage(emptyPage);
+        std::vector<uint8_t> emptyPage(pageSize, 0);
+        return appendPage(emptyPage.data());
     }
 
     RC IXFileHandle::initHiddenPage() {
         if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
-        uint8_t emptyPage[IX::File_Header_Page_Size];
-        memset(emptyPage, 0, IX::File_Header_Page_Size);
-        fseek(fileInMemory, 0, SEEK_SET);
-        fwrite(emptyPage, IX::File_Header_Page_Size, 1, fileInMemory);
+        std::vector<uint8_t> emptyPage(pageSize, 0);
+        RC rc = BufferPool::instance().writeFileHeader(fileId, 0, emptyPage.data(), pageSize);
+        if (rc) return rc;
         return flushMetaData();
     }
 
@@ -140,7 +270,6 @@ namespace PeterDB{
     RC IXFileHandle::setRoot(int32_t newRoot) {
         rootPagePtr = newRoot;
         if (!isOpen()) return RC(IX_ERROR::FILE_NOT_OPEN);
-        clearerr(PeterDB::IXFileHandle::fileInMemory);
         return flushMetaData();
     }
 
@@ -157,6 +286,10 @@ namespace PeterDB{
         return ixAppendPageCounter - 2;
     }
 
+    unsigned IXFileHandle::getPageSize() const {
+        return pageSize;
+    }
+
     std::string IXFileHandle::getFileName() const {
         return fileName;
     }
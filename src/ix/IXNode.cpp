@@ -5,6 +5,42 @@
 
 namespace PeterDB {
 
+    EntryDirectory::EntryDirectory(const uint8_t *page, int32_t start, uint16_t entryCounter, AttrType type,
+                                   int16_t nodeType) : start(start), entryCounter(entryCounter) {
+        // key | rid.page | rid.slot (| right child)
+        int32_t ridLen = sizeof(uint32_t) + sizeof(uint16_t);
+        int32_t childLen = nodeType == IX::INTERNAL_NODE ? IX::NEXT_POINTER_LEN : 0;
+        if (type != TypeVarChar) {
+            stride = (int32_t) (sizeof(int32_t) + ridLen + childLen);
+            return;
+        }
+        stride = 0;
+        offsets.resize(entryCounter + 1);
+        int32_t pos = start;
+        for (uint16_t i = 0; i < entryCounter; i++) {
+            offsets[i] = pos;
+            int32_t strLen;
+            memcpy(&strLen, page + pos, sizeof(int32_t));
+            pos += sizeof(int32_t) + strLen + ridLen + childLen;
+        }
+        offsets[entryCounter] = pos;
+    }
+
+    uint16_t IXNode::findFirstEntryMeetCompCondition(const uint8_t *page, const EntryDirectory &directory,
+                                                     const uint8_t *key, const Attribute &attr, CompOp op) {
+        assert(op == GT_OP || op == GE_OP);
+        uint16_t low = 0, high = directory.size();
+        while (low < high) {
+            uint16_t mid = low + (high - low) / 2;
+            if (isCompositeKeyMeetCompCondition(page + directory[mid], key, attr, op)) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        return low;
+    }
+
     bool IXNode::isCompositeKeyMeetCompCondition(const uint8_t* key1,  const uint8_t* key2,  const Attribute& attr, const CompOp op){
         RID rid1, rid2;
         ((internalEntry*)key1)->getRID(attr.type, rid1.pageNum, rid1.slotNum);
@@ -123,8 +159,8 @@ namespace PeterDB {
         return false;
     }
 
-    RC IXNode::shiftDataLeft(int16_t dataNeedShiftStartPos, int16_t dist) {
-        int16_t dataNeedMoveLen = getFreeBytePointer() - dataNeedShiftStartPos;
+    RC IXNode::shiftDataLeft(int32_t dataNeedShiftStartPos, int32_t dist) {
+        int32_t dataNeedMoveLen = getFreeBytePointer() - dataNeedShiftStartPos;
         if (dataNeedMoveLen < 0) {
             return RC(IX_ERROR::MOVE_FAIL);
         }
@@ -138,8 +174,8 @@ namespace PeterDB {
         return 0;
     }
 
-    RC IXNode::shiftDataRight(int16_t dataNeedMoveStartPos, int16_t dist) {
-        int16_t dataNeedMoveLen = getFreeBytePointer() - dataNeedMoveStartPos;
+    RC IXNode::shiftDataRight(int32_t dataNeedMoveStartPos, int32_t dist) {
+        int32_t dataNeedMoveLen = getFreeBytePointer() - dataNeedMoveStartPos;
         if (dataNeedMoveLen < 0) {
             return RC(IX_ERROR::MOVE_FAIL);
         }
@@ -34,7 +34,7 @@ namespace PeterDB {
         // find the entry with lowkey
         while (curLeafPage != IX::NULL_PTR && curLeafPage < ixFileHandle->getNumberOfPages()) {
             LeafNode leaf(*ixFileHandle, curLeafPage);
-            int16_t firstEntryPos;
+            int32_t firstEntryPos;
             if (this->lowKeyInclusive) {
                 leaf.findFirstKeyMeetCompCondition(firstEntryPos, lowKey, attr, GE_OP);
             } else {
@@ -63,9 +63,8 @@ namespace PeterDB {
         }
         // Read current entry and check if it meets condition
         LeafNode leaf(*ixFileHandle, curLeafPage);
-        uint8_t buffer[PAGE_SIZE];
-        memset(buffer, 0, PAGE_SIZE);
-        auto entry = (leafEntry *) buffer;
+        std::vector<uint8_t> buffer(leaf.pageSize, 0);
+        auto entry = (leafEntry *) buffer.data();
         ret = leaf.getEntry(leaf.getFreeBytePointer() - remainDataLen, entry,attr);
         if (ret) return IX_EOF;
 
@@ -81,7 +80,7 @@ namespace PeterDB {
             return IX_EOF;
         }
 
-        int16_t nextEntryPos =leaf.getFreeBytePointer() - remainDataLen + entry->getEntryLength(attr.type);
+        int32_t nextEntryPos =leaf.getFreeBytePointer() - remainDataLen + entry->getEntryLength(attr.type);
         remainDataLen = leaf.getFreeBytePointer() - nextEntryPos;
         if(remainDataLen == 0) {
             // Reach the end of current page
@@ -103,6 +102,8 @@ namespace PeterDB {
             LeafNode leaf(*ixFileHandle, curLeafPage);
             if (!leaf.isEmpty()) {
                 remainDataLen = leaf.getFreeBytePointer();
+                // the sibling is only known now, start reading it while this leaf is consumed
+                if (leaf.getNextPtr() != IX::NULL_PTR) ixFileHandle->prefetchPages(leaf.getNextPtr(), 1);
                 break;
             }
             curLeafPage = leaf.getNextPtr();
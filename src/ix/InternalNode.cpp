@@ -6,18 +6,23 @@
 namespace PeterDB {
 
     RC InternalNode::getTargetChild(leafEntry *key, const Attribute &attr, int32_t &childPage) {
+        return getTargetChild(data, pageSize, key, attr, childPage);
+    }
+
+    RC InternalNode::getTargetChild(const uint8_t *page, unsigned pageSize, leafEntry *key, const Attribute &attr,
+                                    int32_t &childPage) {
         RC ret = 0;
         if (key == nullptr) {    // For scanner, get the first child
-            memcpy(&childPage, data, IX::NEXT_POINTER_LEN);
+            memcpy(&childPage, page, IX::NEXT_POINTER_LEN);
             return 0;
         }
         // skip the left most pointer;
-        int16_t pos = IX::NEXT_POINTER_LEN;
-        ret = findPosToInsertKey(pos, (internalEntry *) key, attr);
+        int32_t pos = IX::NEXT_POINTER_LEN;
+        ret = findPosToInsertKey(page, getkeyCounterFromData(page, pageSize), pos, (internalEntry *) key, attr);
         assert(ret == SUCCESS);
         // Get previous child pointer
         pos -= IX::NEXT_POINTER_LEN;
-        memcpy(&childPage, data + pos, IX::NEXT_POINTER_LEN);
+        memcpy(&childPage, page + pos, IX::NEXT_POINTER_LEN);
         return SUCCESS;
     }
 
@@ -25,7 +30,7 @@ namespace PeterDB {
         if (getFreeSpace() < key->getEntryLength(attr.type))return RC(IX_ERROR::PAGE_NO_ENOUGH_SPACE);
         // page will have no pointer to itself
         assert(key->getRightChild(attr.type) != getPageNum());
-        int16_t pos = IX::NEXT_POINTER_LEN;
+        int32_t pos = IX::NEXT_POINTER_LEN;
         RC ret = findPosToInsertKey(pos, key, attr);
         assert(ret == SUCCESS);
 
@@ -45,21 +50,21 @@ namespace PeterDB {
         auto internal2Page = ixFileHandle.getLastPageIndex();
 
         // Push up middle key - 3 Cases
-        int16_t newKeyInsertPos;
+        int32_t newKeyInsertPos;
         ret = findPosToInsertKey(newKeyInsertPos, keyToInsert, attr);
         if (ret) return ret;
 
-        int16_t curIndex = 0;
-        int16_t curPos = IX::NEXT_POINTER_LEN, prevPos;
+        int32_t curIndex = 0;
+        int32_t curPos = IX::NEXT_POINTER_LEN, prevPos;
         while (curPos < getFreeBytePointer() / 2) {
             prevPos = curPos;
             curPos += ((internalEntry *) (data + curPos))->getEntryLength(attr.type);
             curIndex++;
         }
-        int16_t prevIndex = curIndex - 1;
+        int32_t prevIndex = curIndex - 1;
 
         auto curKey = (internalEntry *) (data + curPos), prevKey = (internalEntry *) (data + prevPos);
-        int16_t moveStartPos, moveLen;
+        int32_t moveStartPos, moveLen;
         // ... | Prev Key | Cur Key | ...
         if (newKeyInsertPos <= prevPos) {
             // Case 1: Previous Key will be middle key
@@ -87,12 +92,12 @@ namespace PeterDB {
             // insert new N2 data
             // set newChildEntry right child to N2;
             auto newKeyRightChild = keyToInsert->getRightChild(attr.type);
-            uint8_t dataToMove[PAGE_SIZE];
+            std::vector<uint8_t> dataToMove(pageSize);
             moveLen = getFreeBytePointer() - curPos + IX::NEXT_POINTER_LEN;
-            memcpy(dataToMove, &newKeyRightChild, IX::NEXT_POINTER_LEN);
-            memcpy(dataToMove + IX::NEXT_POINTER_LEN, data + curPos, getFreeBytePointer() - curPos);
+            memcpy(dataToMove.data(), &newKeyRightChild, IX::NEXT_POINTER_LEN);
+            memcpy(dataToMove.data() + IX::NEXT_POINTER_LEN, data + curPos, getFreeBytePointer() - curPos);
 
-            InternalNode internal2(dataToMove, moveLen, ixFileHandle, internal2Page,
+            InternalNode internal2(dataToMove.data(), moveLen, ixFileHandle, internal2Page,
                                    getkeyCounter() - curIndex);
 
             setFreeBytePointer(curPos);
@@ -145,26 +150,31 @@ namespace PeterDB {
         assert(firstGTEntry == (internalEntry *) (data + IX::NEXT_POINTER_LEN));
         // empty page, insert directly;
         if (getkeyCounter() == 0)return SUCCESS;
-        for (int16_t i = 0; i < getkeyCounter(); i++) {
+        for (int32_t i = 0; i < getkeyCounter(); i++) {
             if (isCompositeKeyMeetCompCondition((uint8_t *) firstGTEntry, (uint8_t *) key, attr, GT_OP)) break;
             firstGTEntry = firstGTEntry->getNextEntry(attr.type);
         }
         return SUCCESS;
     }
 
-    RC InternalNode::findPosToInsertKey(int16_t &curPos, internalEntry *key, const Attribute &attr) {
+    RC InternalNode::findPosToInsertKey(int32_t &curPos, internalEntry *key, const Attribute &attr) {
+        return findPosToInsertKey(data, getkeyCounter(), curPos, key, attr);
+    }
+
+    RC InternalNode::findPosToInsertKey(const uint8_t *page, uint16_t keyCounter, int32_t &curPos,
+                                        internalEntry *key, const Attribute &attr) {
         // empty page, insert directly;
         curPos = IX::NEXT_POINTER_LEN;
-        if (getkeyCounter() == 0)return SUCCESS;
-        for (int16_t i = 0; i < getkeyCounter(); i++) {
-            if (isCompositeKeyMeetCompCondition((data + curPos), (uint8_t *) key, attr, GT_OP)) break;
-            curPos += ((internalEntry *) (data + curPos))->getEntryLength(attr.type);
-        }
+        if (keyCounter == 0)return SUCCESS;
+        // first key greater than the one to insert
+        EntryDirectory directory(page, IX::NEXT_POINTER_LEN, keyCounter, attr.type, IX::INTERNAL_NODE);
+        uint16_t index = findFirstEntryMeetCompCondition(page, directory, (uint8_t *) key, attr, GT_OP);
+        curPos = directory[index];
         return SUCCESS;
     }
 
 
-    RC InternalNode::writeEntry(internalEntry *key, const Attribute &attribute, int16_t pos) {
+    RC InternalNode::writeEntry(internalEntry *key, const Attribute &attribute, int32_t pos) {
         memcpy(data + pos, (uint8_t *) key, key->getEntryLength(attribute.type));
         return SUCCESS;
     }
@@ -173,9 +183,9 @@ namespace PeterDB {
         // 1. Keys
         out << "{\"keys\": [";
         std::queue<int> children;
-        int16_t offset = 0;
+        int32_t offset = 0;
         uint32_t child;
-        for (int16_t i = 0; i < getkeyCounter(); i++) {
+        for (int32_t i = 0; i < getkeyCounter(); i++) {
             memcpy(&child, data + offset, IX::NEXT_POINTER_LEN);
             children.push(child);
             offset += IX::NEXT_POINTER_LEN;
@@ -5,22 +5,19 @@
 #include "src/include/ix.h"
 
 namespace PeterDB {
-    RC LeafNode::writeEntry(leafEntry *key, const Attribute &attribute, int16_t pos) {
+    RC LeafNode::writeEntry(leafEntry *key, const Attribute &attribute, int32_t pos) {
         memcpy(data + pos, (uint8_t *) key, key->getEntryLength(attribute.type));
         return SUCCESS;
     }
 
     RC LeafNode::insertEntry(leafEntry *key, const Attribute &attribute) {
         if (getFreeSpace() < key->getEntryLength(attribute.type))return RC(IX_ERROR::PAGE_NO_ENOUGH_SPACE);
-        int16_t pos = 0;
+        int32_t pos = 0;
         // if not empty, find the right position
-        auto a = key->getKey<int32_t>();
         if (getkeyCounter() != 0) {
-            for (int i = 0; i < getkeyCounter(); i++) {
-                auto curKey = (leafEntry *) (data + pos);
-                if (isCompositeKeyMeetCompCondition((uint8_t*)key, data + pos, attribute, LT_OP))break;
-                pos += curKey->getEntryLength(attribute.type);
-            }
+            // first entry greater than the new one
+            EntryDirectory directory(data, 0, getkeyCounter(), attribute.type, IX::LEAF_NODE);
+            pos = directory[findFirstEntryMeetCompCondition(data, directory, (uint8_t *) key, attribute, GT_OP)];
         }
 
         if (pos > getFreeBytePointer())return RC(IX_ERROR::FREEBYTE_EXCEEDED);
@@ -39,8 +36,8 @@ namespace PeterDB {
         assert(ret == SUCCESS);
         int32_t leaf2Page = ixFileHandle.getLastPageIndex();
 
-        int16_t moveStartPos = 0;
-        int16_t moveStartIndex = 0;
+        int32_t moveStartPos = 0;
+        int32_t moveStartIndex = 0;
         while (moveStartPos < getFreeBytePointer() / 2) {
             moveStartPos += ((leafEntry *) (data + moveStartPos))->getEntryLength(attr.type);
             moveStartIndex++;
@@ -64,13 +61,13 @@ namespace PeterDB {
 
         if (!isSplitFeasible) {
             moveStartPos = 0;
-            for (int16_t i = 0; i < moveStartIndex; i++) {
+            for (int32_t i = 0; i < moveStartIndex; i++) {
                 moveStartPos += ((leafEntry *) (data + moveStartPos))->getEntryLength(attr.type);
             }
         }
 
         // move the data from moveStartPos to L2
-        int16_t moveLen = getFreeBytePointer() - moveStartPos;
+        int32_t moveLen = getFreeBytePointer() - moveStartPos;
         LeafNode leaf2(data + moveStartPos, moveLen, ixFileHandle, leaf2Page, getNextPtr(),
                        getkeyCounter() - moveStartIndex);
 
@@ -96,15 +93,15 @@ namespace PeterDB {
 
         // generate new middle key to copy up
         // newchildentry = & (smallest key value on L2, pointer to L2)
-        uint8_t buffer[PAGE_SIZE];
-        auto entry = (leafEntry *) buffer;
+        std::vector<uint8_t> buffer(pageSize);
+        auto entry = (leafEntry *) buffer.data();
         leaf2.getEntry(0, entry, attr);
         newChild->setCompositeKey(attr.type, entry->getKeyPtr<uint8_t>());
         newChild->setRightChild(attr.type, leaf2Page);
         return SUCCESS;
     }
 
-    RC LeafNode::getEntry(int16_t pos, leafEntry *leaf, Attribute attr) {
+    RC LeafNode::getEntry(int32_t pos, leafEntry *leaf, Attribute attr) {
         assert(pos < getFreeBytePointer());
         leaf->setKey(attr.type, data + pos);
         pos += leaf->getKeyLength(attr.type);
@@ -117,10 +114,28 @@ namespace PeterDB {
         return SUCCESS;
     }
 
-    RC LeafNode::findFirstKeyMeetCompCondition(int16_t &pos, const uint8_t *key, const Attribute &attr, CompOp op) {
+    RC LeafNode::findFirstKeyMeetCompCondition(int32_t &pos, const uint8_t *key, const Attribute &attr, CompOp op) {
+        if (op == GT_OP || op == GE_OP || op == EQ_OP) {
+            EntryDirectory directory(data, 0, keyCounter, attr.type, IX::LEAF_NODE);
+            if (op != EQ_OP) {
+                pos = directory[findFirstEntryMeetCompCondition(data, directory, key, attr, op)];
+                return SUCCESS;
+            }
+            // GE_OP only looks at the key, walk the entries with an equal key to match the rid
+            uint16_t index = findFirstEntryMeetCompCondition(data, directory, key, attr, GE_OP);
+            while (index < directory.size() && isKeyMeetCompCondition(data + directory[index], key, attr, EQ_OP)) {
+                if (isCompositeKeyMeetCompCondition(data + directory[index], key, attr, EQ_OP)) break;
+                index++;
+            }
+            if (index < directory.size() && !isKeyMeetCompCondition(data + directory[index], key, attr, EQ_OP)) {
+                index = directory.size();
+            }
+            pos = directory[index];
+            return SUCCESS;
+        }
         pos = 0;
         auto entry = (leafEntry *) data;
-        for (int16_t index = 0; index < keyCounter; index++) {
+        for (int32_t index = 0; index < keyCounter; index++) {
             if (isCompositeKeyMeetCompCondition((uint8_t*)entry,  key, attr, op)) {
                 break;
             }
@@ -132,13 +147,13 @@ namespace PeterDB {
 
     RC LeafNode::deleteEntry(leafEntry *key, const Attribute &attr) {
         RC ret = 0;
-        int16_t slotPos = 0;
+        int32_t slotPos = 0;
         findFirstKeyMeetCompCondition(slotPos, (uint8_t *) key, attr, EQ_OP);
         if (slotPos >= getFreeBytePointer()) {
             return RC(IX_ERROR::LEAF_ENTRY_NOT_EXIST);
         }
-        int16_t curEntryLen = ((leafEntry*)(data + slotPos))->getEntryLength(attr.type);
-        int16_t dataNeedMovePos = slotPos + curEntryLen  ;
+        int32_t curEntryLen = ((leafEntry*)(data + slotPos))->getEntryLength(attr.type);
+        int32_t dataNeedMovePos = slotPos + curEntryLen  ;
         if (dataNeedMovePos < getFreeBytePointer()) {
             shiftDataLeft(dataNeedMovePos, curEntryLen);
         }
@@ -166,15 +181,15 @@ namespace PeterDB {
     RC LeafNode::print(const Attribute &attr, std::ostream &out) {
         RC ret = 0;
         out << "{\"keys\": [";
-        int16_t offset = 0;
+        int32_t offset = 0;
         uint32_t pageNum;
-        int16_t slotNum;
+        int32_t slotNum;
 
         int32_t curInt;
         float curFloat;
         std::string curStr;
 
-        int16_t i = 0;
+        int32_t i = 0;
         while(i < getkeyCounter()) {
             out << "\"";
             // Print Key
@@ -242,7 +257,7 @@ namespace PeterDB {
         return 0;
     }
 
-    RC LeafNode::checkKey(int16_t pos, Attribute attr, leafEntry *key) {
+    RC LeafNode::checkKey(int32_t pos, Attribute attr, leafEntry *key) {
         getEntry(pos, (leafEntry *) checkEntryKey, attr);
         assert(memcmp(checkEntryKey, key, key->getEntryLength(attr.type)) == 0);
     }
@@ -10,10 +10,24 @@ namespace PeterDB {
  * IndexManager
  * =============================================
  */
-    RC IndexManager::createFile(const std::string &fileName) {
+    RC IndexManager::createFile(const std::string &fileName, unsigned pageSize) {
         if (isFileExists(fileName)) return RC(IX_ERROR::FILE_EXIST);
+        if (!PagedFileManager::isValidPageSize(pageSize)) {
+            LOG(ERROR) << "Page size " << pageSize << " is not supported @ IndexManager::createFile" << std::endl;
+            return RC(IX_ERROR::PAGE_SIZE_INVALID);
+        }
+        // the name may belong to a file removed behind our back, forget its cached pages
+        BufferPool::instance().dropFile(fileName);
         FILE *x = fopen(fileName.c_str(), "w+b");
-        fflush(x);
+        if (!x) return RC(IX_ERROR::ERR_FILE_OPEN_FAIL);
+        // the hidden page has to exist before the handle reads the metadata from it
+        std::vector<uint8_t> hiddenPage(pageSize, 0);
+        memcpy(hiddenPage.data() + 3 * sizeof(unsigned), &IX::NULL_PTR, sizeof(int32_t));
+        memcpy(hiddenPage.data() + 4 * sizeof(unsigned), &pageSize, sizeof(unsigned));
+        RC rc = LogManager::instance().logFileCreate(fileName, pageSize, hiddenPage.data(), IX::METADATA_LEN);
+        if (rc == SUCCESS) fwrite(hiddenPage.data(), pageSize, 1, x);
+        fclose(x);
+        if (rc) return rc;
         // init metadata of file
         IXFileHandle ixFileHandle;
         ixFileHandle.open(fileName);
@@ -23,10 +37,17 @@ namespace PeterDB {
 
     RC IndexManager::destroyFile(const std::string &fileName) {
         if (!isFileExists(fileName)) return RC(IX_ERROR::FILE_NOT_EXIST);
+        RC rc = LogManager::instance().logFileDestroy(fileName);
+        if (rc) return rc;
+        BufferPool::instance().dropFile(fileName);
         if (remove(fileName.c_str()) != 0) return RC(IX_ERROR::FILE_DELETE_FAIL);
         return SUCCESS;
     }
 
+    RC IndexManager::renameFile(const std::string &fromFileName, const std::string &toFileName) {
+        return PagedFileManager::instance().renameFile(fromFileName, toFileName);
+    }
+
     RC IndexManager::openFile(const std::string &fileName, IXFileHandle &ixFileHandle) {
         if (!isFileExists(fileName)) return RC(IX_ERROR::FILE_NOT_EXIST);
         return ixFileHandle.open(fileName);
@@ -39,54 +60,58 @@ namespace PeterDB {
 
     RC
     IndexManager::insertEntry(IXFileHandle &ixFileHandle, const Attribute &attribute, const void *key, const RID &rid) {
+        LogOperation operation(LOG_OP_IX_INSERT);
         if (!ixFileHandle.isOpen()) {
             auto name = ixFileHandle.getFileName();
             if (name == "") return RC(IX_ERROR::FILE_NOT_EXIST);
             ixFileHandle.open(name);
         }
 
-        uint8_t data[PAGE_SIZE];
-        memset(data, 0, PAGE_SIZE);
-        genCompositeEntry(attribute, key, rid, data);
-        auto entry = (leafEntry*)data;
+        std::vector<uint8_t> data(ixFileHandle.getPageSize(), 0);
+        genCompositeEntry(attribute, key, rid, data.data());
+        auto entry = (leafEntry*)data.data();
 
         if (ixFileHandle.isRootNull()) {
             RC ret = ixFileHandle.createRootPage();
             assert(ret == 0);
             uint32_t rootPage = ixFileHandle.getRoot();
-            LeafNode LeafNode(ixFileHandle, rootPage, IX::NULL_PTR);
-
-            ret = LeafNode.insertEntry(entry, attribute);
+            {
+                // the node writes its page back when it goes out of scope, that has to be before the commit
+                LeafNode LeafNode(ixFileHandle, rootPage, IX::NULL_PTR);
+                ret = LeafNode.insertEntry(entry, attribute);
+            }
             assert(ret == 0);
-            return SUCCESS;
+            return operation.commit();
         }
 
-        uint8_t buffer[PAGE_SIZE];
-        auto newChildEntry = (internalEntry*)buffer;
+        std::vector<uint8_t> buffer(ixFileHandle.getPageSize());
+        auto newChildEntry = (internalEntry*)buffer.data();
         bool isNewChildExist = false;
         RC ret = insertEntryRecur(ixFileHandle, ixFileHandle.getRoot(), entry, newChildEntry, isNewChildExist, attribute);
         if(ret) return ret;
-        return SUCCESS;
+        return operation.commit();
     }
 
     RC
     IndexManager::deleteEntry(IXFileHandle &ixFileHandle, const Attribute &attribute, const void *key, const RID &rid) {
+        LogOperation operation(LOG_OP_IX_DELETE);
         RC ret = 0;
 
         if (ixFileHandle.isRootNull()) return RC(IX_ERROR::ROOT_NOT_EXIST);
         // make the composite entry
-        uint8_t entryToDel[PAGE_SIZE];
-        memset(entryToDel, 0 , PAGE_SIZE);
-        genCompositeEntry(attribute, key, rid, entryToDel);
+        std::vector<uint8_t> entryToDel(ixFileHandle.getPageSize(), 0);
+        genCompositeEntry(attribute, key, rid, entryToDel.data());
 
         int32_t leafPage;
-        ret = findTargetLeafNode(ixFileHandle, leafPage, entryToDel, attribute);
+        ret = findTargetLeafNode(ixFileHandle, leafPage, entryToDel.data(), attribute);
 
         if (ret) return ret;
-        LeafNode leaf(ixFileHandle, leafPage);
-        ret = leaf.deleteEntry((leafEntry *)entryToDel, attribute);
+        {
+            LeafNode leaf(ixFileHandle, leafPage);
+            ret = leaf.deleteEntry((leafEntry *)entryToDel.data(), attribute);
+        }
         if (ret) return ret;
-        return SUCCESS;
+        return operation.commit();
     }
 
     RC IndexManager::scan(IXFileHandle &ixFileHandle,
@@ -137,28 +162,33 @@ namespace PeterDB {
     RC IndexManager::insertEntryRecur(IXFileHandle &ixFileHandle, int32_t nodePointer, leafEntry *entry,
                                       internalEntry *newChildEntry, bool &isNewChildExist, const Attribute &attribute) {
         RC ret;
-        IXNode ixnode(ixFileHandle, nodePointer);
+        std::vector<uint8_t> page(ixFileHandle.getPageSize());
+        const uint8_t *node;
+        uint16_t nodeType;
+        ret = ixFileHandle.readNode(nodePointer, page.data(), node, nodeType);
+        if (ret) return ret;
 
-        if (ixnode.getNodeType() == IX::INTERNAL_NODE) {
+        if (nodeType == IX::INTERNAL_NODE) {
             // No-leaf NODE N
-            InternalNode noLeaf(ixFileHandle, nodePointer);
             //find i such that Ki ≤ entry’s key value < Ki+1;
             int32_t subtree = IX::NULL_PTR;
-            ret = noLeaf.getTargetChild(entry, attribute, subtree);
+            ret = InternalNode::getTargetChild(node, ixFileHandle.getPageSize(), entry, attribute, subtree);
             if (ret) return RC(IX_ERROR::NOLEAF_GETTARGET_CHILD_FAIL);
             ret = insertEntryRecur(ixFileHandle, subtree, entry, newChildEntry,isNewChildExist, attribute);
             if(ret) return ret;
             if (!isNewChildExist) return SUCCESS;
             else {
+                // child split, only now the node has to be opened for writing
+                InternalNode noLeaf(ixFileHandle, nodePointer);
                 // Insert <returned middle composite key, new child page pointer> into current index page
-                int16_t entryLen = newChildEntry->getEntryLength(attribute.type);
+                int32_t entryLen = newChildEntry->getEntryLength(attribute.type);
                 uint8_t tmpEntry[entryLen];
                 memset(tmpEntry, 0, entryLen);
                 memcpy(tmpEntry, newChildEntry, entryLen);
                 ret = noLeaf.splitOrInsertNode((internalEntry*)tmpEntry, attribute, newChildEntry, isNewChildExist);
                 if(ret) return ret;
             }
-        } else if (ixnode.getNodeType() == IX::LEAF_NODE) {
+        } else if (nodeType == IX::LEAF_NODE) {
             // LEAF NODE L
             LeafNode leaf(ixFileHandle, nodePointer);
             ret = leaf.insertOrSplitEntry(entry, attribute, newChildEntry, isNewChildExist);
@@ -185,14 +215,18 @@ namespace PeterDB {
         if (ixFileHandle.isRootNull()) return RC(IX_ERROR::ROOT_NOT_EXIST);
 
         int32_t curPageNum = ixFileHandle.getRoot();
+        std::vector<uint8_t> page(ixFileHandle.getPageSize());
+        const uint8_t *node;
+        uint16_t nodeType;
         while (curPageNum != IX::NULL_PTR && curPageNum < ixFileHandle.getNumberOfPages()) {
-            IXNode node(ixFileHandle, curPageNum);
-            if (node.getNodeType() == IX::LEAF_NODE) {
+            ret = ixFileHandle.readNode(curPageNum, page.data(), node, nodeType);
+            if (ret) return ret;
+            if (nodeType == IX::LEAF_NODE) {
                 //*nodepointer is a leaf, return nodepointer
                 break;
-            }else if(node.getNodeType() == IX::INTERNAL_NODE){
-                InternalNode internal(ixFileHandle, curPageNum);
-                ret = internal.getTargetChild((leafEntry *) key, attr, curPageNum);
+            }else if(nodeType == IX::INTERNAL_NODE){
+                ret = InternalNode::getTargetChild(node, ixFileHandle.getPageSize(), (leafEntry *) key, attr,
+                                                   curPageNum);
                 if (ret) return ret;
             }else{
                 LOG(ERROR) << "Node Type Invalid! @ IndexManager::findTargetLeafNode" << std::endl;
@@ -206,6 +240,41 @@ namespace PeterDB {
         return SUCCESS;
     }
 
+    IndexManager::NodeCache &IndexManager::getNodeCache(IXFileHandle &ixFileHandle) {
+        NodeCache &cache = nodeCaches[ixFileHandle.fileId];
+        // the file has been destroyed or recreated since the nodes were cached
+        uint64_t generation = BufferPool::instance().getFileGeneration(ixFileHandle.fileId);
+        if (cache.generation != generation) {
+            cache.nodes.clear();
+            cache.generation = generation;
+        }
+        return cache;
+    }
+
+    const uint8_t *IndexManager::getCachedNode(IXFileHandle &ixFileHandle, uint32_t pageNum) {
+        NodeCache &cache = getNodeCache(ixFileHandle);
+        auto it = cache.nodes.find(pageNum);
+        if (it == cache.nodes.end()) return nullptr;
+        return it->second.data();
+    }
+
+    void IndexManager::cacheNode(IXFileHandle &ixFileHandle, uint32_t pageNum, const uint8_t *data) {
+        NodeCache &cache = getNodeCache(ixFileHandle);
+        if (cache.nodes.size() >= IX::NODE_CACHE_CAPACITY) return;
+        cache.nodes[pageNum].assign(data, data + ixFileHandle.getPageSize());
+    }
+
+    void IndexManager::refreshCachedNode(IXFileHandle &ixFileHandle, uint32_t pageNum, const uint8_t *data) {
+        NodeCache &cache = getNodeCache(ixFileHandle);
+        auto it = cache.nodes.find(pageNum);
+        if (it == cache.nodes.end()) return;
+        if (IXNode::getNodeTypeFromData(data, ixFileHandle.getPageSize()) != IX::INTERNAL_NODE) {
+            cache.nodes.erase(it);
+            return;
+        }
+        memcpy(it->second.data(), data, ixFileHandle.getPageSize());
+    }
+
     RC IndexManager::genCompositeEntry(const Attribute &attribute,const void *key, const RID &rid, uint8_t *entry ){
         ((leafEntry *) entry)->setKey(attribute.type, (uint8_t *) key);
         ((leafEntry *) entry)->setRID(attribute.type, rid.pageNum, rid.slotNum);
@@ -0,0 +1,1170 @@
+#include "src/include/pfm.h"
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <glog/logging.h>
+
+namespace PeterDB {
+/*==============================================
+ * LRUReplacer
+ * =============================================
+ */
+    LRUReplacer::LRUReplacer(unsigned numFrames) : position(numFrames), tracked(numFrames, false),
+                                                   evictable(numFrames, false) {}
+
+    void LRUReplacer::recordAccess(FrameId frameId) {
+        if (tracked[frameId]) lruList.erase(position[frameId]);
+        // most recently used frame sits at the back
+        position[frameId] = lruList.insert(lruList.end(), frameId);
+        tracked[frameId] = true;
+    }
+
+    void LRUReplacer::setEvictable(FrameId frameId, bool evictable) {
+        this->evictable[frameId] = evictable;
+    }
+
+    bool LRUReplacer::evict(FrameId &frameId) {
+        for (auto it = lruList.begin(); it != lruList.end(); it++) {
+            if (!evictable[*it]) continue;
+            frameId = *it;
+            remove(frameId);
+            return true;
+        }
+        return false;
+    }
+
+    void LRUReplacer::remove(FrameId frameId) {
+        if (!tracked[frameId]) return;
+        lruList.erase(position[frameId]);
+        tracked[frameId] = false;
+        evictable[frameId] = false;
+    }
+
+/*==============================================
+ * ClockReplacer
+ * =============================================
+ */
+    ClockReplacer::ClockReplacer(unsigned numFrames) : hand(0), referenced(numFrames, false),
+                                                       tracked(numFrames, false), evictable(numFrames, false) {}
+
+    void ClockReplacer::recordAccess(FrameId frameId) {
+        tracked[frameId] = true;
+        referenced[frameId] = true;
+    }
+
+    void ClockReplacer::setEvictable(FrameId frameId, bool evictable) {
+        this->evictable[frameId] = evictable;
+    }
+
+    bool ClockReplacer::evict(FrameId &frameId) {
+        FrameId numFrames = tracked.size();
+        if (numFrames == 0) return false;
+        // the first sweep may only clear reference bits, the second one must find a victim if any exists
+        for (FrameId step = 0; step < 2 * numFrames; step++) {
+            FrameId cur = hand;
+            hand = (hand + 1) % numFrames;
+            if (!tracked[cur] || !evictable[cur]) continue;
+            if (referenced[cur]) {
+                referenced[cur] = false;
+                continue;
+            }
+            frameId = cur;
+            remove(frameId);
+            return true;
+        }
+        return false;
+    }
+
+    void ClockReplacer::remove(FrameId frameId) {
+        tracked[frameId] = false;
+        referenced[frameId] = false;
+        evictable[frameId] = false;
+    }
+
+/*==============================================
+ * LRUKReplacer
+ * =============================================
+ */
+    LRUKReplacer::LRUKReplacer(unsigned numFrames, unsigned k) : k(k == 0 ? 1 : k), currentTimestamp(0),
+                                                                 history(numFrames), tracked(numFrames, false),
+                                                                 evictable(numFrames, false) {}
+
+    void LRUKReplacer::recordAccess(FrameId frameId) {
+        tracked[frameId] = true;
+        history[frameId].push_back(currentTimestamp++);
+        if (history[frameId].size() > k) history[frameId].pop_front();
+    }
+
+    void LRUKReplacer::setEvictable(FrameId frameId, bool evictable) {
+        this->evictable[frameId] = evictable;
+    }
+
+    bool LRUKReplacer::evict(FrameId &frameId) {
+        bool found = false;
+        bool victimHasKAccess = true;
+        uint64_t victimTimestamp = UINT64_MAX;
+        for (FrameId i = 0; i < tracked.size(); i++) {
+            if (!tracked[i] || !evictable[i]) continue;
+            bool hasKAccess = history[i].size() >= k;
+            // history.front() is the K-th most recent access, or the first access for frames with < K accesses
+            uint64_t timestamp = history[i].front();
+            if (!found || (victimHasKAccess && !hasKAccess) ||
+                (victimHasKAccess == hasKAccess && timestamp < victimTimestamp)) {
+                found = true;
+                frameId = i;
+                victimHasKAccess = hasKAccess;
+                victimTimestamp = timestamp;
+            }
+        }
+        if (found) remove(frameId);
+        return found;
+    }
+
+    void LRUKReplacer::remove(FrameId frameId) {
+        tracked[frameId] = false;
+        evictable[frameId] = false;
+        history[frameId].clear();
+    }
+
+/*==============================================
+ * BufferPool
+ * =============================================
+ */
+    BufferPool &BufferPool::instance() {
+        static BufferPool _buffer_pool;
+        return _buffer_pool;
+    }
+
+    BufferPool::BufferPool() : poolSize(0), policy(DEFAULT_REPLACEMENT_POLICY), lruK(DEFAULT_LRU_K),
+                               replacer(nullptr), minExtentSize(DEFAULT_MIN_EXTENT_SIZE),
+                               maxExtentSize(DEFAULT_MAX_EXTENT_SIZE), counter{0, 0, 0}, ioEngine(nullptr),
+                               nextIOTag(1), logManager(nullptr), writerStopping(false), writerInterval(0),
+                               writerRoundCounter(0), writerPageCounter(0), dirtyEvictCounter(0) {
+        setPoolSize(DEFAULT_BUFFER_POOL_SIZE);
+        ioEngine = IOEngine::create(DEFAULT_IO_ENGINE);
+        setWriterInterval(DEFAULT_WRITER_INTERVAL);
+    }
+
+    BufferPool::~BufferPool() {
+        stopWriter();
+        drainReads();
+        delete ioEngine;
+        flushAll();
+        for (FileId i = 0; i < mappings.size(); i++) unmapFile(i);
+        for (int &fd: fds) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+        delete replacer;
+    }
+
+    RC BufferPool::setPoolSize(unsigned numFrames) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        RC rc = drainReads();
+        if (rc) return rc;
+        for (auto &frame: frames) {
+            if (frame.isValid && frame.pinCount > 0) {
+                LOG(ERROR) << "Cannot resize while pages are pinned @ BufferPool::setPoolSize" << std::endl;
+                return RC(BUFFER_ERROR::FRAME_PINNED);
+            }
+        }
+        rc = flushAll();
+        if (rc) return rc;
+
+        poolSize = numFrames;
+        frames.assign(poolSize, Frame{FILE_ID_INVALID, 0, 0, false, false, 0, 0});
+        frameData.assign(poolSize, std::vector<uint8_t>(PAGE_SIZE, 0));
+        freeFrames.clear();
+        // hand out low frame ids first
+        for (FrameId i = poolSize; i > 0; i--) freeFrames.push_back(i - 1);
+        pageTable.clear();
+
+        delete replacer;
+        replacer = createReplacer();
+        return SUCCESS;
+    }
+
+    unsigned BufferPool::getPoolSize() const {
+        return poolSize;
+    }
+
+    RC BufferPool::setReplacementPolicy(ReplacementPolicy policy, unsigned k) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        this->policy = policy;
+        this->lruK = k;
+        delete replacer;
+        replacer = createReplacer();
+        // resident pages start with a fresh history under the new policy
+        for (FrameId i = 0; i < poolSize; i++) {
+            if (!frames[i].isValid) continue;
+            replacer->recordAccess(i);
+            replacer->setEvictable(i, frames[i].pinCount == 0);
+        }
+        return SUCCESS;
+    }
+
+    ReplacementPolicy BufferPool::getReplacementPolicy() const {
+        return policy;
+    }
+
+    RC BufferPool::setIOEngine(IOEngineType type) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        RC rc = drainReads();
+        if (rc) return rc;
+        delete ioEngine;
+        ioEngine = IOEngine::create(type);
+        return SUCCESS;
+    }
+
+    IOEngineType BufferPool::getIOEngine() const {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        return ioEngine ? ioEngine->getType() : IO_ENGINE_SYNC;
+    }
+
+    RC BufferPool::setLogManager(LogManager *logManager) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        for (FileId i = 0; logManager && i < mappings.size(); i++) {
+            if (isFileMapped(i)) {
+                LOG(ERROR) << fileNames[i] << " is mapped, its changes cannot be logged @ BufferPool::setLogManager"
+                           << std::endl;
+                return RC(LOG_ERROR::FILE_MAPPED);
+            }
+        }
+        this->logManager = logManager;
+        return SUCCESS;
+    }
+
+    RC BufferPool::setExtentSize(size_t minSize, size_t maxSize) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        if (minSize > maxSize) return RC(BUFFER_ERROR::EXTENT_SIZE_INVALID);
+        minExtentSize = minSize;
+        maxExtentSize = maxSize;
+        return SUCCESS;
+    }
+
+    RC BufferPool::setWriterInterval(unsigned millis) {
+        stopWriter();
+        writerInterval = millis;
+        if (millis == 0) return SUCCESS;
+        writerStopping = false;
+        writer = std::thread(&BufferPool::runWriter, this);
+        return SUCCESS;
+    }
+
+    unsigned BufferPool::getWriterInterval() const {
+        return writerInterval;
+    }
+
+    void BufferPool::stopWriter() {
+        if (!writer.joinable()) return;
+        {
+            std::lock_guard<std::mutex> guard(writerLatch);
+            writerStopping = true;
+        }
+        writerWake.notify_all();
+        writer.join();
+    }
+
+    // a round every interval, or right away when an eviction had to write a dirty page itself
+    void BufferPool::runWriter() {
+        std::unique_lock<std::mutex> lock(writerLatch);
+        while (!writerStopping) {
+            writerWake.wait_for(lock, std::chrono::milliseconds(writerInterval));
+            if (writerStopping) return;
+            lock.unlock();
+            RC rc = writeBackDirtyPages();
+            if (rc) LOG(WARNING) << "Fail to write back dirty pages @ BufferPool::runWriter" << std::endl;
+            lock.lock();
+        }
+    }
+
+    Replacer *BufferPool::createReplacer() const {
+        switch (policy) {
+            case REPLACE_CLOCK:
+                return new ClockReplacer(poolSize);
+            case REPLACE_LRU_K:
+                return new LRUKReplacer(poolSize, lruK);
+            case REPLACE_LRU:
+            default:
+                return new LRUReplacer(poolSize);
+        }
+    }
+
+    FileId BufferPool::registerFile(const std::string &fileName) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        auto it = fileIds.find(fileName);
+        if (it != fileIds.end()) return it->second;
+        FileId fileId = fileNames.size();
+        fileIds[fileName] = fileId;
+        fileNames.push_back(fileName);
+        fds.push_back(-1);
+        fileVersions.push_back(0);
+        fileGenerations.push_back(0);
+        pageSizes.push_back(PAGE_SIZE);
+        unsyncedFiles.push_back(false);
+        reservedSizes.push_back(0);
+        mappings.push_back(Mapping{nullptr, 0});
+        return fileId;
+    }
+
+    RC BufferPool::setFilePageSize(FileId fileId, unsigned pageSize) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        if (fileId >= pageSizes.size()) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        if (pageSizes[fileId] == pageSize) return SUCCESS;
+        // frames already holding pages of the file were cut at the old size
+        RC rc = drainReads();
+        if (rc) return rc;
+        for (FrameId i = 0; i < poolSize; i++) {
+            if (frames[i].isValid && frames[i].fileId == fileId && frames[i].pinCount > 0) {
+                LOG(ERROR) << "Cannot resize the pages of a file with pinned pages @ BufferPool::setFilePageSize"
+                           << std::endl;
+                return RC(BUFFER_ERROR::FRAME_PINNED);
+            }
+        }
+        rc = flushFile(fileId);
+        if (rc) return rc;
+        for (FrameId i = 0; i < poolSize; i++) {
+            if (frames[i].isValid && frames[i].fileId == fileId) releaseFrame(i);
+        }
+        pageSizes[fileId] = pageSize;
+        return SUCCESS;
+    }
+
+    unsigned BufferPool::getFilePageSize(FileId fileId) const {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        return fileId < pageSizes.size() ? pageSizes[fileId] : PAGE_SIZE;
+    }
+
+    uint64_t BufferPool::getPageKey(FileId fileId, PageNum pageNum) {
+        return ((uint64_t) fileId << 32) | pageNum;
+    }
+
+    // data pages of both record files and index files follow one hidden header page of the same size
+    long BufferPool::getPageOffset(FileId fileId, PageNum pageNum) const {
+        return (long) pageSizes[fileId] * ((long) pageNum + 1);
+    }
+
+    uint8_t *BufferPool::getFrameData(FrameId frameId) {
+        return frameData[frameId].data();
+    }
+
+    int BufferPool::getFd(FileId fileId) {
+        if (fileId >= fds.size()) return -1;
+        if (fds[fileId] < 0) {
+            // every access is positional, the descriptor has no file offset to share
+            fds[fileId] = open(fileNames[fileId].c_str(), O_RDWR);
+            if (fds[fileId] < 0) {
+                LOG(ERROR) << "Fail to open " << fileNames[fileId] << " @ BufferPool::getFd" << std::endl;
+                return -1;
+            }
+        }
+        return fds[fileId];
+    }
+
+    // pread/pwrite may transfer less than asked, keep going until done, EOF or an error
+    ssize_t BufferPool::readFully(int fd, void *data, size_t length, off_t offset) {
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = pread(fd, (uint8_t *) data + done, length - done, offset + (off_t) done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return -1;
+            if (n == 0) break;
+            done += n;
+        }
+        return (ssize_t) done;
+    }
+
+    bool BufferPool::writeFully(int fd, const void *data, size_t length, off_t offset) {
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = pwrite(fd, (const uint8_t *) data + done, length - done, offset + (off_t) done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    RC BufferPool::writeBackFrame(FrameId frameId) {
+        Frame &frame = frames[frameId];
+        if (!frame.isValid || !frame.isDirty) return SUCCESS;
+        // write-ahead: the log covering the page goes first
+        if (frame.pageLSN && logManager) {
+            RC rc = logManager->flush(frame.pageLSN);
+            if (rc) return rc;
+        }
+        int fd = getFd(frame.fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        if (!writeFully(fd, getFrameData(frameId), pageSizes[frame.fileId],
+                        getPageOffset(frame.fileId, frame.pageNum))) {
+            LOG(ERROR) << "Fail to write back page " << frame.pageNum << " @ BufferPool::writeBackFrame" << std::endl;
+            return RC(BUFFER_ERROR::WRITE_PAGE_FAIL);
+        }
+        frame.isDirty = false;
+        frame.pageLSN = 0;
+        unsyncedFiles[frame.fileId] = true;
+        return SUCCESS;
+    }
+
+    // write back in page order, frames holding consecutive pages of a file go out in one pwritev
+    RC BufferPool::writeBackFrames(std::vector<FrameId> &frameIds) {
+        std::sort(frameIds.begin(), frameIds.end(), [this](FrameId a, FrameId b) {
+            return getPageKey(frames[a].fileId, frames[a].pageNum) < getPageKey(frames[b].fileId, frames[b].pageNum);
+        });
+        LSN lsn = 0;
+        for (FrameId frameId: frameIds) lsn = std::max(lsn, frames[frameId].pageLSN);
+        if (lsn && logManager) {
+            RC rc = logManager->flush(lsn);
+            if (rc) return rc;
+        }
+        struct iovec iov[MAX_VECTORED_IO_PAGES];
+        size_t begin = 0;
+        while (begin < frameIds.size()) {
+            const Frame &first = frames[frameIds[begin]];
+            size_t end = begin + 1;
+            while (end < frameIds.size() && end - begin < MAX_VECTORED_IO_PAGES &&
+                   frames[frameIds[end]].fileId == first.fileId &&
+                   frames[frameIds[end]].pageNum == first.pageNum + (end - begin))
+                end++;
+
+            int fd = getFd(first.fileId);
+            if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+            unsigned pageSize = pageSizes[first.fileId];
+            for (size_t i = begin; i < end; i++) {
+                iov[i - begin].iov_base = getFrameData(frameIds[i]);
+                iov[i - begin].iov_len = pageSize;
+            }
+            ssize_t length = (ssize_t) (end - begin) * pageSize;
+            ssize_t written = pwritev(fd, iov, (int) (end - begin), getPageOffset(first.fileId, first.pageNum));
+            if (written != length) {
+                // a short vectored write is rare, finish the run one frame at a time
+                for (size_t i = begin; i < end; i++) {
+                    RC rc = writeBackFrame(frameIds[i]);
+                    if (rc) return rc;
+                }
+            }
+            for (size_t i = begin; i < end; i++) {
+                frames[frameIds[i]].isDirty = false;
+                frames[frameIds[i]].pageLSN = 0;
+            }
+            unsyncedFiles[first.fileId] = true;
+            begin = end;
+        }
+        return SUCCESS;
+    }
+
+    void BufferPool::releaseFrame(FrameId frameId) {
+        Frame &frame = frames[frameId];
+        pageTable.erase(getPageKey(frame.fileId, frame.pageNum));
+        replacer->remove(frameId);
+        frame = Frame{FILE_ID_INVALID, 0, 0, false, false, 0, 0};
+        freeFrames.push_back(frameId);
+    }
+
+    // the frame comes back sized to the pages of fileId
+    RC BufferPool::getFreeFrame(FileId fileId, FrameId &frameId, BufferCounter &handleCounter) {
+        if (!freeFrames.empty()) {
+            frameId = freeFrames.back();
+            freeFrames.pop_back();
+            frameData[frameId].resize(pageSizes[fileId]);
+            return SUCCESS;
+        }
+        if (!replacer->evict(frameId)) {
+            LOG(ERROR) << "All frames are pinned @ BufferPool::getFreeFrame" << std::endl;
+            return RC(BUFFER_ERROR::NO_FREE_FRAME);
+        }
+        if (frames[frameId].isDirty) {
+            // the writer has fallen behind, this thread pays for the write
+            dirtyEvictCounter++;
+            writerWake.notify_one();
+        }
+        RC rc = writeBackFrame(frameId);
+        if (rc) {
+            // keep the dirty page resident rather than losing it
+            replacer->recordAccess(frameId);
+            replacer->setEvictable(frameId, true);
+            return rc;
+        }
+        pageTable.erase(getPageKey(frames[frameId].fileId, frames[frameId].pageNum));
+        frames[frameId] = Frame{FILE_ID_INVALID, 0, 0, false, false, 0, 0};
+        frameData[frameId].resize(pageSizes[fileId]);
+        counter.evictCounter++;
+        handleCounter.evictCounter++;
+        return SUCCESS;
+    }
+
+    RC BufferPool::fetchPage(FileId fileId, PageNum pageNum, bool loadFromDisk, uint8_t *&page,
+                             BufferCounter &handleCounter) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        if (isFileMapped(fileId)) {
+            RC rc = growMapping(fileId, getPageOffset(fileId, pageNum + 1));
+            if (rc) return rc;
+            page = mappings[fileId].base + getPageOffset(fileId, pageNum);
+            return SUCCESS;
+        }
+
+        uint64_t key = getPageKey(fileId, pageNum);
+        auto it = pageTable.find(key);
+        if (it != pageTable.end() && frames[it->second].ioTag) {
+            // read ahead is still loading the page, a failed read leaves it non-resident
+            RC rc = waitForRead(frames[it->second].ioTag);
+            if (rc) return rc;
+            it = pageTable.find(key);
+        }
+        if (it != pageTable.end()) {
+            FrameId frameId = it->second;
+            frames[frameId].pinCount++;
+            replacer->recordAccess(frameId);
+            replacer->setEvictable(frameId, false);
+            counter.hitCounter++;
+            handleCounter.hitCounter++;
+            page = getFrameData(frameId);
+            return SUCCESS;
+        }
+
+        FrameId frameId;
+        RC rc = getFreeFrame(fileId, frameId, handleCounter);
+        if (rc) return rc;
+
+        if (loadFromDisk) {
+            int fd = getFd(fileId);
+            if (fd < 0) {
+                freeFrames.push_back(frameId);
+                return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+            }
+            ssize_t pageSize = pageSizes[fileId];
+            if (readFully(fd, getFrameData(frameId), pageSize, getPageOffset(fileId, pageNum)) != pageSize) {
+                LOG(ERROR) << "Fail to read page " << pageNum << " @ BufferPool::fetchPage" << std::endl;
+                freeFrames.push_back(frameId);
+                return RC(BUFFER_ERROR::READ_PAGE_FAIL);
+            }
+        }
+
+        frames[frameId] = Frame{fileId, pageNum, 1, false, true, 0, 0};
+        pageTable[key] = frameId;
+        replacer->recordAccess(frameId);
+        replacer->setEvictable(frameId, false);
+        counter.missCounter++;
+        handleCounter.missCounter++;
+        page = getFrameData(frameId);
+        return SUCCESS;
+    }
+
+    RC BufferPool::unpinPage(FileId fileId, PageNum pageNum, bool isDirty) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        if (isFileMapped(fileId)) {
+            if (isDirty) fileVersions[fileId]++;
+            return SUCCESS;
+        }
+        auto it = pageTable.find(getPageKey(fileId, pageNum));
+        if (it == pageTable.end()) return RC(BUFFER_ERROR::PAGE_NOT_RESIDENT);
+        Frame &frame = frames[it->second];
+        if (isDirty) {
+            frame.isDirty = true;
+            fileVersions[fileId]++;
+        }
+        if (frame.pinCount > 0) frame.pinCount--;
+        if (frame.pinCount == 0) replacer->setEvictable(it->second, true);
+        return SUCCESS;
+    }
+
+    RC BufferPool::readPage(FileId fileId, PageNum pageNum, void *data, BufferCounter &handleCounter) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        uint8_t *page;
+        RC rc = fetchPage(fileId, pageNum, true, page, handleCounter);
+        if (rc) return rc;
+        if (page != data) memcpy(data, page, pageSizes[fileId]);
+        return unpinPage(fileId, pageNum, false);
+    }
+
+    RC BufferPool::writePage(FileId fileId, PageNum pageNum, const void *data, BufferCounter &handleCounter) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        uint8_t *page;
+        // the whole page is overwritten, the old one is only needed as the before image of the log
+        RC rc = fetchPage(fileId, pageNum, logManager != nullptr, page, handleCounter);
+        if (rc) return rc;
+        if (logManager && page != data) {
+            LSN lsn;
+            rc = logManager->logChange(LOG_PAGE_WRITE, fileNames[fileId], pageNum, getPageOffset(fileId, pageNum),
+                                       page, (const uint8_t *) data, pageSizes[fileId], lsn);
+            if (rc) {
+                unpinPage(fileId, pageNum, false);
+                return rc;
+            }
+            if (lsn) frames[pageTable[getPageKey(fileId, pageNum)]].pageLSN = lsn;
+        }
+        // callers working in place on a mapped page pass the page itself
+        if (page != data) memcpy(page, data, pageSizes[fileId]);
+        return unpinPage(fileId, pageNum, true);
+    }
+
+    RC BufferPool::appendPage(FileId fileId, PageNum pageNum, const void *data, BufferCounter &handleCounter) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        if (logManager) {
+            RC rc = logWriteThrough(fileId, pageNum, 1, (const uint8_t *) data);
+            if (rc) return rc;
+        }
+        RC rc = reserveExtent(fileId, getPageOffset(fileId, pageNum + 1));
+        if (rc) return rc;
+        // extend the file on disk, then keep a clean copy resident since it is usually read right away
+        if (!writeFully(fd, data, pageSizes[fileId], getPageOffset(fileId, pageNum))) {
+            LOG(ERROR) << "Fail to append page " << pageNum << " @ BufferPool::appendPage" << std::endl;
+            return RC(BUFFER_ERROR::WRITE_PAGE_FAIL);
+        }
+        unsyncedFiles[fileId] = true;
+        fileVersions[fileId]++;
+        if (isFileMapped(fileId)) return growMapping(fileId, getPageOffset(fileId, pageNum + 1));
+        uint8_t *page;
+        if (fetchPage(fileId, pageNum, false, page, handleCounter) != SUCCESS) return SUCCESS;
+        memcpy(page, data, pageSizes[fileId]);
+        return unpinPage(fileId, pageNum, false);
+    }
+
+    RC BufferPool::prefetchPages(FileId fileId, PageNum startPage, unsigned numPages, BufferCounter &handleCounter) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        unsigned pageSize = pageSizes[fileId];
+        if (isFileMapped(fileId)) {
+            // the scan is about to walk these pages, let the kernel read them ahead
+            size_t begin = getPageOffset(fileId, startPage);
+            RC rc = growMapping(fileId, begin + (size_t) numPages * pageSize);
+            if (rc) return rc;
+            madvise(mappings[fileId].base + begin, (size_t) numPages * pageSize, MADV_WILLNEED);
+            return SUCCESS;
+        }
+        // never let read-ahead push out more than a quarter of the pool
+        numPages = std::min(numPages, poolSize / 4);
+        PageNum endPage = startPage + numPages;
+        PageNum pageNum = startPage;
+        if (ioEngine) {
+            while (pageNum < endPage) {
+                if (pageTable.count(getPageKey(fileId, pageNum))) {
+                    pageNum++;
+                    continue;
+                }
+                PageNum runEnd = pageNum + 1;
+                while (runEnd < endPage && runEnd - pageNum < MAX_VECTORED_IO_PAGES &&
+                       !pageTable.count(getPageKey(fileId, runEnd)))
+                    runEnd++;
+                RC rc = submitRead(fileId, pageNum, runEnd - pageNum, handleCounter);
+                if (rc) return rc;
+                pageNum = runEnd;
+            }
+            return SUCCESS;
+        }
+        struct iovec iov[MAX_VECTORED_IO_PAGES];
+        FrameId runFrames[MAX_VECTORED_IO_PAGES];
+        while (pageNum < endPage) {
+            if (pageTable.count(getPageKey(fileId, pageNum))) {
+                pageNum++;
+                continue;
+            }
+            PageNum runEnd = pageNum + 1;
+            while (runEnd < endPage && runEnd - pageNum < MAX_VECTORED_IO_PAGES &&
+                   !pageTable.count(getPageKey(fileId, runEnd)))
+                runEnd++;
+
+            int fd = getFd(fileId);
+            if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+            // the run is read straight into the frames it is going to live in
+            unsigned runLength = runEnd - pageNum;
+            for (unsigned i = 0; i < runLength; i++) {
+                RC rc = getFreeFrame(fileId, runFrames[i], handleCounter);
+                if (rc) {
+                    for (unsigned j = 0; j < i; j++) freeFrames.push_back(runFrames[j]);
+                    return rc;
+                }
+                iov[i].iov_base = getFrameData(runFrames[i]);
+                iov[i].iov_len = pageSize;
+            }
+            ssize_t bytesRead = preadv(fd, iov, (int) runLength, getPageOffset(fileId, pageNum));
+            unsigned pagesRead = bytesRead < 0 ? 0 : (unsigned) (bytesRead / pageSize);
+
+            for (unsigned i = 0; i < runLength; i++) {
+                if (i >= pagesRead) {
+                    freeFrames.push_back(runFrames[i]);
+                    continue;
+                }
+                FrameId frameId = runFrames[i];
+                frames[frameId] = Frame{fileId, pageNum + i, 0, false, true, 0, 0};
+                pageTable[getPageKey(fileId, pageNum + i)] = frameId;
+                replacer->recordAccess(frameId);
+                replacer->setEvictable(frameId, true);
+                counter.missCounter++;
+                handleCounter.missCounter++;
+            }
+            if (pagesRead < runLength) break;
+            pageNum = runEnd;
+        }
+        return SUCCESS;
+    }
+
+    // pin a frame for every page of the run and hand the read to the engine, the pages count as misses now
+    RC BufferPool::submitRead(FileId fileId, PageNum firstPage, unsigned numPages, BufferCounter &handleCounter) {
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        // completed reads unpin their frames, which may be needed for this run
+        IOCompletion completion;
+        while (ioEngine->pollCompletion(completion)) completeRead(completion);
+
+        uint64_t tag = nextIOTag++;
+        PendingRead &read = pendingReads[tag];
+        for (unsigned i = 0; i < numPages; i++) {
+            FrameId frameId;
+            RC rc = getFreeFrame(fileId, frameId, handleCounter);
+            if (rc) {
+                // read the pages that did get a frame, if any
+                if (i > 0) break;
+                pendingReads.erase(tag);
+                return rc;
+            }
+            frames[frameId] = Frame{fileId, firstPage + i, 1, false, true, tag, 0};
+            pageTable[getPageKey(fileId, firstPage + i)] = frameId;
+            replacer->recordAccess(frameId);
+            replacer->setEvictable(frameId, false);
+            read.frameIds.push_back(frameId);
+            read.iov.push_back({getFrameData(frameId), pageSizes[fileId]});
+            counter.missCounter++;
+            handleCounter.missCounter++;
+        }
+
+        IORequest request{fd, read.iov.data(), (int) read.iov.size(), getPageOffset(fileId, firstPage), false, tag};
+        RC rc;
+        while ((rc = ioEngine->submit(request)) == RC(BUFFER_ERROR::IO_QUEUE_FULL)) {
+            rc = ioEngine->waitCompletion(completion);
+            if (rc) break;
+            completeRead(completion);
+        }
+        if (rc) {
+            completeRead({tag, -EIO});
+            return rc;
+        }
+        return SUCCESS;
+    }
+
+    void BufferPool::completeRead(const IOCompletion &completion) {
+        auto it = pendingReads.find(completion.tag);
+        if (it == pendingReads.end()) return;
+        size_t pageSize = it->second.iov.front().iov_len;
+        size_t pagesRead = completion.result < 0 ? 0 : completion.result / pageSize;
+        for (size_t i = 0; i < it->second.frameIds.size(); i++) {
+            FrameId frameId = it->second.frameIds[i];
+            frames[frameId].ioTag = 0;
+            frames[frameId].pinCount--;
+            // pages past the end of the file, or a failed read, are simply not resident
+            if (i >= pagesRead) {
+                releaseFrame(frameId);
+                continue;
+            }
+            if (frames[frameId].pinCount == 0) replacer->setEvictable(frameId, true);
+        }
+        pendingReads.erase(it);
+    }
+
+    RC BufferPool::waitForRead(uint64_t tag) {
+        while (pendingReads.count(tag)) {
+            IOCompletion completion;
+            RC rc = ioEngine->waitCompletion(completion);
+            if (rc) return rc;
+            completeRead(completion);
+        }
+        return SUCCESS;
+    }
+
+    RC BufferPool::drainReads() {
+        while (!pendingReads.empty()) {
+            RC rc = waitForRead(pendingReads.begin()->first);
+            if (rc) return rc;
+        }
+        return SUCCESS;
+    }
+
+    RC BufferPool::readPages(FileId fileId, PageNum firstPage, unsigned numPages, void *data,
+                             BufferCounter &handleCounter) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        auto *out = (uint8_t *) data;
+        size_t pageSize = pageSizes[fileId];
+        if (isFileMapped(fileId)) {
+            size_t begin = getPageOffset(fileId, firstPage);
+            RC rc = growMapping(fileId, begin + numPages * pageSize);
+            if (rc) return rc;
+            memcpy(out, mappings[fileId].base + begin, numPages * pageSize);
+            return SUCCESS;
+        }
+        PageNum endPage = firstPage + numPages;
+        PageNum pageNum = firstPage;
+        while (pageNum < endPage) {
+            // a resident page may be newer than the disk copy
+            auto it = pageTable.find(getPageKey(fileId, pageNum));
+            if (it != pageTable.end() && frames[it->second].ioTag) {
+                RC rc = waitForRead(frames[it->second].ioTag);
+                if (rc) return rc;
+                it = pageTable.find(getPageKey(fileId, pageNum));
+            }
+            if (it != pageTable.end()) {
+                memcpy(out + (pageNum - firstPage) * pageSize, getFrameData(it->second), pageSize);
+                replacer->recordAccess(it->second);
+                counter.hitCounter++;
+                handleCounter.hitCounter++;
+                pageNum++;
+                continue;
+            }
+            // pages that are not resident are read straight into the caller's buffer without taking frames
+            PageNum runEnd = pageNum + 1;
+            while (runEnd < endPage && !pageTable.count(getPageKey(fileId, runEnd))) runEnd++;
+            int fd = getFd(fileId);
+            if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+            size_t length = (runEnd - pageNum) * pageSize;
+            if (readFully(fd, out + (pageNum - firstPage) * pageSize, length, getPageOffset(fileId, pageNum)) !=
+                (ssize_t) length) {
+                LOG(ERROR) << "Fail to read pages " << pageNum << "-" << runEnd - 1 << " @ BufferPool::readPages"
+                           << std::endl;
+                return RC(BUFFER_ERROR::READ_PAGE_FAIL);
+            }
+            counter.missCounter += runEnd - pageNum;
+            handleCounter.missCounter += runEnd - pageNum;
+            pageNum = runEnd;
+        }
+        return SUCCESS;
+    }
+
+    RC BufferPool::writePages(FileId fileId, PageNum firstPage, unsigned numPages, const void *data) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        // a read still in flight must not land on top of the new pages
+        for (PageNum i = 0; i < numPages; i++) {
+            auto it = pageTable.find(getPageKey(fileId, firstPage + i));
+            if (it == pageTable.end() || !frames[it->second].ioTag) continue;
+            RC rc = waitForRead(frames[it->second].ioTag);
+            if (rc) return rc;
+        }
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        auto *in = (const uint8_t *) data;
+        if (logManager) {
+            RC rc = logWriteThrough(fileId, firstPage, numPages, in);
+            if (rc) return rc;
+        }
+        RC rc = reserveExtent(fileId, getPageOffset(fileId, firstPage + numPages));
+        if (rc) return rc;
+        // written through in one call, this may extend the file
+        size_t pageSize = pageSizes[fileId];
+        if (!writeFully(fd, in, numPages * pageSize, getPageOffset(fileId, firstPage))) {
+            LOG(ERROR) << "Fail to write pages " << firstPage << "-" << firstPage + numPages - 1
+                       << " @ BufferPool::writePages" << std::endl;
+            return RC(BUFFER_ERROR::WRITE_PAGE_FAIL);
+        }
+        unsyncedFiles[fileId] = true;
+        fileVersions[fileId]++;
+        // a shared mapping sees the new pages through the page cache
+        if (isFileMapped(fileId)) return growMapping(fileId, getPageOffset(fileId, firstPage + numPages));
+        // resident copies now match the disk
+        for (PageNum i = 0; i < numPages; i++) {
+            auto it = pageTable.find(getPageKey(fileId, firstPage + i));
+            if (it == pageTable.end()) continue;
+            memcpy(getFrameData(it->second), in + i * pageSize, pageSize);
+            frames[it->second].isDirty = false;
+        }
+        return SUCCESS;
+    }
+
+    // log pages about to be written straight to disk and wait for the log, the old pages come from their
+    // frames or from disk, pages past the end of the file are all zeros
+    RC BufferPool::logWriteThrough(FileId fileId, PageNum firstPage, unsigned numPages, const uint8_t *data) {
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        size_t pageSize = pageSizes[fileId];
+        std::vector<uint8_t> before(pageSize);
+        LSN lastLSN = 0;
+        for (PageNum i = 0; i < numPages; i++) {
+            auto it = pageTable.find(getPageKey(fileId, firstPage + i));
+            if (it != pageTable.end()) {
+                memcpy(before.data(), getFrameData(it->second), pageSize);
+            } else {
+                ssize_t length = readFully(fd, before.data(), pageSize, getPageOffset(fileId, firstPage + i));
+                if (length < 0) return RC(BUFFER_ERROR::READ_PAGE_FAIL);
+                memset(before.data() + length, 0, pageSize - length);
+            }
+            LSN lsn;
+            RC rc = logManager->logChange(LOG_PAGE_WRITE, fileNames[fileId], firstPage + i,
+                                          getPageOffset(fileId, firstPage + i), before.data(), data + i * pageSize,
+                                          pageSize, lsn);
+            if (rc) return rc;
+            lastLSN = std::max(lastLSN, lsn);
+        }
+        return logManager->flush(lastLSN);
+    }
+
+    // allocate the blocks past the end of the file in one go, so that appends neither allocate nor fragment
+    // the file block by block; the reserved space does not count toward the file size
+    RC BufferPool::reserveExtent(FileId fileId, size_t end) {
+        size_t reserved = reservedSizes[fileId];
+        if (maxExtentSize == 0 || end <= reserved) return SUCCESS;
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        size_t extent = std::min(std::max(reserved, minExtentSize), maxExtentSize);
+        size_t newSize = std::max(end, reserved + extent);
+        if (fallocate(fd, FALLOC_FL_KEEP_SIZE, (off_t) reserved, (off_t) (newSize - reserved)) != 0) {
+            // not every file system can, the file then grows with its writes
+            LOG(WARNING) << "Fail to reserve space for " << fileNames[fileId] << " @ BufferPool::reserveExtent"
+                         << std::endl;
+        }
+        reservedSizes[fileId] = newSize;
+        return SUCCESS;
+    }
+
+    RC BufferPool::readFileHeader(FileId fileId, unsigned offset, void *data, unsigned length) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        if (readFully(fd, data, length, offset) != (ssize_t) length) {
+            LOG(ERROR) << "Fail to read the header of " << fileNames[fileId] << " @ BufferPool::readFileHeader"
+                       << std::endl;
+            return RC(BUFFER_ERROR::READ_PAGE_FAIL);
+        }
+        return SUCCESS;
+    }
+
+    RC BufferPool::writeFileHeader(FileId fileId, unsigned offset, const void *data, unsigned length) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        if (logManager) {
+            // the header is written through, so its log record has to be on disk first
+            std::vector<uint8_t> before(length, 0);
+            if (readFully(fd, before.data(), length, offset) < 0) return RC(BUFFER_ERROR::READ_PAGE_FAIL);
+            LSN lsn;
+            RC rc = logManager->logChange(LOG_HEADER_WRITE, fileNames[fileId], 0, offset, before.data(),
+                                          (const uint8_t *) data, length, lsn);
+            if (rc) return rc;
+            rc = logManager->flush(lsn);
+            if (rc) return rc;
+        }
+        if (!writeFully(fd, data, length, offset)) {
+            LOG(ERROR) << "Fail to write the header of " << fileNames[fileId] << " @ BufferPool::writeFileHeader"
+                       << std::endl;
+            return RC(BUFFER_ERROR::WRITE_PAGE_FAIL);
+        }
+        unsyncedFiles[fileId] = true;
+        return SUCCESS;
+    }
+
+    uint64_t BufferPool::getFileVersion(FileId fileId) const {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        return fileId < fileVersions.size() ? fileVersions[fileId] : 0;
+    }
+
+    uint64_t BufferPool::getFileGeneration(FileId fileId) const {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        return fileId < fileGenerations.size() ? fileGenerations[fileId] : 0;
+    }
+
+    void BufferPool::bumpFileGeneration(FileId fileId) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        if (fileId < fileGenerations.size()) fileGenerations[fileId]++;
+    }
+
+    RC BufferPool::flushFile(FileId fileId) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        std::vector<FrameId> dirtyFrames;
+        for (FrameId i = 0; i < poolSize; i++) {
+            if (frames[i].isValid && frames[i].isDirty && frames[i].fileId == fileId) dirtyFrames.push_back(i);
+        }
+        return writeBackFrames(dirtyFrames);
+    }
+
+    RC BufferPool::setFileMapped(FileId fileId, bool mapped) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        if (fileId >= mappings.size()) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+        if (isFileMapped(fileId) == mapped) return SUCCESS;
+        if (mapped && logManager) {
+            LOG(ERROR) << "Changes to a mapped file cannot be logged @ BufferPool::setFileMapped" << std::endl;
+            return RC(LOG_ERROR::FILE_MAPPED);
+        }
+        if (!mapped) {
+            // writes to the mapping are already in the page cache, reads through frames see them
+            unmapFile(fileId);
+            return SUCCESS;
+        }
+
+        // the mapping becomes the only copy of the pages, write back and drop the frames first
+        RC rc = drainReads();
+        if (rc) return rc;
+        for (FrameId i = 0; i < poolSize; i++) {
+            if (frames[i].isValid && frames[i].fileId == fileId && frames[i].pinCount > 0) {
+                LOG(ERROR) << "Cannot map a file with pinned pages @ BufferPool::setFileMapped" << std::endl;
+                return RC(BUFFER_ERROR::FRAME_PINNED);
+            }
+        }
+        rc = flushFile(fileId);
+        if (rc) return rc;
+        for (FrameId i = 0; i < poolSize; i++) {
+            if (frames[i].isValid && frames[i].fileId == fileId) releaseFrame(i);
+        }
+
+        void *base = mmap(nullptr, MMAP_RESERVE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (base == MAP_FAILED) {
+            LOG(ERROR) << "Fail to reserve address space for " << fileNames[fileId] << " @ BufferPool::setFileMapped"
+                       << std::endl;
+            return RC(BUFFER_ERROR::MAP_FILE_FAIL);
+        }
+        mappings[fileId] = Mapping{(uint8_t *) base, 0};
+        return SUCCESS;
+    }
+
+    bool BufferPool::isFileMapped(FileId fileId) const {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        return fileId < mappings.size() && mappings[fileId].base != nullptr;
+    }
+
+    // map the file over the reserved range chunk by chunk, pages already handed out keep their address
+    RC BufferPool::growMapping(FileId fileId, size_t size) {
+        Mapping &mapping = mappings[fileId];
+        if (size <= mapping.mappedSize) return SUCCESS;
+        if (size > MMAP_RESERVE_SIZE) {
+            LOG(ERROR) << fileNames[fileId] << " outgrows its mapping @ BufferPool::growMapping" << std::endl;
+            return RC(BUFFER_ERROR::MAP_FILE_FAIL);
+        }
+        int fd = getFd(fileId);
+        if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+
+        size_t newSize = std::min((size + MMAP_CHUNK_SIZE - 1) / MMAP_CHUNK_SIZE * MMAP_CHUNK_SIZE, MMAP_RESERVE_SIZE);
+        uint8_t *chunk = mapping.base + mapping.mappedSize;
+        size_t length = newSize - mapping.mappedSize;
+        // the chunk may reach past the end of the file, only pages below the page count are ever touched
+        if (mmap(chunk, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                 (off_t) mapping.mappedSize) == MAP_FAILED) {
+            LOG(ERROR) << "Fail to map " << fileNames[fileId] << " @ BufferPool::growMapping" << std::endl;
+            return RC(BUFFER_ERROR::MAP_FILE_FAIL);
+        }
+        // point lookups are the common case, scans ask for their pages through prefetchPages
+        madvise(chunk, length, MADV_RANDOM);
+        mapping.mappedSize = newSize;
+        return SUCCESS;
+    }
+
+    void BufferPool::unmapFile(FileId fileId) {
+        if (!isFileMapped(fileId)) return;
+        munmap(mappings[fileId].base, MMAP_RESERVE_SIZE);
+        mappings[fileId] = Mapping{nullptr, 0};
+    }
+
+    RC BufferPool::closeFile(FileId fileId) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        // reads in flight still use the descriptor
+        RC rc = drainReads();
+        if (rc) return rc;
+        rc = flushFile(fileId);
+        if (rc) return rc;
+        // clean frames stay resident, the descriptor is reopened lazily when a page has to be read
+        if (fileId < fds.size() && fds[fileId] >= 0) {
+            close(fds[fileId]);
+            fds[fileId] = -1;
+        }
+        return SUCCESS;
+    }
+
+    RC BufferPool::flushAll() {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        std::vector<FrameId> dirtyFrames;
+        for (FrameId i = 0; i < frames.size(); i++) {
+            if (frames[i].isValid && frames[i].isDirty) dirtyFrames.push_back(i);
+        }
+        return writeBackFrames(dirtyFrames);
+    }
+
+    RC BufferPool::syncFiles() {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        for (FileId i = 0; i < unsyncedFiles.size(); i++) {
+            if (!unsyncedFiles[i]) continue;
+            // a descriptor closed since the write is reopened, the data is still in the page cache
+            int fd = getFd(i);
+            if (fd < 0) return RC(BUFFER_ERROR::FILE_OPEN_FAIL);
+            if (fdatasync(fd) != 0) {
+                LOG(ERROR) << "Fail to sync " << fileNames[i] << " @ BufferPool::syncFiles" << std::endl;
+                return RC(BUFFER_ERROR::WRITE_PAGE_FAIL);
+            }
+            unsyncedFiles[i] = false;
+        }
+        return SUCCESS;
+    }
+
+    // dirty unpinned frames go out in page order, MAX_VECTORED_IO_PAGES at a time; the latch is taken
+    // again for every batch so that readers and writers get in between
+    RC BufferPool::writeBackDirtyPages() {
+        uint64_t nextKey = 0;
+        while (true) {
+            std::lock_guard<std::recursive_mutex> guard(latch);
+            std::vector<FrameId> batch;
+            for (FrameId i = 0; i < poolSize; i++) {
+                const Frame &frame = frames[i];
+                if (frame.isValid && frame.isDirty && frame.pinCount == 0 && !frame.ioTag &&
+                    getPageKey(frame.fileId, frame.pageNum) >= nextKey)
+                    batch.push_back(i);
+            }
+            if (batch.empty()) break;
+            auto byPage = [this](FrameId a, FrameId b) {
+                return getPageKey(frames[a].fileId, frames[a].pageNum) <
+                       getPageKey(frames[b].fileId, frames[b].pageNum);
+            };
+            if (batch.size() > MAX_VECTORED_IO_PAGES) {
+                std::partial_sort(batch.begin(), batch.begin() + MAX_VECTORED_IO_PAGES, batch.end(), byPage);
+                batch.resize(MAX_VECTORED_IO_PAGES);
+            }
+            // pages dirtied behind this point wait for the next round
+            FrameId last = *std::max_element(batch.begin(), batch.end(), byPage);
+            nextKey = getPageKey(frames[last].fileId, frames[last].pageNum) + 1;
+            unsigned numPages = batch.size();
+            RC rc = writeBackFrames(batch);
+            if (rc) return rc;
+            writerPageCounter += numPages;
+        }
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        writerRoundCounter++;
+        return SUCCESS;
+    }
+
+    RC BufferPool::dropFile(const std::string &fileName) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        auto it = fileIds.find(fileName);
+        if (it == fileIds.end()) return SUCCESS;
+        FileId fileId = it->second;
+        RC rc = drainReads();
+        if (rc) return rc;
+        for (FrameId i = 0; i < poolSize; i++) {
+            if (frames[i].isValid && frames[i].fileId == fileId) releaseFrame(i);
+        }
+        fileVersions[fileId]++;
+        fileGenerations[fileId]++;
+        unsyncedFiles[fileId] = false;
+        reservedSizes[fileId] = 0;
+        // a file created later under the same name is a different file on disk
+        unmapFile(fileId);
+        if (fds[fileId] >= 0) {
+            close(fds[fileId]);
+            fds[fileId] = -1;
+        }
+        return SUCCESS;
+    }
+
+    RC BufferPool::collectCounterValues(unsigned &hitCount, unsigned &missCount, unsigned &evictCount) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        hitCount = counter.hitCounter;
+        missCount = counter.missCounter;
+        evictCount = counter.evictCounter;
+        return SUCCESS;
+    }
+
+    RC BufferPool::collectWriterCounterValues(unsigned &roundCount, unsigned &writeCount, unsigned &dirtyEvictCount) {
+        std::lock_guard<std::recursive_mutex> guard(latch);
+        roundCount = writerRoundCounter;
+        writeCount = writerPageCounter;
+        dirtyEvictCount = dirtyEvictCounter;
+        return SUCCESS;
+    }
+}
@@ -0,0 +1,210 @@
+#include "src/include/pfm.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <glog/logging.h>
+
+namespace PeterDB {
+/*==============================================
+ * IOEngine
+ * =============================================
+ */
+    IOEngine *IOEngine::create(IOEngineType type, unsigned queueDepth) {
+        if (type == IO_ENGINE_SYNC) return nullptr;
+        if (type == IO_ENGINE_URING) {
+            auto *engine = new URingEngine();
+            if (engine->init(queueDepth) == SUCCESS) return engine;
+            delete engine;
+            LOG(WARNING) << "io_uring is not available, using the thread pool @ IOEngine::create" << std::endl;
+        }
+        return new ThreadPoolEngine(IO_THREAD_POOL_SIZE, queueDepth);
+    }
+
+/*==============================================
+ * URingEngine
+ * =============================================
+ */
+    URingEngine::URingEngine() : ringFd(-1), queueDepth(0), inFlight(0), sqRing(MAP_FAILED), cqRing(MAP_FAILED),
+                                 sqRingSize(0), cqRingSize(0), sqes((io_uring_sqe *) MAP_FAILED), sqesSize(0),
+                                 sqHead(nullptr), sqTail(nullptr), sqMask(nullptr), sqArray(nullptr),
+                                 cqHead(nullptr), cqTail(nullptr), cqMask(nullptr), cqes(nullptr) {}
+
+    URingEngine::~URingEngine() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+        if (ringFd >= 0) close(ringFd);
+    }
+
+    RC URingEngine::init(unsigned queueDepth) {
+        struct io_uring_params params{};
+        ringFd = (int) syscall(__NR_io_uring_setup, queueDepth, &params);
+        if (ringFd < 0) return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+        this->queueDepth = std::min(queueDepth, params.sq_entries);
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        // newer kernels map both rings with a single call
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                      IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+        cqRing = singleMap ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe *) mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                                     IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+
+        auto *sq = (uint8_t *) sqRing;
+        sqHead = (unsigned *) (sq + params.sq_off.head);
+        sqTail = (unsigned *) (sq + params.sq_off.tail);
+        sqMask = (unsigned *) (sq + params.sq_off.ring_mask);
+        sqArray = (unsigned *) (sq + params.sq_off.array);
+        auto *cq = (uint8_t *) cqRing;
+        cqHead = (unsigned *) (cq + params.cq_off.head);
+        cqTail = (unsigned *) (cq + params.cq_off.tail);
+        cqMask = (unsigned *) (cq + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe *) (cq + params.cq_off.cqes);
+        return SUCCESS;
+    }
+
+    RC URingEngine::submit(const IORequest &request) {
+        if (inFlight >= queueDepth) return RC(BUFFER_ERROR::IO_QUEUE_FULL);
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe &sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = request.isWrite ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe.fd = request.fd;
+        sqe.off = request.offset;
+        sqe.addr = (uint64_t) (uintptr_t) request.iov;
+        sqe.len = request.iovCount;
+        sqe.user_data = request.tag;
+        sqArray[index] = index;
+        // the kernel may only see the new tail once the entry is filled in
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        while (syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, nullptr, 0) < 0) {
+            if (errno == EINTR) continue;
+            LOG(ERROR) << "Fail to submit to io_uring: " << strerror(errno) << " @ URingEngine::submit" << std::endl;
+            return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+        }
+        inFlight++;
+        return SUCCESS;
+    }
+
+    bool URingEngine::pollCompletion(IOCompletion &completion) {
+        unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) return false;
+        const io_uring_cqe &cqe = cqes[head & *cqMask];
+        completion.tag = cqe.user_data;
+        completion.result = cqe.res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        inFlight--;
+        return true;
+    }
+
+    RC URingEngine::waitCompletion(IOCompletion &completion) {
+        if (inFlight == 0) return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+        while (!pollCompletion(completion)) {
+            if (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR) {
+                LOG(ERROR) << "Fail to wait on io_uring: " << strerror(errno) << " @ URingEngine::waitCompletion"
+                           << std::endl;
+                return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+            }
+        }
+        return SUCCESS;
+    }
+
+    unsigned URingEngine::getNumberOfInFlight() const {
+        return inFlight;
+    }
+
+    IOEngineType URingEngine::getType() const {
+        return IO_ENGINE_URING;
+    }
+
+/*==============================================
+ * ThreadPoolEngine
+ * =============================================
+ */
+    ThreadPoolEngine::ThreadPoolEngine(unsigned numThreads, unsigned queueDepth) : queueDepth(queueDepth),
+                                                                                  inFlight(0), stopping(false) {
+        for (unsigned i = 0; i < numThreads; i++) workers.emplace_back(&ThreadPoolEngine::run, this);
+    }
+
+    ThreadPoolEngine::~ThreadPoolEngine() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stopping = true;
+        }
+        requestReady.notify_all();
+        for (auto &worker: workers) worker.join();
+    }
+
+    void ThreadPoolEngine::run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            requestReady.wait(lock, [this]() { return stopping || !requests.empty(); });
+            if (requests.empty()) return;
+            IORequest request = requests.front();
+            requests.pop_front();
+            lock.unlock();
+
+            ssize_t result = request.isWrite ? pwritev(request.fd, request.iov, request.iovCount, request.offset)
+                                             : preadv(request.fd, request.iov, request.iovCount, request.offset);
+            if (result < 0) result = -errno;
+
+            lock.lock();
+            completions.push_back({request.tag, result});
+            completionReady.notify_one();
+        }
+    }
+
+    RC ThreadPoolEngine::submit(const IORequest &request) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (inFlight >= queueDepth) return RC(BUFFER_ERROR::IO_QUEUE_FULL);
+            requests.push_back(request);
+            inFlight++;
+        }
+        requestReady.notify_one();
+        return SUCCESS;
+    }
+
+    RC ThreadPoolEngine::waitCompletion(IOCompletion &completion) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (inFlight == 0) return RC(BUFFER_ERROR::IO_ENGINE_FAIL);
+        completionReady.wait(lock, [this]() { return !completions.empty(); });
+        completion = completions.front();
+        completions.pop_front();
+        inFlight--;
+        return SUCCESS;
+    }
+
+    bool ThreadPoolEngine::pollCompletion(IOCompletion &completion) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (completions.empty()) return false;
+        completion = completions.front();
+        completions.pop_front();
+        inFlight--;
+        return true;
+    }
+
+    unsigned ThreadPoolEngine::getNumberOfInFlight() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return inFlight;
+    }
+
+    IOEngineType ThreadPoolEngine::getType() const {
+        return IO_ENGINE_THREAD_POOL;
+    }
+}
@@ -0,0 +1,594 @@
+#include "src/include/pfm.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <unordered_set>
+#include <glog/logging.h>
+
+namespace PeterDB {
+    // a page write of the running operation, kept to roll it back
+    struct UndoChange {
+        std::string fileName;
+        PageNum pageNum;
+        uint64_t fileOffset;                    // of the page
+        std::vector<uint8_t> body;              // runs as in its log record
+    };
+
+    // the logged operation of the calling thread
+    struct OperationState {
+        uint64_t opId;                          // 0 while the log is closed
+        LogOperationType type;
+        unsigned depth;                         // nested beginOperation calls
+        bool logged;                            // something has to be committed
+        bool gated;                             // counted as running by the checkpoint gate
+        bool rollingBack;                       // its page writes are compensations
+        std::vector<UndoChange> changes;
+    };
+
+    static thread_local OperationState currentOperation = {0, LOG_OP_NONE, 0, false, false, false};
+
+    // the checksum covers a record from its LSN on
+    static const size_t CHECKSUM_BEGIN = 2 * sizeof(uint32_t);
+
+    static bool writeFully(int fd, const uint8_t *data, size_t length, off_t offset) {
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = pwrite(fd, data + done, length - done, offset + (off_t) done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    // files touched by recovery, -1 for one that does not exist (any more)
+    typedef std::unordered_map<std::string, int> ReplayFiles;
+
+    static int getReplayFd(ReplayFiles &files, const std::string &fileName) {
+        auto it = files.find(fileName);
+        if (it != files.end()) return it->second;
+        int fd = open(fileName.c_str(), O_RDWR);
+        files[fileName] = fd;
+        return fd;
+    }
+
+    // write the after images of a page/header record for redo, the before images for undo
+    static bool replayChange(const uint8_t *record, ReplayFiles &files, bool redo) {
+        LogRecordHeader header;
+        memcpy(&header, record, sizeof(LogRecordHeader));
+        std::string fileName((const char *) record + sizeof(LogRecordHeader), header.nameLength);
+        int fd = getReplayFd(files, fileName);
+        // the file has been destroyed later on
+        if (fd < 0) return true;
+
+        const uint8_t *body = record + sizeof(LogRecordHeader) + header.nameLength;
+        uint32_t numRuns;
+        memcpy(&numRuns, body, sizeof(uint32_t));
+        body += sizeof(uint32_t);
+        for (uint32_t i = 0; i < numRuns; i++) {
+            uint64_t offset;
+            uint32_t length;
+            memcpy(&offset, body, sizeof(uint64_t));
+            memcpy(&length, body + sizeof(uint64_t), sizeof(uint32_t));
+            body += sizeof(uint64_t) + sizeof(uint32_t);
+            if (!writeFully(fd, redo ? body + length : body, length, (off_t) offset)) return false;
+            body += 2 * length;
+        }
+        return true;
+    }
+
+    static bool replayFileCreate(const uint8_t *record, ReplayFiles &files) {
+        LogRecordHeader header;
+        memcpy(&header, record, sizeof(LogRecordHeader));
+        std::string fileName((const char *) record + sizeof(LogRecordHeader), header.nameLength);
+        auto it = files.find(fileName);
+        if (it != files.end() && it->second >= 0) close(it->second);
+
+        const uint8_t *body = record + sizeof(LogRecordHeader) + header.nameLength;
+        uint32_t pageSize, length;
+        memcpy(&pageSize, body, sizeof(uint32_t));
+        memcpy(&length, body + sizeof(uint32_t), sizeof(uint32_t));
+        std::vector<uint8_t> headerPage(pageSize, 0);
+        memcpy(headerPage.data(), body + 2 * sizeof(uint32_t), std::min(length, pageSize));
+        // a file created again under the same name starts over
+        int fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        files[fileName] = fd;
+        return fd >= 0 && writeFully(fd, headerPage.data(), pageSize, 0);
+    }
+
+    static void replayFileDestroy(const uint8_t *record, ReplayFiles &files) {
+        LogRecordHeader header;
+        memcpy(&header, record, sizeof(LogRecordHeader));
+        std::string fileName((const char *) record + sizeof(LogRecordHeader), header.nameLength);
+        auto it = files.find(fileName);
+        if (it != files.end() && it->second >= 0) close(it->second);
+        files[fileName] = -1;
+        remove(fileName.c_str());
+    }
+
+    LogManager &LogManager::instance() {
+        static LogManager _log_manager;
+        return _log_manager;
+    }
+
+    // the file registry and the pool are created first so they are destroyed after the final checkpoint
+    LogManager::LogManager() : enabled(false), fd(-1), nextLSN(1), flushedLSN(0), flushing(false), logSize(0),
+                               nextOpId(1), checkpointLogSize(DEFAULT_CHECKPOINT_LOG_SIZE), groupCommitDelay(0),
+                               commitCounter(0), syncCounter(0), checkpointCounter(0), redoCounter(0),
+                               undoCounter(0), activeOperations(0), checkpointing(false), checkpointerStopping(false),
+                               checkpointInterval(DEFAULT_CHECKPOINT_INTERVAL) {
+        PagedFileManager::instance();
+    }
+
+    LogManager::~LogManager() {
+        close();
+    }
+
+    RC LogManager::open(const std::string &logFileName) {
+        if (isOpen()) return RC(LOG_ERROR::LOG_ALREADY_OPEN);
+        fd = ::open(logFileName.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            LOG(ERROR) << "Fail to open the log " << logFileName << " @ LogManager::open" << std::endl;
+            return RC(LOG_ERROR::LOG_OPEN_FAIL);
+        }
+        this->logFileName = logFileName;
+        RC rc = recover();
+        if (rc == SUCCESS) rc = BufferPool::instance().setLogManager(this);
+        if (rc) {
+            ::close(fd);
+            fd = -1;
+            return rc;
+        }
+        enabled = true;
+        if (checkpointInterval) startCheckpointer();
+        return SUCCESS;
+    }
+
+    RC LogManager::close() {
+        if (!isOpen()) return SUCCESS;
+        stopCheckpointer();
+        RC rc = checkpoint();
+        if (rc) return rc;
+        BufferPool::instance().setLogManager(nullptr);
+        enabled = false;
+        ::close(fd);
+        fd = -1;
+        return SUCCESS;
+    }
+
+    bool LogManager::isOpen() const {
+        return enabled;
+    }
+
+    void LogManager::beginOperation(LogOperationType type) {
+        if (currentOperation.depth++ > 0) return;
+        currentOperation.type = type;
+        currentOperation.opId = 0;
+        currentOperation.logged = false;
+        currentOperation.gated = false;
+        currentOperation.changes.clear();
+        if (!isOpen()) return;
+        {
+            // a checkpoint in progress waits for running operations and holds back new ones
+            std::unique_lock<std::mutex> lock(gateLatch);
+            gateChanged.wait(lock, [this]() { return !checkpointing; });
+            activeOperations++;
+        }
+        currentOperation.gated = true;
+        std::lock_guard<std::mutex> guard(latch);
+        currentOperation.opId = nextOpId++;
+    }
+
+    RC LogManager::commitOperation() {
+        return endOperation(true);
+    }
+
+    RC LogManager::abortOperation() {
+        return endOperation(false);
+    }
+
+    // an aborted operation is rolled back before it lets a checkpoint in
+    RC LogManager::endOperation(bool commit) {
+        if (currentOperation.depth == 0 || --currentOperation.depth > 0) return SUCCESS;
+        RC rc = SUCCESS;
+        if (!commit && currentOperation.logged && isOpen()) rc = rollback();
+        if (commit && currentOperation.logged && isOpen()) {
+            LSN lsn;
+            rc = appendRecord(LOG_COMMIT, "", 0, std::vector<uint8_t>(), lsn);
+            if (rc == SUCCESS) rc = flush(lsn);
+            if (rc == SUCCESS) {
+                std::lock_guard<std::mutex> guard(latch);
+                commitCounter++;
+            }
+        }
+        bool gated = currentOperation.gated;
+        currentOperation.opId = 0;
+        currentOperation.type = LOG_OP_NONE;
+        currentOperation.logged = false;
+        currentOperation.gated = false;
+        currentOperation.changes.clear();
+        if (gated) {
+            std::lock_guard<std::mutex> guard(gateLatch);
+            activeOperations--;
+            gateChanged.notify_all();
+        }
+        if (commit && rc == SUCCESS && isOpen() && getLogSize() >= checkpointLogSize) {
+            if (!checkpointer.joinable()) return checkpoint();
+            checkpointerWake.notify_one();
+        }
+        return rc;
+    }
+
+    // the before images of the page writes go back newest first; each restore is a page write of its own,
+    // logged as a compensation, so a later checkpoint writes back the restored pages and recovery knows
+    // how far the rollback got
+    RC LogManager::rollback() {
+        BufferPool &bufferPool = BufferPool::instance();
+        BufferCounter counter = {0, 0, 0};
+        std::vector<uint8_t> page;
+        std::unordered_set<FileId> rolledBackFiles;
+        RC rc = SUCCESS;
+        currentOperation.rollingBack = true;
+        for (auto it = currentOperation.changes.rbegin(); it != currentOperation.changes.rend(); it++) {
+            FileId fileId = bufferPool.registerFile(it->fileName);
+            page.resize(bufferPool.getFilePageSize(fileId));
+            rc = bufferPool.readPage(fileId, it->pageNum, page.data(), counter);
+            if (rc) break;
+            const uint8_t *body = it->body.data();
+            uint32_t numRuns;
+            memcpy(&numRuns, body, sizeof(uint32_t));
+            body += sizeof(uint32_t);
+            for (uint32_t i = 0; i < numRuns; i++) {
+                uint64_t offset;
+                uint32_t length;
+                memcpy(&offset, body, sizeof(uint64_t));
+                memcpy(&length, body + sizeof(uint64_t), sizeof(uint32_t));
+                body += sizeof(uint64_t) + sizeof(uint32_t);
+                memcpy(page.data() + (offset - it->fileOffset), body, length);
+                body += 2 * length;
+            }
+            rc = bufferPool.writePage(fileId, it->pageNum, page.data(), counter);
+            if (rc) break;
+            rolledBackFiles.insert(fileId);
+        }
+        currentOperation.rollingBack = false;
+        // copies of the pages kept above the pool are stale now
+        for (FileId fileId: rolledBackFiles) bufferPool.bumpFileGeneration(fileId);
+        if (rc) {
+            LOG(ERROR) << "Fail to roll back an operation @ LogManager::rollback" << std::endl;
+            return rc;
+        }
+        LSN lsn;
+        return appendRecord(LOG_ABORT, "", 0, std::vector<uint8_t>(), lsn);
+    }
+
+    RC LogManager::logChange(LogRecordType type, const std::string &fileName, PageNum pageNum, uint64_t fileOffset,
+                             const uint8_t *before, const uint8_t *after, unsigned length, LSN &lsn) {
+        lsn = 0;
+        if (!isOpen()) return SUCCESS;
+        std::vector<uint8_t> body(sizeof(uint32_t));
+        uint32_t numRuns = 0;
+        unsigned i = 0;
+        while (i < length) {
+            if (before[i] == after[i]) {
+                i++;
+                continue;
+            }
+            // a run ends after LOG_RUN_GAP unchanged bytes in a row
+            unsigned begin = i, end = i + 1;
+            for (unsigned j = end; j < length && j - end < LOG_RUN_GAP; j++) {
+                if (before[j] != after[j]) end = j + 1;
+            }
+            uint64_t offset = fileOffset + begin;
+            uint32_t runLength = end - begin;
+            size_t pos = body.size();
+            body.resize(pos + sizeof(uint64_t) + sizeof(uint32_t) + 2 * runLength);
+            memcpy(body.data() + pos, &offset, sizeof(uint64_t));
+            memcpy(body.data() + pos + sizeof(uint64_t), &runLength, sizeof(uint32_t));
+            pos += sizeof(uint64_t) + sizeof(uint32_t);
+            memcpy(body.data() + pos, before + begin, runLength);
+            memcpy(body.data() + pos + runLength, after + begin, runLength);
+            numRuns++;
+            i = end;
+        }
+        if (numRuns == 0) return SUCCESS;
+        memcpy(body.data(), &numRuns, sizeof(uint32_t));
+        if (currentOperation.rollingBack) return appendRecord(LOG_COMPENSATION, fileName, pageNum, body, lsn);
+        RC rc = appendRecord(type, fileName, pageNum, body, lsn);
+        if (rc || currentOperation.depth == 0) return rc;
+        currentOperation.logged = true;
+        if (type == LOG_PAGE_WRITE) {
+            currentOperation.changes.push_back(UndoChange{fileName, pageNum, fileOffset, std::move(body)});
+        }
+        return SUCCESS;
+    }
+
+    RC LogManager::logFileCreate(const std::string &fileName, unsigned pageSize, const void *header,
+                                 unsigned length) {
+        if (!isOpen()) return SUCCESS;
+        std::vector<uint8_t> body(2 * sizeof(uint32_t) + length);
+        memcpy(body.data(), &pageSize, sizeof(uint32_t));
+        memcpy(body.data() + sizeof(uint32_t), &length, sizeof(uint32_t));
+        memcpy(body.data() + 2 * sizeof(uint32_t), header, length);
+        LSN lsn;
+        return appendRecord(LOG_FILE_CREATE, fileName, 0, body, lsn);
+    }
+
+    RC LogManager::logFileDestroy(const std::string &fileName) {
+        if (!isOpen()) return SUCCESS;
+        LSN lsn;
+        return appendRecord(LOG_FILE_DESTROY, fileName, 0, std::vector<uint8_t>(), lsn);
+    }
+
+    RC LogManager::appendRecord(LogRecordType type, const std::string &fileName, PageNum pageNum,
+                                const std::vector<uint8_t> &body, LSN &lsn) {
+        LogRecordHeader header{};
+        header.length = sizeof(LogRecordHeader) + fileName.size() + body.size();
+        header.opId = currentOperation.opId;
+        header.type = type;
+        header.opType = currentOperation.type;
+        header.nameLength = fileName.size();
+        header.pageNum = pageNum;
+
+        std::lock_guard<std::mutex> guard(latch);
+        header.lsn = lsn = nextLSN++;
+        size_t pos = buffer.size();
+        buffer.resize(pos + header.length);
+        uint8_t *record = buffer.data() + pos;
+        memcpy(record, &header, sizeof(LogRecordHeader));
+        memcpy(record + sizeof(LogRecordHeader), fileName.data(), fileName.size());
+        if (!body.empty()) memcpy(record + sizeof(LogRecordHeader) + fileName.size(), body.data(), body.size());
+        header.checksum = getChecksum(record + CHECKSUM_BEGIN, header.length - CHECKSUM_BEGIN);
+        memcpy(record + sizeof(uint32_t), &header.checksum, sizeof(uint32_t));
+        return SUCCESS;
+    }
+
+    // one committer at a time writes out everything buffered so far, the others wait for it
+    RC LogManager::flush(LSN lsn) {
+        std::unique_lock<std::mutex> lock(latch);
+        while (flushedLSN < lsn) {
+            if (fd < 0) return RC(LOG_ERROR::LOG_NOT_OPEN);
+            if (flushing) {
+                flushDone.wait(lock);
+                continue;
+            }
+            flushing = true;
+            if (groupCommitDelay) {
+                lock.unlock();
+                bool othersRunning;
+                {
+                    std::lock_guard<std::mutex> guard(gateLatch);
+                    othersRunning = activeOperations > 1;
+                }
+                // give the other running operations a chance to reach their commit record
+                if (othersRunning) std::this_thread::sleep_for(std::chrono::microseconds(groupCommitDelay));
+                lock.lock();
+            }
+            std::vector<uint8_t> batch;
+            batch.swap(buffer);
+            LSN batchLSN = nextLSN - 1;
+            size_t offset = logSize;
+            lock.unlock();
+
+            bool written = writeFully(fd, batch.data(), batch.size(), (off_t) offset) && fdatasync(fd) == 0;
+
+            lock.lock();
+            flushing = false;
+            flushDone.notify_all();
+            if (!written) {
+                LOG(ERROR) << "Fail to write the log " << logFileName << " @ LogManager::flush" << std::endl;
+                buffer.insert(buffer.begin(), batch.begin(), batch.end());
+                return RC(LOG_ERROR::LOG_WRITE_FAIL);
+            }
+            logSize += batch.size();
+            flushedLSN = batchLSN;
+            syncCounter++;
+        }
+        return SUCCESS;
+    }
+
+    RC LogManager::checkpoint() {
+        if (!isOpen()) return RC(LOG_ERROR::LOG_NOT_OPEN);
+        // the operation of this thread would never finish
+        if (currentOperation.depth) return RC(LOG_ERROR::OPERATION_IN_PROGRESS);
+        {
+            std::unique_lock<std::mutex> lock(gateLatch);
+            gateChanged.wait(lock, [this]() { return !checkpointing; });
+            checkpointing = true;
+            gateChanged.wait(lock, [this]() { return activeOperations == 0; });
+        }
+        // headers first, their write back is logged and flushed like any other
+        RC rc = PagedFileManager::instance().flushAll();
+        if (rc == SUCCESS) rc = BufferPool::instance().flushAll();
+        if (rc == SUCCESS) rc = BufferPool::instance().syncFiles();
+        if (rc == SUCCESS) rc = truncate();
+        if (rc == SUCCESS) {
+            std::lock_guard<std::mutex> guard(latch);
+            checkpointCounter++;
+        }
+        {
+            std::lock_guard<std::mutex> guard(gateLatch);
+            checkpointing = false;
+        }
+        gateChanged.notify_all();
+        return rc;
+    }
+
+    // every change written to the log so far is on disk, the log starts over; records still buffered
+    // were appended after the write back began and are kept, replaying them again is harmless
+    RC LogManager::truncate() {
+        std::unique_lock<std::mutex> lock(latch);
+        flushDone.wait(lock, [this]() { return !flushing; });
+        if (ftruncate(fd, 0) != 0 || fdatasync(fd) != 0) {
+            LOG(ERROR) << "Fail to truncate the log " << logFileName << " @ LogManager::truncate" << std::endl;
+            return RC(LOG_ERROR::LOG_SYNC_FAIL);
+        }
+        logSize = 0;
+        return SUCCESS;
+    }
+
+    void LogManager::startCheckpointer() {
+        checkpointerStopping = false;
+        checkpointer = std::thread(&LogManager::runCheckpointer, this);
+    }
+
+    void LogManager::stopCheckpointer() {
+        if (!checkpointer.joinable()) return;
+        {
+            std::lock_guard<std::mutex> guard(checkpointerLatch);
+            checkpointerStopping = true;
+        }
+        checkpointerWake.notify_all();
+        checkpointer.join();
+    }
+
+    // a checkpoint every interval, or as soon as a committer finds the log too large
+    void LogManager::runCheckpointer() {
+        std::unique_lock<std::mutex> lock(checkpointerLatch);
+        while (!checkpointerStopping) {
+            checkpointerWake.wait_for(lock, std::chrono::milliseconds(checkpointInterval));
+            if (checkpointerStopping) return;
+            lock.unlock();
+            if (getLogSize() > 0 && checkpoint() != SUCCESS) {
+                LOG(WARNING) << "Fail to checkpoint @ LogManager::runCheckpointer" << std::endl;
+            }
+            lock.lock();
+        }
+    }
+
+    RC LogManager::recover() {
+        redoCounter = 0;
+        undoCounter = 0;
+        off_t size = lseek(fd, 0, SEEK_END);
+        if (size < 0) return RC(LOG_ERROR::LOG_READ_FAIL);
+        std::vector<uint8_t> log(size);
+        size_t done = 0;
+        while (done < log.size()) {
+            ssize_t n = pread(fd, log.data() + done, log.size() - done, (off_t) done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return RC(LOG_ERROR::LOG_READ_FAIL);
+            done += n;
+        }
+
+        // a crash may tear the last records, the log ends at the first one that does not check out
+        std::vector<size_t> records;
+        std::unordered_set<uint64_t> committed;
+        // page writes of unfinished operations taken back by a rollback cut short by the crash
+        std::unordered_map<uint64_t, unsigned> compensated;
+        size_t pos = 0;
+        while (pos + sizeof(LogRecordHeader) <= log.size()) {
+            LogRecordHeader header;
+            memcpy(&header, log.data() + pos, sizeof(LogRecordHeader));
+            if (header.length < sizeof(LogRecordHeader) + header.nameLength || header.length > log.size() - pos) break;
+            uint32_t checksum = getChecksum(log.data() + pos + CHECKSUM_BEGIN, header.length - CHECKSUM_BEGIN);
+            if (checksum != header.checksum) break;
+            records.push_back(pos);
+            // an aborted operation has been rolled back completely
+            if (header.type == LOG_COMMIT || header.type == LOG_ABORT) committed.insert(header.opId);
+            if (header.type == LOG_COMPENSATION) compensated[header.opId]++;
+            pos += header.length;
+        }
+
+        ReplayFiles files;
+        bool replayed = true;
+        // redo everything in log order
+        for (size_t i = 0; i < records.size() && replayed; i++) {
+            const uint8_t *record = log.data() + records[i];
+            switch (record[offsetof(LogRecordHeader, type)]) {
+                case LOG_PAGE_WRITE:
+                case LOG_HEADER_WRITE:
+                case LOG_COMPENSATION:
+                    replayed = replayChange(record, files, true);
+                    break;
+                case LOG_FILE_CREATE:
+                    replayed = replayFileCreate(record, files);
+                    break;
+                case LOG_FILE_DESTROY:
+                    replayFileDestroy(record, files);
+                    break;
+                default:
+                    continue;
+            }
+            redoCounter++;
+        }
+        // then take back what unfinished operations changed, newest first; a rollback compensates the
+        // newest page writes first, as many as it logged compensations
+        for (size_t i = records.size(); i > 0 && replayed; i--) {
+            const uint8_t *record = log.data() + records[i - 1];
+            LogRecordHeader header;
+            memcpy(&header, record, sizeof(LogRecordHeader));
+            if (header.opId == 0 || committed.count(header.opId)) continue;
+            if (header.type != LOG_PAGE_WRITE && header.type != LOG_HEADER_WRITE) continue;
+            if (header.type == LOG_PAGE_WRITE) {
+                auto it = compensated.find(header.opId);
+                if (it != compensated.end() && it->second > 0) {
+                    it->second--;
+                    continue;
+                }
+            }
+            replayed = replayChange(record, files, false);
+            undoCounter++;
+        }
+
+        for (auto &file: files) {
+            if (file.second >= 0) {
+                if (fdatasync(file.second) != 0) replayed = false;
+                ::close(file.second);
+            }
+            // cached pages and headers of the file predate the replay
+            BufferPool::instance().dropFile(file.first);
+            PagedFileManager::instance().forgetFile(file.first);
+        }
+        if (!replayed) {
+            LOG(ERROR) << "Fail to replay the log " << logFileName << " @ LogManager::recover" << std::endl;
+            return RC(LOG_ERROR::LOG_REPLAY_FAIL);
+        }
+        return truncate();
+    }
+
+    void LogManager::setCheckpointLogSize(size_t size) {
+        checkpointLogSize = size;
+    }
+
+    void LogManager::setCheckpointInterval(unsigned millis) {
+        stopCheckpointer();
+        checkpointInterval = millis;
+        if (millis && isOpen()) startCheckpointer();
+    }
+
+    void LogManager::setGroupCommitDelay(unsigned micros) {
+        groupCommitDelay = micros;
+    }
+
+    size_t LogManager::getLogSize() const {
+        std::lock_guard<std::mutex> guard(latch);
+        return logSize + buffer.size();
+    }
+
+    RC LogManager::collectCounterValues(unsigned &commitCount, unsigned &syncCount, unsigned &checkpointCount) const {
+        std::lock_guard<std::mutex> guard(latch);
+        commitCount = commitCounter;
+        syncCount = syncCounter;
+        checkpointCount = checkpointCounter;
+        return SUCCESS;
+    }
+
+    void LogManager::getRecoveryCounts(unsigned &redoCount, unsigned &undoCount) const {
+        redoCount = redoCounter;
+        undoCount = undoCounter;
+    }
+
+    // FNV-1a
+    uint32_t LogManager::getChecksum(const uint8_t *data, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+}
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <typeinfo>
 #include <cstring>
+#include <algorithm>
 
 using namespace std;
 
@@ -12,35 +13,82 @@ namespace PeterDB {
         return _pf_manager;
     }
 
-    PagedFileManager::PagedFileManager() = default;
-
-    PagedFileManager::~PagedFileManager() = default;
-
-    PagedFileManager::PagedFileManager(const PagedFileManager &) = default;
+    // the pool is created first so it is destroyed after the registry has written back into it
+    PagedFileManager::PagedFileManager() : maxOpenFiles(DEFAULT_MAX_OPEN_FILES), clock(0) {
+        BufferPool::instance();
+    }
 
-    PagedFileManager &PagedFileManager::operator=(const PagedFileManager &) = default;
+    PagedFileManager::~PagedFileManager() {
+        flushAll();
+    }
 
-    RC PagedFileManager::createFile(const string &fileName) {
+    RC PagedFileManager::createFile(const string &fileName, unsigned pageSize, unsigned pageFormat) {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        if (!isValidPageSize(pageSize)) return RC(FILE_ERROR::FILE_PAGE_SIZE_INVALID);
         if (isFileExists(fileName)) return -1;
+        // the name may belong to a file removed behind our back, forget its cached pages and header
+        forgetFile(fileName);
+        BufferPool::instance().dropFile(fileName);
 
         FILE* fp = fopen(fileName.c_str(), "w+b");
 
-        // init metadata of file
-        FileHeader header = {0, 0, 0, 0};
-        fwrite(&header, File_Header_Page_Size, 1, fp);
+        // init metadata of file, an empty free-space map is all zeros, the header takes a whole page
+        std::vector<uint8_t> headerPage(pageSize, 0);
+        FileHeader header = {0, 0, 0, 0, pageSize, pageFormat, FILE_FORMAT_VERSION};
+        memcpy(headerPage.data(), &header, sizeof(FileHeader));
+        RC rc = LogManager::instance().logFileCreate(fileName, pageSize, &header, sizeof(FileHeader));
+        if (rc) {
+            fclose(fp);
+            return rc;
+        }
+        fwrite(headerPage.data(), pageSize, 1, fp);
         fflush(fp);
         fclose(fp);
         return 0;
     }
 
     RC PagedFileManager::destroyFile(const string &fileName) {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
         if (!isFileExists(fileName)) return RC(FILE_ERROR::FILE_NOT_EXIST);
+        RC rc = LogManager::instance().logFileDestroy(fileName);
+        if (rc) return rc;
+        forgetFile(fileName);
+        BufferPool::instance().dropFile(fileName);
         if (remove(fileName.c_str()) != 0) return -1;
         return 0;
     }
 
+    RC PagedFileManager::renameFile(const string &fromFileName, const string &toFileName) {
+        // the log must not hold changes under the old names, a checkpoint writes them back and empties it
+        LogManager &logManager = LogManager::instance();
+        if (logManager.isOpen()) {
+            RC rc = logManager.checkpoint();
+            if (rc) return rc;
+        }
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        if (!isFileExists(fromFileName)) return RC(FILE_ERROR::FILE_NOT_EXIST);
+        BufferPool &bufferPool = BufferPool::instance();
+        for (const string &fileName: {fromFileName, toFileName}) {
+            auto it = fileStates.find(fileName);
+            if (it == fileStates.end()) continue;
+            if (it->second.use_count() > 1) return RC(FILE_ERROR::FILE_IN_USE);
+            RC rc = writeBackFileState(*it->second);
+            if (rc) return rc;
+            fileStates.erase(it);
+        }
+        // the pages are on disk before the new name is
+        RC rc = bufferPool.syncFiles();
+        if (rc) return rc;
+        bufferPool.dropFile(fromFileName);
+        bufferPool.dropFile(toFileName);
+        if (rename(fromFileName.c_str(), toFileName.c_str()) != 0) return RC(FILE_ERROR::FILE_RENAME_FAIL);
+        return SUCCESS;
+    }
+
     RC PagedFileManager::openFile(const string &fileName, FileHandle &fileHandle) {
-        if (!isFileExists(fileName))return RC(FILE_ERROR::FILE_NOT_EXIST);
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        // a cached file is known to exist, skip the extra open
+        if (!fileStates.count(fileName) && !isFileExists(fileName)) return RC(FILE_ERROR::FILE_NOT_EXIST);
         return fileHandle.openFile(fileName);
     }
 
@@ -55,45 +103,196 @@ namespace PeterDB {
         return true;
     }
 
+    bool PagedFileManager::isValidPageSize(unsigned pageSize) {
+        return pageSize >= MIN_PAGE_SIZE && pageSize <= MAX_PAGE_SIZE && (pageSize & (pageSize - 1)) == 0;
+    }
+
+    RC PagedFileManager::setMaxOpenFiles(unsigned numFiles) {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        maxOpenFiles = numFiles;
+        return evictIdleFiles();
+    }
+
+    unsigned PagedFileManager::getMaxOpenFiles() const {
+        return maxOpenFiles;
+    }
+
+    unsigned PagedFileManager::getNumberOfOpenFiles() const {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        return fileStates.size();
+    }
+
+    RC PagedFileManager::flushAll() {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        for (auto &entry: fileStates) {
+            RC rc = writeBackFileState(*entry.second);
+            if (rc) return rc;
+        }
+        return SUCCESS;
+    }
+
+    RC PagedFileManager::acquireFileState(const std::string &fileName, std::shared_ptr<FileState> &state) {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        auto it = fileStates.find(fileName);
+        if (it != fileStates.end()) {
+            state = it->second;
+            state->lastUsed = ++clock;
+            return SUCCESS;
+        }
+
+        BufferPool &bufferPool = BufferPool::instance();
+        std::shared_ptr<FileState> newState = std::make_shared<FileState>();
+        newState->fileId = bufferPool.registerFile(fileName);
+        newState->metadataDirty = false;
+        newState->pendingMetadataOps = 0;
+        newState->freeSpaceMapDirty = false;
+        newState->lastUsed = ++clock;
+        RC rc = bufferPool.readFileHeader(newState->fileId, 0, &newState->header, sizeof(FileHeader));
+        if (rc) return RC(FILE_ERROR::FILE_READ_FAIL);
+        // an older header page puts the free-space map where this one keeps its fields
+        if (newState->header.formatVersion != FILE_FORMAT_VERSION) return RC(FILE_ERROR::FILE_FORMAT_UNSUPPORTED);
+        if (!isValidPageSize(newState->header.pageSize)) return RC(FILE_ERROR::FILE_PAGE_SIZE_INVALID);
+        rc = bufferPool.setFilePageSize(newState->fileId, newState->header.pageSize);
+        if (rc) return rc;
+        unsigned pageSize = newState->header.pageSize;
+        unsigned headerMapSize = getHeaderMapSize(pageSize);
+        newState->fsmBucketSize = pageSize / FSM_BUCKETS_PER_PAGE;
+        unsigned fsmPages = newState->header.pageCounter > headerMapSize ?
+                            (newState->header.pageCounter - headerMapSize + pageSize - 1) / pageSize : 0;
+        newState->freeSpaceMap.assign(headerMapSize + fsmPages * pageSize, 0);
+        newState->fsmPagesDirty.assign(fsmPages, false);
+        rc = bufferPool.readFileHeader(newState->fileId, FSM_OFFSET, newState->freeSpaceMap.data(), headerMapSize);
+        if (rc) return RC(FILE_ERROR::FILE_READ_FAIL);
+        BufferCounter fsmCounter = {0, 0, 0};
+        for (unsigned i = 0; i < fsmPages; i++) {
+            rc = bufferPool.readPages(newState->fileId, getFsmFilePageNum(i, pageSize), 1,
+                                      newState->freeSpaceMap.data() + headerMapSize + i * pageSize, fsmCounter);
+            if (rc) return RC(FILE_ERROR::FILE_READ_FAIL);
+        }
+
+        fileStates[fileName] = newState;
+        state = newState;
+        return evictIdleFiles();
+    }
+
+    RC PagedFileManager::releaseFileState(std::shared_ptr<FileState> &state) {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        state->lastUsed = ++clock;
+        // the last handle writes back pages and header, only the descriptor and the header cache stay
+        RC rc = state.use_count() > 2 ? SUCCESS : writeBackFileState(*state);
+        state.reset();
+        if (rc) return rc;
+        return evictIdleFiles();
+    }
+
+    RC PagedFileManager::evictIdleFiles() {
+        while (fileStates.size() > maxOpenFiles) {
+            // a state only referenced by the registry is not open in any handle
+            auto victim = fileStates.end();
+            for (auto it = fileStates.begin(); it != fileStates.end(); it++) {
+                if (it->second.use_count() > 1) continue;
+                if (victim == fileStates.end() || it->second->lastUsed < victim->second->lastUsed) victim = it;
+            }
+            if (victim == fileStates.end()) return SUCCESS;
+
+            RC rc = writeBackFileState(*victim->second);
+            if (rc) return rc;
+            rc = BufferPool::instance().closeFile(victim->second->fileId);
+            if (rc) return rc;
+            fileStates.erase(victim);
+        }
+        return SUCCESS;
+    }
+
+    RC PagedFileManager::writeBackFileState(FileState &state) {
+        std::lock_guard<std::mutex> guard(state.latch);
+        BufferPool &bufferPool = BufferPool::instance();
+        RC rc = bufferPool.flushFile(state.fileId);
+        if (rc) return rc;
+        if (state.metadataDirty) {
+            rc = bufferPool.writeFileHeader(state.fileId, 0, &state.header, sizeof(FileHeader));
+            if (rc) return rc;
+            state.metadataDirty = false;
+            state.pendingMetadataOps = 0;
+        }
+        return writeFreeSpaceMap(state);
+    }
+
+    RC PagedFileManager::writeFreeSpaceMap(FileState &state) {
+        BufferPool &bufferPool = BufferPool::instance();
+        unsigned pageSize = state.header.pageSize;
+        unsigned headerMapSize = getHeaderMapSize(pageSize);
+        if (state.freeSpaceMapDirty) {
+            RC rc = bufferPool.writeFileHeader(state.fileId, FSM_OFFSET, state.freeSpaceMap.data(), headerMapSize);
+            if (rc) return rc;
+            state.freeSpaceMapDirty = false;
+        }
+        for (unsigned i = 0; i < state.fsmPagesDirty.size(); i++) {
+            if (!state.fsmPagesDirty[i]) continue;
+            RC rc = bufferPool.writePages(state.fileId, getFsmFilePageNum(i, pageSize), 1,
+                                          state.freeSpaceMap.data() + headerMapSize + i * pageSize);
+            if (rc) return rc;
+            state.fsmPagesDirty[i] = false;
+        }
+        return SUCCESS;
+    }
+
+    void PagedFileManager::forgetFile(const std::string &fileName) {
+        std::lock_guard<std::recursive_mutex> guard(registryLatch);
+        fileStates.erase(fileName);
+    }
+
     FileHandle::FileHandle() {
-        pageCounter = 0;
-        readPageCounter = 0;
-        writePageCounter = 0;
-        appendPageCounter = 0;
+        bufferCounter = {0, 0, 0};
+        metadataFlushInterval = DEFAULT_METADATA_FLUSH_INTERVAL;
     }
 
     FileHandle::~FileHandle() = default;
 
     RC FileHandle::openFile(const std::string& fileName){
-        // open file as binary
-        fileInMemory = fopen(fileName.c_str(), "r+b");
-        fileIsOpen = true;
-        this->fileName = fileName;
-        return readMetadata();
+        bufferCounter = {0, 0, 0};
+        return PagedFileManager::instance().acquireFileState(fileName, state);
     };
 
     RC FileHandle::closeFile(){
         if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
-        flushMetadata();
-        fclose(fileInMemory);
-        fileIsOpen = false;
-        return SUCCESS;
+        return PagedFileManager::instance().releaseFileState(state);
     }
 
     RC FileHandle::readPage(PageNum pageNum, void *data) {
-        size_t result;
         // check if pageNum is valid
         if (getNumberOfPages() <= pageNum) {
             return RC(FILE_ERROR::FILE_NO_ENOUGH_PAGE);
         }
-        // point to that page
-        fseek(fileInMemory, File_Header_Page_Size + PAGE_SIZE * pageNum, SEEK_SET);
-        // retrieve data
-        result = fread(data, PAGE_SIZE, 1, fileInMemory);
-        if (result < 1) return RC(FILE_ERROR::FILE_READ_ONE_PAGE_FAIL);
-        // update counter
-        readPageCounter = readPageCounter + 1;
-        return flushMetadata();
+        std::lock_guard<std::mutex> guard(state->latch);
+        // retrieve data through buffer pool
+        if (BufferPool::instance().readPage(state->fileId, getFilePageNum(pageNum, state->header.pageSize), data,
+                                            bufferCounter) != SUCCESS)
+            return RC(FILE_ERROR::FILE_READ_ONE_PAGE_FAIL);
+        // update counter, persisted later
+        state->header.readPageCounter++;
+        return markMetadataDirty();
+    }
+
+    RC FileHandle::pinPage(PageNum pageNum, const uint8_t *&page) {
+        if (getNumberOfPages() <= pageNum) {
+            return RC(FILE_ERROR::FILE_NO_ENOUGH_PAGE);
+        }
+        std::lock_guard<std::mutex> guard(state->latch);
+        // the frame stays pinned, or the page mapped, so the caller reads it without a copy
+        uint8_t *frame;
+        if (BufferPool::instance().fetchPage(state->fileId, getFilePageNum(pageNum, state->header.pageSize), true,
+                                             frame, bufferCounter) != SUCCESS)
+            return RC(FILE_ERROR::FILE_READ_ONE_PAGE_FAIL);
+        page = frame;
+        state->header.readPageCounter++;
+        return markMetadataDirty();
+    }
+
+    RC FileHandle::unpinPage(PageNum pageNum) {
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        std::lock_guard<std::mutex> guard(state->latch);
+        return BufferPool::instance().unpinPage(state->fileId, getFilePageNum(pageNum, state->header.pageSize), false);
     }
 
     RC FileHandle::writePage(PageNum pageNum, const void *data) {
@@ -101,58 +300,272 @@ namespace PeterDB {
         if (getNumberOfPages() <= pageNum) {
             return RC(FILE_ERROR::FILE_NO_ENOUGH_PAGE);
         }
-        // point to that page
-        fseek(fileInMemory, File_Header_Page_Size + PAGE_SIZE * pageNum, SEEK_SET);
-        // overwrite data into page
-        fwrite(data, PAGE_SIZE, 1, fileInMemory);
-        // write into file on disk
-        fflush(fileInMemory);
-        // update counter
-        writePageCounter = writePageCounter + 1;
-        return flushMetadata();
+        std::lock_guard<std::mutex> guard(state->latch);
+        // overwrite data into the buffered page, written back on eviction or checkpoint
+        RC rc = BufferPool::instance().writePage(state->fileId, getFilePageNum(pageNum, state->header.pageSize), data,
+                                                 bufferCounter);
+        if (rc) return rc;
+        // update counter, persisted later
+        state->header.writePageCounter++;
+        return markMetadataDirty();
     }
 
     RC FileHandle::appendPage(const void *data) {
-        fseek(fileInMemory, File_Header_Page_Size + PAGE_SIZE * pageCounter, SEEK_SET);
-        fwrite(data, PAGE_SIZE, 1, fileInMemory);
-        appendPageCounter = appendPageCounter + 1;
-        pageCounter = pageCounter + 1;
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        std::lock_guard<std::mutex> guard(state->latch);
+        RC rc = appendFsmPageIfNeeded();
+        if (rc) return rc;
+        rc = BufferPool::instance().appendPage(state->fileId,
+                                               getFilePageNum(state->header.pageCounter, state->header.pageSize),
+                                               data, bufferCounter);
+        if (rc) return rc;
+        state->header.appendPageCounter++;
+        state->header.pageCounter++;
+        // the page count has to reach the header together with the new page
+        return flushMetadata();
+    }
+
+    RC FileHandle::readPages(PageNum firstPage, unsigned numPages, void *data) {
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        if (firstPage + numPages > getNumberOfPages() || firstPage + numPages < firstPage) {
+            return RC(FILE_ERROR::FILE_NO_ENOUGH_PAGE);
+        }
+        std::lock_guard<std::mutex> guard(state->latch);
+        auto *out = (uint8_t *) data;
+        for (PageNum pageNum = firstPage; pageNum < firstPage + numPages;) {
+            unsigned run = getContiguousPages(pageNum, firstPage + numPages - pageNum);
+            if (BufferPool::instance().readPages(state->fileId, getFilePageNum(pageNum, state->header.pageSize), run,
+                                                 out, bufferCounter) != SUCCESS)
+                return RC(FILE_ERROR::FILE_READ_ONE_PAGE_FAIL);
+            out += run * state->header.pageSize;
+            pageNum += run;
+        }
+        state->header.readPageCounter += numPages;
+        return markMetadataDirty();
+    }
+
+    RC FileHandle::writePages(PageNum firstPage, unsigned numPages, const void *data) {
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        if (firstPage + numPages > getNumberOfPages() || firstPage + numPages < firstPage) {
+            return RC(FILE_ERROR::FILE_NO_ENOUGH_PAGE);
+        }
+        std::lock_guard<std::mutex> guard(state->latch);
+        // unlike writePage the pages go straight to disk, resident copies are refreshed
+        auto *in = (const uint8_t *) data;
+        for (PageNum pageNum = firstPage; pageNum < firstPage + numPages;) {
+            unsigned run = getContiguousPages(pageNum, firstPage + numPages - pageNum);
+            RC rc = BufferPool::instance().writePages(state->fileId, getFilePageNum(pageNum, state->header.pageSize),
+                                                      run, in);
+            if (rc) return rc;
+            in += run * state->header.pageSize;
+            pageNum += run;
+        }
+        state->header.writePageCounter += numPages;
+        return markMetadataDirty();
+    }
+
+    RC FileHandle::appendPages(unsigned numPages, const void *data) {
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        if (numPages == 0) return SUCCESS;
+        std::lock_guard<std::mutex> guard(state->latch);
+        auto *in = (const uint8_t *) data;
+        while (numPages > 0) {
+            RC rc = appendFsmPageIfNeeded();
+            if (rc) return rc;
+            PageNum pageNum = state->header.pageCounter;
+            unsigned run = getContiguousPages(pageNum, numPages);
+            rc = BufferPool::instance().writePages(state->fileId, getFilePageNum(pageNum, state->header.pageSize),
+                                                   run, in);
+            if (rc) return rc;
+            state->header.appendPageCounter += run;
+            state->header.pageCounter += run;
+            in += run * state->header.pageSize;
+            numPages -= run;
+        }
         return flushMetadata();
     }
 
     unsigned FileHandle::getNumberOfPages() {
-        return pageCounter;
+        return isFileOpen() ? state->header.pageCounter : 0;
+    }
+
+    unsigned FileHandle::getPageSize() {
+        return isFileOpen() ? state->header.pageSize : PAGE_SIZE;
+    }
+
+    unsigned FileHandle::getPageFormat() {
+        return isFileOpen() ? state->header.pageFormat : 0;
     }
 
     RC FileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount) {
-        readPageCount = readPageCounter;
-        writePageCount = writePageCounter;
-        appendPageCount = appendPageCounter;
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        readPageCount = state->header.readPageCounter;
+        writePageCount = state->header.writePageCounter;
+        appendPageCount = state->header.appendPageCounter;
         return 0;
     }
 
+    RC FileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount,
+                                        unsigned &hitCount, unsigned &missCount, unsigned &evictCount) {
+        RC rc = collectCounterValues(readPageCount, writePageCount, appendPageCount);
+        if (rc) return rc;
+        hitCount = bufferCounter.hitCounter;
+        missCount = bufferCounter.missCounter;
+        evictCount = bufferCounter.evictCounter;
+        return 0;
+    }
+
+    RC FileHandle::checkpoint() {
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        return PagedFileManager::instance().writeBackFileState(*state);
+    }
+
+    RC FileHandle::prefetchPages(PageNum startPage, unsigned numPages) {
+        if (startPage >= getNumberOfPages()) return SUCCESS;
+        numPages = std::min(numPages, getNumberOfPages() - startPage);
+        for (PageNum pageNum = startPage; pageNum < startPage + numPages;) {
+            unsigned run = getContiguousPages(pageNum, startPage + numPages - pageNum);
+            RC rc = BufferPool::instance().prefetchPages(state->fileId, getFilePageNum(pageNum, state->header.pageSize),
+                                                         run, bufferCounter);
+            if (rc) return rc;
+            pageNum += run;
+        }
+        return SUCCESS;
+    }
+
+    uint64_t FileHandle::getFileVersion() {
+        return isFileOpen() ? BufferPool::instance().getFileVersion(state->fileId) : 0;
+    }
+
+    RC FileHandle::getPageFreeSpace(PageNum pageNum, unsigned &freeBytes) {
+        if (pageNum >= getNumberOfPages()) return RC(FILE_ERROR::FILE_NO_ENOUGH_PAGE);
+        // the map grows with the file, appends resize it under the latch
+        std::lock_guard<std::mutex> guard(state->latch);
+        freeBytes = state->freeSpaceMap[pageNum] * state->fsmBucketSize;
+        return SUCCESS;
+    }
+
+    RC FileHandle::setPageFreeSpace(PageNum pageNum, unsigned freeBytes) {
+        if (pageNum >= getNumberOfPages()) return RC(FILE_ERROR::FILE_NO_ENOUGH_PAGE);
+        std::lock_guard<std::mutex> guard(state->latch);
+        uint8_t bucket = std::min(freeBytes / state->fsmBucketSize, (unsigned) UINT8_MAX);
+        if (state->freeSpaceMap[pageNum] != bucket) {
+            state->freeSpaceMap[pageNum] = bucket;
+            unsigned headerMapSize = getHeaderMapSize(state->header.pageSize);
+            if (pageNum < headerMapSize) {
+                state->freeSpaceMapDirty = true;
+            } else {
+                state->fsmPagesDirty[(pageNum - headerMapSize) / state->header.pageSize] = true;
+            }
+        }
+        return SUCCESS;
+    }
+
+    RC FileHandle::findPageWithFreeSpace(unsigned freeBytes, PageNum startPage, PageNum &pageNum) {
+        // round up so that any page in a matching bucket is guaranteed to have freeBytes
+        unsigned bucket = (freeBytes + state->fsmBucketSize - 1) / state->fsmBucketSize;
+        std::lock_guard<std::mutex> guard(state->latch);
+        PageNum endPage = getNumberOfPages();
+        for (PageNum i = startPage; i < endPage; i++) {
+            if (state->freeSpaceMap[i] >= bucket) {
+                pageNum = i;
+                return SUCCESS;
+            }
+        }
+        return RC(FILE_ERROR::FILE_NO_FREE_PAGE);
+    }
+
+    void FileHandle::setMetadataFlushInterval(unsigned interval) {
+        metadataFlushInterval = interval;
+    }
+
+    RC FileHandle::setMapped(bool mapped) {
+        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
+        return BufferPool::instance().setFileMapped(state->fileId, mapped);
+    }
+
+    bool FileHandle::isMapped() {
+        return isFileOpen() && BufferPool::instance().isFileMapped(state->fileId);
+    }
+
+    uint8_t *FileHandle::getMappedPage(PageNum pageNum) {
+        if (!isMapped() || pageNum >= getNumberOfPages()) return nullptr;
+        std::lock_guard<std::mutex> guard(state->latch);
+        uint8_t *page;
+        // mapped pages are not pinned, fetching one only makes sure the mapping covers it
+        if (BufferPool::instance().fetchPage(state->fileId, getFilePageNum(pageNum, state->header.pageSize), true, page,
+                                             bufferCounter) != SUCCESS)
+            return nullptr;
+        state->header.readPageCounter++;
+        markMetadataDirty();
+        return page;
+    }
+
     RC FileHandle::flushMetadata(){
         if (!isFileOpen()){
             return RC(FILE_ERROR::FILE_NOT_OPEN);
         }
-        clearerr(PeterDB::FileHandle::fileInMemory);
-        fseek(fileInMemory, 0, SEEK_SET);
+        RC rc = BufferPool::instance().writeFileHeader(state->fileId, 0, &state->header, sizeof(FileHeader));
+        if (rc) return rc;
+        state->metadataDirty = false;
+        state->pendingMetadataOps = 0;
+        return 0;
+    }
 
-        fwrite(&pageCounter, sizeof(unsigned),4, fileInMemory);
-        fflush(fileInMemory);
+    // write read/write/append counters only, the page count is written by appendPage
+    RC FileHandle::flushCounters(){
+        if (!isFileOpen()){
+            return RC(FILE_ERROR::FILE_NOT_OPEN);
+        }
+        RC rc = BufferPool::instance().writeFileHeader(state->fileId, sizeof(unsigned), &state->header.readPageCounter,
+                                                       3 * sizeof(unsigned));
+        if (rc) return rc;
+        state->metadataDirty = false;
+        state->pendingMetadataOps = 0;
         return 0;
     }
 
-    RC FileHandle::readMetadata(){
-        if (!isFileOpen()) return RC(FILE_ERROR::FILE_NOT_OPEN);
-        fseek(fileInMemory, 0 ,SEEK_SET);
-        clearerr(PeterDB::FileHandle::fileInMemory);
-        fread(&pageCounter, sizeof(unsigned), 4, fileInMemory);
+    RC FileHandle::flushFreeSpaceMap(){
+        if (!isFileOpen()){
+            return RC(FILE_ERROR::FILE_NOT_OPEN);
+        }
+        std::lock_guard<std::mutex> guard(state->latch);
+        return PagedFileManager::instance().writeFreeSpaceMap(*state);
+    }
+
+    // the first data page a chained FSM page covers is appended right after it, the new page starts empty
+    RC FileHandle::appendFsmPageIfNeeded() {
+        unsigned pageSize = state->header.pageSize;
+        unsigned headerMapSize = getHeaderMapSize(pageSize);
+        PageNum pageNum = state->header.pageCounter;
+        if (pageNum < headerMapSize || (pageNum - headerMapSize) % pageSize != 0) return SUCCESS;
+        unsigned idx = (pageNum - headerMapSize) / pageSize;
+        if (idx < state->fsmPagesDirty.size()) return SUCCESS;
+        std::vector<uint8_t> fsmPage(pageSize, 0);
+        RC rc = BufferPool::instance().writePages(state->fileId, getFsmFilePageNum(idx, pageSize), 1, fsmPage.data());
+        if (rc) return rc;
+        state->freeSpaceMap.resize(headerMapSize + (idx + 1) * pageSize, 0);
+        state->fsmPagesDirty.push_back(false);
+        return SUCCESS;
+    }
+
+    unsigned FileHandle::getContiguousPages(PageNum pageNum, unsigned numPages) {
+        unsigned pageSize = state->header.pageSize;
+        unsigned headerMapSize = getHeaderMapSize(pageSize);
+        unsigned runEnd = pageNum < headerMapSize ? headerMapSize
+                                                  : pageNum + pageSize - (pageNum - headerMapSize) % pageSize;
+        return std::min(numPages, runEnd - pageNum);
+    }
+
+    RC FileHandle::markMetadataDirty(){
+        state->metadataDirty = true;
+        state->pendingMetadataOps++;
+        if (metadataFlushInterval && state->pendingMetadataOps >= metadataFlushInterval) return flushCounters();
         return 0;
     }
 
     bool FileHandle::isFileOpen(){
-        return this->fileIsOpen && fileInMemory != NULL;
+        return state != nullptr;
     }
 
 
@@ -1,16 +1,38 @@
 #include "src/include/qe.h"
+#include <algorithm>
+#include <unistd.h>
 
 namespace PeterDB {
     Filter::Filter(Iterator *input, const Condition &condition) {
         this->iter = input;
         this->cond = condition;
         input->getAttributes(this->attrs);
+        lhsAttrIdx = -1;
+        for (int i = 0; i < attrs.size(); i++) {
+            if (attrs[i].name == cond.lhsAttr) lhsAttrIdx = i;
+            allAttrIdx.push_back(i);
+        }
+        readInPlace = lhsAttrIdx >= 0 && !cond.bRhsIsAttr;
     }
 
     Filter::~Filter() = default;
 
     RC Filter::getNextTuple(void *data) {
         RC ret = 0;
+        // only tuples that pass are copied out of their page
+        while (readInPlace) {
+            ret = iter->getNextTupleView(view);
+            if (ret == RC(RBFM_ERROR::LAYOUT_NOT_SUPPORTED)) {
+                readInPlace = false;
+                break;
+            }
+            if (ret) return QE_EOF;
+            if (!isViewMeetCondition(view)) continue;
+            ret = view.toRawData(attrs, allAttrIdx, data);
+            // the pin must not outlive the input
+            view.release();
+            return ret;
+        }
         ret = iter->getNextTuple(data);
         if(ret) return QE_EOF;
         while(!isRecordMeetCondition(data)) {
@@ -20,6 +42,23 @@ namespace PeterDB {
         return SUCCESS;
     }
 
+    bool Filter::isViewMeetCondition(const RecordView &record) const {
+        if (record.isNull(lhsAttrIdx)) return false;
+        switch (attrs[lhsAttrIdx].type) {
+            case TypeInt:
+                return QEHelper::performOper(record.getField<int32_t>(lhsAttrIdx), *(int32_t *) cond.rhsValue.data,
+                                             cond.op);
+            case TypeReal:
+                return QEHelper::performOper(record.getField<float>(lhsAttrIdx), *(float *) cond.rhsValue.data,
+                                             cond.op);
+            case TypeVarChar:
+                return QEHelper::performOper(record.getField<std::string>(lhsAttrIdx),
+                        std::string((char *) cond.rhsValue.data + sizeof(int32_t), *(int32_t *) cond.rhsValue.data),
+                        cond.op);
+        }
+        return false;
+    }
+
     RC Filter::getAttributes(std::vector<Attribute> &attrs) const {
         attrs = this->attrs;
         return SUCCESS;
@@ -122,13 +161,15 @@ namespace PeterDB {
         return SUCCESS;
     }
 
+    const uint32_t BNLJoin::NO_ENTRY;
+
     BNLJoin::BNLJoin(Iterator *leftIn, TableScan *rightIn, const Condition &condition, const unsigned int numPages) {
         this->outer = leftIn;
         this->inner = rightIn;
         this->cond = condition;
-        this->hashTableMaxSize = numPages * PAGE_SIZE;
-        this->remainSize = numPages * PAGE_SIZE;
-        this->hasPointer = false;
+        this->hasPendingOuter = false;
+        this->isOuterDone = false;
+        this->matchPos = NO_ENTRY;
 
         leftIn->getAttributes(this->outerAttrs);
         rightIn->getAttributes(this->innerAttrs);
@@ -136,111 +177,69 @@ namespace PeterDB {
         this->joinedAttrs.insert(joinedAttrs.end(), outerAttrs.begin(), outerAttrs.end());
         this->joinedAttrs.insert(joinedAttrs.end(), innerAttrs.begin(), innerAttrs.end());
 
-        for (const auto& attr:outerAttrs){
-            if (attr.name == cond.lhsAttr){
-                this->outerJoinAttr = attr;
+        this->outerJoinIdx = 0;
+        this->innerJoinIdx = 0;
+        for (int16_t i = 0; i < outerAttrs.size(); i++){
+            if (outerAttrs[i].name == cond.lhsAttr){
+                this->outerJoinAttr = outerAttrs[i];
+                this->outerJoinIdx = i;
                 break;
             }
         }
-        for (const auto& attr:innerAttrs){
-            if (attr.name == cond.rhsAttr){
-                this->innerJoinAttr = attr;
+        for (int16_t i = 0; i < innerAttrs.size(); i++){
+            if (innerAttrs[i].name == cond.rhsAttr){
+                this->innerJoinAttr = innerAttrs[i];
+                this->innerJoinIdx = i;
                 break;
             }
         }
-        loadBlock();
+
+        // any outer tuple fits in an empty block, so a block never ends up empty before the outer side is done
+        this->arena.resize(std::max((size_t) numPages * PAGE_SIZE, sizeof(BlockEntry) + PAGE_SIZE));
+        // the smallest tuple takes a header, a null byte and a 4-byte key, keep the table at most half full
+        size_t maxEntries = arena.size() / (sizeof(BlockEntry) + 1 + sizeof(int32_t)) + 1;
+        size_t numSlots = 1;
+        while (numSlots < 2 * maxEntries) numSlots <<= 1;
+        this->slots.assign(numSlots, NO_ENTRY);
+        this->slotMask = numSlots - 1;
+
+        if (loadBlock()) isOuterDone = true;
     }
 
     BNLJoin::~BNLJoin() = default;
 
     RC BNLJoin::getNextTuple(void *data) {
-        RC ret;
-        // already matched a key, then join all the outer record
-        if (hasPointer){
-            auto innerRecord = (RawRecord*)innerReadBuffer;
-            switch (outerJoinAttr.type) {
-                case TypeInt:
-                    if(hashLinkedListPos < intHash[matchedIntKey].size()) {
-                        auto outerRecord = (RawRecord*)intHash[matchedIntKey][hashLinkedListPos].data();
-                        outerRecord->join(outerAttrs, innerRecord, innerAttrs, (RawRecord*)data, joinedAttrs);
-                        hashLinkedListPos++;
-                        return SUCCESS;
-                    }
-                case TypeReal:
-                    if(hashLinkedListPos < floatHash[matchedFloatKey].size()) {
-                        auto outerRecord = (RawRecord*)floatHash[matchedFloatKey][hashLinkedListPos].data();
-                        outerRecord->join(outerAttrs, innerRecord, innerAttrs, (RawRecord*)data, joinedAttrs);
-                        hashLinkedListPos++;
-                        return SUCCESS;
-                    }
-                case TypeVarChar:
-                    if(hashLinkedListPos < strHash[matchedStrKey].size()) {
-                        auto outerRecord = (RawRecord*)strHash[matchedStrKey][hashLinkedListPos].data();
-                        outerRecord->join(outerAttrs, innerRecord, innerAttrs, (RawRecord*)data, joinedAttrs);
-                        hashLinkedListPos++;
-                        return SUCCESS;
-                    }
+        while (!isOuterDone) {
+            // join the current inner tuple with the next outer tuple of the same key
+            if (matchPos != NO_ENTRY) {
+                auto entry = (BlockEntry *) (arena.data() + matchPos);
+                auto outerRecord = (RawRecord *) (entry + 1);
+                outerRecord->join(outerAttrs, (RawRecord *) innerReadBuffer, innerAttrs, (RawRecord *) data,
+                                  joinedAttrs);
+                matchPos = entry->next;
+                return SUCCESS;
             }
-        }
 
-        // find a matched inner record;
-        int32_t intKey;
-        float floatKey;
-        std::string strKey;
-        bool isMatchFound = false;
-        while(!isMatchFound) {
-            ret = inner->getNextTuple(innerReadBuffer);
-            if(ret) {
+            if (inner->getNextTuple(innerReadBuffer)) {
                 // Reach inner table's end, reload blocks
-                ret = loadBlock();
-                hasPointer = false;
-                if(ret) {
+                if (loadBlock()) {
                     // Reload blocks fail, reach outer table's end, return QE_EOF
-                    return QE_EOF;
+                    isOuterDone = true;
+                    break;
                 }
                 // Reset inner table's iterator
                 inner->setIterator();
-                inner->getNextTuple(innerReadBuffer);
+                continue;
             }
-            auto innerRecord = (RawRecord*)innerReadBuffer;
+
             // Probe hash table in memory
-            switch (outerJoinAttr.type) {
-                case TypeInt:
-                    intKey = innerRecord->getField<int32_t>(innerAttrs, innerJoinAttr.name);
-                    if(intHash.find(intKey) != intHash.end()) {
-                        auto outerRecord = (RawRecord*)intHash[intKey][0].data();
-                        outerRecord->join(outerAttrs, innerRecord, innerAttrs, (RawRecord*)data, joinedAttrs);
-                        matchedIntKey = intKey;
-                        hashLinkedListPos = 1;
-                        hasPointer = true;
-                        isMatchFound = true;
-                    }
-                    break;
-                case TypeReal:
-                    floatKey = innerRecord->getField<float>(innerAttrs, innerJoinAttr.name);
-                    if(floatHash.find(floatKey) != floatHash.end()) {
-                        auto outerRecord = (RawRecord*)floatHash[floatKey][0].data();
-                        outerRecord->join(outerAttrs, innerRecord, innerAttrs, (RawRecord*)data, joinedAttrs);
-                        matchedFloatKey = floatKey;
-                        hashLinkedListPos = 1;
-                        hasPointer = true;
-                        isMatchFound = true;
-                    }
-                    break;
-                case TypeVarChar:
-                    strKey =  innerRecord->getField<std::string>(innerAttrs, innerJoinAttr.name);
-                    if(strHash.find(strKey) != strHash.end()) {
-                        auto outerRecord = (RawRecord*)strHash[strKey][0].data();
-                        outerRecord->join(outerAttrs, innerRecord, innerAttrs, (RawRecord*)data, joinedAttrs);
-                        matchedStrKey = strKey;
-                        hashLinkedListPos = 1;
-                        hasPointer = true;
-                        isMatchFound = true;
-                    }
-                    break;
-            }
+            auto innerRecord = (RawRecord *) innerReadBuffer;
+            if (innerRecord->isNullField(innerJoinIdx)) continue;
+            auto key = (const uint8_t *) innerRecord->getFieldPtr(innerAttrs, innerJoinAttr.name);
+            uint32_t slot = findSlot(key, QEHelper::getKeyLength(key, innerJoinAttr.type));
+            matchPos = slots[slot];
         }
-        return SUCCESS;
+        return QE_EOF;
     }
 
     RC BNLJoin::getAttributes(std::vector<Attribute> &attrs) const {
@@ -249,37 +248,52 @@ namespace PeterDB {
         return SUCCESS;
     }
 
-    RC BNLJoin::loadBlock() {
-        RC ret = 0;
-        remainSize = hashTableMaxSize;
-        intHash.clear();
-        floatHash.clear();
-        strHash.clear();
-        // keep loading until block size
+    uint32_t BNLJoin::findSlot(const uint8_t *key, uint16_t keyLen) const {
+        uint32_t slot = QEHelper::hashKey(key, keyLen) & slotMask;
+        // linear probing, stops at the slot of this key or at an empty one
+        while (slots[slot] != NO_ENTRY) {
+            auto entry = (const BlockEntry *) (arena.data() + slots[slot]);
+            const uint8_t *entryKey = (const uint8_t *) (entry + 1) + entry->keyOffset;
+            if (entry->keyLen == keyLen && memcmp(entryKey, key, keyLen) == 0) break;
+            slot = (slot + 1) & slotMask;
+        }
+        return slot;
+    }
 
-        int32_t intKey;
-        float floatKey;
-        std::string strKey;
-        while(remainSize > 0){
-            ret = outer->getNextTuple(outerReadBuffer);
-            if(ret) break;
+    RC BNLJoin::loadBlock() {
+        std::fill(slots.begin(), slots.end(), NO_ENTRY);
+        arenaUsed = 0;
+        matchPos = NO_ENTRY;
+
+        // keep loading until the arena is full
+        while (true) {
+            if (!hasPendingOuter && outer->getNextTuple(outerReadBuffer)) break;
+            hasPendingOuter = false;
             auto outRawRecord = (RawRecord*)outerReadBuffer;
+            // a null key never joins
+            if (outRawRecord->isNullField(outerJoinIdx)) continue;
             int32_t dataLen = 0;
             outRawRecord->size(outerAttrs, &dataLen);
-            switch (outerJoinAttr.type){
-                case TypeInt:
-                    intKey = outRawRecord->getField<int32_t>(outerAttrs, outerJoinAttr.name);
-                    intHash[intKey].push_back(std::vector<uint8_t>(outerReadBuffer, outerReadBuffer + dataLen));
-                case TypeReal:
-                    floatKey = outRawRecord->getField<float>(outerAttrs, outerJoinAttr.name);
-                    floatHash[floatKey].push_back(std::vector<uint8_t>(outerReadBuffer, outerReadBuffer + dataLen));
-                case TypeVarChar:
-                    strKey = outRawRecord->getField<std::string>(outerAttrs, outerJoinAttr.name);
-                    strHash[strKey].push_back(std::vector<uint8_t>(outerReadBuffer, outerReadBuffer + dataLen));
+            if (arenaUsed + sizeof(BlockEntry) + dataLen > arena.size()) {
+                // block is full, the tuple goes into the next one
+                hasPendingOuter = true;
+                break;
             }
-            remainSize -= dataLen;
+
+            auto key = (const uint8_t *) outRawRecord->getFieldPtr(outerAttrs, outerJoinAttr.name);
+            auto entry = (BlockEntry *) (arena.data() + arenaUsed);
+            entry->keyOffset = key - outerReadBuffer;
+            entry->keyLen = QEHelper::getKeyLength(key, outerJoinAttr.type);
+            memcpy(entry + 1, outerReadBuffer, dataLen);
+
+            uint32_t slot = findSlot(key, entry->keyLen);
+            entry->next = slots[slot];
+            slots[slot] = arenaUsed;
+            arenaUsed += sizeof(BlockEntry) + dataLen;
+            // keep the headers aligned
+            arenaUsed = (arenaUsed + alignof(BlockEntry) - 1) & ~(uint32_t) (alignof(BlockEntry) - 1);
         }
-        if(remainSize == hashTableMaxSize) {
+        if (arenaUsed == 0) {
             // outer table done
             return QE_EOF;
         }
@@ -351,20 +365,253 @@ namespace PeterDB {
         return SUCCESS;
     }
 
-    GHJoin::GHJoin(Iterator *leftIn, Iterator *rightIn, const Condition &condition, const unsigned int numPartitions) {
+    // keeps the partition files of GHJoin operators alive at the same time apart,
+    // the pid keeps them apart from those of other processes and of earlier runs
+    static unsigned nextGHJoinId = 0;
 
+    GHJoin::GHJoin(Iterator *leftIn, Iterator *rightIn, const Condition &condition, const unsigned int numPartitions,
+                   const unsigned int buildPages) {
+        this->left = leftIn;
+        this->right = rightIn;
+        this->cond = condition;
+        this->numPartitions = numPartitions > 0 ? numPartitions : 1;
+        this->buildMaxSize = (size_t) buildPages * PAGE_SIZE;
+        this->nextFileNum = 0;
+        this->partitionRc = SUCCESS;
+        this->build = nullptr;
+        this->hasPendingBuild = false;
+        this->probe = nullptr;
+        this->matches = nullptr;
+        this->matchPos = 0;
+        this->buildOnLeft = true;
+
+        leftIn->getAttributes(this->leftAttrs);
+        rightIn->getAttributes(this->rightAttrs);
+        this->joinedAttrs.insert(joinedAttrs.end(), leftAttrs.begin(), leftAttrs.end());
+        this->joinedAttrs.insert(joinedAttrs.end(), rightAttrs.begin(), rightAttrs.end());
+
+        this->leftJoinIdx = 0;
+        this->rightJoinIdx = 0;
+        for (int16_t i = 0; i < leftAttrs.size(); i++) {
+            if (leftAttrs[i].name == cond.lhsAttr) {
+                this->leftJoinIdx = i;
+                break;
+            }
+        }
+        for (int16_t i = 0; i < rightAttrs.size(); i++) {
+            if (rightAttrs[i].name == cond.rhsAttr) {
+                this->rightJoinIdx = i;
+                break;
+            }
+        }
+        this->joinType = leftAttrs[leftJoinIdx].type;
+        this->filePrefix = "ghjoin_" + std::to_string(getpid()) + "_" + std::to_string(nextGHJoinId++);
+
+        // partition phase, both inputs are consumed here
+        std::vector<std::string> leftFiles, rightFiles;
+        std::vector<size_t> leftSizes, rightSizes;
+        partitionRc = partition(left, true, 0, leftFiles, leftSizes);
+        if (!partitionRc) partitionRc = partition(right, false, 0, rightFiles, rightSizes);
+        if (partitionRc) {
+            LOG(ERROR) << "Fail to partition the inputs @ GHJoin::GHJoin" << std::endl;
+            return;
+        }
+        for (unsigned i = this->numPartitions; i-- > 0;) {
+            pendingPairs.push_back({leftFiles[i], rightFiles[i], leftSizes[i], rightSizes[i], 0});
+        }
     }
 
     GHJoin::~GHJoin() {
-
+        delete build;
+        delete probe;
+        RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+        for (const std::string &fileName: partitionFiles) {
+            rbfm.destroyFile(fileName);
+        }
     }
 
     RC GHJoin::getNextTuple(void *data) {
-        return -1;
+        if (partitionRc) return partitionRc;
+        std::string key;
+        while (true) {
+            // join the probe tuple with the remaining build tuples of the same key
+            if (matches && matchPos < matches->size()) {
+                auto buildRecord = (const RawRecord *) (*matches)[matchPos].data();
+                auto probeRecord = (const RawRecord *) readBuffer;
+                matchPos++;
+                if (buildOnLeft) {
+                    buildRecord->join(leftAttrs, probeRecord, rightAttrs, (RawRecord *) data, joinedAttrs);
+                } else {
+                    probeRecord->join(leftAttrs, buildRecord, rightAttrs, (RawRecord *) data, joinedAttrs);
+                }
+                return SUCCESS;
+            }
+            matches = nullptr;
+
+            if (probe) {
+                if (probe->getNextTuple(readBuffer) == SUCCESS) {
+                    if (getKey(readBuffer, !buildOnLeft, key)) {
+                        auto it = buildHash.find(key);
+                        if (it != buildHash.end()) {
+                            matches = &it->second;
+                            matchPos = 0;
+                        }
+                    }
+                    continue;
+                }
+                delete probe;
+                probe = nullptr;
+                buildHash.clear();
+                if (build) {
+                    // the build side did not fit, join its next block
+                    RC rc = loadBuildBlock();
+                    if (rc) return rc;
+                    continue;
+                }
+            }
+
+            // next partition pair
+            if (pendingPairs.empty()) return QE_EOF;
+            PartitionPair pair = pendingPairs.back();
+            pendingPairs.pop_back();
+            if (pair.leftSize == 0 || pair.rightSize == 0) continue;
+            RC rc;
+            // a single partition would only copy the pair again
+            if (std::min(pair.leftSize, pair.rightSize) > buildMaxSize && pair.level < GHJOIN_MAX_LEVEL &&
+                numPartitions > 1) {
+                rc = repartition(pair);
+            } else {
+                rc = buildAndProbe(pair);
+            }
+            if (rc) return rc;
+        }
     }
 
     RC GHJoin::getAttributes(std::vector<Attribute> &attrs) const {
-        return -1;
+        attrs.clear();
+        attrs.insert(attrs.end(), joinedAttrs.begin(), joinedAttrs.end());
+        return SUCCESS;
+    }
+
+    bool GHJoin::getKey(const uint8_t *data, bool isLeft, std::string &key) const {
+        auto record = (const RawRecord *) data;
+        const std::vector<Attribute> &attrs = isLeft ? leftAttrs : rightAttrs;
+        int16_t idx = isLeft ? leftJoinIdx : rightJoinIdx;
+        // a null key never matches
+        if (record->isNullField(idx)) return false;
+        auto keyPtr = (const char *) record->getFieldPtr(attrs, attrs[idx].name);
+        int32_t keyLen = sizeof(int32_t);
+        if (joinType == TypeVarChar) keyLen += *(const int32_t *) keyPtr;
+        key.assign(keyPtr, keyLen);
+        return true;
+    }
+
+    RC GHJoin::partition(Iterator *input, bool isLeft, unsigned level, std::vector<std::string> &files,
+                         std::vector<size_t> &sizes) {
+        RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+        const std::vector<Attribute> &attrs = isLeft ? leftAttrs : rightAttrs;
+        std::vector<FileHandle> fileHandles(numPartitions);
+        files.clear();
+        sizes.assign(numPartitions, 0);
+
+        RC rc = SUCCESS;
+        unsigned numOpen = 0;
+        for (; numOpen < numPartitions; numOpen++) {
+            std::string fileName = filePrefix + (isLeft ? "_left_" : "_right_") + std::to_string(nextFileNum++);
+            // an existing file belongs to someone else, it is not overwritten
+            rc = rbfm.createFile(fileName);
+            if (rc) {
+                LOG(ERROR) << "Fail to create partition " << fileName << " @ GHJoin::partition" << std::endl;
+                break;
+            }
+            partitionFiles.push_back(fileName);
+            files.push_back(fileName);
+            rc = rbfm.openFile(fileName, fileHandles[numOpen]);
+            if (rc) break;
+        }
+
+        // the level goes into the hash so an overflowing partition spreads out when repartitioned
+        std::string key;
+        RID rid;
+        while (!rc && input->getNextTuple(readBuffer) == SUCCESS) {
+            if (!getKey(readBuffer, isLeft, key)) continue;
+            size_t pos = std::hash<std::string>()(key + (char) level) % numPartitions;
+            int32_t size = 0;
+            ((RawRecord *) readBuffer)->size(attrs, &size);
+            rc = rbfm.insertRecord(fileHandles[pos], attrs, readBuffer, rid);
+            if (rc) break;
+            sizes[pos] += size;
+        }
+        for (unsigned i = 0; i < numOpen; i++) {
+            rbfm.closeFile(fileHandles[i]);
+        }
+        return rc;
+    }
+
+    RC GHJoin::repartition(const PartitionPair &pair) {
+        std::vector<std::string> leftFiles, rightFiles;
+        std::vector<size_t> leftSizes, rightSizes;
+        RC rc;
+        {
+            PartitionScan leftIn(pair.leftFile, leftAttrs);
+            rc = partition(&leftIn, true, pair.level + 1, leftFiles, leftSizes);
+            if (rc) return rc;
+        }
+        {
+            PartitionScan rightIn(pair.rightFile, rightAttrs);
+            rc = partition(&rightIn, false, pair.level + 1, rightFiles, rightSizes);
+            if (rc) return rc;
+        }
+        // the parent pair is not needed anymore
+        RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+        for (const std::string &fileName: {pair.leftFile, pair.rightFile}) {
+            rbfm.destroyFile(fileName);
+            partitionFiles.erase(std::find(partitionFiles.begin(), partitionFiles.end(), fileName));
+        }
+        for (unsigned i = numPartitions; i-- > 0;) {
+            pendingPairs.push_back({leftFiles[i], rightFiles[i], leftSizes[i], rightSizes[i], pair.level + 1});
+        }
+        return SUCCESS;
+    }
+
+    RC GHJoin::buildAndProbe(const PartitionPair &pair) {
+        // build on the smaller side of the pair
+        buildOnLeft = pair.leftSize <= pair.rightSize;
+        probeFile = buildOnLeft ? pair.rightFile : pair.leftFile;
+        delete build;
+        build = new PartitionScan(buildOnLeft ? pair.leftFile : pair.rightFile, buildOnLeft ? leftAttrs : rightAttrs);
+        hasPendingBuild = false;
+        return loadBuildBlock();
+    }
+
+    RC GHJoin::loadBuildBlock() {
+        // a pair still too big at the last level is joined block by block, as a block nested-loop join
+        const std::vector<Attribute> &buildAttrs = buildOnLeft ? leftAttrs : rightAttrs;
+        buildHash.clear();
+        size_t blockSize = 0;
+        std::string key;
+        while (true) {
+            if (!hasPendingBuild && build->getNextTuple(buildBuffer) != SUCCESS) {
+                // build side done, this is its last block
+                delete build;
+                build = nullptr;
+                break;
+            }
+            hasPendingBuild = false;
+            if (!getKey(buildBuffer, buildOnLeft, key)) continue;
+            int32_t size = 0;
+            ((RawRecord *) buildBuffer)->size(buildAttrs, &size);
+            if (blockSize > 0 && blockSize + size > buildMaxSize) {
+                // block is full, the tuple goes into the next one
+                hasPendingBuild = true;
+                break;
+            }
+            buildHash[key].emplace_back(buildBuffer, buildBuffer + size);
+            blockSize += size;
+        }
+        probe = new PartitionScan(probeFile, buildOnLeft ? rightAttrs : leftAttrs);
+        matches = nullptr;
+        return SUCCESS;
     }
 
     Aggregate::Aggregate(Iterator *input, const Attribute &aggAttr, AggregateOp op) {
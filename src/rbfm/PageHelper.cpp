@@ -3,24 +3,57 @@
 //
 
 #include "src/include/rbfm.h"
+#include <algorithm>
 #include <cstring>
 #include <glog/logging.h>
 #include "src/include/errorCode.h"
 
 
 namespace PeterDB {
-    PageHelper::PageHelper(FileHandle &fileHandle, PageNum pageNum) : fh(fileHandle), pageNum(pageNum) {
-        RC rc = fileHandle.readPage(pageNum, dataSeq);
-        if (rc){
-            LOG(ERROR) << "read page err" << "@ PageHelper::PageHelper" << std::endl;
+    PageHelper::PageHelper(FileHandle &fileHandle, PageNum pageNum) : fh(fileHandle), pageNum(pageNum),
+                                                                      pageSize(fileHandle.getPageSize()) {
+        // a mapped page is worked on in place, flushPage then only marks it written
+        dataSeq = fileHandle.getMappedPage(pageNum);
+        if (!dataSeq) {
+            pageBuffer.resize(pageSize);
+            dataSeq = pageBuffer.data();
+            RC rc = fileHandle.readPage(pageNum, dataSeq);
+            if (rc){
+                LOG(ERROR) << "read page err" << "@ PageHelper::PageHelper" << std::endl;
+            }
         }
         memcpy(&freeBytePointer, dataSeq + getFreeBytePointerOffset(), sizeof(short));
         memcpy(&slotCounter, dataSeq + getSlotCounterOffset(), sizeof(short));
+        memcpy(&fragmentedBytes, dataSeq + getFragmentedBytesOffset(), sizeof(FragmentedBytes));
+        memcpy(&freeSlotHead, dataSeq + getFreeSlotHeadOffset(), sizeof(FreeSlotHead));
+    }
+
+    // a pinned page read in place, or a page built up in memory past the end of the file that flushPage appends
+    PageHelper::PageHelper(FileHandle &fileHandle, PageNum pageNum, uint8_t *page) : fh(fileHandle), pageNum(pageNum),
+                                                                                    pageSize(fileHandle.getPageSize()),
+                                                                                    dataSeq(page) {
+        memcpy(&freeBytePointer, dataSeq + getFreeBytePointerOffset(), sizeof(short));
+        memcpy(&slotCounter, dataSeq + getSlotCounterOffset(), sizeof(short));
+        memcpy(&fragmentedBytes, dataSeq + getFragmentedBytesOffset(), sizeof(FragmentedBytes));
+        memcpy(&freeSlotHead, dataSeq + getFreeSlotHeadOffset(), sizeof(FreeSlotHead));
     }
 
     PageHelper::~PageHelper() = default;
 
     RC PageHelper::insertRecordInByte(uint8_t *byteSeq, int16_t recLength, RID &rid, bool setUnoriginal) {
+        addRecordInByte(byteSeq, recLength, rid, setUnoriginal);
+        // flush page on disk
+        RC rc = flushPage();
+        if(rc){
+            LOG(ERROR) << "write page fail " << "@ PageHelper::insertRecordInByte" << std::endl;
+            return RC(PAGE_ERROR::WRITE_PAGE_FAIL);
+        }
+        return SUCCESS;
+    }
+
+    RC PageHelper::addRecordInByte(uint8_t *byteSeq, int16_t recLength, RID &rid, bool setUnoriginal) {
+        // the slot directory may grow into the gap, so leave room for one more slot
+        if (getContiguousFreeSpace() - getSlotSize() < recLength) compact();
         // find the next available slot ID unless add one more slot
         int16_t slotId = getAvlSlotOffsetIdx();
         // [offset, recLength]
@@ -32,12 +65,6 @@ namespace PeterDB {
         // update freeBytePointer
         freeBytePointer += recLength;
         memcpy(dataSeq + getFreeBytePointerOffset(), &freeBytePointer, sizeof(FreeBytePointer));
-        // flush page on disk
-        RC rc = fh.writePage(pageNum, dataSeq);
-        if(rc){
-            LOG(ERROR) << "write page fail " << "@ PageHelper::insertRecordInByte" << std::endl;
-            return RC(PAGE_ERROR::WRITE_PAGE_FAIL);
-        }
         // save rid
         rid.pageNum = this->pageNum;
         rid.slotNum = slotId;
@@ -47,7 +74,7 @@ namespace PeterDB {
 
     RC PageHelper::getRecordByte(int16_t slotNum, uint8_t *byteSeq, int16_t &recLength) {
         // get the start byte of record
-        int16_t recordOffset = getRecordBeginPos(slotNum);
+        int32_t recordOffset = getRecordBeginPos(slotNum);
         recLength = getRecordLen(slotNum);
         // read data byte to recordByte
         memcpy(byteSeq, dataSeq + recordOffset, recLength);
@@ -65,16 +92,26 @@ namespace PeterDB {
             return RC(PAGE_ERROR::PAGE_SLOT_INVALID);
         }
 
-        int16_t recordOffset = getRecordBeginPos(slotIndex);
+        int32_t recordOffset = getRecordBeginPos(slotIndex);
         int16_t recordLen = getRecordLen(slotIndex);
 
-        shiftRecord(recordOffset + recordLen, recordLen, SHIFT_LEFT);
+        // the last record just gives its bytes back, any other one leaves a hole for compact()
+        if (recordOffset + recordLen == freeBytePointer) {
+            freeBytePointer = recordOffset;
+            setFreeBytePointer(freeBytePointer);
+        } else {
+            fragmentedBytes += recordLen;
+            setFragmentedBytes(fragmentedBytes);
+        }
 
+        // push the slot on the free-slot chain, the rid stays unused until an insert pops it
         setRecordOffset(slotIndex, SLOT_OFFSET_EMPTY);
-        setRecordLen(slotIndex, SLOT_LEN_EMPTY, false);
+        setRecordLen(slotIndex, (SlotLen) freeSlotHead, false);
+        freeSlotHead = slotIndex;
+        setFreeSlotHead(freeSlotHead);
 
         // flush page on disk
-        fh.writePage(pageNum, dataSeq);
+        flushPage();
 
         return 0;
     }
@@ -85,39 +122,45 @@ namespace PeterDB {
     }
 
     int16_t PageHelper::getFlagsLength() {
-        return sizeof(FreeBytePointer) + sizeof(SlotCounter);
+        return sizeof(FreeBytePointer) + sizeof(SlotCounter) + sizeof(FragmentedBytes) + sizeof(FreeSlotHead);
     }
 
-    int16_t PageHelper::getHeaderLength() {
+    int32_t PageHelper::getHeaderLength() {
         // Num + Free + slot_table
         return getFlagsLength() + getSlotSize() * slotCounter;
     }
 
-    int16_t PageHelper::getSlotCounterOffset() {
-        return PAGE_SIZE - getFlagsLength();
+    int32_t PageHelper::getSlotCounterOffset() {
+        return (int32_t) pageSize - (int32_t) (sizeof(FreeBytePointer) + sizeof(SlotCounter));
+    }
+
+    int32_t PageHelper::getFreeBytePointerOffset() {
+        return (int32_t) pageSize - (int32_t) sizeof(FreeBytePointer);
+
     }
 
-    int16_t PageHelper::getFreeBytePointerOffset() {
-        return PAGE_SIZE - sizeof(FreeBytePointer);
+    int32_t PageHelper::getFragmentedBytesOffset() {
+        return getSlotCounterOffset() - (int32_t) sizeof(FragmentedBytes);
+    }
 
+    int32_t PageHelper::getFreeSlotHeadOffset() {
+        return (int32_t) pageSize - getFlagsLength();
     }
 
     // start from 1
-    int16_t PageHelper::getSlotOffset(int16_t slotNum) {
-        return getSlotCounterOffset() - getSlotSize() * slotNum;
+    int32_t PageHelper::getSlotOffset(int16_t slotNum) {
+        return getFreeSlotHeadOffset() - getSlotSize() * slotNum;
     }
 
     // get the present available slot offset and it might change slotCounter
     int16_t PageHelper::getAvlSlotOffsetIdx() {
-        // find empty slot from the tail
-        int16_t pos = 0;
-        for (short i = 1; i <= slotCounter; i++) {
-            if (isRecordDeleted(i)){
-                pos = i;
-                break;
-            }
+        // pop the free-slot chain, the length of an empty slot holds the next one
+        if (freeSlotHead != FREE_SLOT_END) {
+            int16_t pos = (int16_t) freeSlotHead;
+            freeSlotHead = (FreeSlotHead) getRecordLen(pos);
+            setFreeSlotHead(freeSlotHead);
+            return pos;
         }
-        if (pos > 0) return pos;
 
         // no empty slot, create a new slot and update slotCounter
         slotCounter++;
@@ -126,37 +169,57 @@ namespace PeterDB {
     }
 
     bool PageHelper::IsFreeSpaceEnough(int recLength) {
-        short freeSpace = PAGE_SIZE - freeBytePointer - getHeaderLength();
+        return getFreeSpaceForRecord() >= recLength;
+    }
+
+    int32_t PageHelper::getFreeSpaceForRecord() {
+        // dead bytes count too, compact() makes them contiguous on demand
+        int32_t freeSpace = getContiguousFreeSpace() + fragmentedBytes;
         // record + 1 slot !!!
-        return freeSpace >= (recLength + getSlotSize());
+        return freeSpace - getSlotSize();
     }
 
-    // dataStartPos: start from the data that needs to be moved
-    RC PageHelper::shiftRecord(int16_t dataStartPos, int16_t distance, int8_t direction) {
-        int16_t dataSeqNeedsBeMovedLen = freeBytePointer - dataStartPos;
+    int32_t PageHelper::getMaxRecordLength(unsigned pageSize) {
+        int32_t emptyPageSpace = (int32_t) pageSize -
+                                 (int32_t) (sizeof(FreeBytePointer) + sizeof(SlotCounter) + sizeof(FragmentedBytes) +
+                                            sizeof(FreeSlotHead)) -
+                                 (int32_t) (sizeof(SlotOffset) + sizeof(SlotLen));
+        return std::min(emptyPageSpace, MAX_RECORD_SIZE);
+    }
 
-        if (dataSeqNeedsBeMovedLen != 0) {
-            if (direction == SHIFT_LEFT){
-                memmove(dataSeq + dataStartPos - distance, dataSeq + dataStartPos, dataSeqNeedsBeMovedLen);
-            }else if (direction == SHIFT_RIGHT) {
-                memmove(dataSeq + dataStartPos + distance, dataSeq + dataStartPos, dataSeqNeedsBeMovedLen);
-            }
+    RC PageHelper::flushPage() {
+        RC rc = pageNum == fh.getNumberOfPages() ? fh.appendPage(dataSeq) : fh.writePage(pageNum, dataSeq);
+        if (rc) return rc;
+        int32_t freeSpace = getFreeSpaceForRecord();
+        return fh.setPageFreeSpace(pageNum, freeSpace > 0 ? freeSpace : 0);
+    }
 
-            // update slots
-            int16_t curSlotOffset;
-            for (int16_t i = 1; i <= slotCounter; i++) {
-                memcpy(&curSlotOffset, dataSeq + getSlotOffset(i), sizeof(SlotOffset));
-                if (curSlotOffset == SLOT_OFFSET_EMPTY || curSlotOffset < dataStartPos) continue;
-                if (direction == SHIFT_LEFT) { curSlotOffset -= distance;
-                }else if (direction == SHIFT_RIGHT) { curSlotOffset += distance; }
-                memcpy(dataSeq + getSlotOffset(i), &curSlotOffset, sizeof(SlotOffset));
+    int32_t PageHelper::getContiguousFreeSpace() {
+        return (int32_t) pageSize - freeBytePointer - getHeaderLength();
+    }
+
+    void PageHelper::compact() {
+        if (fragmentedBytes == 0) return;
+        // slide the live records down in offset order, each one only moves towards the page start
+        std::vector<std::pair<SlotOffset, int16_t>> liveSlots;
+        for (int16_t i = 1; i <= slotCounter; i++) {
+            if (!isRecordDeleted(i)) liveSlots.emplace_back(getRecordBeginPos(i), i);
+        }
+        std::sort(liveSlots.begin(), liveSlots.end());
+
+        FreeBytePointer pos = 0;
+        for (auto &slot: liveSlots) {
+            int16_t recordLen = getRecordLen(slot.second);
+            if (slot.first != pos) {
+                memmove(dataSeq + pos, dataSeq + slot.first, recordLen);
+                setRecordOffset(slot.second, pos);
             }
+            pos += recordLen;
         }
-        // update freePointer
-        if (direction == SHIFT_LEFT) freeBytePointer -= distance;
-        if (direction == SHIFT_RIGHT) freeBytePointer += distance;
+        freeBytePointer = pos;
         setFreeBytePointer(freeBytePointer);
-        return SUCCESS;
+        fragmentedBytes = 0;
+        setFragmentedBytes(fragmentedBytes);
     }
 
     void PageHelper::setFreeBytePointer(FreeBytePointer newPtr) {
@@ -184,8 +247,8 @@ namespace PeterDB {
         return (int16_t)abs(recordLen);
     }
 
-    int16_t PageHelper::getRecordBeginPos(int16_t slotIndex) {
-        int16_t recordBegin;
+    int32_t PageHelper::getRecordBeginPos(int16_t slotIndex) {
+        SlotOffset recordBegin;
         memcpy(&recordBegin, dataSeq + getSlotOffset(slotIndex), sizeof(SlotOffset));
         return recordBegin;
     }
@@ -205,7 +268,7 @@ namespace PeterDB {
 
     RC PageHelper::getRecordPointer(int16_t slotIndex, uint32_t &ridPageNum, uint16_t &ridSlotNum) {
         if (!isRecordValid(slotIndex)) return RC(PAGE_ERROR::PAGE_SLOT_INVALID);
-        int16_t recBegin = getRecordBeginPos(slotIndex);
+        int32_t recBegin = getRecordBeginPos(slotIndex);
         Flag fg;
         memcpy(&fg, dataSeq + recBegin, sizeof(Flag));
 
@@ -234,27 +297,45 @@ namespace PeterDB {
         }
 
         int16_t oldRecLen = getRecordLen(slotIndex);
-        int16_t oldRecBeg = getRecordBeginPos(slotIndex);
-
-        // shift data block to spare enough new space
-        if (oldRecLen <= recLength) {
-            shiftRecord(oldRecBeg + oldRecLen, recLength - oldRecLen, SHIFT_RIGHT);
+        int32_t oldRecBeg = getRecordBeginPos(slotIndex);
+        bool isLastRecord = oldRecBeg + oldRecLen == freeBytePointer;
+
+        if (isLastRecord && oldRecBeg + recLength <= freeBytePointer + getContiguousFreeSpace()) {
+            // the last record grows or shrinks in place, moving the free byte pointer along
+            freeBytePointer = oldRecBeg + recLength;
+            setFreeBytePointer(freeBytePointer);
+        } else if (recLength <= oldRecLen) {
+            // shrink in place, the tail of the old record is dead until the next compaction
+            fragmentedBytes += oldRecLen - recLength;
+            setFragmentedBytes(fragmentedBytes);
         } else {
-            shiftRecord(oldRecBeg + oldRecLen, oldRecLen - recLength, SHIFT_LEFT);
+            // grow: drop the old bytes and append, compacting first if the gap is too small
+            if (isLastRecord) {
+                freeBytePointer = oldRecBeg;
+            } else {
+                fragmentedBytes += oldRecLen;
+            }
+            setRecordOffset(slotIndex, SLOT_OFFSET_EMPTY);
+            if (getContiguousFreeSpace() < recLength) compact();
+            oldRecBeg = freeBytePointer;
+            setRecordOffset(slotIndex, oldRecBeg);
+            freeBytePointer += recLength;
+            setFreeBytePointer(freeBytePointer);
+            setFragmentedBytes(fragmentedBytes);
         }
         // update data
         memcpy(dataSeq + oldRecBeg, byteSeq, recLength);
         // if it is unoriginal record, need to set a sign
         setRecordLen(slotIndex, recLength, setUnoriginal);
 
-        fh.writePage(pageNum, dataSeq);
+        flushPage();
 
         return SUCCESS;
     }
 
     RC PageHelper::setRecordPointToNewRID(int16_t curSlotIndex, const RID &newRecordRID, bool setUnoriginal) {
         if (!isRecordValid(curSlotIndex)) return RC(PAGE_ERROR::PAGE_SLOT_INVALID);
-        int16_t recordBeg = getRecordBeginPos(curSlotIndex);
+        int32_t recordBeg = getRecordBeginPos(curSlotIndex);
         int16_t oldRecLen = getRecordLen(curSlotIndex);
         // 1B flag + 4B pageNum + 2B slotNum
         memcpy(dataSeq + recordBeg, &RECORD_FLAG_POINTER, sizeof(Flag));
@@ -263,12 +344,16 @@ namespace PeterDB {
 
         int16_t newRecLen = sizeof(Flag) + sizeof(newRecordRID.pageNum) + sizeof(newRecordRID.slotNum);
         setRecordLen(curSlotIndex, newRecLen,setUnoriginal);
-        // Shift records left
 
-        int16_t dist = oldRecLen - newRecLen;
-        shiftRecord(recordBeg + oldRecLen, dist, SHIFT_LEFT);
-        // todo not sure
-        fh.writePage(pageNum, dataSeq);
+        // the rest of the old record is dead, or free again if it was the last one
+        if (recordBeg + oldRecLen == freeBytePointer) {
+            freeBytePointer = recordBeg + newRecLen;
+            setFreeBytePointer(freeBytePointer);
+        } else {
+            fragmentedBytes += oldRecLen - newRecLen;
+            setFragmentedBytes(fragmentedBytes);
+        }
+        flushPage();
         return SUCCESS;
     }
 
@@ -290,7 +375,7 @@ namespace PeterDB {
     }
 
     int16_t PageHelper::getAttrEndPos(int16_t slotIndex, int16_t attrIndex) {
-        int16_t recordOffset = getRecordBeginPos(slotIndex);
+        int32_t recordOffset = getRecordBeginPos(slotIndex);
         int16_t dirOffset = sizeof(Flag) + sizeof(PlaceHolder) + sizeof(AttrNum) + attrIndex * sizeof(AttrDir);
         int16_t attrEndPos;
         memcpy(&attrEndPos, dataSeq + recordOffset + dirOffset, sizeof(AttrDir));
@@ -307,6 +392,14 @@ namespace PeterDB {
         memcpy(dataSeq + getSlotCounterOffset(), &sc, sizeof(SlotCounter));
     }
 
+    void PageHelper::setFragmentedBytes(FragmentedBytes fb) {
+        memcpy(dataSeq + getFragmentedBytesOffset(), &fb, sizeof(FragmentedBytes));
+    }
+
+    void PageHelper::setFreeSlotHead(FreeSlotHead head) {
+        memcpy(dataSeq + getFreeSlotHeadOffset(), &head, sizeof(FreeSlotHead));
+    }
+
     RC PageHelper::getNextRecordData(int16_t & slotIndex, uint8_t *byteSeq, int16_t & recordLen){
         RC rc;
         slotIndex++;
@@ -321,8 +414,15 @@ namespace PeterDB {
             return RC(PAGE_ERROR::RECORD_UNORIGINAL);
         }
 
+        // common case, the record lives in this page
+        if (isRecordData(slotIndex)){
+            return getRecordByte(slotIndex, byteSeq, recordLen);
+        }
+
+        // the record has moved, follow the pointers
         uint16_t realDataSlotId = slotIndex;
         uint32_t realDataPageId = pageNum;
+        getRecordPointer(slotIndex, realDataPageId, realDataSlotId);
 
         while (realDataPageId < fh.getNumberOfPages()){
             PageHelper realDataPage(fh, realDataPageId);
@@ -364,7 +464,7 @@ namespace PeterDB {
     }
 
     bool PageHelper::isRecordDeleted(int16_t slotIndex) {
-        int16_t recordBeg = getRecordBeginPos(slotIndex);
+        int32_t recordBeg = getRecordBeginPos(slotIndex);
         if (recordBeg == SLOT_OFFSET_EMPTY) return true;
         return false;
     }
@@ -0,0 +1,400 @@
+#include "src/include/rbfm.h"
+#include <algorithm>
+#include <cstring>
+#include <glog/logging.h>
+#include "src/include/errorCode.h"
+
+namespace PeterDB {
+    PaxPageHelper::PaxPageHelper(FileHandle &fileHandle, PageNum pageNum,
+                                 const std::vector<Attribute> &recordDescriptor) : fh(fileHandle), pageNum(pageNum),
+                                                                                   pageSize(fileHandle.getPageSize()),
+                                                                                   recordDescriptor(recordDescriptor) {
+        // a mapped page is worked on in place, flushPage then only marks it written
+        dataSeq = fileHandle.getMappedPage(pageNum);
+        if (!dataSeq) {
+            pageBuffer.resize(pageSize);
+            dataSeq = pageBuffer.data();
+            RC rc = fileHandle.readPage(pageNum, dataSeq);
+            if (rc) {
+                LOG(ERROR) << "read page err" << "@ PaxPageHelper::PaxPageHelper" << std::endl;
+            }
+        }
+        initLayout();
+    }
+
+    // a pinned page read in place, or a page built up in memory past the end of the file that flushPage appends
+    PaxPageHelper::PaxPageHelper(FileHandle &fileHandle, PageNum pageNum, const std::vector<Attribute> &recordDescriptor,
+                                 uint8_t *page) : fh(fileHandle), pageNum(pageNum), pageSize(fileHandle.getPageSize()),
+                                                  recordDescriptor(recordDescriptor), dataSeq(page) {
+        initLayout();
+    }
+
+    PaxPageHelper::~PaxPageHelper() = default;
+
+    // bytes of the three slot bitmaps and the minipages of a page with capacity slots, the heap begins after them
+    static int32_t getFixedLength(int32_t capacity, int32_t numAttrs) {
+        return (capacity + 7) / 8 * (3 + numAttrs) + capacity * numAttrs * (int32_t) sizeof(int32_t);
+    }
+
+    // only a record with a VarChar can grow and be forwarded
+    static int32_t getMinHeapLength(const std::vector<Attribute> &recordDescriptor) {
+        for (const Attribute &attr: recordDescriptor) {
+            if (attr.type == TypeVarChar) return PAX_FORWARD_LENGTH;
+        }
+        return 0;
+    }
+
+    PaxCapacity PaxPageHelper::getCapacity(unsigned pageSize, const std::vector<Attribute> &recordDescriptor,
+                                           int32_t heapLength) {
+        int32_t usable = pageSize - sizeof(PaxCapacity) - sizeof(SlotCounter) - sizeof(PaxHeapPointer);
+        int32_t numAttrs = recordDescriptor.size();
+        int32_t expectedHeap = 0;
+        for (const Attribute &attr: recordDescriptor) {
+            if (attr.type != TypeVarChar) continue;
+            expectedHeap += (attr.length + 1) / 2;
+        }
+        int32_t minHeapLength = getMinHeapLength(recordDescriptor);
+        expectedHeap = std::max(expectedHeap, minHeapLength);
+        heapLength = std::max(heapLength, minHeapLength);
+        // every slot takes three bitmap bits, and a null bit and a 4 byte value per attribute
+        int32_t capacity = usable * 8 / (3 + numAttrs * 33 + expectedHeap * 8) + 1;
+        while (capacity > 1 && (getFixedLength(capacity, numAttrs) + capacity * expectedHeap > usable ||
+                                getFixedLength(capacity, numAttrs) + heapLength > usable)) {
+            capacity--;
+        }
+        return std::min<int32_t>(capacity, UINT16_MAX);
+    }
+
+    int32_t PaxPageHelper::getHeapLength(const uint8_t *rawData, const std::vector<Attribute> &recordDescriptor) {
+        const uint8_t *value = rawData + (recordDescriptor.size() + 7) / 8;
+        int32_t heapLength = 0;
+        for (int16_t i = 0; i < recordDescriptor.size(); i++) {
+            if (RecordHelper::rawDataIsNullAttr(const_cast<uint8_t *>(rawData), i)) continue;
+            if (recordDescriptor[i].type == TypeVarChar) {
+                RawDataStrLen strLen;
+                memcpy(&strLen, value, sizeof(RawDataStrLen));
+                heapLength += strLen;
+                value += sizeof(RawDataStrLen) + strLen;
+            } else {
+                value += sizeof(int32_t);
+            }
+        }
+        return heapLength;
+    }
+
+    void PaxPageHelper::initLayout() {
+        int32_t footerOffset = getFooterOffset();
+        memcpy(&capacity, dataSeq + footerOffset, sizeof(PaxCapacity));
+        memcpy(&slotCounter, dataSeq + footerOffset + sizeof(PaxCapacity), sizeof(SlotCounter));
+        memcpy(&heapPointer, dataSeq + footerOffset + sizeof(PaxCapacity) + sizeof(SlotCounter),
+               sizeof(PaxHeapPointer));
+        // an all zero page has not been laid out yet, the footer is written with its first record
+        isNewPage = capacity == 0;
+        if (isNewPage) capacity = getCapacity(pageSize, recordDescriptor);
+        minHeapLength = getMinHeapLength(recordDescriptor);
+        liveHeapLength = -1;
+        layoutMinipages();
+    }
+
+    void PaxPageHelper::layoutMinipages() {
+        minipageOffsets.resize(recordDescriptor.size());
+        int32_t offset = 3 * getBitmapSize();
+        for (int16_t i = 0; i < recordDescriptor.size(); i++) {
+            minipageOffsets[i] = offset;
+            int32_t valueSize = recordDescriptor[i].type == TypeVarChar ? sizeof(PaxHeapEntry) : sizeof(int32_t);
+            offset += getBitmapSize() + capacity * valueSize;
+        }
+        if (isNewPage) {
+            slotCounter = 0;
+            heapPointer = offset;
+        }
+    }
+
+    void PaxPageHelper::writeFooter() {
+        int32_t footerOffset = getFooterOffset();
+        memcpy(dataSeq + footerOffset, &capacity, sizeof(PaxCapacity));
+        memcpy(dataSeq + footerOffset + sizeof(PaxCapacity), &slotCounter, sizeof(SlotCounter));
+        memcpy(dataSeq + footerOffset + sizeof(PaxCapacity) + sizeof(SlotCounter), &heapPointer,
+               sizeof(PaxHeapPointer));
+    }
+
+    int32_t PaxPageHelper::getFooterOffset() {
+        return pageSize - sizeof(PaxCapacity) - sizeof(SlotCounter) - sizeof(PaxHeapPointer);
+    }
+
+    int32_t PaxPageHelper::getBitmapSize() {
+        return (capacity + 7) / 8;
+    }
+
+    int32_t PaxPageHelper::getHeapBegin() {
+        if (recordDescriptor.empty()) return getBitmapSize();
+        int32_t valueSize = recordDescriptor.back().type == TypeVarChar ? sizeof(PaxHeapEntry) : sizeof(int32_t);
+        return minipageOffsets.back() + getBitmapSize() + capacity * valueSize;
+    }
+
+    int32_t PaxPageHelper::getLiveHeapLength() {
+        if (liveHeapLength >= 0) return liveHeapLength;
+        liveHeapLength = 0;
+        for (uint16_t slotNum = 1; slotNum <= slotCounter; slotNum++) {
+            if (!getBit(0, slotNum)) continue;
+            liveHeapLength += std::max(getSlotHeapLength(slotNum), minHeapLength);
+        }
+        return liveHeapLength;
+    }
+
+    int32_t PaxPageHelper::getSlotHeapLength(uint16_t slotNum) {
+        if (isRecordForwarded(slotNum)) return PAX_FORWARD_LENGTH;
+        int32_t heapLength = 0;
+        for (int16_t i = 0; i < recordDescriptor.size(); i++) {
+            if (recordDescriptor[i].type != TypeVarChar || getBit(minipageOffsets[i], slotNum)) continue;
+            PaxHeapEntry entry;
+            memcpy(&entry, getValuePtr(i, slotNum), sizeof(PaxHeapEntry));
+            heapLength += entry.length;
+        }
+        return heapLength;
+    }
+
+    bool PaxPageHelper::hasFreeSlot() {
+        if (slotCounter < capacity) return true;
+        for (uint16_t slotNum = 1; slotNum <= slotCounter; slotNum++) {
+            if (!getBit(0, slotNum)) return true;
+        }
+        return false;
+    }
+
+    bool PaxPageHelper::getBit(int32_t bitmapOffset, uint16_t slotNum) {
+        return (dataSeq[bitmapOffset + (slotNum - 1) / 8] >> (7 - (slotNum - 1) % 8)) & 0x01;
+    }
+
+    void PaxPageHelper::setBit(int32_t bitmapOffset, uint16_t slotNum, bool value) {
+        uint8_t mask = 0x80 >> ((slotNum - 1) % 8);
+        uint8_t &byte = dataSeq[bitmapOffset + (slotNum - 1) / 8];
+        byte = value ? byte | mask : byte & ~mask;
+    }
+
+    uint8_t *PaxPageHelper::getValuePtr(int16_t attrIdx, uint16_t slotNum) {
+        int32_t valueSize = recordDescriptor[attrIdx].type == TypeVarChar ? sizeof(PaxHeapEntry) : sizeof(int32_t);
+        return dataSeq + minipageOffsets[attrIdx] + getBitmapSize() + (slotNum - 1) * valueSize;
+    }
+
+    bool PaxPageHelper::IsFreeSpaceEnough(int32_t heapLength) {
+        heapLength = std::max(heapLength, minHeapLength);
+        if (isNewPage) {
+            PaxCapacity fitCapacity = getCapacity(pageSize, recordDescriptor, heapLength);
+            return getFixedLength(fitCapacity, recordDescriptor.size()) + heapLength <= getFooterOffset();
+        }
+        if (!hasFreeSlot()) return false;
+        return getFooterOffset() - getHeapBegin() - getLiveHeapLength() >= heapLength;
+    }
+
+    bool PaxPageHelper::IsFreeSpaceEnoughToUpdate(uint16_t slotNum, int32_t heapLength) {
+        if (!isRecordValid(slotNum)) return false;
+        int32_t freeBytes = getFooterOffset() - getHeapBegin() - getLiveHeapLength() +
+                            std::max(getSlotHeapLength(slotNum), minHeapLength);
+        return freeBytes >= std::max(heapLength, minHeapLength);
+    }
+
+    bool PaxPageHelper::isRecordValid(uint16_t slotNum) {
+        return slotNum >= 1 && slotNum <= slotCounter && getBit(0, slotNum);
+    }
+
+    bool PaxPageHelper::isRecordForwarded(uint16_t slotNum) {
+        return isRecordValid(slotNum) && getBit(getBitmapSize(), slotNum);
+    }
+
+    bool PaxPageHelper::isOriginal(uint16_t slotNum) {
+        return !getBit(2 * getBitmapSize(), slotNum);
+    }
+
+    void PaxPageHelper::getRecordPointer(uint16_t slotNum, RID &rid) {
+        PaxHeapEntry entry;
+        memcpy(&entry, getValuePtr(0, slotNum), sizeof(PaxHeapEntry));
+        memcpy(&rid.pageNum, dataSeq + entry.offset, sizeof(PageNum));
+        memcpy(&rid.slotNum, dataSeq + entry.offset + sizeof(PageNum), sizeof(uint16_t));
+    }
+
+    RC PaxPageHelper::addRecord(const uint8_t *rawData, RID &rid, bool setUnoriginal) {
+        int32_t heapLength = getHeapLength(rawData, recordDescriptor);
+        if (!IsFreeSpaceEnough(heapLength)) {
+            LOG(ERROR) << "No room for the record @ PaxPageHelper::addRecord" << std::endl;
+            return RC(PAGE_ERROR::PAGE_NO_ENOUGH_SLOT);
+        }
+        if (isNewPage) {
+            // the first record decides the capacity, a big one gets a page with fewer slots
+            capacity = getCapacity(pageSize, recordDescriptor, heapLength);
+            layoutMinipages();
+            isNewPage = false;
+            liveHeapLength = 0;
+        }
+        if (getFooterOffset() - heapPointer < heapLength) compactHeap();
+        // reuse the first deleted slot
+        uint16_t slotNum = 1;
+        while (slotNum <= slotCounter && getBit(0, slotNum)) slotNum++;
+        writeRecord(slotNum, rawData, setUnoriginal);
+        if (slotNum > slotCounter) slotCounter = slotNum;
+        if (liveHeapLength >= 0) liveHeapLength += std::max(heapLength, minHeapLength);
+        writeFooter();
+        rid.pageNum = pageNum;
+        rid.slotNum = slotNum;
+        return SUCCESS;
+    }
+
+    RC PaxPageHelper::insertRecord(const uint8_t *rawData, RID &rid, bool setUnoriginal) {
+        RC rc = addRecord(rawData, rid, setUnoriginal);
+        if (rc) return rc;
+        rc = flushPage();
+        if (rc) {
+            LOG(ERROR) << "write page fail " << "@ PaxPageHelper::insertRecord" << std::endl;
+            return RC(PAGE_ERROR::WRITE_PAGE_FAIL);
+        }
+        return SUCCESS;
+    }
+
+    RC PaxPageHelper::updateRecord(uint16_t slotNum, const uint8_t *rawData) {
+        if (!isRecordValid(slotNum)) return RC(PAGE_ERROR::PAGE_SLOT_INVALID);
+        int32_t heapLength = getHeapLength(rawData, recordDescriptor);
+        if (!IsFreeSpaceEnoughToUpdate(slotNum, heapLength)) {
+            LOG(ERROR) << "Record does not fit in its page any more @ PaxPageHelper::updateRecord" << std::endl;
+            return RC(PAGE_ERROR::RECORD_TOO_LARGE);
+        }
+        // the old values are dropped first, a record that does not grow always fits
+        bool setUnoriginal = !isOriginal(slotNum);
+        dropRecordForRewrite(slotNum, heapLength);
+        writeRecord(slotNum, rawData, setUnoriginal);
+        writeFooter();
+        return flushPage();
+    }
+
+    RC PaxPageHelper::setRecordPointToNewRID(uint16_t slotNum, const RID &newRid) {
+        if (!isRecordValid(slotNum)) return RC(PAGE_ERROR::PAGE_SLOT_INVALID);
+        // the slot was counted as PAX_FORWARD_LENGTH bytes at least, the rid takes its place
+        dropRecordForRewrite(slotNum, PAX_FORWARD_LENGTH);
+        PaxHeapEntry entry = {heapPointer, PAX_FORWARD_LENGTH};
+        memcpy(dataSeq + heapPointer, &newRid.pageNum, sizeof(PageNum));
+        memcpy(dataSeq + heapPointer + sizeof(PageNum), &newRid.slotNum, sizeof(uint16_t));
+        heapPointer += PAX_FORWARD_LENGTH;
+        memcpy(getValuePtr(0, slotNum), &entry, sizeof(PaxHeapEntry));
+        setBit(getBitmapSize(), slotNum, true);
+        setBit(2 * getBitmapSize(), slotNum, false);
+        setBit(0, slotNum, true);
+        writeFooter();
+        return flushPage();
+    }
+
+    RC PaxPageHelper::deleteRecord(uint16_t slotNum) {
+        if (!isRecordValid(slotNum)) return RC(PAGE_ERROR::PAGE_SLOT_INVALID);
+        setBit(0, slotNum, false);
+        liveHeapLength = -1;
+        return flushPage();
+    }
+
+    void PaxPageHelper::dropRecordForRewrite(uint16_t slotNum, int32_t heapLength) {
+        setBit(0, slotNum, false);
+        liveHeapLength = -1;
+        if (getFooterOffset() - heapPointer < heapLength) compactHeap();
+    }
+
+    void PaxPageHelper::writeRecord(uint16_t slotNum, const uint8_t *rawData, bool setUnoriginal) {
+        const uint8_t *value = rawData + (recordDescriptor.size() + 7) / 8;
+        for (int16_t i = 0; i < recordDescriptor.size(); i++) {
+            bool isNull = RecordHelper::rawDataIsNullAttr(const_cast<uint8_t *>(rawData), i);
+            setBit(minipageOffsets[i], slotNum, isNull);
+            if (isNull) continue;
+            if (recordDescriptor[i].type == TypeVarChar) {
+                RawDataStrLen strLen;
+                memcpy(&strLen, value, sizeof(RawDataStrLen));
+                PaxHeapEntry entry = {heapPointer, (uint16_t) strLen};
+                memcpy(dataSeq + heapPointer, value + sizeof(RawDataStrLen), strLen);
+                memcpy(getValuePtr(i, slotNum), &entry, sizeof(PaxHeapEntry));
+                heapPointer += strLen;
+                value += sizeof(RawDataStrLen) + strLen;
+            } else {
+                memcpy(getValuePtr(i, slotNum), value, sizeof(int32_t));
+                value += sizeof(int32_t);
+            }
+        }
+        setBit(getBitmapSize(), slotNum, false);
+        setBit(2 * getBitmapSize(), slotNum, setUnoriginal);
+        setBit(0, slotNum, true);
+    }
+
+    void PaxPageHelper::compactHeap() {
+        // slide the live values down in offset order, each one only moves towards the heap begin
+        std::vector<std::pair<uint16_t, uint8_t *>> liveValues;
+        auto addLiveValue = [&liveValues](uint8_t *value) {
+            PaxHeapEntry entry;
+            memcpy(&entry, value, sizeof(PaxHeapEntry));
+            liveValues.emplace_back(entry.offset, value);
+        };
+        for (uint16_t slotNum = 1; slotNum <= slotCounter; slotNum++) {
+            if (!getBit(0, slotNum)) continue;
+            // a forwarded slot only has its rid in the heap
+            if (isRecordForwarded(slotNum)) {
+                addLiveValue(getValuePtr(0, slotNum));
+                continue;
+            }
+            for (int16_t i = 0; i < recordDescriptor.size(); i++) {
+                if (recordDescriptor[i].type != TypeVarChar || getBit(minipageOffsets[i], slotNum)) continue;
+                addLiveValue(getValuePtr(i, slotNum));
+            }
+        }
+        std::sort(liveValues.begin(), liveValues.end());
+
+        PaxHeapPointer pos = getHeapBegin();
+        for (auto &liveValue: liveValues) {
+            PaxHeapEntry entry;
+            memcpy(&entry, liveValue.second, sizeof(PaxHeapEntry));
+            memmove(dataSeq + pos, dataSeq + entry.offset, entry.length);
+            entry.offset = pos;
+            memcpy(liveValue.second, &entry, sizeof(PaxHeapEntry));
+            pos += entry.length;
+        }
+        heapPointer = pos;
+    }
+
+    bool PaxPageHelper::readField(uint16_t slotNum, int16_t attrIdx, const uint8_t *&field, int16_t &fieldLen) {
+        if (getBit(minipageOffsets[attrIdx], slotNum)) return false;
+        if (recordDescriptor[attrIdx].type == TypeVarChar) {
+            PaxHeapEntry entry;
+            memcpy(&entry, getValuePtr(attrIdx, slotNum), sizeof(PaxHeapEntry));
+            field = dataSeq + entry.offset;
+            fieldLen = entry.length;
+        } else {
+            field = getValuePtr(attrIdx, slotNum);
+            fieldLen = sizeof(int32_t);
+        }
+        return true;
+    }
+
+    RC PaxPageHelper::readRecord(uint16_t slotNum, const std::vector<uint16_t> &selectedAttrIdx, uint8_t *rawData) {
+        if (!isRecordValid(slotNum) || isRecordForwarded(slotNum)) return RC(PAGE_ERROR::PAGE_SLOT_INVALID);
+        int32_t nullBytes = (selectedAttrIdx.size() + 7) / 8;
+        memset(rawData, 0, nullBytes);
+        uint8_t *value = rawData + nullBytes;
+        // only the minipages of the selected attributes are touched
+        for (int16_t i = 0; i < selectedAttrIdx.size(); i++) {
+            const uint8_t *field;
+            int16_t fieldLen;
+            if (!readField(slotNum, selectedAttrIdx[i], field, fieldLen)) {
+                rawData[i / 8] |= 0x80 >> (i % 8);
+                continue;
+            }
+            if (recordDescriptor[selectedAttrIdx[i]].type == TypeVarChar) {
+                RawDataStrLen strLen = fieldLen;
+                memcpy(value, &strLen, sizeof(RawDataStrLen));
+                value += sizeof(RawDataStrLen);
+            }
+            memcpy(value, field, fieldLen);
+            value += fieldLen;
+        }
+        return SUCCESS;
+    }
+
+    RC PaxPageHelper::flushPage() {
+        RC rc = pageNum == fh.getNumberOfPages() ? fh.appendPage(dataSeq) : fh.writePage(pageNum, dataSeq);
+        if (rc) return rc;
+        // a page without a free slot is full, whatever its heap has left
+        int32_t freeSpace = hasFreeSlot() ? getFooterOffset() - getHeapBegin() - getLiveHeapLength() : 0;
+        return fh.setPageFreeSpace(pageNum, freeSpace > 0 ? freeSpace : 0);
+    }
+}
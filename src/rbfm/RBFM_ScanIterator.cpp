@@ -1,27 +1,201 @@
 //
 // Created by Fan Zhao on 1/31/23.
 //
+#include <algorithm>
+#include <type_traits>
 #include "src/include/rbfm.h"
 #include <cstring>
 #include <glog/logging.h>
 #include "src/include/errorCode.h"
 
 namespace PeterDB {
+    namespace {
+        // op is a template argument, so only its own comparison is compiled into each predicate
+        template<CompOp op, typename T>
+        inline bool compareValues(const T &a, const T &b) {
+            switch (op) {
+                case EQ_OP:
+                    return a == b;
+                case LT_OP:
+                    return a < b;
+                case LE_OP:
+                    return a <= b;
+                case GT_OP:
+                    return a > b;
+                case GE_OP:
+                    return a >= b;
+                case NE_OP:
+                    return a != b;
+                default:
+                    return false;
+            }
+        }
+
+        // Int and Real, the field may be unaligned inside the page
+        template<AttrType type, CompOp op>
+        struct FieldComparator {
+            typedef typename std::conditional<type == TypeReal, float, int32_t>::type Value;
+
+            static bool meets(const uint8_t *field, int16_t, const uint8_t *value, int32_t) {
+                Value a, b;
+                memcpy(&a, field, sizeof(Value));
+                memcpy(&b, value, sizeof(Value));
+                return compareValues<op>(a, b);
+            }
+        };
+
+        // VarChar, compared byte by byte and then by length like std::string
+        template<CompOp op>
+        struct FieldComparator<TypeVarChar, op> {
+            static bool meets(const uint8_t *field, int16_t fieldLen, const uint8_t *value, int32_t valueLen) {
+                if (op == EQ_OP || op == NE_OP) {
+                    bool equal = fieldLen == valueLen && memcmp(field, value, fieldLen) == 0;
+                    return op == EQ_OP ? equal : !equal;
+                }
+                int cmp = memcmp(field, value, std::min<int32_t>(fieldLen, valueLen));
+                if (cmp == 0) cmp = fieldLen - valueLen;
+                return compareValues<op>(cmp, 0);
+            }
+        };
+
+        template<AttrType type>
+        FieldPredicate selectPredicate(CompOp op) {
+            switch (op) {
+                case EQ_OP:
+                    return &FieldComparator<type, EQ_OP>::meets;
+                case LT_OP:
+                    return &FieldComparator<type, LT_OP>::meets;
+                case LE_OP:
+                    return &FieldComparator<type, LE_OP>::meets;
+                case GT_OP:
+                    return &FieldComparator<type, GT_OP>::meets;
+                case GE_OP:
+                    return &FieldComparator<type, GE_OP>::meets;
+                case NE_OP:
+                    return &FieldComparator<type, NE_OP>::meets;
+                default:
+                    return nullptr;
+            }
+        }
+
+        FieldPredicate selectPredicate(AttrType type, CompOp op) {
+            switch (type) {
+                case TypeInt:
+                    return selectPredicate<TypeInt>(op);
+                case TypeReal:
+                    return selectPredicate<TypeReal>(op);
+                case TypeVarChar:
+                    return selectPredicate<TypeVarChar>(op);
+            }
+            return nullptr;
+        }
+    }
+
     RBFM_ScanIterator::RBFM_ScanIterator() {
-        conditionVal = new uint8_t[4096];
+        curPage = nullptr;
+        paxLayout = false;
+        curPaxPage = nullptr;
+        curPageVersion = 0;
+        readAheadPages = DEFAULT_SCAN_READ_AHEAD;
+        prefetchedUntil = 0;
     }
 
     RBFM_ScanIterator::~RBFM_ScanIterator() {
-        if(conditionVal) {
-            delete[] conditionVal;
+        close();
+    }
+
+    void RBFM_ScanIterator::setReadAhead(unsigned numPages) {
+        readAheadPages = numPages;
+    }
+
+    RC RBFM_ScanIterator::close() {
+        curView.release();
+        if (curPage) {
+            fileHandle.unpinPage(curPage->pageNum);
+            delete curPage;
+            curPage = nullptr;
+        }
+        if (curPaxPage) {
+            fileHandle.unpinPage(curPaxPage->pageNum);
+            delete curPaxPage;
+            curPaxPage = nullptr;
+        }
+        return SUCCESS;
+    }
+
+    RC RBFM_ScanIterator::loadPage(PageNum pageNum) {
+        uint8_t *page = nullptr;
+        if (curPage && curPage->pageNum == pageNum) {
+            // still pinned, only the header and the slots may have changed
+            page = curPage->dataSeq;
+        } else if (curPage) {
+            fileHandle.unpinPage(curPage->pageNum);
+        }
+        delete curPage;
+        curPage = nullptr;
+        curPageVersion = fileHandle.getFileVersion();
+        if (!page) {
+            const uint8_t *pinnedPage;
+            RC rc = fileHandle.pinPage(pageNum, pinnedPage);
+            if (rc) return rc;
+            page = const_cast<uint8_t *>(pinnedPage);
+            readAhead(pageNum);
+        }
+        curPage = new PageHelper(fileHandle, pageNum, page);
+        return SUCCESS;
+    }
+
+    RC RBFM_ScanIterator::loadPaxPage(PageNum pageNum) {
+        uint8_t *page = nullptr;
+        if (curPaxPage && curPaxPage->pageNum == pageNum) {
+            // still pinned, only the footer may have changed
+            page = curPaxPage->dataSeq;
+        } else if (curPaxPage) {
+            fileHandle.unpinPage(curPaxPage->pageNum);
+        }
+        delete curPaxPage;
+        curPaxPage = nullptr;
+        curPageVersion = fileHandle.getFileVersion();
+        if (!page) {
+            const uint8_t *pinnedPage;
+            RC rc = fileHandle.pinPage(pageNum, pinnedPage);
+            if (rc) return rc;
+            page = const_cast<uint8_t *>(pinnedPage);
+            readAhead(pageNum);
+        }
+        curPaxPage = new PaxPageHelper(fileHandle, pageNum, recordDescriptor, page);
+        return SUCCESS;
+    }
+
+    void RBFM_ScanIterator::readAhead(PageNum pageNum) {
+        // top the window up once half of it is consumed, so reads stay in flight while pages are scanned
+        if (readAheadPages > 0 && pageNum + readAheadPages / 2 >= prefetchedUntil) {
+            PageNum start = std::max(prefetchedUntil, pageNum + 1);
+            PageNum end = pageNum + 1 + readAheadPages;
+            fileHandle.prefetchPages(start, end - start);
+            prefetchedUntil = end;
         }
     }
     RC RBFM_ScanIterator::begin(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                                 const std::string &conditionAttribute, const CompOp compOp, const void *value,
                                 const std::vector<std::string> &selectedAttrNames) {
+        std::vector<ScanCondition> conditions;
+        if (compOp != NO_OP) conditions.push_back(ScanCondition{conditionAttribute, compOp, value});
+        return begin(fileHandle, recordDescriptor, conditions, selectedAttrNames);
+    }
+
+    RC RBFM_ScanIterator::begin(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                                const std::vector<ScanCondition> &conditions,
+                                const std::vector<std::string> &selectedAttrNames) {
+        // release what the last scan holds, its pins belong to the old file
+        close();
         // init basic variable
         this->fileHandle = fileHandle;
         this->recordDescriptor = recordDescriptor;
+        this->selectedAttrIdx.clear();
+        this->conditions.clear();
+        this->prefetchedUntil = 0;
+        this->paxLayout = fileHandle.getPageFormat() == PAGE_LAYOUT_PAX;
 
         for (int i = 0; i < selectedAttrNames.size(); i++){
             // to find the index j of this attr in recordDescriptor
@@ -33,81 +207,89 @@ namespace PeterDB {
         this->curPageNum = 0;
         this->curSlotNum = 0;
 
-        // init conditions
-        // todo NO-OP
-        this->compOp = compOp;
-        this->conditionAttrIdx = CONDITION_ATTR_IDX_INVALID;
-        if (compOp == NO_OP){
-            this->conditionVal = nullptr;
-        }else{
+        // compile the conditions, each one gets the comparison for its type and operator
+        for (const ScanCondition &condition: conditions) {
+            if (condition.op == NO_OP) continue;
+            int16_t attrIdx = ATTR_IDX_INVALID;
             for (int i = 0; i < recordDescriptor.size(); i++) {
-                if (recordDescriptor[i].name == conditionAttribute) {
-                    this->conditionAttrIdx = i;
-                    this->conditionAttr = recordDescriptor[i];
+                if (recordDescriptor[i].name == condition.attrName) {
+                    attrIdx = i;
                     break;
                 }
             }
-            if (this->conditionAttrIdx == CONDITION_ATTR_IDX_INVALID) {
+            if (attrIdx == ATTR_IDX_INVALID) {
                 LOG(ERROR) << "CONDITION_ATTR_IDX_INVALID @ RBFM_ScanIterator::begin" << std::endl;
                 return RC(RBFM_ERROR::CONDITION_ATTR_IDX_INVALID);
             }
-            if (!value) {
+            if (!condition.value) {
                 LOG(ERROR) << "condition value empty @ RBFM_ScanIterator::begin" << std::endl;
                 return RC(RBFM_ERROR::CONDITION_VALUE_EMPTY);
             }
 
-            switch (conditionAttr.type) {
-                case TypeInt:
-                    memcpy(this->conditionVal, (uint8_t *) value, sizeof(int));
-                    break;
-                case TypeReal:
-                    memcpy(this->conditionVal, (uint8_t *) value, sizeof(float));
-                    break;
-                case TypeVarChar:
-                    memcpy(&this->conditionStrLen, (uint8_t *) value, sizeof(int32_t));
-                    memcpy(this->conditionVal, (uint8_t *) value + sizeof(int32_t), conditionStrLen);
-                    break;
+            CompiledCondition compiled;
+            compiled.attrIdx = attrIdx;
+            compiled.predicate = selectPredicate(recordDescriptor[attrIdx].type, condition.op);
+            const uint8_t *value = (const uint8_t *) condition.value;
+            if (recordDescriptor[attrIdx].type == TypeVarChar) {
+                RawDataStrLen strLen;
+                memcpy(&strLen, value, sizeof(RawDataStrLen));
+                compiled.value.assign(value + sizeof(RawDataStrLen), value + sizeof(RawDataStrLen) + strLen);
+            } else {
+                compiled.value.assign(value, value + sizeof(int32_t));
             }
+            this->conditions.push_back(compiled);
         }
-
+        // the cheap fixed-width comparisons reject most rows before a string is looked at
+        std::stable_partition(this->conditions.begin(), this->conditions.end(),
+                              [&recordDescriptor](const CompiledCondition &condition) {
+                                  return recordDescriptor[condition.attrIdx].type != TypeVarChar;
+                              });
 
         return SUCCESS;
     }
 
     RC RBFM_ScanIterator::getNextRecord(RID &rid, void *data) {
-        if (curPageNum >= fileHandle.getNumberOfPages()) {
-            LOG(ERROR) << "PageNum exceeded! @ RBFM_ScanIterator::getNextRecord" << std::endl;
-            return RBFM_EOF;
-        }
+        if (paxLayout) return getNextPaxRecord(rid, data);
+        RC rc = getNextRecordView(rid, curView);
+        if (rc) return rc;
+        // convert data to rawdata
+        return curView.toRawData(recordDescriptor, selectedAttrIdx, data);
+    }
 
-        int16_t recordLen = 0;
+    RC RBFM_ScanIterator::getNextRecordView(RID &rid, RecordView &view) {
+        view.release();
+        if (paxLayout) return RC(RBFM_ERROR::LAYOUT_NOT_SUPPORTED);
         while (curPageNum < fileHandle.getNumberOfPages()) {
-            PageHelper thisPage(fileHandle, curPageNum);
-            RC rc = thisPage.getNextRecordData(curSlotNum, recordData, recordLen);
-            if (rc) {
-                // next page
-                if (rc == RC(PAGE_ERROR::PAGE_NO_ENOUGH_SLOT)) {
+            if (!curPage || curPage->pageNum != curPageNum || curPageVersion != fileHandle.getFileVersion()) {
+                if (loadPage(curPageNum)) {
                     curPageNum++;
                     curSlotNum = 0;
+                    continue;
                 }
-                continue;
             }
-            // get the real data record
-            if (this->compOp == NO_OP) {
-                // no condition, return
-                break;
-            } else if (RecordHelper::recordIsAttrNull(recordData, conditionAttrIdx)) {
-                // condition attribute is null, should skip this record
+            curSlotNum++;
+            if (curSlotNum > curPage->slotCounter) {
+                // next page
+                curPageNum++;
+                curSlotNum = 0;
                 continue;
+            }
+            // only original records are returned, a moved one is read through its rid
+            if (curPage->isRecordDeleted(curSlotNum) || !curPage->isOriginal(curSlotNum)) continue;
+            if (curPage->isRecordData(curSlotNum)) {
+                view.openInPage(curPage->dataSeq + curPage->getRecordBeginPos(curSlotNum),
+                                curPage->getRecordLen(curSlotNum));
             } else {
-                // check if the record meet the condition
-                uint8_t attr[PAGE_SIZE];
-                RecordHelper::recordGetAttr(recordData, conditionAttrIdx, recordDescriptor, attr);
-                int16_t attrLen = RecordHelper::recordGetAttrLen(recordData,conditionAttrIdx);
-                if (recordMeetCondition(attr, attrLen))break;
+                // moved away, the view pins the page the data went to
+                uint32_t targetPageNum;
+                uint16_t targetSlotNum;
+                curPage->getRecordPointer(curSlotNum, targetPageNum, targetSlotNum);
+                if (view.open(fileHandle, targetPageNum, targetSlotNum)) continue;
             }
 
-
+            // check the conditions on the page bytes
+            if (recordMeetConditions(view)) break;
+            view.release();
         }
 
         if (curPageNum >= fileHandle.getNumberOfPages()) return RBFM_EOF;
@@ -115,102 +297,79 @@ namespace PeterDB {
         // will return the original real data record RID
         rid.pageNum = curPageNum;
         rid.slotNum = curSlotNum;
-
-        // convert data to rawdata
-        RecordHelper::recordToRawData(recordData, recordDescriptor, selectedAttrIdx, (uint8_t *)data);
-
         return SUCCESS;
     }
 
-    bool RBFM_ScanIterator::recordMeetCondition(uint8_t *attrVal, int16_t attrLen) {
-        AttrType at = recordDescriptor[conditionAttrIdx].type;
-        // attrVal has a 1-byte null flag
-        switch(at){
-            case TypeInt:
-                int recordAttrInt;
-                int conditionAttrInt;
-                memcpy(&recordAttrInt, attrVal + 1, sizeof(int));
-                memcpy(&conditionAttrInt, conditionVal, sizeof(int));
-                return compareInt(recordAttrInt, conditionAttrInt);
-
-            case TypeReal:
-                float recordAttrFloat;
-                float conditionAttrFloat;
-                memcpy(&recordAttrFloat, attrVal + 1, sizeof(float));
-                memcpy(&conditionAttrFloat, conditionVal, sizeof(float));
-                return compareFloat(recordAttrFloat, conditionAttrFloat);
-
-            case TypeVarChar:
-                char recordAttrStr[attrLen];
-                memset(recordAttrStr, 0, attrLen);
-                memcpy(recordAttrStr, attrVal + 1, attrLen);
-
-                char conditionAttrStr[conditionStrLen];
-                memset(conditionAttrStr, 0, conditionStrLen);
-                memcpy(conditionAttrStr, conditionVal, conditionStrLen);
-                return compareStr(std::string(recordAttrStr, attrLen), std::string(conditionAttrStr,conditionStrLen));
-        }
-    }
-
-    bool RBFM_ScanIterator::compareInt(int a, int b){
-        switch(compOp){
-            case EQ_OP:
-                return a == b;
-            case  LT_OP:
-                return a < b;
-            case LE_OP:
-                return a<= b;
-            case GT_OP:
-                return a > b;
-            case GE_OP:
-                return a >= b;
-            case NE_OP:
-                return a != b;
-            default:
-                LOG(ERROR) << "compOp Err!" << std::endl;
-                return false;
-        }
-    }
-
-    bool RBFM_ScanIterator::compareFloat(float a, float b){
-        switch(compOp){
-            case EQ_OP:
-                return a == b;
-            case  LT_OP:
-                return a < b;
-            case LE_OP:
-                return a<= b;
-            case GT_OP:
-                return a > b;
-            case GE_OP:
-                return a >= b;
-            case NE_OP:
-                return a != b;
-            default:
-                LOG(ERROR) << "compOp Err!" << std::endl;
-                return false;
-        }
-    }
-
-    bool RBFM_ScanIterator::compareStr(std::string a, std::string b){
-        switch(compOp){
-            case EQ_OP:
-                return a == b;
-            case  LT_OP:
-                return a < b;
-            case LE_OP:
-                return a<= b;
-            case GT_OP:
-                return a > b;
-            case GE_OP:
-                return a >= b;
-            case NE_OP:
-                return a != b;
-            default:
-                LOG(ERROR) << "compOp Err!" << std::endl;
-                return false;
+    RC RBFM_ScanIterator::getNextPaxRecord(RID &rid, void *data) {
+        while (curPageNum < fileHandle.getNumberOfPages()) {
+            if (!curPaxPage || curPaxPage->pageNum != curPageNum || curPageVersion != fileHandle.getFileVersion()) {
+                if (loadPaxPage(curPageNum)) {
+                    curPageNum++;
+                    curSlotNum = 0;
+                    continue;
+                }
+            }
+            curSlotNum++;
+            if (curSlotNum > curPaxPage->slotCounter) {
+                // next page
+                curPageNum++;
+                curSlotNum = 0;
+                continue;
+            }
+            // only original records are returned, a moved one is read through its home slot
+            if (!curPaxPage->isRecordValid(curSlotNum) || !curPaxPage->isOriginal(curSlotNum)) continue;
+            if (curPaxPage->isRecordForwarded(curSlotNum)) {
+                bool meetsConditions;
+                RC rc = readForwardedPaxRecord(curSlotNum, data, meetsConditions);
+                if (rc || !meetsConditions) continue;
+            } else {
+                if (!recordMeetConditions(*curPaxPage, curSlotNum)) continue;
+                // only the projected minipages are decoded
+                RC rc = curPaxPage->readRecord(curSlotNum, selectedAttrIdx, (uint8_t *) data);
+                if (rc) return rc;
+            }
+            rid.pageNum = curPageNum;
+            rid.slotNum = curSlotNum;
+            return SUCCESS;
         }
+        return RBFM_EOF;
     }
 
+    RC RBFM_ScanIterator::readForwardedPaxRecord(uint16_t slotNum, void *data, bool &meetsConditions) {
+        meetsConditions = false;
+        RID target;
+        curPaxPage->getRecordPointer(slotNum, target);
+        if (target.pageNum >= fileHandle.getNumberOfPages()) return RC(RBFM_ERROR::PAGE_EXCEEDED);
+        const uint8_t *page;
+        RC rc = fileHandle.pinPage(target.pageNum, page);
+        if (rc) return rc;
+        {
+            PaxPageHelper targetPage(fileHandle, target.pageNum, recordDescriptor, const_cast<uint8_t *>(page));
+            meetsConditions = targetPage.isRecordValid(target.slotNum) && !targetPage.isOriginal(target.slotNum) &&
+                              recordMeetConditions(targetPage, target.slotNum);
+            if (meetsConditions) rc = targetPage.readRecord(target.slotNum, selectedAttrIdx, (uint8_t *) data);
+        }
+        fileHandle.unpinPage(target.pageNum);
+        return rc;
+    }
 
+    bool RBFM_ScanIterator::recordMeetConditions(const RecordView &view) const {
+        const uint8_t *field;
+        int16_t fieldLen;
+        for (const CompiledCondition &condition: conditions) {
+            if (!view.readField(condition.attrIdx, field, fieldLen)) return false;
+            if (!condition.predicate(field, fieldLen, condition.value.data(), condition.value.size())) return false;
+        }
+        return true;
+    }
+
+    bool RBFM_ScanIterator::recordMeetConditions(PaxPageHelper &page, uint16_t slotNum) const {
+        const uint8_t *field;
+        int16_t fieldLen;
+        for (const CompiledCondition &condition: conditions) {
+            if (!page.readField(slotNum, condition.attrIdx, field, fieldLen)) return false;
+            if (!condition.predicate(field, fieldLen, condition.value.data(), condition.value.size())) return false;
+        }
+        return true;
+    }
 }
\ No newline at end of file
@@ -36,30 +36,36 @@ namespace PeterDB {
         int16_t dirOffset = sizeof(Flag) + sizeof(PlaceHolder) + sizeof(AttrNum);
         int16_t valOffset = dirOffset + sizeof(AttrDir) * attrNum;
 
-        // 4. write directory and each attribute raw data
-        int16_t dirPos = dirOffset, valPos = valOffset, rawDataPos = sizeof(int8_t) * nullFlagLenInByte;
+        // 4. write directory and each attribute raw data, recordByte holds up to MAX_RECORD_SIZE bytes
+        int16_t dirPos = dirOffset;
+        int32_t valPos = valOffset, rawDataPos = sizeof(int8_t) * nullFlagLenInByte;
+        AttrDir valEndPos;
         // directory move right by 2 byte
         for (short i = 0; i < attrNum; i++, dirPos += sizeof(AttrDir)) {
             if (rawDataIsNullAttr(rawData, i)) {
-                short valEndPos = -1;
+                valEndPos = ATTR_DIR_EMPTY;
                 memcpy(recordByte + dirPos, &valEndPos, sizeof(AttrDir));
                 continue;
             }
             switch (recordDescriptor[i].type) {
                 case TypeInt:
                 case TypeReal:
+                    if (valPos + (int32_t) recordDescriptor[i].length > MAX_RECORD_SIZE)
+                        return RC(PAGE_ERROR::RECORD_TOO_LARGE);
                     memcpy(recordByte + valPos, rawData + rawDataPos, recordDescriptor[i].length);
                     rawDataPos += recordDescriptor[i].length;
                     valPos += recordDescriptor[i].length;
                     // set directory
-                    memcpy(recordByte + dirPos, &valPos, sizeof(AttrDir));
+                    valEndPos = (AttrDir) valPos;
+                    memcpy(recordByte + dirPos, &valEndPos, sizeof(AttrDir));
                     break;
                 case TypeVarChar:
                     RawDataStrLen strLen;
                     // get varchar length
                     memcpy(&strLen, rawData + rawDataPos, sizeof(RawDataStrLen));
-                    if (strLen > PAGE_SIZE) {
+                    if (valPos + (int64_t) strLen > MAX_RECORD_SIZE) {
                         LOG(ERROR) << "strLen error" << std::endl;
+                        return RC(PAGE_ERROR::RECORD_TOO_LARGE);
                     }
                     rawDataPos += sizeof(RawDataStrLen);
                     // copy string
@@ -67,7 +73,8 @@ namespace PeterDB {
                     rawDataPos += strLen;
                     valPos += strLen;
                     // set directory
-                    memcpy(recordByte + dirPos, &valPos, sizeof(AttrDir));
+                    valEndPos = (AttrDir) valPos;
+                    memcpy(recordByte + dirPos, &valEndPos, sizeof(AttrDir));
                     break;
             }
         }
@@ -370,7 +377,7 @@ namespace PeterDB {
 
         // Copy right data
         int rightSize;
-        this->size(rightAttrs, &rightSize);
+        rightRecord->size(rightAttrs, &rightSize);
         int rightDataSectionSize = rightSize - rightRecord->getNullByteSize(rightAttrs.size());
         memcpy(dest, rightRecord->dataSection(rightAttrs.size()), rightDataSectionSize);
 
@@ -0,0 +1,101 @@
+#include "src/include/rbfm.h"
+#include <cstring>
+#include <glog/logging.h>
+#include "src/include/errorCode.h"
+
+namespace PeterDB {
+    RecordView::~RecordView() {
+        release();
+    }
+
+    RC RecordView::release() {
+        if (!record) return SUCCESS;
+        record = nullptr;
+        recordLen = 0;
+        if (!ownsPin) return SUCCESS;
+        ownsPin = false;
+        return fileHandle->unpinPage(pageNum);
+    }
+
+    RC RecordView::open(FileHandle &fh, PageNum pageNum, uint16_t slotNum) {
+        release();
+        // a moved record is one hop away, files written before updates kept that may hold longer chains
+        while (true) {
+            if (pageNum >= fh.getNumberOfPages()) {
+                LOG(ERROR) << "Target Page not exist! @ RecordView::open" << std::endl;
+                return RC(RBFM_ERROR::PAGE_EXCEEDED);
+            }
+            const uint8_t *page;
+            RC rc = fh.pinPage(pageNum, page);
+            if (rc) return rc;
+            PageHelper pageHelper(fh, pageNum, const_cast<uint8_t *>(page));
+            if (!pageHelper.isRecordValid(slotNum)) {
+                fh.unpinPage(pageNum);
+                LOG(ERROR) << "Record is invalid! @ RecordView::open" << std::endl;
+                return RC(RBFM_ERROR::SLOT_INVALID);
+            }
+            if (pageHelper.isRecordData(slotNum)) {
+                this->fileHandle = &fh;
+                this->pageNum = pageNum;
+                record = page + pageHelper.getRecordBeginPos(slotNum);
+                recordLen = pageHelper.getRecordLen(slotNum);
+                ownsPin = true;
+                return SUCCESS;
+            }
+            uint32_t nextPageNum;
+            uint16_t nextSlotNum;
+            pageHelper.getRecordPointer(slotNum, nextPageNum, nextSlotNum);
+            fh.unpinPage(pageNum);
+            pageNum = nextPageNum;
+            slotNum = nextSlotNum;
+        }
+    }
+
+    void RecordView::openInPage(const uint8_t *record, int16_t recordLen) {
+        release();
+        this->record = record;
+        this->recordLen = recordLen;
+    }
+
+    int16_t RecordView::getAttrNum() const {
+        return RecordHelper::recordGetAttrNum(const_cast<uint8_t *>(record));
+    }
+
+    bool RecordView::isNull(int16_t attrIdx) const {
+        if (attrIdx >= getAttrNum()) return true;
+        return RecordHelper::recordIsAttrNull(const_cast<uint8_t *>(record), attrIdx);
+    }
+
+    const uint8_t *RecordView::getFieldPtr(int16_t attrIdx) const {
+        const uint8_t *field;
+        int16_t fieldLen;
+        return readField(attrIdx, field, fieldLen) ? field : nullptr;
+    }
+
+    int16_t RecordView::getFieldLength(int16_t attrIdx) const {
+        const uint8_t *field;
+        int16_t fieldLen;
+        return readField(attrIdx, field, fieldLen) ? fieldLen : 0;
+    }
+
+    bool RecordView::readField(int16_t attrIdx, const uint8_t *&field, int16_t &fieldLen) const {
+        uint8_t *bytes = const_cast<uint8_t *>(record);
+        if (attrIdx >= RecordHelper::recordGetAttrNum(bytes)) return false;
+        int16_t endPos = RecordHelper::recordGetAttrEndPos(bytes, attrIdx);
+        if (endPos == ATTR_DIR_EMPTY) return false;
+        int16_t beginPos = RecordHelper::recordGetAttrBeginPos(bytes, attrIdx);
+        field = record + beginPos;
+        fieldLen = endPos - beginPos;
+        return true;
+    }
+
+    RC RecordView::toRawData(const std::vector<Attribute> &recordDescriptor, std::vector<uint16_t> &selectedAttrIdx,
+                             void *data) const {
+        if (!record) {
+            LOG(ERROR) << "view is not open @ RecordView::toRawData" << std::endl;
+            return ERR_GENERAL;
+        }
+        return RecordHelper::recordToRawData(const_cast<uint8_t *>(record), recordDescriptor, selectedAttrIdx,
+                                             (uint8_t *) data);
+    }
+}
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <sstream>
 #include <cstring>
+#include <memory>
+#include <algorithm>
 #include "src/include/errorCode.h"
 #include <glog/logging.h>
 
@@ -20,17 +22,25 @@ namespace PeterDB {
 
     RecordBasedFileManager &RecordBasedFileManager::operator=(const RecordBasedFileManager &) = default;
 
-    RC RecordBasedFileManager::createFile(const std::string &fileName) {
+    RC RecordBasedFileManager::createFile(const std::string &fileName, unsigned pageSize, PageLayout pageLayout) {
         if (PagedFileManager::instance().isFileExists(fileName)){
             PagedFileManager::instance().destroyFile(fileName);
         }
-        return PagedFileManager::instance().createFile(fileName);
+        return PagedFileManager::instance().createFile(fileName, pageSize, pageLayout);
+    }
+
+    PageLayout RecordBasedFileManager::getPageLayout(FileHandle &fileHandle) {
+        return (PageLayout) fileHandle.getPageFormat();
     }
 
     RC RecordBasedFileManager::destroyFile(const std::string &fileName) {
         return PagedFileManager::instance().destroyFile(fileName);
     }
 
+    RC RecordBasedFileManager::renameFile(const std::string &fromFileName, const std::string &toFileName) {
+        return PagedFileManager::instance().renameFile(fromFileName, toFileName);
+    }
+
     RC RecordBasedFileManager::openFile(const std::string &fileName, FileHandle &fileHandle) {
         return PagedFileManager::instance().openFile(fileName, fileHandle);
     }
@@ -41,11 +51,23 @@ namespace PeterDB {
 
     RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                                             const void *data, RID &rid) {
+        LogOperation operation(LOG_OP_RBFM_INSERT);
         RC rc = 0;
         // 1. check file state
         if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
+        if (getPageLayout(fileHandle) == PAGE_LAYOUT_PAX) {
+            // the record is split into the minipages straight from its raw format
+            PageNum availablePageNum;
+            int32_t heapLength = PaxPageHelper::getHeapLength((const uint8_t *) data, recordDescriptor);
+            rc = getAvailablePaxPage(fileHandle, recordDescriptor, heapLength, availablePageNum);
+            if (rc) return rc;
+            PaxPageHelper thisPage(fileHandle, availablePageNum, recordDescriptor);
+            rc = thisPage.insertRecord((const uint8_t *) data, rid);
+            if (rc) return rc;
+            return operation.commit();
+        }
         // 2. convert raw data to byte sequence
-        uint8_t pageBuffer[PAGE_SIZE] = {};
+        uint8_t pageBuffer[MAX_RECORD_SIZE];
         short recByteLen = 0;
 
         rc = RecordHelper::rawDataToRecord((uint8_t*) data, recordDescriptor, pageBuffer, recByteLen);
@@ -53,6 +75,10 @@ namespace PeterDB {
             std::cout << "Fail to Convert Record to Byte Seq @ RecordBasedFileManager::insertRecord" << std::endl;
             return rc;
         }
+        if (recByteLen > PageHelper::getMaxRecordLength(fileHandle.getPageSize())) {
+            LOG(ERROR) << "Record does not fit in a page @ RecordBasedFileManager::insertRecord" << std::endl;
+            return RC(PAGE_ERROR::RECORD_TOO_LARGE);
+        }
 
         uint8_t buffer[recByteLen];
         memset(buffer, 0, recByteLen);
@@ -60,39 +86,206 @@ namespace PeterDB {
 
         // 3. find a page
         PageNum availablePageNum;
-        getAvailablePage(fileHandle, recByteLen, availablePageNum);
+        rc = getAvailablePage(fileHandle, recByteLen, availablePageNum);
+        if (rc) return rc;
         PageHelper thisPage(fileHandle, availablePageNum);
 
         // 4. insert binary data
-        thisPage.insertRecordInByte(buffer, recByteLen, rid, false);
-        return 0;
+        rc = thisPage.insertRecordInByte(buffer, recByteLen, rid, false);
+        if (rc) return rc;
+        return operation.commit();
+    }
+
+    RC RecordBasedFileManager::insertRecords(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                                             const std::vector<const void *> &data, std::vector<RID> &rids) {
+        LogOperation operation(LOG_OP_RBFM_INSERT);
+        RC rc = 0;
+        if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
+        rids.clear();
+        rids.reserve(data.size());
+        if (getPageLayout(fileHandle) == PAGE_LAYOUT_PAX) {
+            rc = insertPaxRecords(fileHandle, recordDescriptor, data, rids);
+            if (rc) return rc;
+            return operation.commit();
+        }
+        int32_t maxRecordLength = PageHelper::getMaxRecordLength(fileHandle.getPageSize());
+
+        // records go into the last page while it has room, then into new pages built in memory
+        std::vector<uint8_t> newPage(fileHandle.getPageSize());
+        std::unique_ptr<PageHelper> curPage;
+        if (fileHandle.getNumberOfPages() > 0) {
+            curPage.reset(new PageHelper(fileHandle, fileHandle.getNumberOfPages() - 1));
+        }
+        bool curPageDirty = false;
+        size_t curPageFirstRid = 0;     // rids from here on are on the page not written yet
+
+        uint8_t pageBuffer[MAX_RECORD_SIZE];
+        for (const void *record: data) {
+            short recByteLen = 0;
+            rc = RecordHelper::rawDataToRecord((uint8_t *) record, recordDescriptor, pageBuffer, recByteLen);
+            if (rc) {
+                LOG(ERROR) << "Fail to Convert Record to Byte Seq @ RecordBasedFileManager::insertRecords" << std::endl;
+                break;
+            }
+            if (recByteLen > maxRecordLength) {
+                LOG(ERROR) << "Record does not fit in a page @ RecordBasedFileManager::insertRecords" << std::endl;
+                rc = RC(PAGE_ERROR::RECORD_TOO_LARGE);
+                break;
+            }
+            if (!curPage || !curPage->IsFreeSpaceEnough(recByteLen)) {
+                // the page is full, write it once and start an empty one after the end of the file
+                if (curPageDirty) {
+                    rc = curPage->flushPage();
+                    if (rc) {
+                        rids.resize(curPageFirstRid);
+                        return rc;
+                    }
+                    curPageDirty = false;
+                }
+                std::fill(newPage.begin(), newPage.end(), 0);
+                curPage.reset(new PageHelper(fileHandle, fileHandle.getNumberOfPages(), newPage.data()));
+                curPageFirstRid = rids.size();
+            }
+            RID rid;
+            curPage->addRecordInByte(pageBuffer, recByteLen, rid, false);
+            curPageDirty = true;
+            rids.push_back(rid);
+        }
+        if (curPageDirty) {
+            RC flushRc = curPage->flushPage();
+            // only records on written pages get a rid
+            if (flushRc) rids.resize(curPageFirstRid);
+            if (!rc) rc = flushRc;
+        }
+        if (rc) return rc;
+        return operation.commit();
+    }
+
+    RC RecordBasedFileManager::insertPaxRecords(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                                                const std::vector<const void *> &data, std::vector<RID> &rids) {
+        RC rc = 0;
+        // same as the row layout, the last page first and then new pages each written once
+        std::vector<uint8_t> newPage(fileHandle.getPageSize());
+        std::unique_ptr<PaxPageHelper> curPage;
+        if (fileHandle.getNumberOfPages() > 0) {
+            curPage.reset(new PaxPageHelper(fileHandle, fileHandle.getNumberOfPages() - 1, recordDescriptor));
+        }
+        bool curPageDirty = false;
+        size_t curPageFirstRid = 0;
+
+        for (const void *record: data) {
+            int32_t heapLength = PaxPageHelper::getHeapLength((const uint8_t *) record, recordDescriptor);
+            if (!curPage || !curPage->IsFreeSpaceEnough(heapLength)) {
+                if (curPageDirty) {
+                    rc = curPage->flushPage();
+                    if (rc) {
+                        rids.resize(curPageFirstRid);
+                        return rc;
+                    }
+                    curPageDirty = false;
+                }
+                std::fill(newPage.begin(), newPage.end(), 0);
+                curPage.reset(new PaxPageHelper(fileHandle, fileHandle.getNumberOfPages(), recordDescriptor,
+                                                newPage.data()));
+                curPageFirstRid = rids.size();
+                if (!curPage->IsFreeSpaceEnough(heapLength)) {
+                    LOG(ERROR) << "Record does not fit in a page @ RecordBasedFileManager::insertPaxRecords"
+                               << std::endl;
+                    rc = RC(PAGE_ERROR::RECORD_TOO_LARGE);
+                    break;
+                }
+            }
+            RID rid;
+            curPage->addRecord((const uint8_t *) record, rid);
+            curPageDirty = true;
+            rids.push_back(rid);
+        }
+        if (curPageDirty) {
+            RC flushRc = curPage->flushPage();
+            if (flushRc) rids.resize(curPageFirstRid);
+            if (!rc) rc = flushRc;
+        }
+        return rc;
     }
 
     RC RecordBasedFileManager::readRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                                           const RID &rid, void *data) {
 
-        uint8_t buffer[PAGE_SIZE] = {};
-        short recByteLen = 0;
-        readInternalRecord(fileHandle, recordDescriptor, rid, buffer, recByteLen);
-
-        if (recByteLen == 0){
+        std::vector<uint16_t> selectedAttrIndex(recordDescriptor.size());
+        for(uint16_t i = 0; i < recordDescriptor.size(); i++) {
+            selectedAttrIndex[i] = i;
+        }
+        if (getPageLayout(fileHandle) == PAGE_LAYOUT_PAX) {
+            return readPaxRecord(fileHandle, recordDescriptor, rid, selectedAttrIndex, data);
+        }
+        // convert straight from the page, the record is not copied out first
+        RecordView view;
+        RC rc = readRecordView(fileHandle, rid, view);
+        if (rc) return rc;
+        if (view.recordLen == 0){
             LOG(WARNING)<< "record does not exist @RecordBasedFileManager::readRecord" << std::endl;
             return ERR_GENERAL;
         }
         // convert binary to raw data
-        std::vector<uint16_t> selectedAttrIndex(recordDescriptor.size());
-        for(uint16_t i = 0; i < recordDescriptor.size(); i++) {
-            selectedAttrIndex[i] = i;
+        return view.toRawData(recordDescriptor, selectedAttrIndex, data);
+    }
+
+    RC RecordBasedFileManager::readPaxRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                                             const RID &rid, const std::vector<uint16_t> &selectedAttrIndex,
+                                             void *data) {
+        if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
+        if (rid.pageNum >= fileHandle.getNumberOfPages()) return RC(RBFM_ERROR::PAGE_EXCEEDED);
+        // decode the selected minipages in place
+        const uint8_t *page;
+        RC rc = fileHandle.pinPage(rid.pageNum, page);
+        if (rc) return rc;
+        RID target = rid;
+        {
+            PaxPageHelper homePage(fileHandle, rid.pageNum, recordDescriptor, const_cast<uint8_t *>(page));
+            if (!homePage.isRecordValid(rid.slotNum) || !homePage.isOriginal(rid.slotNum)) {
+                LOG(ERROR) << "Record is invalid! @ RecordBasedFileManager::readPaxRecord" << std::endl;
+                rc = RC(RBFM_ERROR::SLOT_INVALID);
+            } else if (homePage.isRecordForwarded(rid.slotNum)) {
+                homePage.getRecordPointer(rid.slotNum, target);
+            } else {
+                rc = homePage.readRecord(rid.slotNum, selectedAttrIndex, (uint8_t *) data);
+            }
         }
-        RecordHelper::recordToRawData(buffer, recordDescriptor,selectedAttrIndex, (uint8_t *)data);
+        fileHandle.unpinPage(rid.pageNum);
+        if (rc || (target.pageNum == rid.pageNum && target.slotNum == rid.slotNum)) return rc;
 
-        return SUCCESS;
+        // a grown record lives on another page, its home slot points straight at it
+        if (target.pageNum >= fileHandle.getNumberOfPages()) {
+            LOG(ERROR) << "Target Page not exist! @ RecordBasedFileManager::readPaxRecord" << std::endl;
+            return RC(RBFM_ERROR::PAGE_EXCEEDED);
+        }
+        rc = fileHandle.pinPage(target.pageNum, page);
+        if (rc) return rc;
+        {
+            PaxPageHelper targetPage(fileHandle, target.pageNum, recordDescriptor, const_cast<uint8_t *>(page));
+            if (!targetPage.isRecordValid(target.slotNum) || targetPage.isOriginal(target.slotNum)) {
+                LOG(ERROR) << "Moved record is invalid! @ RecordBasedFileManager::readPaxRecord" << std::endl;
+                rc = RC(RBFM_ERROR::SLOT_INVALID);
+            } else {
+                rc = targetPage.readRecord(target.slotNum, selectedAttrIndex, (uint8_t *) data);
+            }
+        }
+        fileHandle.unpinPage(target.pageNum);
+        return rc;
+    }
+
+    RC RecordBasedFileManager::readRecordView(FileHandle &fileHandle, const RID &rid, RecordView &view) {
+        if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
+        if (getPageLayout(fileHandle) != PAGE_LAYOUT_ROW) return RC(RBFM_ERROR::LAYOUT_NOT_SUPPORTED);
+        if (rid.pageNum >= fileHandle.getNumberOfPages()) return RC(RBFM_ERROR::PAGE_EXCEEDED);
+        return view.open(fileHandle, rid.pageNum, rid.slotNum);
     }
 
     RC RecordBasedFileManager::readInternalRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                           const RID &rid, void *data, short & recByteLen){
         // 1. check file state and page validity
         if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
+        if (getPageLayout(fileHandle) != PAGE_LAYOUT_ROW) return RC(RBFM_ERROR::LAYOUT_NOT_SUPPORTED);
         if ( rid.pageNum > fileHandle.getNumberOfPages() - 1) return RC(RBFM_ERROR::PAGE_EXCEEDED);
 
         // 2. get real data RID
@@ -121,9 +314,29 @@ namespace PeterDB {
 
     RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                                             const RID &rid) {
+        LogOperation operation(LOG_OP_RBFM_DELETE);
         // 1. check file state and page validity
         if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
         if ( rid.pageNum > fileHandle.getNumberOfPages() - 1) return RC(RBFM_ERROR::PAGE_EXCEEDED);
+        if (getPageLayout(fileHandle) == PAGE_LAYOUT_PAX) {
+            PaxPageHelper homePage(fileHandle, rid.pageNum, recordDescriptor);
+            if (!homePage.isRecordValid(rid.slotNum) || !homePage.isOriginal(rid.slotNum)) {
+                return RC(RBFM_ERROR::SLOT_INVALID);
+            }
+            RC rc;
+            if (homePage.isRecordForwarded(rid.slotNum)) {
+                // the moved record goes first, then the slot pointing at it
+                RID target;
+                homePage.getRecordPointer(rid.slotNum, target);
+                if (target.pageNum >= fileHandle.getNumberOfPages()) return RC(RBFM_ERROR::PAGE_EXCEEDED);
+                PaxPageHelper targetPage(fileHandle, target.pageNum, recordDescriptor);
+                rc = targetPage.deleteRecord(target.slotNum);
+                if (rc) return rc;
+            }
+            rc = homePage.deleteRecord(rid.slotNum);
+            if (rc) return rc;
+            return operation.commit();
+        }
 
         // 2. get real data RID
         uint32_t curPageID = rid.pageNum;
@@ -148,8 +361,9 @@ namespace PeterDB {
         }
         // 2. get real data record
         PageHelper thisPage(fileHandle, curPageID);
-        thisPage.deleteRecord(curSlotID);
-        return 0;
+        RC rc = thisPage.deleteRecord(curSlotID);
+        if (rc) return rc;
+        return operation.commit();
     }
 
     RC RecordBasedFileManager::printRecord(const std::vector<Attribute> &recordDescriptor, const void *data,
@@ -157,7 +371,7 @@ namespace PeterDB {
         int dataPos = ceil(recordDescriptor.size() / 8.0);
         RecordHelper rh;
         const std::string separator = " ";
-        char buffer[PAGE_SIZE];
+        char buffer[MAX_RECORD_SIZE];
 
         for(short i = 0; i < recordDescriptor.size(); i++) {
             // start
@@ -207,15 +421,23 @@ namespace PeterDB {
 
     RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
                                             const void *data, const RID &rid) {
+        LogOperation operation(LOG_OP_RBFM_UPDATE);
 
 
         // 1. check file state and page validity
         if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
         if ( rid.pageNum > fileHandle.getNumberOfPages() - 1) return RC(RBFM_ERROR::PAGE_EXCEEDED);
-        // 2. get real data RID
+        if (getPageLayout(fileHandle) == PAGE_LAYOUT_PAX) {
+            RC rc = updatePaxRecord(fileHandle, recordDescriptor, (const uint8_t *) data, rid);
+            if (rc) return rc;
+            return operation.commit();
+        }
+        // 2. get real data RID, keeping the pointers passed on the way (only files written before
+        // updates re-pointed the original slot can have more than one)
         uint32_t curPageID = rid.pageNum;
         uint16_t curSlotID = rid.slotNum;
         bool setUnoriginal = false;
+        std::vector<RID> pointers;
         while (curPageID < fileHandle.getNumberOfPages()){
             PageHelper thisPage(fileHandle, curPageID);
             if (!thisPage.isRecordValid(curSlotID)){
@@ -224,6 +446,7 @@ namespace PeterDB {
             }
             if (thisPage.isRecordData(curSlotID)) break;
             // data get pointed to is not original record
+            if (setUnoriginal) pointers.push_back(RID{curPageID, curSlotID});
             setUnoriginal = true;
             thisPage.getRecordPointer(curSlotID,curPageID,curSlotID);
             if (curPageID >= fileHandle.getNumberOfPages()){
@@ -233,7 +456,7 @@ namespace PeterDB {
         }
 
         // 3. convert raw data to byte sequence
-        uint8_t pageBuffer[PAGE_SIZE] = {};
+        uint8_t pageBuffer[MAX_RECORD_SIZE];
         short recByteLen = 0;
 
         RC rc = RecordHelper::rawDataToRecord((uint8_t*) data, recordDescriptor, pageBuffer, recByteLen);
@@ -241,30 +464,54 @@ namespace PeterDB {
             std::cout << "Fail to Convert Record to Byte Seq @ RecordBasedFileManager::updateRecord" << std::endl;
             return rc;
         }
+        if (recByteLen > PageHelper::getMaxRecordLength(fileHandle.getPageSize())) {
+            LOG(ERROR) << "Record does not fit in a page @ RecordBasedFileManager::updateRecord" << std::endl;
+            return RC(PAGE_ERROR::RECORD_TOO_LARGE);
+        }
 
         uint8_t buffer[recByteLen];
         memset(buffer, 0, recByteLen);
         memcpy(buffer, pageBuffer, recByteLen);
 
-        // find new space for new record
+        // 4. keep the record where it is if it fits
+        {
+            PageHelper thisPage(fileHandle, curPageID);
+            int16_t oldRecLen = thisPage.getRecordLen(curSlotID);
+            if (oldRecLen >= recByteLen || thisPage.IsFreeSpaceEnough(recByteLen - oldRecLen)) {
+                rc = thisPage.updateRecord(curSlotID, buffer, recByteLen, setUnoriginal);
+                if (rc) return rc;
+                return operation.commit();
+            }
+            // a moved record is dropped from its current place, the original slot is re-pointed below
+            if (setUnoriginal) thisPage.deleteRecord(curSlotID);
+        }
+        for (const RID &pointer: pointers) {
+            PageHelper pointerPage(fileHandle, pointer.pageNum);
+            pointerPage.deleteRecord(pointer.slotNum);
+        }
+
+        // 5. move the record, the original slot always points straight at it so a read takes one hop at most
+        PageHelper homePage(fileHandle, rid.pageNum);
+        if (setUnoriginal && homePage.IsFreeSpaceEnough(recByteLen - homePage.getRecordLen(rid.slotNum))) {
+            // there is room on the original page again, the record goes back to its rid
+            rc = homePage.updateRecord(rid.slotNum, buffer, recByteLen, false);
+            if (rc) return rc;
+            return operation.commit();
+        }
+        // store in some other available page
         PageNum newPage;
-        PageHelper thisPage(fileHandle, curPageID);
-        int16_t oldRecLen = thisPage.getRecordLen(curSlotID);
-
-        if (oldRecLen >= recByteLen || (oldRecLen < recByteLen &&  thisPage.IsFreeSpaceEnough(recByteLen - oldRecLen))){
-            // store in current page
-            thisPage.updateRecord(curSlotID, buffer, recByteLen, setUnoriginal);
-        }else{
-            // store in some other available page
-            RID newRecordRID;
-            getAvailablePage(fileHandle, recByteLen, newPage);
+        RID newRecordRID;
+        rc = getAvailablePage(fileHandle, recByteLen, newPage);
+        if (rc) return rc;
+        {
             PageHelper nextPage(fileHandle, newPage);
             // this data must be pointed to , so set it to unoriginal
-            nextPage.insertRecordInByte(buffer, recByteLen, newRecordRID, true);
-
-            thisPage.setRecordPointToNewRID(curSlotID, newRecordRID, setUnoriginal);
+            rc = nextPage.insertRecordInByte(buffer, recByteLen, newRecordRID, true);
+            if (rc) return rc;
         }
-        return SUCCESS;
+        rc = homePage.setRecordPointToNewRID(rid.slotNum, newRecordRID, false);
+        if (rc) return rc;
+        return operation.commit();
     }
 
     RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
@@ -273,12 +520,7 @@ namespace PeterDB {
         if (!fileHandle.isFileOpen()) return RC(RBFM_ERROR::FILE_NOT_OPEN);
         if ( rid.pageNum > fileHandle.getNumberOfPages() - 1) return RC(RBFM_ERROR::PAGE_EXCEEDED);
 
-        // 2. get the  whole record data
-        uint8_t record[PAGE_SIZE];
-        short recLen = 0;
-        readInternalRecord(fileHandle, recordDescriptor, rid, record, recLen);
-
-        // 3. get the attribute
+        // 2. get the attribute
         int16_t attrIndex = ATTR_IDX_INVALID;
         int16_t attrLen = 0;
         int16_t readAttrLen;
@@ -293,6 +535,16 @@ namespace PeterDB {
             LOG(ERROR) << "Attribute Index Err @ RecordBasedFileManager::readAttribute" << std::endl;
             return ERR_GENERAL;
         }
+        if (getPageLayout(fileHandle) == PAGE_LAYOUT_PAX) {
+            // only the minipage of the attribute is read
+            std::vector<uint16_t> selectedAttrIndex{(uint16_t) attrIndex};
+            return readPaxRecord(fileHandle, recordDescriptor, rid, selectedAttrIndex, data);
+        }
+
+        // 3. get the  whole record data
+        uint8_t record[MAX_RECORD_SIZE];
+        short recLen = 0;
+        readInternalRecord(fileHandle, recordDescriptor, rid, record, recLen);
         RecordHelper::recordGetAttr(record, attrIndex, recordDescriptor, (uint8_t *)data);
 
         return SUCCESS;
@@ -310,9 +562,19 @@ namespace PeterDB {
         return SUCCESS;
     }
 
+    RC RecordBasedFileManager::scan(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                                    const std::vector<ScanCondition> &conditions,
+                                    const std::vector<std::string> &attributeNames,
+                                    RBFM_ScanIterator &rbfm_ScanIterator) {
+        RC rc = rbfm_ScanIterator.begin(fileHandle, recordDescriptor, conditions, attributeNames);
+        if (rc){
+            LOG(ERROR) << "rbfm_ScanIterator.begin Err @ RecordBasedFileManager::scan" << std::endl;
+        }
+        return rc;
+    }
+
     RC RecordBasedFileManager::getAvailablePage(FileHandle& fileHandle, short recLength, PageNum& availablePageNum){
         unsigned pageCount = fileHandle.getNumberOfPages();
-        uint8_t data[PAGE_SIZE] = {};
         // we have pages
         if (pageCount > 0){
             // check if last page is available
@@ -323,18 +585,102 @@ namespace PeterDB {
                 return 0;
             }
 
-            // traverse all pages from beginning
-            for (PageNum i = 0 ; i < lastPageNum; i++){
-                PageHelper ithPage(fileHandle, i);
-                if (ithPage.IsFreeSpaceEnough(recLength)){
-                    availablePageNum = i;
+            // look up the free-space map instead of reading every page, an entry may be stale
+            // (e.g. written by another handle), so verify the candidate and correct the map on a miss
+            PageNum candidate = 0;
+            while (fileHandle.findPageWithFreeSpace(recLength, candidate, candidate) == SUCCESS
+                   && candidate < lastPageNum){
+                PageHelper candidatePage(fileHandle, candidate);
+                if (candidatePage.IsFreeSpaceEnough(recLength)){
+                    availablePageNum = candidate;
                     return 0;
                 }
+                int32_t freeSpace = candidatePage.getFreeSpaceForRecord();
+                fileHandle.setPageFreeSpace(candidate, freeSpace > 0 ? freeSpace : 0);
+                candidate++;
             }
         }
 
         // no available page, append a new page
-        fileHandle.appendPage(data);
+        std::vector<uint8_t> data(fileHandle.getPageSize(), 0);
+        fileHandle.appendPage(data.data());
+        availablePageNum = fileHandle.getNumberOfPages() - 1;
+        return 0;
+    }
+
+    RC RecordBasedFileManager::updatePaxRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                                               const uint8_t *data, const RID &rid) {
+        PaxPageHelper homePage(fileHandle, rid.pageNum, recordDescriptor);
+        if (!homePage.isRecordValid(rid.slotNum) || !homePage.isOriginal(rid.slotNum)) {
+            return RC(RBFM_ERROR::SLOT_INVALID);
+        }
+        int32_t heapLength = PaxPageHelper::getHeapLength(data, recordDescriptor);
+        RC rc;
+        if (!homePage.isRecordForwarded(rid.slotNum)) {
+            // keep the record on its page if it fits
+            if (homePage.IsFreeSpaceEnoughToUpdate(rid.slotNum, heapLength)) {
+                return homePage.updateRecord(rid.slotNum, data);
+            }
+        } else {
+            RID target;
+            homePage.getRecordPointer(rid.slotNum, target);
+            if (target.pageNum >= fileHandle.getNumberOfPages()) {
+                LOG(ERROR) << "Target Page not exist! @ RecordBasedFileManager::updatePaxRecord" << std::endl;
+                return RC(RBFM_ERROR::PAGE_EXCEEDED);
+            }
+            PaxPageHelper targetPage(fileHandle, target.pageNum, recordDescriptor);
+            if (targetPage.IsFreeSpaceEnoughToUpdate(target.slotNum, heapLength)) {
+                return targetPage.updateRecord(target.slotNum, data);
+            }
+            // the moved record is dropped, it goes back to its rid if there is room again
+            rc = targetPage.deleteRecord(target.slotNum);
+            if (rc) return rc;
+            if (homePage.IsFreeSpaceEnoughToUpdate(rid.slotNum, heapLength)) {
+                return homePage.updateRecord(rid.slotNum, data);
+            }
+        }
+
+        // move the record to another page, the home slot always points straight at it
+        PageNum newPageNum;
+        rc = getAvailablePaxPage(fileHandle, recordDescriptor, heapLength, newPageNum);
+        if (rc) return rc;
+        RID newRid;
+        {
+            PaxPageHelper newPage(fileHandle, newPageNum, recordDescriptor);
+            rc = newPage.insertRecord(data, newRid, true);
+            if (rc) return rc;
+        }
+        return homePage.setRecordPointToNewRID(rid.slotNum, newRid);
+    }
+
+    RC RecordBasedFileManager::getAvailablePaxPage(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                                                   int32_t heapLength, PageNum &availablePageNum) {
+        unsigned pageCount = fileHandle.getNumberOfPages();
+        if (pageCount > 0) {
+            PageNum lastPageNum = pageCount - 1;
+            if (PaxPageHelper(fileHandle, lastPageNum, recordDescriptor).IsFreeSpaceEnough(heapLength)) {
+                availablePageNum = lastPageNum;
+                return 0;
+            }
+            // a full page has no entry in the free-space map, so ask for one byte at least
+            PageNum candidate = 0;
+            while (fileHandle.findPageWithFreeSpace(std::max(heapLength, 1), candidate, candidate) == SUCCESS
+                   && candidate < lastPageNum) {
+                if (PaxPageHelper(fileHandle, candidate, recordDescriptor).IsFreeSpaceEnough(heapLength)) {
+                    availablePageNum = candidate;
+                    return 0;
+                }
+                fileHandle.setPageFreeSpace(candidate, 0);
+                candidate++;
+            }
+        }
+
+        std::vector<uint8_t> data(fileHandle.getPageSize(), 0);
+        if (!PaxPageHelper(fileHandle, pageCount, recordDescriptor, data.data()).IsFreeSpaceEnough(heapLength)) {
+            LOG(ERROR) << "Record does not fit in a page @ RecordBasedFileManager::getAvailablePaxPage" << std::endl;
+            return RC(PAGE_ERROR::RECORD_TOO_LARGE);
+        }
+        fileHandle.appendPage(data.data());
         availablePageNum = fileHandle.getNumberOfPages() - 1;
         return 0;
     }
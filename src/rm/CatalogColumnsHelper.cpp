@@ -60,6 +60,12 @@ namespace PeterDB {
             rawDataPos += sizeof(column_length);
         }
 
+        // Column Position
+        if(attrNamesSet.find(CATALOG_COLUMNS_COLUMNPOS) != attrNamesSet.end()) {
+            memcpy(&column_position, rawData + rawDataPos, sizeof(column_position));
+            rawDataPos += sizeof(column_position);
+        }
+
     }
 
     RC CatalogColumnsHelper::getRecordRawData(uint8_t *rawData) {
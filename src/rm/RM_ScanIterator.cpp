@@ -20,6 +20,17 @@ namespace PeterDB {
         return SUCCESS;
     }
 
+    RC RM_ScanIterator::begin(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+                              const std::vector<ScanCondition> &conditions,
+                              const std::vector<std::string> &selectedAttrNames) {
+        RC rc = rbfmIterator.begin(fileHandle, recordDescriptor, conditions, selectedAttrNames);
+        if(rc) {
+            LOG(ERROR) << "Fail to open RM scan iterator @ RM_ScanIterator::begin" << std::endl;
+            return RC(RM_ERROR::ITERATOR_BEGIN_FAIL);
+        }
+        return SUCCESS;
+    }
+
     RC RM_ScanIterator::getNextTuple(RID &rid, void *data) {
         RC rc = rbfmIterator.getNextRecord(rid, data);
         if(rc) {
@@ -28,6 +39,16 @@ namespace PeterDB {
         return SUCCESS;
     }
 
+    RC RM_ScanIterator::getNextTupleView(RID &rid, RecordView &view) {
+        RC rc = rbfmIterator.getNextRecordView(rid, view);
+        // a PAX table has no row to view, the caller reads it with getNextTuple instead
+        if(rc == RC(RBFM_ERROR::LAYOUT_NOT_SUPPORTED)) return rc;
+        if(rc) {
+            return RM_EOF;
+        }
+        return SUCCESS;
+    }
+
     RC RM_ScanIterator::close() {
         return rbfmIterator.close();
     }
@@ -2,6 +2,8 @@
 #include "src/include/ix.h"
 #include <cstdio>
 #include <typeinfo>
+#include <map>
+#include <algorithm>
 #include <cstring>
 #include "src/include/errorCode.h"
 #include <glog/logging.h>
@@ -13,7 +15,10 @@ namespace PeterDB {
         return _relation_manager;
     }
 
-    RelationManager::RelationManager() = default;
+    // the file registry and the pool have to outlive the index handles kept here
+    RelationManager::RelationManager() {
+        PagedFileManager::instance();
+    }
 
     RelationManager::~RelationManager() {
         for(auto& fh: ixScanFHList) {
@@ -33,6 +38,7 @@ namespace PeterDB {
     RC RelationManager::createCatalog() {
         // 1.create two basic tables file on disk
         RC rc = 0;
+        clearCatalogCache();
         RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
         rc = rbfm.createFile(CATALOG_TABLES);
         if (rc) {
@@ -143,6 +149,7 @@ namespace PeterDB {
         fhTables.closeFile();
         fhColumns.closeFile();
         fhIndexes.closeFile();
+        clearCatalogCache();
 
         rc = rbfm.destroyFile(CATALOG_TABLES);
         if (rc) {
@@ -251,7 +258,8 @@ namespace PeterDB {
         return SUCCESS;
     }
 
-    RC RelationManager::createTable(const std::string &tableName, const std::vector<Attribute> &attrs) {
+    RC RelationManager::createTable(const std::string &tableName, const std::vector<Attribute> &attrs,
+                                    PageLayout pageLayout) {
         RC rc;
         if (isTableNameEmpty(tableName)) {
             return RC(RM_ERROR::TABLE_NAME_EMPTY);
@@ -265,11 +273,12 @@ namespace PeterDB {
             return RC(RM_ERROR::CATALOG_OPEN_FAIL);
         }
         RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
-        rc = rbfm.createFile(tableName);
+        rc = rbfm.createFile(tableName, PAGE_SIZE, pageLayout);
         if (rc) {
             LOG(ERROR) << "create file err" << "@RelationManager::createCatalog" << std::endl;
             return RC(RM_ERROR::ERR_UNDEFINED);
         }
+        invalidateCatalogCache(tableName);
         insertMetaDataToCatalog(tableName, attrs);
         return SUCCESS;
     }
@@ -283,6 +292,13 @@ namespace PeterDB {
             return RC(RM_ERROR::TABLE_ACCESS_DENIED);
         }
         RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+        std::unordered_map<std::string, std::string> indexedAttrAndFileName;
+        if (getIndexes(tableName, indexedAttrAndFileName) == SUCCESS) {
+            for (const auto &index: indexedAttrAndFileName) {
+                closeIndexHandle(index.second);
+            }
+        }
+        invalidateCatalogCache(tableName);
         rc = rbfm.destroyFile(tableName);
         if (rc) {
             LOG(ERROR) << "destroy file err" << "@RelationManager::deleteTable" << std::endl;
@@ -313,7 +329,32 @@ namespace PeterDB {
         if (isTableNameEmpty(tableName)) {
             return RC(RM_ERROR::TABLE_NAME_EMPTY);
         }
+        const CatalogCacheEntry *entry;
+        rc = getCatalogCacheEntry(tableName, entry);
+        if (rc) return rc;
+        attrs.insert(attrs.end(), entry->attrs.begin(), entry->attrs.end());
+        return SUCCESS;
+    }
+
+    RC RelationManager::getCatalogCacheEntry(const std::string &tableName, const CatalogCacheEntry *&entry) {
+        auto it = catalogCache.find(tableName);
+        if (it != catalogCache.end()) {
+            catalogCacheHitCounter++;
+            entry = &it->second;
+            return SUCCESS;
+        }
+        catalogCacheMissCounter++;
+        CatalogCacheEntry loaded;
+        RC rc = loadCatalogCacheEntry(tableName, loaded);
+        if (rc) return rc;
+        CatalogCacheEntry &cached = catalogCache[tableName];
+        cached = std::move(loaded);
+        entry = &cached;
+        return SUCCESS;
+    }
 
+    RC RelationManager::loadCatalogCacheEntry(const std::string &tableName, CatalogCacheEntry &entry) {
+        RC rc;
         RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
         rc = openCatalog();
         if (rc) {
@@ -322,14 +363,15 @@ namespace PeterDB {
         CatalogTablesHelper tablesHelper(fhTables);
         int32_t tableID = tablesHelper.getTableID(tableName);
         if (!isTableIdValid(tableID)) {
-            LOG(ERROR) << "Invalid table ID @RelationManager::deleteTable" << std::endl;
+            LOG(ERROR) << "Invalid table ID @RelationManager::loadCatalogCacheEntry" << std::endl;
             return RC(RM_ERROR::TABLE_NAME_INVALID);
         }
+        entry.tableID = tableID;
 
         // Scan columns table
         RBFM_ScanIterator colIterator;
         std::vector<std::string> colAttrNames = {CATALOG_COLUMNS_COLUMNNAME, CATALOG_COLUMNS_COLUMNTYPE,
-                                                 CATALOG_COLUMNS_COLUMNLENGTH};
+                                                 CATALOG_COLUMNS_COLUMNLENGTH, CATALOG_COLUMNS_COLUMNPOS};
         rc = rbfm.scan(fhColumns, catalogColumnsSchema, CATALOG_COLUMNS_TABLEID,
                        EQ_OP, &tableID, colAttrNames, colIterator);
         if (rc) {
@@ -338,14 +380,60 @@ namespace PeterDB {
         RID curRID;
         uint8_t rawData[PAGE_SIZE];
         memset(rawData, 0, PAGE_SIZE);
+        // deleted catalog rows leave their slots to later inserts, so scan order is not column order
+        std::map<int32_t, Attribute> colsByPosition;
         while (colIterator.getNextRecord(curRID, rawData) != RBFM_EOF) {
             CatalogColumnsHelper curRow(rawData, colAttrNames);
-            attrs.push_back(curRow.getAttribute());
+            colsByPosition[curRow.column_position] = curRow.getAttribute();
+        }
+        for (auto &col: colsByPosition) {
+            entry.attrs.push_back(col.second);
         }
 
+        // Scan indexes table
+        RBFM_ScanIterator idxIterator;
+        std::vector<std::string> idxAttrNames = {CATALOG_INDEXES_ATTRNAME, CATALOG_INDEXES_FILENAME};
+        rc = rbfm.scan(fhIndexes, catalogIndexesSchema, CATALOG_INDEXES_TABLEID,
+                       EQ_OP, &tableID, idxAttrNames, idxIterator);
+        if (rc) {
+            return RC(RM_ERROR::ITERATOR_BEGIN_FAIL);
+        }
+        while (idxIterator.getNextRecord(curRID, rawData) != RBFM_EOF) {
+            CatalogIndexesHelper curIndex(rawData, idxAttrNames);
+            entry.indexes[curIndex.attr_name] = curIndex.file_name;
+        }
         return SUCCESS;
     }
 
+    void RelationManager::invalidateCatalogCache(const std::string &tableName) {
+        // entries of other tables stay valid, the version only tells callers that some DDL happened
+        catalogCache.erase(tableName);
+        catalogVersion++;
+    }
+
+    void RelationManager::clearCatalogCache() {
+        catalogCache.clear();
+        catalogVersion++;
+    }
+
+    // drop the cached handle, a later createIndex starts a new file under the same name
+    void RelationManager::closeIndexHandle(const std::string &ixFileName) {
+        auto cached = ixFHMap.find(ixFileName);
+        if (cached == ixFHMap.end()) return;
+        IndexManager::instance().closeFile(*cached->second);
+        delete cached->second;
+        ixFHMap.erase(cached);
+    }
+
+    uint64_t RelationManager::getCatalogVersion() const {
+        return catalogVersion;
+    }
+
+    void RelationManager::collectCatalogCacheCounters(unsigned &hitCount, unsigned &missCount) const {
+        hitCount = catalogCacheHitCounter;
+        missCount = catalogCacheMissCounter;
+    }
+
     RC RelationManager::insertTuple(const std::string &tableName, const void *data, RID &rid) {
         RC rc;
         if (isTableNameEmpty(tableName)) {
@@ -367,6 +455,8 @@ namespace PeterDB {
         }
         rc = getAttributes(tableName, recordDescriptor);
         if (rc) return RC(RM_ERROR::DESCRIPTOR_GET_FAIL);
+        // the record and its index entries are logged as one operation
+        LogOperation operation(LOG_OP_RM_INSERT);
         rc = rbfm.insertRecord(thisFile, recordDescriptor, data, rid);
         if (rc) {
             LOG(ERROR) << "insert record err" << "@RelationManager::insertTuple" << std::endl;
@@ -374,7 +464,17 @@ namespace PeterDB {
         }
 
         // insert all associated index
-        insertIndex(tableName, data, recordDescriptor, rid);
+        rc = insertIndex(tableName, data, recordDescriptor, rid);
+        if (rc) {
+            LOG(ERROR) << "insert index err" << "@RelationManager::insertTuple" << std::endl;
+            rbfm.closeFile(thisFile);
+            return rc;
+        }
+        rc = operation.commit();
+        if (rc) {
+            rbfm.closeFile(thisFile);
+            return rc;
+        }
 
         rc = rbfm.closeFile(thisFile);
         if (rc) {
@@ -384,6 +484,44 @@ namespace PeterDB {
         return SUCCESS;
     }
 
+    RC RelationManager::insertTuples(const std::string &tableName, const std::vector<const void *> &data,
+                                     std::vector<RID> &rids) {
+        RC rc;
+        if (isTableNameEmpty(tableName)) {
+            return RC(RM_ERROR::TABLE_NAME_EMPTY);
+        }
+
+        if (!isTableAccessible(tableName)) {
+            return RC(RM_ERROR::TABLE_ACCESS_DENIED);
+        }
+
+        RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+        FileHandle thisFile;
+        std::vector<Attribute> recordDescriptor;
+        // table name is file name in this system
+        rc = rbfm.openFile(tableName, thisFile);
+        if (rc) {
+            LOG(ERROR) << "open file err" << "@RelationManager::insertTuples" << std::endl;
+            return RC(RM_ERROR::FILE_OPEN_FAIL);
+        }
+        rc = getAttributes(tableName, recordDescriptor);
+        if (rc) {
+            rbfm.closeFile(thisFile);
+            return RC(RM_ERROR::DESCRIPTOR_GET_FAIL);
+        }
+        LogOperation operation(LOG_OP_RM_INSERT);
+        rc = rbfm.insertRecords(thisFile, recordDescriptor, data, rids);
+        // the tuples stored before a failure are still indexed, but the batch is not committed
+        RC ixRc = insertIndexes(tableName, data, recordDescriptor, rids);
+        if (!rc && !ixRc) ixRc = operation.commit();
+        rbfm.closeFile(thisFile);
+        if (rc) {
+            LOG(ERROR) << "insert records err" << "@RelationManager::insertTuples" << std::endl;
+            return RC(RM_ERROR::TUPLE_INSERT_FAIL);
+        }
+        return ixRc;
+    }
+
     RC RelationManager::deleteTuple(const std::string &tableName, const RID &rid) {
         RC rc;
         if (isTableNameEmpty(tableName)) {
@@ -410,13 +548,17 @@ namespace PeterDB {
         uint8_t buffer[PAGE_SIZE];
         rc = rbfm.readRecord(thisFile, recordDescriptor,rid,buffer);
         if (rc)return rc;
-        rc = deleteIndex(tableName, buffer, recordDescriptor, const_cast<RID &>(rid));
-        if (rc)return rc;
+        // the record and its index entries are logged as one operation
+        LogOperation operation(LOG_OP_RM_DELETE);
         rc = rbfm.deleteRecord(thisFile, recordDescriptor, rid);
         if (rc) {
             LOG(ERROR) << "insert record err" << "@RelationManager::deleteTuple" << std::endl;
             return RC(RM_ERROR::TUPLE_DEL_FAIL);
         }
+        rc = deleteIndex(tableName, buffer, recordDescriptor, const_cast<RID &>(rid));
+        if (rc)return rc;
+        rc = operation.commit();
+        if (rc)return rc;
         rc = rbfm.closeFile(thisFile);
         if (rc) {
             LOG(ERROR) << "close file err" << "@RelationManager::deleteTuple" << std::endl;
@@ -448,16 +590,21 @@ namespace PeterDB {
         if (rc) {
             return RC(RM_ERROR::DESCRIPTOR_GET_FAIL);
         }
+        // the index entries are found by the old values
+        uint8_t oldData[PAGE_SIZE];
+        rc = rbfm.readRecord(thisFile, recordDescriptor,rid,oldData);
+        if (rc)return rc;
+        // the record and its index entries are logged as one operation
+        LogOperation operation(LOG_OP_RM_UPDATE);
         rc = rbfm.updateRecord(thisFile, recordDescriptor, data, rid);
         if (rc) {
             LOG(ERROR) << "update record err" << "@RelationManager::updateTuple" << std::endl;
             return RC(RM_ERROR::TUPLE_UPDATE_FAIL);
         }
-        uint8_t oldData[PAGE_SIZE];
-        rc = rbfm.readRecord(thisFile, recordDescriptor,rid,oldData);
-        if (rc)return rc;
         rc = updateIndex(tableName, oldData, data, recordDescriptor, const_cast<RID &>(rid));
         if (rc)return rc;
+        rc = operation.commit();
+        if (rc)return rc;
 
         rc = rbfm.closeFile(thisFile);
         if (rc) {
@@ -556,6 +703,15 @@ namespace PeterDB {
                              const void *value,
                              const std::vector<std::string> &attributeNames,
                              RM_ScanIterator &rm_ScanIterator) {
+        std::vector<ScanCondition> conditions;
+        if (compOp != NO_OP) conditions.push_back(ScanCondition{conditionAttribute, compOp, value});
+        return scan(tableName, conditions, attributeNames, rm_ScanIterator);
+    }
+
+    RC RelationManager::scan(const std::string &tableName,
+                             const std::vector<ScanCondition> &conditions,
+                             const std::vector<std::string> &attributeNames,
+                             RM_ScanIterator &rm_ScanIterator) {
         RC rc;
         if (isTableNameEmpty(tableName)) {
             return RC(RM_ERROR::TABLE_NAME_EMPTY);
@@ -574,7 +730,7 @@ namespace PeterDB {
             return RC(RM_ERROR::FILE_OPEN_FAIL);
         }
 
-        rc = rm_ScanIterator.begin(fh, attrs, conditionAttribute, compOp, value, attributeNames);
+        rc = rm_ScanIterator.begin(fh, attrs, conditions, attributeNames);
         if (rc) {
             return RC(RM_ERROR::ITERATOR_BEGIN_FAIL);
         }
@@ -687,13 +843,102 @@ namespace PeterDB {
         rc = getTableMetaData(tableName, tableRecord);
         if (rc) return rc;
         rc = insertIndexToCatalog(tableRecord.table_id, attributeName, ixFileName);
+        invalidateCatalogCache(tableName);
         if (rc) return rc;
         // 3. build index
-        rc = buildIndex(tableName, ixFileName, attributeName);
+        rc = buildIndex(tableName, tableName, ixFileName, attributeName);
         if (rc) return rc;
         return SUCCESS;
     }
 
+    RC RelationManager::reorganizeTable(const std::string &tableName) {
+        RC rc;
+        if (isTableNameEmpty(tableName)) {
+            return RC(RM_ERROR::TABLE_NAME_EMPTY);
+        }
+        if (!isTableAccessible(tableName)) {
+            return RC(RM_ERROR::TABLE_ACCESS_DENIED);
+        }
+        std::vector<Attribute> attrs;
+        rc = getAttributes(tableName, attrs);
+        if (rc) return RC(RM_ERROR::DESCRIPTOR_GET_FAIL);
+        std::unordered_map<std::string, std::string> indexedAttrAndFileName;
+        rc = getIndexes(tableName, indexedAttrAndFileName);
+        if (rc) return rc;
+        for (const auto &index: indexedAttrAndFileName) {
+            closeIndexHandle(index.second);
+        }
+
+        // 1. copy the tuples into fresh pages in rid order and build every index for the new rids into
+        // scratch files, a failure here leaves the table and its indexes as they were
+        RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+        IndexManager &ix = IndexManager::instance();
+        std::string scratchFileName = tableName + REORGANIZE_FILE_SUFFIX;
+        std::vector<std::pair<std::string, std::string>> scratchIndexes;      // scratch file -> index file
+        rc = copyTableFile(tableName, scratchFileName, attrs);
+        for (auto it = indexedAttrAndFileName.begin(); !rc && it != indexedAttrAndFileName.end(); ++it) {
+            std::string scratchIndexName = it->second + REORGANIZE_FILE_SUFFIX;
+            // left over by a reorganization that did not finish
+            ix.destroyFile(scratchIndexName);
+            rc = ix.createFile(scratchIndexName);
+            if (rc) break;
+            scratchIndexes.emplace_back(scratchIndexName, it->second);
+            rc = buildIndex(tableName, scratchFileName, scratchIndexName, it->first);
+        }
+
+        // 2. the copies replace the table and its indexes
+        if (!rc) rc = rbfm.renameFile(scratchFileName, tableName);
+        for (auto it = scratchIndexes.begin(); !rc && it != scratchIndexes.end(); ++it) {
+            rc = ix.renameFile(it->first, it->second);
+        }
+        if (rc) {
+            LOG(ERROR) << "Fail to reorganize table " << tableName << " @ RelationManager::reorganizeTable"
+                       << std::endl;
+            // only the copies that were not swapped in are still there
+            rbfm.destroyFile(scratchFileName);
+            for (const auto &scratchIndex: scratchIndexes) {
+                ix.destroyFile(scratchIndex.first);
+            }
+            return rc;
+        }
+        return SUCCESS;
+    }
+
+    RC RelationManager::copyTableFile(const std::string &fromFileName, const std::string &toFileName,
+                                      const std::vector<Attribute> &attrs) {
+        RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
+        FileHandle fromFile, toFile;
+        RC rc = rbfm.openFile(fromFileName, fromFile);
+        if (rc) return RC(RM_ERROR::FILE_OPEN_FAIL);
+        // createFile replaces the file if it is already there
+        rc = rbfm.createFile(toFileName, fromFile.getPageSize(), rbfm.getPageLayout(fromFile));
+        if (!rc) rc = rbfm.openFile(toFileName, toFile);
+        if (rc) {
+            rbfm.closeFile(fromFile);
+            return RC(RM_ERROR::FILE_OPEN_FAIL);
+        }
+
+        RBFM_ScanIterator tableIterator;
+        std::vector<std::string> attrNames;
+        for (const Attribute &attr: attrs) {
+            attrNames.push_back(attr.name);
+        }
+        rc = rbfm.scan(fromFile, attrs, "", NO_OP, nullptr, attrNames, tableIterator);
+        if (rc) rc = RC(RM_ERROR::ITERATOR_BEGIN_FAIL);
+        RID curRID, newRID;
+        // the raw format adds a null bitmap and a length before each VarChar to the stored record
+        std::vector<uint8_t> rawData(PageHelper::getMaxRecordLength(fromFile.getPageSize()) +
+                                     attrs.size() * sizeof(int32_t));
+        while (!rc && tableIterator.getNextRecord(curRID, rawData.data()) != RBFM_EOF) {
+            rc = rbfm.insertRecord(toFile, attrs, rawData.data(), newRID);
+            if (rc) rc = RC(RM_ERROR::TUPLE_INSERT_FAIL);
+        }
+        tableIterator.close();
+        rbfm.closeFile(toFile);
+        rbfm.closeFile(fromFile);
+        return rc;
+    }
+
     RC RelationManager::destroyIndex(const std::string &tableName, const std::string &attributeName) {
         RC rc;
         if (isTableNameEmpty(tableName)) {
@@ -716,12 +961,11 @@ namespace PeterDB {
         }
         std::string ixFileName = indexedAttrAndFileName[attributeName];
 
-        //  Delete index from catalog
-        rc = deleteIndexFromCatalog(tableRecord.table_id, attributeName,false);
-        if (rc) return rc;
+        closeIndexHandle(ixFileName);
 
-        // 4. Delete index file
-        rc = ix.destroyFile(ixFileName);
+        //  Delete index from catalog, this also removes the index file
+        invalidateCatalogCache(tableName);
+        rc = deleteIndexFromCatalog(tableRecord.table_id, attributeName,false);
         if (rc) return rc;
 
         return 0;
@@ -850,8 +1094,8 @@ namespace PeterDB {
         return SUCCESS;
     }
 
-    RC RelationManager::buildIndex(const std::string &tableName, const std::string &ixName,
-                                   const std::string &attributeName) {
+    RC RelationManager::buildIndex(const std::string &tableName, const std::string &tableFileName,
+                                   const std::string &ixName, const std::string &attributeName) {
         RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
         IndexManager &ix = IndexManager::instance();
         FileHandle fh;
@@ -866,7 +1110,7 @@ namespace PeterDB {
         }
         assert(attr_pos < attrs.size());
 
-        rc = rbfm.openFile(tableName, fh);
+        rc = rbfm.openFile(tableFileName, fh);
         if (rc) return rc;
         RBFM_ScanIterator tableIterator;
         std::vector<std::string> projectAttrNames = {attrs[attr_pos].name};
@@ -883,41 +1127,45 @@ namespace PeterDB {
         auto record = (Record *) buffer;
         rc = ix.openFile(ixName, ixFileHandle);
         if (rc) return rc;
-        while (tableIterator.getNextRecord(curRID, rawData) != RBFM_EOF) {
-            record->fromRawRecord((RawRecord *) rawData, attrs, tableIterator.getSelectedAttrIdx(), recLen);
-            record->getField<uint8_t>(attr_pos);
-            memcpy(keyData, record->getFieldPtr<uint8_t>(attr_pos), attrs[attr_pos].length);
-            ix.insertEntry(ixFileHandle, attrs[attr_pos], (void *) keyData, curRID);
+        if (indexBulkLoad) {
+            IXBulkLoader loader(ixFileHandle, attrs[attr_pos], indexFillFactor);
+            while (tableIterator.getNextRecord(curRID, rawData) != RBFM_EOF) {
+                record->fromRawRecord((RawRecord *) rawData, attrs, tableIterator.getSelectedAttrIdx(), recLen);
+                if (record->getDirectoryEntry(attr_pos)->isNull()) continue;
+                memcpy(keyData, record->getFieldPtr<uint8_t>(attr_pos), attrs[attr_pos].length);
+                rc = loader.addEntry(keyData, curRID);
+                if (rc) break;
+            }
+            if (!rc) rc = loader.finish();
+        } else {
+            while (tableIterator.getNextRecord(curRID, rawData) != RBFM_EOF) {
+                record->fromRawRecord((RawRecord *) rawData, attrs, tableIterator.getSelectedAttrIdx(), recLen);
+                record->getField<uint8_t>(attr_pos);
+                memcpy(keyData, record->getFieldPtr<uint8_t>(attr_pos), attrs[attr_pos].length);
+                ix.insertEntry(ixFileHandle, attrs[attr_pos], (void *) keyData, curRID);
+            }
+        }
+        tableIterator.close();
+        ix.closeFile(ixFileHandle);
+        rbfm.closeFile(fh);
+        if (rc) {
+            LOG(ERROR) << "Fail to bulk load index " << ixName << " @ RelationManager::buildIndex" << std::endl;
+            return rc;
         }
-
         return SUCCESS;
     }
 
+    void RelationManager::setIndexBulkLoad(bool enable, float fillFactor) {
+        indexBulkLoad = enable;
+        indexFillFactor = fillFactor;
+    }
+
     RC RelationManager::getIndexes(const std::string &tableName,
                                    std::unordered_map<std::string, std::string> &indexedAttrAndFileName) {
-        RC rc = 0;
-        rc = openCatalog();
-        if (rc) {
-            return RC(RM_ERROR::CATALOG_OPEN_FAIL);
-        }
-        RecordBasedFileManager &rbfm = RecordBasedFileManager::instance();
-        CatalogTablesHelper tablesRecord;
-        rc = getTableMetaData(tableName, tablesRecord);
-        if (rc)return rc;
-
-        RBFM_ScanIterator IdxIterator;
-        std::vector<std::string> projectAttrNames = {CATALOG_INDEXES_ATTRNAME, CATALOG_INDEXES_FILENAME};
-        rc = rbfm.scan(fhIndexes, catalogIndexesSchema, CATALOG_INDEXES_TABLEID,
-                       EQ_OP, &tablesRecord.table_id, projectAttrNames, IdxIterator);
-        if (rc) { return RC(RM_ERROR::ITERATOR_BEGIN_FAIL); }
-
-        RID curRID;
-        uint8_t rawData[PAGE_SIZE];
-        while (IdxIterator.getNextRecord(curRID, rawData) == 0) {
-            CatalogIndexesHelper curIndex(rawData, projectAttrNames);
-            indexedAttrAndFileName[curIndex.attr_name] = curIndex.file_name;
-        }
-
+        const CatalogCacheEntry *entry;
+        RC rc = getCatalogCacheEntry(tableName, entry);
+        if (rc) return rc;
+        indexedAttrAndFileName.insert(entry->indexes.begin(), entry->indexes.end());
         return SUCCESS;
     }
 
@@ -934,19 +1182,83 @@ namespace PeterDB {
             if (rawData->isNullField(i)) continue;
             if (indexedAttrAndFileName.find(recordDescriptor[i].name) != indexedAttrAndFileName.end()) {
                 // insert entry into each index
-                // update ixFHMap
-                if (ixFHMap.find(indexedAttrAndFileName[recordDescriptor[i].name]) == ixFHMap.end()) {
-                    IXFileHandle *fh = new IXFileHandle;
-                    ret = ix.openFile(indexedAttrAndFileName[recordDescriptor[i].name], *fh);
+                IXFileHandle *ixFileHandle;
+                ret = getIndexHandle(indexedAttrAndFileName[recordDescriptor[i].name], ixFileHandle);
+                if (ret) return ret;
+                uint8_t *key = (uint8_t *)(rawData->getFieldPtr(recordDescriptor, recordDescriptor[i].name));
+                ret = ix.insertEntry(*ixFileHandle, recordDescriptor[i], key, rid);
+                if (ret) return ret;
+            }
+        }
+        return SUCCESS;
+    }
+
+    // one pass per index over the whole batch: an empty index is bulk loaded, otherwise the entries go in
+    // in key order, so consecutive inserts descend through the same cached internal nodes to a resident leaf
+    RC RelationManager::insertIndexes(const std::string &tableName, const std::vector<const void *> &data,
+                                      const std::vector<Attribute> &recordDescriptor, const std::vector<RID> &rids) {
+        RC ret;
+        IndexManager &ix = IndexManager::instance();
+        std::unordered_map<std::string, std::string> indexedAttrAndFileName;
+        ret = getIndexes(tableName, indexedAttrAndFileName);
+        if (ret) return ret;
+        struct IndexEntry {
+            const uint8_t *key;
+            RID rid;
+        };
+        for (int i = 0; i < recordDescriptor.size(); i++) {
+            auto index = indexedAttrAndFileName.find(recordDescriptor[i].name);
+            if (index == indexedAttrAndFileName.end()) continue;
+            IXFileHandle *ixFileHandle;
+            ret = getIndexHandle(index->second, ixFileHandle);
+            if (ret) return ret;
+            const Attribute &attr = recordDescriptor[i];
+            std::vector<IndexEntry> entries;
+            for (size_t j = 0; j < rids.size(); j++) {
+                auto rawData = (RawRecord *) data[j];
+                if (rawData->isNullField(i)) continue;
+                entries.push_back({(const uint8_t *) rawData->getFieldPtr(recordDescriptor, attr.name), rids[j]});
+            }
+            if (entries.empty()) continue;
+
+            if (indexBulkLoad && ixFileHandle->isRootNull()) {
+                IXBulkLoader loader(*ixFileHandle, attr, indexFillFactor);
+                for (const IndexEntry &entry: entries) {
+                    ret = loader.addEntry(entry.key, entry.rid);
                     if (ret) return ret;
-                    ixFHMap[indexedAttrAndFileName[recordDescriptor[i].name]] = fh;
                 }
-                uint8_t *key = (uint8_t *)(rawData->getFieldPtr(recordDescriptor, recordDescriptor[i].name));
-                ret = ix.insertEntry(*ixFHMap[indexedAttrAndFileName[recordDescriptor[i].name]], recordDescriptor[i],
-                                     key, rid);
+                ret = loader.finish();
                 if (ret) return ret;
+                continue;
             }
+            std::sort(entries.begin(), entries.end(), [&attr](const IndexEntry &a, const IndexEntry &b) {
+                if (IXNode::isKeyMeetCompCondition(a.key, b.key, attr, LT_OP)) return true;
+                if (IXNode::isKeyMeetCompCondition(b.key, a.key, attr, LT_OP)) return false;
+                return IXNode::isRidMeetCompCondition(a.rid, b.rid, LT_OP);
+            });
+            for (const IndexEntry &entry: entries) {
+                ret = ix.insertEntry(*ixFileHandle, attr, entry.key, entry.rid);
+                if (ret) return ret;
+            }
+        }
+        return SUCCESS;
+    }
+
+    // index handles stay open in ixFHMap until the index or its table is dropped
+    RC RelationManager::getIndexHandle(const std::string &ixFileName, IXFileHandle *&ixFileHandle) {
+        auto cached = ixFHMap.find(ixFileName);
+        if (cached != ixFHMap.end()) {
+            ixFileHandle = cached->second;
+            return SUCCESS;
+        }
+        IXFileHandle *fh = new IXFileHandle;
+        RC ret = IndexManager::instance().openFile(ixFileName, *fh);
+        if (ret) {
+            delete fh;
+            return ret;
         }
+        ixFHMap[ixFileName] = fh;
+        ixFileHandle = fh;
         return SUCCESS;
     }
 
@@ -0,0 +1,76 @@
+#include <random>
+#include <map>
+#include "src/include/ix.h"
+#include "test/utils/ix_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(IX_Test, bulk_load_with_spilled_runs) {
+        // Functions tested
+        // 1. Bulk load int keys with duplicates in random order, small runs so they are spilled and merged
+        // 2. Scan everything back in key order and a range
+        // 3. The loaded tree keeps accepting inserts and deletes
+
+        const unsigned numOfTuples = 20000;
+        std::mt19937 gen(20230305);
+        std::multimap<int, unsigned> expected;
+
+        {
+            PeterDB::IXBulkLoader loader(ixFileHandle, ageAttr, 0.7, 16 * 1024);
+            for (unsigned i = 0; i < numOfTuples; i++) {
+                int key = (int) (gen() % 5000);
+                rid.pageNum = i + 1;
+                rid.slotNum = i % 100;
+                ASSERT_EQ(loader.addEntry(&key, rid), success) << "IXBulkLoader::addEntry() should succeed.";
+                expected.insert({key, i + 1});
+            }
+            ASSERT_EQ(loader.finish(), success) << "IXBulkLoader::finish() should succeed.";
+            EXPECT_GT(loader.getNumberOfRuns(), 1) << "Entries should not fit in a single run.";
+        }
+        PeterDB::IXBulkLoader again(ixFileHandle, ageAttr);
+        int key = 1;
+        ASSERT_EQ(again.addEntry(&key, rid), success);
+        ASSERT_NE(again.finish(), success) << "Bulk loading into a non empty index should fail.";
+
+        ASSERT_EQ(ix.scan(ixFileHandle, ageAttr, nullptr, nullptr, true, true, ix_ScanIterator), success)
+                                    << "indexManager::scan() should succeed.";
+        int lastKey = INT32_MIN;
+        unsigned count = 0;
+        while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+            ASSERT_GE(key, lastKey) << "Keys should come back sorted.";
+            lastKey = key;
+            count++;
+        }
+        EXPECT_EQ(count, numOfTuples) << "scan count is not correct.";
+        ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+
+        // inserting through the regular path splits the packed leaves
+        for (unsigned i = 0; i < 2000; i++) {
+            key = 2500;
+            rid.pageNum = numOfTuples + i + 1;
+            rid.slotNum = 0;
+            ASSERT_EQ(ix.insertEntry(ixFileHandle, ageAttr, &key, rid), success)
+                                        << "indexManager::insertEntry() should succeed.";
+            expected.insert({key, rid.pageNum});
+        }
+        auto first = expected.begin();
+        rid.pageNum = first->second;
+        rid.slotNum = (first->second - 1) % 100;
+        ASSERT_EQ(ix.deleteEntry(ixFileHandle, ageAttr, &first->first, rid), success)
+                                    << "indexManager::deleteEntry() should succeed.";
+        expected.erase(first);
+
+        int lowKey = 2400, highKey = 2600;
+        ASSERT_EQ(ix.scan(ixFileHandle, ageAttr, &lowKey, &highKey, true, false, ix_ScanIterator), success)
+                                    << "indexManager::scan() should succeed.";
+        count = 0;
+        while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+            ASSERT_GE(key, lowKey);
+            ASSERT_LT(key, highKey);
+            count++;
+        }
+        EXPECT_EQ(count, std::distance(expected.lower_bound(lowKey), expected.lower_bound(highKey)));
+        ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+    }
+
+} // namespace PeterDBTesting
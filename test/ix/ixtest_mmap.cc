@@ -0,0 +1,41 @@
+#include "src/include/ix.h"
+#include "test/utils/ix_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(IX_Test, mapped_index_insert_and_scan) {
+        // Functions tested
+        // 1. Map the index, insert entries until the tree has internal levels
+        // 2. Descents read nodes from the mapping, the node cache is not used
+        // 3. Scan everything back mapped and unmapped
+
+        unsigned numOfTuples = 5000;
+        unsigned hit, miss, evict, nodeHit, nodeMiss;
+
+        ASSERT_EQ(ixFileHandle.setMapped(true), success) << "IXFileHandle::setMapped() should succeed.";
+        ASSERT_TRUE(ixFileHandle.isMapped());
+        generateAndInsertEntries<int>(numOfTuples, ageAttr, 1);
+        ASSERT_EQ(ixFileHandle.collectCounterValues(rc, wc, ac, hit, miss, evict, nodeHit, nodeMiss), success)
+                                    << "IXFileHandle::collectCounterValues() should succeed.";
+        EXPECT_EQ(nodeHit + nodeMiss, 0) << "Mapped nodes should not go through the node cache.";
+
+        for (bool mapped: {true, false}) {
+            // closing the scan closes the handle, the mapping belongs to the file and outlives it
+            if (!ixFileHandle.isOpen()) ASSERT_EQ(ix.openFile(indexFileName, ixFileHandle), success);
+            EXPECT_TRUE(ixFileHandle.isMapped());
+            ASSERT_EQ(ixFileHandle.setMapped(mapped), success);
+            ASSERT_EQ(ix.scan(ixFileHandle, ageAttr, nullptr, nullptr, true, true, ix_ScanIterator), success)
+                                        << "indexManager::scan() should succeed.";
+            int key, lastKey = 0;
+            unsigned count = 0;
+            while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+                EXPECT_GT(key, lastKey) << "Keys should come back sorted.";
+                lastKey = key;
+                count++;
+            }
+            EXPECT_EQ(count, numOfTuples) << "scan count is not correct, mapped " << mapped;
+            ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+        }
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,77 @@
+#include "src/include/ix.h"
+#include "test/utils/ix_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(IX_Test, node_cache_hit_rate) {
+        // Functions tested
+        // 1. Insert entries until the tree has internal levels
+        // 2. Insert more entries, the internal levels should come from the node cache
+        // 3. Scan everything back
+
+        unsigned numOfTuples = 5000;
+        unsigned numOfMoreTuples = 1000;
+        unsigned hit, miss, evict, nodeHit, nodeMiss, nodeHitAfter, nodeMissAfter;
+
+        generateAndInsertEntries<int>(numOfTuples, ageAttr, 1);
+        ASSERT_EQ(ixFileHandle.collectCounterValues(rc, wc, ac, hit, miss, evict, nodeHit, nodeMiss), success)
+                                    << "IXFileHandle::collectCounterValues() should succeed.";
+
+        generateAndInsertEntries<int>(numOfMoreTuples, ageAttr, numOfTuples + 1);
+        ASSERT_EQ(ixFileHandle.collectCounterValues(rcAfter, wcAfter, acAfter, hit, miss, evict, nodeHitAfter,
+                                                    nodeMissAfter), success)
+                                    << "IXFileHandle::collectCounterValues() should succeed.";
+
+        unsigned lookups = nodeHitAfter - nodeHit + nodeMissAfter - nodeMiss;
+        GTEST_LOG_(INFO) << "Node cache: " << nodeHitAfter - nodeHit << " hits / " << lookups << " lookups";
+        EXPECT_GE(lookups, numOfMoreTuples) << "Every insert should go through an internal node.";
+        EXPECT_GE((nodeHitAfter - nodeHit) * 10, lookups * 9) << "Internal levels should stay cached.";
+
+        ASSERT_EQ(ix.scan(ixFileHandle, ageAttr, nullptr, nullptr, true, true, ix_ScanIterator), success)
+                                    << "indexManager::scan() should succeed.";
+        int key;
+        unsigned count = 0;
+        while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+            count++;
+        }
+        EXPECT_EQ(count, numOfTuples + numOfMoreTuples) << "scan count is not correct.";
+        ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+    }
+
+    TEST_F(IX_Test, node_cache_shared_between_handles) {
+        // Functions tested
+        // 1. Build a tree with internal levels through one handle
+        // 2. Keep inserting through a second handle, splitting internal nodes
+        // 3. Reopen the first handle and look the new entries up
+
+        unsigned numOfTuples = 3000;
+        unsigned numOfMoreTuples = 3000;
+        generateAndInsertEntries<int>(numOfTuples, ageAttr, 1);
+
+        PeterDB::IXFileHandle ixFileHandle2;
+        ASSERT_EQ(ix.openFile(indexFileName, ixFileHandle2), success) << "indexManager::openFile() should succeed.";
+        for (unsigned i = 0; i < numOfMoreTuples; i++) {
+            int key = (int) (numOfTuples + 1 + i);
+            rid.pageNum = key;
+            rid.slotNum = key % SHRT_MAX;
+            ASSERT_EQ(ix.insertEntry(ixFileHandle2, ageAttr, &key, rid), success)
+                                        << "indexManager::insertEntry() should succeed.";
+        }
+        ASSERT_EQ(ix.closeFile(ixFileHandle2), success) << "indexManager::closeFile() should succeed.";
+        // pick up the new root and page count, cached nodes stay resident across handles
+        reopenIndexFile();
+
+        for (unsigned i = 0; i < numOfMoreTuples; i += 100) {
+            int key = (int) (numOfTuples + 1 + i);
+            ASSERT_EQ(ix.scan(ixFileHandle, ageAttr, &key, &key, true, true, ix_ScanIterator), success)
+                                        << "indexManager::scan() should succeed.";
+            int returnedKey;
+            ASSERT_EQ(ix_ScanIterator.getNextEntry(rid, &returnedKey), success)
+                                        << "Entry inserted through the other handle should be found: " << key;
+            EXPECT_EQ(returnedKey, key);
+            EXPECT_EQ(rid.pageNum, key);
+            ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+        }
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,90 @@
+#include <random>
+#include <map>
+#include "src/include/ix.h"
+#include "test/utils/ix_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class IX_Node_Search_Test : public IX_Test {
+    protected:
+        std::multimap<std::string, std::pair<unsigned, unsigned>> expected;
+
+        static void prepareVarCharKey(const std::string &str, char *key) {
+            int len = (int) str.length();
+            memcpy(key, &len, sizeof(int));
+            memcpy(key + sizeof(int), str.c_str(), len);
+        }
+
+        void scanAndCompare(const std::string &low, const std::string &high, bool lowInclusive, bool highInclusive) {
+            char lowKey[PAGE_SIZE], highKey[PAGE_SIZE], key[PAGE_SIZE];
+            prepareVarCharKey(low, lowKey);
+            prepareVarCharKey(high, highKey);
+            ASSERT_EQ(ix.scan(ixFileHandle, empNameAttr, lowKey, highKey, lowInclusive, highInclusive,
+                              ix_ScanIterator), success) << "indexManager::scan() should succeed.";
+
+            auto begin = lowInclusive ? expected.lower_bound(low) : expected.upper_bound(low);
+            auto end = highInclusive ? expected.upper_bound(high) : expected.lower_bound(high);
+            std::multiset<std::pair<unsigned, unsigned>> remaining;
+            for (auto it = begin; it != end; it++) remaining.insert(it->second);
+
+            while (ix_ScanIterator.getNextEntry(rid, key) == success) {
+                auto target = remaining.find({rid.pageNum, rid.slotNum});
+                ASSERT_NE(target, remaining.end()) << "Unexpected rid " << rid.pageNum << " " << rid.slotNum;
+                remaining.erase(target);
+            }
+            EXPECT_TRUE(remaining.empty()) << remaining.size() << " entries between " << low << " and " << high
+                                           << " were not returned.";
+            ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+        }
+    };
+
+    TEST_F(IX_Node_Search_Test, varchar_keys_in_random_order) {
+        // Functions tested
+        // 1. Insert VarChar keys of different lengths with duplicates in random order
+        // 2. Delete a part of them
+        // 3. Range scans should match a sorted container
+
+        const unsigned numOfTuples = 4000;
+        std::mt19937 gen(20230301);
+        std::vector<std::pair<std::string, PeterDB::RID>> entries;
+        for (unsigned i = 0; i < numOfTuples; i++) {
+            std::string str(1 + gen() % 40, 'a' + (char) (i % 26));
+            str += std::to_string(gen() % 500);
+            entries.push_back({str, PeterDB::RID{i + 1, (unsigned short) (i % 97)}});
+        }
+
+        char key[PAGE_SIZE];
+        for (auto &entry: entries) {
+            prepareVarCharKey(entry.first, key);
+            ASSERT_EQ(ix.insertEntry(ixFileHandle, empNameAttr, key, entry.second), success)
+                                        << "indexManager::insertEntry() should succeed.";
+            expected.insert({entry.first, {entry.second.pageNum, entry.second.slotNum}});
+        }
+
+        std::shuffle(entries.begin(), entries.end(), gen);
+        for (unsigned i = 0; i < numOfTuples / 3; i++) {
+            prepareVarCharKey(entries[i].first, key);
+            ASSERT_EQ(ix.deleteEntry(ixFileHandle, empNameAttr, key, entries[i].second), success)
+                                        << "indexManager::deleteEntry() should succeed.";
+            auto range = expected.equal_range(entries[i].first);
+            for (auto it = range.first; it != range.second; it++) {
+                if (it->second.first == entries[i].second.pageNum &&
+                    it->second.second == entries[i].second.slotNum) {
+                    expected.erase(it);
+                    break;
+                }
+            }
+        }
+        // deleting an entry twice should fail
+        prepareVarCharKey(entries[0].first, key);
+        ASSERT_NE(ix.deleteEntry(ixFileHandle, empNameAttr, key, entries[0].second), success)
+                                    << "indexManager::deleteEntry() on a deleted entry should not succeed.";
+
+        ASSERT_NO_FATAL_FAILURE(scanAndCompare("a", "z", true, true));
+        ASSERT_NO_FATAL_FAILURE(scanAndCompare("c", "h", true, false));
+        ASSERT_NO_FATAL_FAILURE(scanAndCompare(entries[numOfTuples / 2].first, entries[numOfTuples / 2].first,
+                                               true, true));
+        ASSERT_NO_FATAL_FAILURE(scanAndCompare(entries[numOfTuples - 1].first, "x", false, true));
+    }
+
+} // namespace PeterDBTesting
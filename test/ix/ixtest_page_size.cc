@@ -0,0 +1,49 @@
+#include "src/include/ix.h"
+#include "test/utils/ix_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(IX_Test, large_page_insert_scan_delete) {
+        // Functions tested
+        // 1. Create File with an unsupported page size fails
+        // 2. Insert entries into an index with 64 KB nodes until the root splits
+        // 3. Scan everything back, delete half and scan again
+
+        const unsigned pageSize = 65536, numOfTuples = 30000;
+        ASSERT_EQ(ix.closeFile(ixFileHandle), success);
+        ASSERT_EQ(ix.destroyFile(indexFileName), success);
+        ASSERT_NE(ix.createFile(indexFileName, 1000), success) << "A page size that is not a power of two should fail.";
+        ASSERT_FALSE(fileExists(indexFileName));
+        ASSERT_EQ(ix.createFile(indexFileName, pageSize), success);
+        ASSERT_EQ(ix.openFile(indexFileName, ixFileHandle), success);
+        ASSERT_EQ(ixFileHandle.getPageSize(), pageSize);
+
+        generateAndInsertEntries<int>(numOfTuples, ageAttr, 1);
+        // 4 KB nodes would need dozens of leaves
+        EXPECT_GT(ixFileHandle.getNumberOfPages(), 2) << "The root should have split.";
+        EXPECT_LT(ixFileHandle.getNumberOfPages(), 20) << "Entries should be packed into the large nodes.";
+
+        for (unsigned deleted: {0u, numOfTuples / 2}) {
+            if (!ixFileHandle.isOpen()) ASSERT_EQ(ix.openFile(indexFileName, ixFileHandle), success);
+            ASSERT_EQ(ix.scan(ixFileHandle, ageAttr, nullptr, nullptr, true, true, ix_ScanIterator), success)
+                                        << "indexManager::scan() should succeed.";
+            int key, lastKey = 0;
+            unsigned count = 0;
+            while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+                EXPECT_GT(key, lastKey) << "Keys should come back sorted.";
+                lastKey = key;
+                count++;
+            }
+            EXPECT_EQ(count, numOfTuples - deleted);
+            ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+            if (deleted) break;
+
+            if (!ixFileHandle.isOpen()) ASSERT_EQ(ix.openFile(indexFileName, ixFileHandle), success);
+            for (int key = 1; key <= (int) numOfTuples; key += 2) {
+                ASSERT_EQ(ix.deleteEntry(ixFileHandle, ageAttr, &key, rids[key - 1]), success)
+                                            << "indexManager::deleteEntry() should succeed.";
+            }
+        }
+    }
+
+} // namespace PeterDBTesting
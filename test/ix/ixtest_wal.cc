@@ -0,0 +1,74 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include "src/include/ix.h"
+#include "test/utils/ix_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(IX_Test, wal_recover_after_crash) {
+        // Functions tested
+        // 1. A child process logs committed inserts, then deletes and inserts that split nodes without a commit
+        // 2. The unfinished operation reaches the disk before the process dies
+        // 3. Opening the log replays it, a scan returns exactly the committed entries
+
+        const std::string logFileName = "ix_test_wal_log";
+        const int numCommitted = 2000, numLost = 3000;
+        remove(logFileName.c_str());
+        ASSERT_EQ(ix.closeFile(ixFileHandle), success);
+        // the child must not share an io_uring instance with the parent
+        ASSERT_EQ(PeterDB::BufferPool::instance().setIOEngine(PeterDB::IO_ENGINE_SYNC), success);
+        ASSERT_EQ(PeterDB::BufferPool::instance().flushAll(), success);
+
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+            if (logManager.open(logFileName) != success || ix.openFile(indexFileName, ixFileHandle) != success)
+                _exit(1);
+            for (int key = 1; key <= numCommitted; key++) {
+                PeterDB::RID entryRid{(unsigned) key, (unsigned short) (key % 100)};
+                if (ix.insertEntry(ixFileHandle, ageAttr, &key, entryRid) != success) _exit(2);
+            }
+            logManager.beginOperation(PeterDB::LOG_OP_IX_INSERT);
+            for (int key = 1; key <= numCommitted; key += 3) {
+                PeterDB::RID entryRid{(unsigned) key, (unsigned short) (key % 100)};
+                if (ix.deleteEntry(ixFileHandle, ageAttr, &key, entryRid) != success) _exit(3);
+            }
+            for (int key = numCommitted + 1; key <= numCommitted + numLost; key++) {
+                PeterDB::RID entryRid{(unsigned) key, (unsigned short) (key % 100)};
+                if (ix.insertEntry(ixFileHandle, ageAttr, &key, entryRid) != success) _exit(4);
+            }
+            if (PeterDB::BufferPool::instance().flushAll() != success) _exit(5);
+            _exit(0);
+        }
+        int status;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0) << "The child process failed.";
+
+        PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+        ASSERT_EQ(logManager.open(logFileName), success);
+        unsigned redoCount, undoCount;
+        logManager.getRecoveryCounts(redoCount, undoCount);
+        EXPECT_GT(redoCount, 0);
+        EXPECT_GT(undoCount, 0);
+
+        ASSERT_EQ(ix.openFile(indexFileName, ixFileHandle), success);
+        ASSERT_EQ(ix.scan(ixFileHandle, ageAttr, nullptr, nullptr, true, true, ix_ScanIterator), success)
+                                    << "indexManager::scan() should succeed.";
+        int key, expected = 0;
+        while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+            expected++;
+            ASSERT_EQ(key, expected);
+            EXPECT_EQ(rid.pageNum, (unsigned) key);
+            EXPECT_EQ(rid.slotNum, key % 100);
+        }
+        EXPECT_EQ(expected, numCommitted);
+        ASSERT_EQ(ix_ScanIterator.close(), success) << "IX_ScanIterator::close() should succeed.";
+
+        ASSERT_EQ(logManager.close(), success);
+        PeterDB::BufferPool::instance().setIOEngine(PeterDB::DEFAULT_IO_ENGINE);
+        remove(logFileName.c_str());
+    }
+
+} // namespace PeterDBTesting
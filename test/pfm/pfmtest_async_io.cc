@@ -0,0 +1,111 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <set>
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class PFM_Async_IO_Test : public PFM_Page_Test,
+                              public ::testing::WithParamInterface<PeterDB::IOEngineType> {
+    protected:
+        ~PFM_Async_IO_Test() override {
+            PeterDB::BufferPool::instance().setIOEngine(PeterDB::DEFAULT_IO_ENGINE);
+        }
+    };
+
+    TEST_P (PFM_Async_IO_Test, engine_reads_and_writes_pages) {
+        // Functions Tested:
+        // 1. Submit more single page reads than the queue depth, reaping completions when the queue is full
+        // 2. Every completion carries its tag and the page it read
+        // 3. Asynchronous writes are seen by a later read
+        // 4. A read past the end of the file completes with 0 bytes
+
+        const unsigned numPages = 32, queueDepth = 8;
+        std::vector<uint8_t> inBuffer(numPages * PAGE_SIZE), outBuffer(numPages * PAGE_SIZE, 0);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i + 3, i + 9);
+        }
+        ASSERT_EQ(fileHandle.appendPages(numPages, inBuffer.data()), success);
+
+        std::unique_ptr<PeterDB::IOEngine> engine(PeterDB::IOEngine::create(GetParam(), queueDepth));
+        ASSERT_NE(engine, nullptr);
+        int fd = open(fileName.c_str(), O_RDWR);
+        ASSERT_GE(fd, 0);
+
+        std::vector<struct iovec> iov(numPages);
+        std::set<uint64_t> completed;
+        auto reap = [&](bool block) {
+            PeterDB::IOCompletion completion{};
+            bool done = block ? engine->waitCompletion(completion) == success : engine->pollCompletion(completion);
+            if (!done) return;
+            EXPECT_EQ(completion.result, PAGE_SIZE) << "Page " << completion.tag;
+            completed.insert(completion.tag);
+        };
+        for (unsigned i = 0; i < numPages; i++) {
+            iov[i] = {outBuffer.data() + i * PAGE_SIZE, PAGE_SIZE};
+            // the hidden header page comes first
+            PeterDB::IORequest request{fd, &iov[i], 1, (off_t) (i + 1) * PAGE_SIZE, false, i};
+            while (engine->submit(request) == PeterDB::RC(PeterDB::BUFFER_ERROR::IO_QUEUE_FULL)) reap(true);
+            EXPECT_LE(engine->getNumberOfInFlight(), queueDepth);
+        }
+        while (engine->getNumberOfInFlight() > 0) reap(true);
+        EXPECT_EQ(completed.size(), numPages);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), numPages * PAGE_SIZE), 0);
+
+        generateData(inBuffer.data(), 2 * PAGE_SIZE, 17, 19);
+        struct iovec writeIov[2] = {{inBuffer.data(), PAGE_SIZE}, {inBuffer.data() + PAGE_SIZE, PAGE_SIZE}};
+        ASSERT_EQ(engine->submit({fd, writeIov, 2, PAGE_SIZE, true, 100}), success);
+        PeterDB::IOCompletion completion{};
+        ASSERT_EQ(engine->waitCompletion(completion), success);
+        EXPECT_EQ(completion.tag, 100);
+        EXPECT_EQ(completion.result, 2 * PAGE_SIZE);
+        EXPECT_FALSE(engine->pollCompletion(completion)) << "Nothing should be left in flight.";
+        ASSERT_EQ(pread(fd, outBuffer.data(), 2 * PAGE_SIZE, PAGE_SIZE), 2 * PAGE_SIZE);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), 2 * PAGE_SIZE), 0);
+
+        ASSERT_EQ(engine->submit({fd, iov.data(), 1, (off_t) (numPages + 1) * PAGE_SIZE, false, 200}), success);
+        ASSERT_EQ(engine->waitCompletion(completion), success);
+        EXPECT_EQ(completion.tag, 200);
+        EXPECT_EQ(completion.result, 0);
+        close(fd);
+    }
+
+    TEST_P (PFM_Async_IO_Test, asynchronous_read_ahead) {
+        // Functions Tested:
+        // 1. Prefetch Pages submits the reads, Read Page waits for the one it needs
+        // 2. Writing a page while its read is in flight keeps the new data
+
+        PeterDB::BufferPool &bufferPool = PeterDB::BufferPool::instance();
+        ASSERT_EQ(bufferPool.setIOEngine(GetParam()), success);
+        EXPECT_NE(bufferPool.getIOEngine(), PeterDB::IO_ENGINE_SYNC);
+
+        const unsigned numPages = 40;
+        std::vector<uint8_t> inBuffer(numPages * PAGE_SIZE), outBuffer(PAGE_SIZE);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i + 5, i + 2);
+        }
+        ASSERT_EQ(fileHandle.appendPages(numPages, inBuffer.data()), success);
+        // drop the appended pages from the pool so that read-ahead has to go to disk
+        ASSERT_EQ(bufferPool.setPoolSize(PeterDB::DEFAULT_BUFFER_POOL_SIZE), success);
+
+        ASSERT_EQ(fileHandle.prefetchPages(0, numPages), success);
+        generateData(inBuffer.data() + 7 * PAGE_SIZE, PAGE_SIZE, 31, 37);
+        ASSERT_EQ(fileHandle.writePage(7, inBuffer.data() + 7 * PAGE_SIZE), success);
+
+        unsigned rc, wc, ac, hit, miss, evict;
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hit, miss, evict), success);
+        EXPECT_EQ(miss, numPages) << "Every prefetched page is a miss once.";
+        for (unsigned i = 0; i < numPages; i++) {
+            ASSERT_EQ(fileHandle.readPage(i, outBuffer.data()), success);
+            EXPECT_EQ(memcmp(inBuffer.data() + i * PAGE_SIZE, outBuffer.data(), PAGE_SIZE), 0) << "Page " << i;
+        }
+        unsigned missAfter;
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hit, missAfter, evict), success);
+        EXPECT_EQ(missAfter, miss) << "Pages read ahead should not be read again.";
+    }
+
+    INSTANTIATE_TEST_SUITE_P(Engines, PFM_Async_IO_Test,
+                             ::testing::Values(PeterDB::IO_ENGINE_URING, PeterDB::IO_ENGINE_THREAD_POOL));
+
+} // namespace PeterDBTesting
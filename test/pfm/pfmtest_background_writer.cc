@@ -0,0 +1,105 @@
+#include <chrono>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class PFM_Background_Writer_Test : public PFM_Page_Test {
+    protected:
+        ~PFM_Background_Writer_Test() override {
+            PeterDB::BufferPool::instance().setWriterInterval(PeterDB::DEFAULT_WRITER_INTERVAL);
+        }
+
+        // wait for a whole round of the writer that started after the call
+        static bool waitForWriter() {
+            unsigned roundCount, writeCount, dirtyEvictCount, roundsBefore;
+            PeterDB::BufferPool::instance().collectWriterCounterValues(roundsBefore, writeCount, dirtyEvictCount);
+            for (unsigned i = 0; i < 500; i++) {
+                PeterDB::BufferPool::instance().collectWriterCounterValues(roundCount, writeCount, dirtyEvictCount);
+                if (roundCount >= roundsBefore + 2) return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return false;
+        }
+    };
+
+    TEST_F (PFM_Background_Writer_Test, dirty_pages_reach_disk_without_flush) {
+        // Functions Tested:
+        // 1. Pages written through the pool are only dirty frames until the writer runs
+        // 2. The writer writes them back without a flush or close, the frames stay resident
+        // 3. Stopping the writer leaves new dirty pages alone
+
+        PeterDB::BufferPool &bufferPool = PeterDB::BufferPool::instance();
+        const unsigned numPages = 200;
+        std::vector<uint8_t> inBuffer(numPages * PAGE_SIZE, 0), outBuffer(numPages * PAGE_SIZE);
+        ASSERT_EQ(fileHandle.appendPages(numPages, inBuffer.data()), success);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i + 1, i + 7);
+            ASSERT_EQ(fileHandle.writePage(i, inBuffer.data() + i * PAGE_SIZE), success);
+        }
+        int fd = open(fileName.c_str(), O_RDONLY);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(pread(fd, outBuffer.data(), PAGE_SIZE, PAGE_SIZE), PAGE_SIZE);
+        EXPECT_NE(memcmp(inBuffer.data(), outBuffer.data(), PAGE_SIZE), 0) << "Writes should be buffered.";
+
+        unsigned roundCount, writeCount, dirtyEvictCount;
+        ASSERT_EQ(bufferPool.collectWriterCounterValues(roundCount, writeCount, dirtyEvictCount), success);
+        ASSERT_EQ(bufferPool.setWriterInterval(5), success);
+        EXPECT_EQ(bufferPool.getWriterInterval(), 5);
+        ASSERT_TRUE(waitForWriter());
+        unsigned writeCountAfter;
+        ASSERT_EQ(bufferPool.collectWriterCounterValues(roundCount, writeCountAfter, dirtyEvictCount), success);
+        EXPECT_EQ(writeCountAfter - writeCount, numPages) << "The writer should write back every dirty page once.";
+        ASSERT_EQ(pread(fd, outBuffer.data(), numPages * PAGE_SIZE, PAGE_SIZE), numPages * PAGE_SIZE);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), numPages * PAGE_SIZE), 0);
+
+        unsigned rc, wc, ac, hitCount, missCount, evictCount, missAfter;
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hitCount, missCount, evictCount), success);
+        ASSERT_EQ(fileHandle.readPages(0, numPages, outBuffer.data()), success);
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hitCount, missAfter, evictCount), success);
+        EXPECT_EQ(missAfter, missCount) << "Written back pages should stay resident.";
+
+        ASSERT_EQ(bufferPool.setWriterInterval(0), success);
+        ASSERT_EQ(bufferPool.collectWriterCounterValues(roundCount, writeCount, dirtyEvictCount), success);
+        generateData(inBuffer.data(), PAGE_SIZE, 13, 17);
+        ASSERT_EQ(fileHandle.writePage(0, inBuffer.data()), success);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ASSERT_EQ(bufferPool.collectWriterCounterValues(roundCount, writeCountAfter, dirtyEvictCount), success);
+        EXPECT_EQ(writeCountAfter, writeCount);
+        close(fd);
+    }
+
+    TEST_F (PFM_Background_Writer_Test, writer_keeps_frames_clean_for_eviction) {
+        // Functions Tested:
+        // 1. With the writer running, a small pool cycles through many more pages than it holds
+        // 2. Evictions mostly find clean frames, every page comes back intact
+
+        PeterDB::BufferPool &bufferPool = PeterDB::BufferPool::instance();
+        const unsigned numPages = 512, poolSize = 128;
+        std::vector<uint8_t> inBuffer(numPages * PAGE_SIZE, 0), page(PAGE_SIZE);
+        ASSERT_EQ(fileHandle.appendPages(numPages, inBuffer.data()), success);
+        ASSERT_EQ(bufferPool.setPoolSize(poolSize), success);
+        ASSERT_EQ(bufferPool.setWriterInterval(1), success);
+
+        unsigned roundCount, writeCount, dirtyEvictBefore, dirtyEvictAfter;
+        ASSERT_EQ(bufferPool.collectWriterCounterValues(roundCount, writeCount, dirtyEvictBefore), success);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i % 50 + 1, i + 3);
+            ASSERT_EQ(fileHandle.writePage(i, inBuffer.data() + i * PAGE_SIZE), success);
+            // leave the writer time to catch up every half pool
+            if (i % (poolSize / 2) == poolSize / 2 - 1) ASSERT_TRUE(waitForWriter());
+        }
+        ASSERT_EQ(bufferPool.collectWriterCounterValues(roundCount, writeCount, dirtyEvictAfter), success);
+        EXPECT_LT(dirtyEvictAfter - dirtyEvictBefore, poolSize / 2) << "Evictions should rarely write.";
+        for (unsigned i = 0; i < numPages; i++) {
+            ASSERT_EQ(fileHandle.readPage(i, page.data()), success);
+            ASSERT_EQ(memcmp(inBuffer.data() + i * PAGE_SIZE, page.data(), PAGE_SIZE), 0) << "Page " << i;
+        }
+        ASSERT_EQ(bufferPool.setWriterInterval(0), success);
+        ASSERT_EQ(bufferPool.setPoolSize(PeterDB::DEFAULT_BUFFER_POOL_SIZE), success);
+    }
+
+} // namespace PeterDBTesting
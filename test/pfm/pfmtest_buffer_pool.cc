@@ -0,0 +1,131 @@
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class PFM_Buffer_Pool_Test : public PFM_Page_Test {
+    protected:
+        PeterDB::BufferPool &bufferPool = PeterDB::BufferPool::instance();
+
+        ~PFM_Buffer_Pool_Test() override {
+            // Runs after TearDown closed the file, restore the defaults for the other tests in this process
+            bufferPool.setReplacementPolicy(PeterDB::DEFAULT_REPLACEMENT_POLICY);
+            bufferPool.setPoolSize(PeterDB::DEFAULT_BUFFER_POOL_SIZE);
+        }
+
+        void appendPages(unsigned numPages) {
+            inBuffer = malloc(PAGE_SIZE);
+            for (unsigned i = 0; i < numPages; i++) {
+                generateData(inBuffer, PAGE_SIZE, i + 1, i + 3);
+                ASSERT_EQ(fileHandle.appendPage(inBuffer), success) << "Appending a page should succeed.";
+            }
+        }
+
+        void checkPage(unsigned pageNum, unsigned seed, unsigned salt) {
+            generateData(inBuffer, PAGE_SIZE, seed, salt);
+            ASSERT_EQ(fileHandle.readPage(pageNum, outBuffer), success) << "Reading a page should succeed.";
+            ASSERT_EQ(memcmp(inBuffer, outBuffer, PAGE_SIZE), 0) << "Page " << pageNum << " should be intact.";
+        }
+    };
+
+    TEST_F (PFM_Buffer_Pool_Test, hit_after_append) {
+        // Functions Tested:
+        // 1. Append Page
+        // 2. Read Page twice
+        // 3. Get Counter Values with buffer pool counters
+
+        unsigned rc, wc, ac, hit, miss, evict;
+        unsigned rcAfter, wcAfter, acAfter, hitAfter, missAfter, evictAfter;
+
+        appendPages(1);
+        outBuffer = malloc(PAGE_SIZE);
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hit, miss, evict), success);
+
+        checkPage(0, 1, 3);
+        checkPage(0, 1, 3);
+
+        ASSERT_EQ(fileHandle.collectCounterValues(rcAfter, wcAfter, acAfter, hitAfter, missAfter, evictAfter),
+                  success);
+        EXPECT_EQ(rcAfter - rc, 2) << "Logical reads should still be counted.";
+        EXPECT_EQ(hitAfter - hit, 2) << "An appended page should stay resident.";
+        EXPECT_EQ(missAfter - miss, 0);
+        EXPECT_EQ(evictAfter - evict, 0);
+    }
+
+    TEST_F (PFM_Buffer_Pool_Test, write_back_on_eviction) {
+        // Functions Tested:
+        // 1. Shrink the pool
+        // 2. Write pages so that dirty frames get evicted
+        // 3. Reopen File and read the pages back
+
+        const unsigned numPages = 16;
+        ASSERT_EQ(bufferPool.setPoolSize(4), success);
+        appendPages(numPages);
+        outBuffer = malloc(PAGE_SIZE);
+
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer, PAGE_SIZE, i + 100, i + 7);
+            ASSERT_EQ(fileHandle.writePage(i, inBuffer), success) << "Writing a page should succeed.";
+        }
+
+        unsigned rc, wc, ac, hit, miss, evict;
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hit, miss, evict), success);
+        EXPECT_GT(evict, 0) << "A 4-frame pool should have evicted pages.";
+
+        reopenFile();
+        for (unsigned i = 0; i < numPages; i++) {
+            checkPage(i, i + 100, i + 7);
+        }
+    }
+
+    TEST_F (PFM_Buffer_Pool_Test, replacement_policies) {
+        // Functions Tested:
+        // 1. Switch between LRU, CLOCK and LRU-K
+        // 2. Read pages in a loop larger than the pool
+
+        const unsigned numPages = 12;
+        ASSERT_EQ(bufferPool.setPoolSize(5), success);
+        appendPages(numPages);
+        outBuffer = malloc(PAGE_SIZE);
+
+        for (auto policy: {PeterDB::REPLACE_LRU, PeterDB::REPLACE_CLOCK, PeterDB::REPLACE_LRU_K}) {
+            ASSERT_EQ(bufferPool.setReplacementPolicy(policy), success);
+            ASSERT_EQ(bufferPool.getReplacementPolicy(), policy);
+            for (unsigned round = 0; round < 3; round++) {
+                for (unsigned i = 0; i < numPages; i++) {
+                    checkPage(i, i + 1, i + 3);
+                }
+            }
+        }
+    }
+
+    TEST_F (PFM_Buffer_Pool_Test, pinned_frames) {
+        // Functions Tested:
+        // 1. Pin every frame
+        // 2. Fetching another page or resizing the pool should fail
+        // 3. Unpin and fetch again
+
+        const unsigned poolSize = 3;
+        ASSERT_EQ(bufferPool.setPoolSize(poolSize), success);
+        appendPages(poolSize + 1);
+
+        PeterDB::FileId fileId = bufferPool.registerFile(fileName);
+        PeterDB::BufferCounter counter = {0, 0, 0};
+        uint8_t *page;
+        for (unsigned i = 0; i < poolSize; i++) {
+            ASSERT_EQ(bufferPool.fetchPage(fileId, i, true, page, counter), success);
+        }
+        ASSERT_NE(bufferPool.fetchPage(fileId, poolSize, true, page, counter), success)
+                                    << "Every frame is pinned, fetching should fail.";
+        ASSERT_NE(bufferPool.setPoolSize(poolSize + 1), success) << "Resizing with pinned pages should fail.";
+
+        ASSERT_EQ(bufferPool.unpinPage(fileId, 0, false), success);
+        counter = {0, 0, 0};
+        ASSERT_EQ(bufferPool.fetchPage(fileId, poolSize, true, page, counter), success);
+        EXPECT_EQ(counter.evictCounter, 1);
+        for (unsigned i = 1; i <= poolSize; i++) {
+            ASSERT_EQ(bufferPool.unpinPage(fileId, i, false), success);
+        }
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,67 @@
+#include <sys/stat.h>
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class PFM_Extent_Test : public PFM_Page_Test {
+    protected:
+        ~PFM_Extent_Test() override {
+            PeterDB::BufferPool::instance().setExtentSize(PeterDB::DEFAULT_MIN_EXTENT_SIZE,
+                                                          PeterDB::DEFAULT_MAX_EXTENT_SIZE);
+        }
+
+        // bytes the file system has allocated to the file, reserved space past its end included
+        size_t getAllocatedSize() const {
+            struct stat st{};
+            stat(fileName.c_str(), &st);
+            return (size_t) st.st_blocks * 512;
+        }
+    };
+
+    TEST_F (PFM_Extent_Test, append_grows_file_in_extents) {
+        // Functions Tested:
+        // 1. Appending one page reserves a whole extent past the end of the file
+        // 2. Extents double once the file outgrows the smallest one
+        // 3. The file size and the page count still only cover the pages written
+        // 4. A fixed extent size is honored, a minimum above the maximum is rejected
+
+        PeterDB::BufferPool &bufferPool = PeterDB::BufferPool::instance();
+        EXPECT_NE(bufferPool.setExtentSize(2 << 20, 1 << 20), success) << "The minimum may not exceed the maximum.";
+        std::vector<uint8_t> page(PAGE_SIZE), outBuffer(PAGE_SIZE);
+        generateData(page.data(), PAGE_SIZE, 1, 2);
+        ASSERT_EQ(fileHandle.appendPage(page.data()), success);
+        if (getAllocatedSize() < PeterDB::DEFAULT_MIN_EXTENT_SIZE) GTEST_SKIP() << "fallocate is not supported here.";
+
+        const unsigned numPages = 300;
+        for (unsigned i = 1; i < numPages; i++) {
+            generateData(page.data(), PAGE_SIZE, i % 90 + 1, i + 2);
+            ASSERT_EQ(fileHandle.appendPage(page.data()), success);
+        }
+        EXPECT_EQ(fileHandle.getNumberOfPages(), numPages);
+        EXPECT_EQ(getFileSize(fileName), (numPages + 1) * PAGE_SIZE) << "Reserved space is not part of the file.";
+        EXPECT_GE(getAllocatedSize(), 2 * PeterDB::DEFAULT_MIN_EXTENT_SIZE) << "The second extent should double.";
+
+        const size_t extentSize = 256 * 1024;
+        ASSERT_EQ(bufferPool.setExtentSize(extentSize, extentSize), success);
+        std::vector<uint8_t> pages(numPages * PAGE_SIZE);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(pages.data() + i * PAGE_SIZE, PAGE_SIZE, i % 70 + 1, i + 5);
+        }
+        ASSERT_EQ(fileHandle.appendPages(numPages, pages.data()), success);
+        size_t fileSize = (2 * numPages + 1) * PAGE_SIZE;
+        EXPECT_EQ(getFileSize(fileName), fileSize);
+        EXPECT_GE(getAllocatedSize(), fileSize);
+
+        reopenFile();
+        EXPECT_EQ(fileHandle.getNumberOfPages(), 2 * numPages);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(page.data(), PAGE_SIZE, i == 0 ? 1 : i % 90 + 1, i == 0 ? 2 : i + 2);
+            ASSERT_EQ(fileHandle.readPage(i, outBuffer.data()), success);
+            ASSERT_EQ(memcmp(page.data(), outBuffer.data(), PAGE_SIZE), 0) << "Page " << i;
+            ASSERT_EQ(fileHandle.readPage(numPages + i, outBuffer.data()), success);
+            ASSERT_EQ(memcmp(pages.data() + i * PAGE_SIZE, outBuffer.data(), PAGE_SIZE), 0) << "Page " << i;
+        }
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,202 @@
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class PFM_File_Registry_Test : public PFM_File_Test {
+    protected:
+        std::vector<std::string> fileNames;
+
+        void TearDown() override {
+            pfm.setMaxOpenFiles(PeterDB::DEFAULT_MAX_OPEN_FILES);
+            for (auto &name: fileNames) {
+                pfm.destroyFile(name);
+            }
+        }
+
+        void createFiles(unsigned numFiles) {
+            for (unsigned i = 0; i < numFiles; i++) {
+                std::string name = fileName + "_" + std::to_string(i);
+                remove(name.c_str());
+                ASSERT_EQ(pfm.createFile(name), success) << "Creating the file should not fail: " << name;
+                fileNames.push_back(name);
+            }
+        }
+    };
+
+    TEST_F (PFM_File_Registry_Test, handles_share_header_state) {
+        // Functions Tested:
+        // 1. Open the same file with two handles
+        // 2. Append Page through one handle, the other one sees the page and the counters
+        // 3. Close one handle, the other one keeps working
+
+        ASSERT_NO_FATAL_FAILURE(createFiles(1));
+        PeterDB::FileHandle first, second;
+        ASSERT_EQ(pfm.openFile(fileNames[0], first), success);
+        ASSERT_EQ(pfm.openFile(fileNames[0], second), success);
+
+        std::vector<uint8_t> inBuffer(PAGE_SIZE), outBuffer(PAGE_SIZE);
+        generateData(inBuffer.data(), PAGE_SIZE, 5, 11);
+        ASSERT_EQ(first.appendPage(inBuffer.data()), success);
+        ASSERT_EQ(second.getNumberOfPages(), 1) << "The page count should be shared.";
+        ASSERT_EQ(second.readPage(0, outBuffer.data()), success);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), PAGE_SIZE), 0);
+
+        unsigned rc1, wc1, ac1, rc2, wc2, ac2;
+        ASSERT_EQ(first.collectCounterValues(rc1, wc1, ac1), success);
+        ASSERT_EQ(second.collectCounterValues(rc2, wc2, ac2), success);
+        EXPECT_EQ(rc1, rc2);
+        EXPECT_EQ(ac1, ac2);
+        EXPECT_EQ(rc1, 1);
+        EXPECT_EQ(ac1, 1);
+
+        ASSERT_EQ(pfm.closeFile(first), success);
+        EXPECT_FALSE(first.isFileOpen());
+        ASSERT_EQ(second.appendPage(inBuffer.data()), success) << "The other handle should still be open.";
+        ASSERT_EQ(second.getNumberOfPages(), 2);
+        ASSERT_EQ(pfm.closeFile(second), success);
+        EXPECT_NE(pfm.closeFile(second), success) << "Closing a closed handle should fail.";
+    }
+
+    TEST_F (PFM_File_Registry_Test, idle_files_evicted_under_cap) {
+        // Functions Tested:
+        // 1. Open, Append Page and Close more files than the cap
+        // 2. Idle files are evicted, files still open in a handle are not
+        // 3. Evicted files are read back from disk with their pages and counters
+
+        const unsigned numFiles = 5;
+        ASSERT_EQ(pfm.setMaxOpenFiles(2), success);
+        ASSERT_NO_FATAL_FAILURE(createFiles(numFiles));
+
+        std::vector<uint8_t> inBuffer(PAGE_SIZE), outBuffer(PAGE_SIZE);
+        PeterDB::FileHandle pinned;
+        ASSERT_EQ(pfm.openFile(fileNames[0], pinned), success);
+        for (unsigned i = 0; i < numFiles; i++) {
+            PeterDB::FileHandle fileHandle;
+            ASSERT_EQ(pfm.openFile(fileNames[i], fileHandle), success);
+            generateData(inBuffer.data(), PAGE_SIZE, i + 1, i + 7);
+            ASSERT_EQ(fileHandle.appendPage(inBuffer.data()), success);
+            ASSERT_EQ(fileHandle.writePage(0, inBuffer.data()), success);
+            ASSERT_EQ(pfm.closeFile(fileHandle), success);
+            EXPECT_LE(pfm.getNumberOfOpenFiles(), 2) << "Idle files above the cap should be evicted.";
+        }
+        ASSERT_EQ(pinned.getNumberOfPages(), 1) << "A file open in a handle should not be evicted.";
+
+        for (unsigned i = 0; i < numFiles; i++) {
+            PeterDB::FileHandle fileHandle;
+            ASSERT_EQ(pfm.openFile(fileNames[i], fileHandle), success);
+            ASSERT_EQ(fileHandle.getNumberOfPages(), 1);
+            generateData(inBuffer.data(), PAGE_SIZE, i + 1, i + 7);
+            ASSERT_EQ(fileHandle.readPage(0, outBuffer.data()), success);
+            EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), PAGE_SIZE), 0) << "File " << i << " should be intact.";
+            unsigned readCount, writeCount, appendCount;
+            ASSERT_EQ(fileHandle.collectCounterValues(readCount, writeCount, appendCount), success);
+            EXPECT_EQ(writeCount, 1) << "Counters should survive eviction.";
+            EXPECT_EQ(appendCount, 1);
+            ASSERT_EQ(pfm.closeFile(fileHandle), success);
+        }
+        ASSERT_EQ(pfm.closeFile(pinned), success);
+    }
+
+    TEST_F (PFM_File_Registry_Test, rename_replaces_closed_file) {
+        // Functions Tested:
+        // 1. Append Pages to two files, one of them only in the buffer pool
+        // 2. Renaming is refused while a file is open in a handle
+        // 3. Once closed, the first file replaces the second with its pages and counters
+
+        ASSERT_NO_FATAL_FAILURE(createFiles(2));
+        std::vector<uint8_t> inBuffer(PAGE_SIZE), outBuffer(PAGE_SIZE);
+        PeterDB::FileHandle from, to;
+        ASSERT_EQ(pfm.openFile(fileNames[0], from), success);
+        ASSERT_EQ(pfm.openFile(fileNames[1], to), success);
+        for (unsigned i = 0; i < 3; i++) {
+            generateData(inBuffer.data(), PAGE_SIZE, i + 2, i + 9);
+            ASSERT_EQ(from.appendPage(inBuffer.data()), success);
+        }
+        ASSERT_EQ(from.writePage(2, inBuffer.data()), success);
+        ASSERT_EQ(to.appendPage(inBuffer.data()), success);
+        ASSERT_EQ(pfm.closeFile(from), success);
+        EXPECT_NE(pfm.renameFile(fileNames[0], fileNames[1]), success) << "An open file should not be replaced.";
+
+        ASSERT_EQ(pfm.closeFile(to), success);
+        ASSERT_EQ(pfm.renameFile(fileNames[0], fileNames[1]), success);
+        EXPECT_FALSE(pfm.isFileExists(fileNames[0]));
+        ASSERT_EQ(pfm.openFile(fileNames[1], to), success);
+        ASSERT_EQ(to.getNumberOfPages(), 3);
+        for (unsigned i = 0; i < 3; i++) {
+            generateData(inBuffer.data(), PAGE_SIZE, i + 2, i + 9);
+            ASSERT_EQ(to.readPage(i, outBuffer.data()), success);
+            EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), PAGE_SIZE), 0) << "Page " << i << " should be moved.";
+        }
+        unsigned readCount, writeCount, appendCount;
+        ASSERT_EQ(to.collectCounterValues(readCount, writeCount, appendCount), success);
+        EXPECT_EQ(writeCount, 1);
+        EXPECT_EQ(appendCount, 3);
+        ASSERT_EQ(pfm.closeFile(to), success);
+    }
+
+    TEST_F (PFM_File_Registry_Test, close_writes_back_last_handle) {
+        // Functions Tested:
+        // 1. Append and Write Pages, then close the last handle
+        // 2. Pages and header counters are on disk once the file is closed
+        // 3. Reopen after the buffer pool dropped its frames, the pages are read back from disk
+
+        ASSERT_NO_FATAL_FAILURE(createFiles(1));
+        std::vector<uint8_t> inBuffer(3 * PAGE_SIZE), outBuffer(PAGE_SIZE);
+        PeterDB::FileHandle fileHandle;
+        ASSERT_EQ(pfm.openFile(fileNames[0], fileHandle), success);
+        for (unsigned i = 0; i < 3; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i + 3, i + 5);
+            ASSERT_EQ(fileHandle.appendPage(inBuffer.data() + i * PAGE_SIZE), success);
+        }
+        generateData(inBuffer.data() + PAGE_SIZE, PAGE_SIZE, 8, 13);
+        ASSERT_EQ(fileHandle.writePage(1, inBuffer.data() + PAGE_SIZE), success);
+        ASSERT_EQ(pfm.closeFile(fileHandle), success);
+
+        PeterDB::FileHeader header;
+        FILE *fp = fopen(fileNames[0].c_str(), "rb");
+        ASSERT_NE(fp, nullptr);
+        ASSERT_EQ(fread(&header, sizeof(header), 1, fp), 1);
+        fclose(fp);
+        EXPECT_EQ(header.pageCounter, 3) << "The header should be written back on close.";
+        EXPECT_EQ(header.writePageCounter, 1);
+        EXPECT_EQ(header.appendPageCounter, 3);
+        EXPECT_EQ(getFileSize(fileNames[0]), 4 * PAGE_SIZE) << "The pages should be written back on close.";
+
+        ASSERT_EQ(PeterDB::BufferPool::instance().dropFile(fileNames[0]), success);
+        ASSERT_EQ(pfm.openFile(fileNames[0], fileHandle), success);
+        ASSERT_EQ(fileHandle.getNumberOfPages(), 3);
+        for (unsigned i = 0; i < 3; i++) {
+            ASSERT_EQ(fileHandle.readPage(i, outBuffer.data()), success);
+            EXPECT_EQ(memcmp(inBuffer.data() + i * PAGE_SIZE, outBuffer.data(), PAGE_SIZE), 0) << "Page " << i << " should be on disk.";
+        }
+        ASSERT_EQ(pfm.closeFile(fileHandle), success);
+    }
+
+    TEST_F (PFM_File_Registry_Test, old_format_rejected) {
+        // Functions Tested:
+        // 1. Write a file whose header page has the layout from before the format version,
+        //    the free-space map starting right after the page size
+        // 2. Opening it fails with FILE_FORMAT_UNSUPPORTED instead of reading map bytes as header fields
+
+        std::string name = fileName + "_old_format";
+        remove(name.c_str());
+        fileNames.push_back(name);
+        std::vector<uint8_t> headerPage(PAGE_SIZE, 0);
+        unsigned oldHeader[5] = {1, 0, 0, 1, PAGE_SIZE};
+        memcpy(headerPage.data(), oldHeader, sizeof(oldHeader));
+        // free bytes of the one data page in the old map
+        headerPage[sizeof(oldHeader)] = 200;
+        std::vector<uint8_t> dataPage(PAGE_SIZE, 0);
+        FILE *fp = fopen(name.c_str(), "wb");
+        ASSERT_NE(fp, nullptr);
+        ASSERT_EQ(fwrite(headerPage.data(), PAGE_SIZE, 1, fp), 1);
+        ASSERT_EQ(fwrite(dataPage.data(), PAGE_SIZE, 1, fp), 1);
+        fclose(fp);
+
+        PeterDB::FileHandle fileHandle;
+        EXPECT_EQ(pfm.openFile(name, fileHandle), (PeterDB::RC) PeterDB::FILE_ERROR::FILE_FORMAT_UNSUPPORTED)
+                            << "A file of an older format should not be opened.";
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,47 @@
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F (PFM_Page_Test, free_space_map_past_header) {
+        // Functions Tested:
+        // 1. Append more pages than the header map covers, in one call and one by one
+        // 2. Pages read back across the chained FSM pages between them
+        // 3. Free space of pages past the header map is tracked, found and persisted
+
+        const unsigned headerMapSize = PeterDB::getHeaderMapSize(PAGE_SIZE);
+        const unsigned numPages = headerMapSize + PAGE_SIZE + 10;
+        std::vector<uint8_t> inBuffer(numPages * PAGE_SIZE), outBuffer(numPages * PAGE_SIZE);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i % 97 + 1, i % 89 + 3);
+        }
+        ASSERT_EQ(fileHandle.appendPages(numPages - 5, inBuffer.data()), success);
+        for (unsigned i = numPages - 5; i < numPages; i++) {
+            ASSERT_EQ(fileHandle.appendPage(inBuffer.data() + i * PAGE_SIZE), success);
+        }
+        ASSERT_EQ(fileHandle.getNumberOfPages(), numPages);
+        ASSERT_EQ(fileHandle.readPages(0, numPages, outBuffer.data()), success);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), numPages * PAGE_SIZE), 0);
+
+        // the last page of the header map, the first of each chained FSM page, the last one
+        std::vector<PeterDB::PageNum> pages{headerMapSize - 1, headerMapSize, headerMapSize + PAGE_SIZE, numPages - 1};
+        for (unsigned i = 0; i < pages.size(); i++) {
+            ASSERT_EQ(fileHandle.setPageFreeSpace(pages[i], (i + 1) * 512), success);
+        }
+        PeterDB::PageNum pageNum;
+        ASSERT_EQ(fileHandle.findPageWithFreeSpace(1500, headerMapSize, pageNum), success);
+        EXPECT_EQ(pageNum, headerMapSize + PAGE_SIZE) << "Pages past the header map should be found.";
+
+        reopenFile();
+        ASSERT_EQ(fileHandle.getNumberOfPages(), numPages);
+        for (unsigned i = 0; i < pages.size(); i++) {
+            unsigned freeBytes;
+            ASSERT_EQ(fileHandle.getPageFreeSpace(pages[i], freeBytes), success);
+            EXPECT_EQ(freeBytes, (i + 1) * 512) << "Free space of page " << pages[i] << " should be persisted.";
+            ASSERT_EQ(fileHandle.readPage(pages[i], outBuffer.data()), success);
+            EXPECT_EQ(memcmp(inBuffer.data() + pages[i] * PAGE_SIZE, outBuffer.data(), PAGE_SIZE), 0);
+        }
+        EXPECT_EQ(getFileSize(fileName), (numPages + 3) * PAGE_SIZE) << "Header, pages and two chained FSM pages.";
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,85 @@
+#include <thread>
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F (PFM_Page_Test, append_write_read_pages) {
+        // Functions Tested:
+        // 1. Append Pages in one call
+        // 2. Overwrite a range of pages in one call
+        // 3. Read Pages back, a dirty buffered page wins over the disk copy
+
+        const unsigned numPages = 100;
+        std::vector<uint8_t> inBuffer(numPages * PAGE_SIZE), outBuffer(numPages * PAGE_SIZE);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i + 1, i + 3);
+        }
+        ASSERT_EQ(fileHandle.appendPages(numPages, inBuffer.data()), success);
+        ASSERT_EQ(fileHandle.getNumberOfPages(), numPages);
+        ASSERT_EQ(fileHandle.readPages(0, numPages, outBuffer.data()), success);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), numPages * PAGE_SIZE), 0);
+
+        for (unsigned i = 10; i < 20; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i + 7, i + 11);
+        }
+        ASSERT_EQ(fileHandle.writePages(10, 10, inBuffer.data() + 10 * PAGE_SIZE), success);
+        EXPECT_NE(fileHandle.writePages(95, 10, inBuffer.data()), success) << "Writing past the end should fail.";
+
+        // page 15 is only in the buffer pool, page 16 only on disk after the reopen below
+        generateData(inBuffer.data() + 15 * PAGE_SIZE, PAGE_SIZE, 40, 50);
+        ASSERT_EQ(fileHandle.writePage(15, inBuffer.data() + 15 * PAGE_SIZE), success);
+        ASSERT_EQ(fileHandle.readPages(5, 20, outBuffer.data()), success);
+        EXPECT_EQ(memcmp(inBuffer.data() + 5 * PAGE_SIZE, outBuffer.data(), 20 * PAGE_SIZE), 0);
+
+        reopenFile();
+        ASSERT_EQ(fileHandle.readPages(0, numPages, outBuffer.data()), success);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), numPages * PAGE_SIZE), 0) << "Pages should be persisted.";
+
+        unsigned readCount, writeCount, appendCount;
+        ASSERT_EQ(fileHandle.collectCounterValues(readCount, writeCount, appendCount), success);
+        EXPECT_EQ(readCount, 2 * numPages + 20);
+        EXPECT_EQ(writeCount, 11);
+        EXPECT_EQ(appendCount, numPages);
+    }
+
+    TEST_F (PFM_Page_Test, concurrent_readers_one_handle) {
+        // Functions Tested:
+        // 1. Several threads read pages through the same handle
+        // 2. Every page comes back intact and the read counter is exact
+
+        const unsigned numPages = 64, numThreads = 4, rounds = 20;
+        std::vector<uint8_t> inBuffer(numPages * PAGE_SIZE);
+        for (unsigned i = 0; i < numPages; i++) {
+            generateData(inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE, i + 2, i + 5);
+        }
+        ASSERT_EQ(fileHandle.appendPages(numPages, inBuffer.data()), success);
+        PeterDB::BufferPool::instance().flushAll();
+
+        std::vector<unsigned> mismatches(numThreads, 0);
+        std::vector<std::thread> readers;
+        for (unsigned t = 0; t < numThreads; t++) {
+            readers.emplace_back([&, t]() {
+                std::vector<uint8_t> page(PAGE_SIZE), pages(8 * PAGE_SIZE);
+                for (unsigned r = 0; r < rounds; r++) {
+                    for (unsigned i = t; i < numPages; i += numThreads) {
+                        if (fileHandle.readPage(i, page.data()) != success ||
+                            memcmp(page.data(), inBuffer.data() + i * PAGE_SIZE, PAGE_SIZE) != 0)
+                            mismatches[t]++;
+                    }
+                    PeterDB::PageNum first = (t * 8 + r) % (numPages - 8);
+                    if (fileHandle.readPages(first, 8, pages.data()) != success ||
+                        memcmp(pages.data(), inBuffer.data() + first * PAGE_SIZE, 8 * PAGE_SIZE) != 0)
+                        mismatches[t]++;
+                }
+            });
+        }
+        for (auto &reader: readers) reader.join();
+        for (unsigned t = 0; t < numThreads; t++) EXPECT_EQ(mismatches[t], 0) << "Thread " << t;
+
+        unsigned readCount, writeCount, appendCount;
+        ASSERT_EQ(fileHandle.collectCounterValues(readCount, writeCount, appendCount), success);
+        EXPECT_EQ(readCount, rounds * (numPages + numThreads * 8));
+    }
+
+} // namespace PeterDBTesting
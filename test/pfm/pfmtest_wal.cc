@@ -0,0 +1,60 @@
+#include <thread>
+#include "src/include/pfm.h"
+#include "test/utils/pfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F (PFM_Page_Test, group_commit) {
+        // Functions Tested:
+        // 1. Several threads commit logged page writes at the same time
+        // 2. Every commit is durable, but commits share syncs of the log
+        // 3. Closing the log checkpoints and empties it
+
+        const std::string logFileName = "pfm_test_wal_log";
+        const unsigned numThreads = 8, numOperations = 50;
+        remove(logFileName.c_str());
+        std::vector<uint8_t> inBuffer(numThreads * PAGE_SIZE, 0);
+        ASSERT_EQ(fileHandle.appendPages(numThreads, inBuffer.data()), success);
+
+        PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+        ASSERT_EQ(logManager.open(logFileName), success);
+        EXPECT_NE(logManager.open(logFileName), success) << "The log is open already.";
+        logManager.setGroupCommitDelay(1000);
+        unsigned commitCount, syncCount, checkpointCount;
+        ASSERT_EQ(logManager.collectCounterValues(commitCount, syncCount, checkpointCount), success);
+        const unsigned commitsBefore = commitCount, syncsBefore = syncCount;
+
+        // every thread changes its own page
+        std::vector<unsigned> failures(numThreads, 0);
+        std::vector<std::thread> writers;
+        for (unsigned t = 0; t < numThreads; t++) {
+            writers.emplace_back([&, t]() {
+                std::vector<uint8_t> page(PAGE_SIZE, 0);
+                for (unsigned i = 0; i < numOperations; i++) {
+                    PeterDB::LogOperation operation(PeterDB::LOG_OP_RBFM_UPDATE);
+                    generateData(page.data(), 64, t + i + 1, t + 1);
+                    if (fileHandle.writePage(t, page.data()) != success || operation.commit() != success) failures[t]++;
+                }
+                memcpy(inBuffer.data() + t * PAGE_SIZE, page.data(), PAGE_SIZE);
+            });
+        }
+        for (auto &writer: writers) writer.join();
+        for (unsigned t = 0; t < numThreads; t++) EXPECT_EQ(failures[t], 0) << "Thread " << t;
+
+        ASSERT_EQ(logManager.collectCounterValues(commitCount, syncCount, checkpointCount), success);
+        EXPECT_EQ(commitCount - commitsBefore, numThreads * numOperations);
+        EXPECT_LT(syncCount - syncsBefore, commitCount - commitsBefore) << "Commits should be grouped.";
+        EXPECT_GT(logManager.getLogSize(), 0);
+
+        logManager.setGroupCommitDelay(0);
+        ASSERT_EQ(logManager.close(), success);
+        EXPECT_FALSE(logManager.isOpen());
+        EXPECT_EQ(getFileSize(logFileName), 0) << "A checkpoint should empty the log.";
+        reopenFile();
+        std::vector<uint8_t> outBuffer(numThreads * PAGE_SIZE);
+        ASSERT_EQ(fileHandle.readPages(0, numThreads, outBuffer.data()), success);
+        EXPECT_EQ(memcmp(inBuffer.data(), outBuffer.data(), numThreads * PAGE_SIZE), 0);
+        remove(logFileName.c_str());
+    }
+
+} // namespace PeterDBTesting
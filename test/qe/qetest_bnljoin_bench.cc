@@ -0,0 +1,100 @@
+#include <chrono>
+#include <fstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "test/utils/qe_test_util.h"
+
+namespace PeterDBTesting {
+
+    // outcome of one block size, sent back by the child process that ran it
+    struct BNLJoinRun {
+        unsigned count;
+        int lastB;
+        bool sameKeys;
+        double seconds;
+        long peakGrowthKB;      // peak RSS of the run minus the RSS it started with
+    };
+
+    static long currentRSSKB() {
+        long size = 0, resident = 0;
+        std::ifstream statm("/proc/self/statm");
+        statm >> size >> resident;
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    TEST_F(QE_Test, bnljoin_block_sizes) {
+        // 1. BNLJoin -- on TypeInt Attribute with several block sizes
+        // 2. Every block size returns the same tuples, throughput and peak RSS growth are logged
+        // 3. Each block size runs in its own child process, ru_maxrss is a peak of the whole process
+        // SELECT * from left, right WHERE left.B = right.B
+
+        inBuffer = malloc(bufSize);
+        outBuffer = malloc(bufSize);
+
+        unsigned numOfTuples = 5000;
+        createAndPopulateTable("left", {}, numOfTuples);
+        createAndPopulateTable("right", {}, numOfTuples);
+
+        unsigned expected = 0;
+        for (unsigned i = 0; i < numOfTuples; i++) {
+            for (unsigned j = 0; j < numOfTuples; j++) {
+                if ((i + 10) % 197 == j % 251 + 20) expected++;
+            }
+        }
+
+        // the children must not share an io_uring instance with the parent
+        ASSERT_EQ(PeterDB::BufferPool::instance().setIOEngine(PeterDB::IO_ENGINE_SYNC), success);
+        ASSERT_EQ(PeterDB::PagedFileManager::instance().flushAll(), success);
+        ASSERT_EQ(PeterDB::BufferPool::instance().flushAll(), success);
+
+        PeterDB::Condition cond{"left.B", PeterDB::EQ_OP, true, "right.B"};
+        for (unsigned numPages: {1u, 10u, 100u}) {
+            int fds[2];
+            ASSERT_EQ(pipe(fds), 0);
+            pid_t pid = fork();
+            ASSERT_GE(pid, 0);
+            if (pid == 0) {
+                close(fds[0]);
+                BNLJoinRun run{0, -1, true, 0, 0};
+                long startKB = currentRSSKB();
+                auto start = std::chrono::steady_clock::now();
+                {
+                    PeterDB::TableScan leftIn(rm, "left");
+                    PeterDB::TableScan rightIn(rm, "right");
+                    PeterDB::BNLJoin bnlJoin(&leftIn, &rightIn, cond, numPages);
+                    while (bnlJoin.getNextTuple(outBuffer) != QE_EOF) {
+                        // left.B and right.B sit right after the null byte and left.A
+                        int leftB = *(int *) ((char *) outBuffer + 1 + sizeof(int));
+                        int rightB = *(int *) ((char *) outBuffer + 1 + 3 * sizeof(int));
+                        if (leftB != rightB) run.sameKeys = false;
+                        run.lastB = leftB;
+                        run.count++;
+                    }
+                }
+                run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                struct rusage usage{};
+                getrusage(RUSAGE_SELF, &usage);
+                run.peakGrowthKB = usage.ru_maxrss - startKB;
+                _exit(write(fds[1], &run, sizeof(run)) == sizeof(run) ? 0 : 1);
+            }
+            close(fds[1]);
+            BNLJoinRun run{};
+            ssize_t readSize = read(fds[0], &run, sizeof(run));
+            close(fds[0]);
+            int status;
+            ASSERT_EQ(waitpid(pid, &status, 0), pid);
+            ASSERT_TRUE(WIFEXITED(status));
+            ASSERT_EQ(WEXITSTATUS(status), 0) << "The child process failed.";
+            ASSERT_EQ(readSize, (ssize_t) sizeof(run));
+
+            GTEST_LOG_(INFO) << "numPages " << numPages << ": " << run.count << " tuples, "
+                             << (long) (run.count / std::max(run.seconds, 1e-6)) << " tuples/s, peak RSS growth "
+                             << run.peakGrowthKB << " KB";
+            EXPECT_TRUE(run.sameKeys) << "Joined tuples should have the same key.";
+            EXPECT_EQ(run.count, expected) << "The number of returned tuple is not correct, last key " << run.lastB;
+        }
+        PeterDB::BufferPool::instance().setIOEngine(PeterDB::DEFAULT_IO_ENGINE);
+    }
+
+} // namespace PeterDBTesting
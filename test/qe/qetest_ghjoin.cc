@@ -0,0 +1,115 @@
+#include "test/utils/qe_test_util.h"
+
+namespace PeterDBTesting {
+
+    // rows of SELECT * from left, right WHERE left.B = right.B for tables from createAndPopulateTable
+    static std::vector<std::string> expectedJoinOnB(int numOfTuples) {
+        std::vector<std::string> expected;
+        for (int i = 0; i < numOfTuples; i++) {
+            unsigned a = i % 203;
+            unsigned b1 = (i + 10) % 197;
+            float c1 = (float) (i % 167) + 50.5f;
+            for (int j = 0; j < numOfTuples; j++) {
+                unsigned b2 = j % 251 + 20;
+                float c2 = (float) (j % 261) + 25.5f;
+                unsigned d = j % 179;
+                if (b1 == b2) {
+                    expected.emplace_back(
+                            "left.A: " + std::to_string(a) + ", left.B: " + std::to_string(b1) + ", left.C: " +
+                            std::to_string(c1) + ", right.B: " + std::to_string(b2) + ", right.C: " +
+                            std::to_string(c2) + ", right.D: " + std::to_string(d));
+                }
+            }
+        }
+        return expected;
+    }
+
+    TEST_F(QE_Test, ghjoin_with_recursive_partitioning) {
+        // 1. GHJoin -- on TypeInt Attribute, partitions overflow the build memory and are partitioned again
+        // SELECT * from left, right WHERE left.B = right.B
+
+        inBuffer = malloc(bufSize);
+        outBuffer = malloc(bufSize);
+
+        unsigned numPartitions = 3;
+        unsigned numOfTuples = 4000;
+
+        createAndPopulateTable("left", {}, numOfTuples);
+        createAndPopulateTable("right", {}, numOfTuples);
+
+        PeterDB::TableScan leftIn(rm, "left");
+        PeterDB::TableScan rightIn(rm, "right");
+        PeterDB::Condition cond{"left.B", PeterDB::EQ_OP, true, "right.B"};
+
+        int numFiles = (int) glob("").size();
+        // a single page of build memory, every first level partition has to be split up
+        auto *ghJoin = new PeterDB::GHJoin(&leftIn, &rightIn, cond, numPartitions, 1);
+
+        std::vector<std::string> printed;
+        ASSERT_EQ(ghJoin->getAttributes(attrs), success) << "GHJoin.getAttributes() should succeed.";
+        while (ghJoin->getNextTuple(outBuffer) != QE_EOF) {
+            std::stringstream stream;
+            ASSERT_EQ(rm.printTuple(attrs, outBuffer, stream), success)
+                                        << "RelationManager.printTuple() should succeed.";
+            printed.emplace_back(stream.str());
+            memset(outBuffer, 0, bufSize);
+        }
+        ASSERT_GT(glob("").size(), numFiles + 2 * numPartitions) << "Partitions should have been split further.";
+
+        std::vector<std::string> expected = expectedJoinOnB(numOfTuples);
+        sort(expected.begin(), expected.end());
+        sort(printed.begin(), printed.end());
+
+        ASSERT_EQ(expected.size(), printed.size()) << "The number of returned tuple is not correct.";
+        for (int i = 0; i < expected.size(); ++i) {
+            checkPrintRecord(expected[i], printed[i], false, {}, i % 5000 == 0);
+        }
+
+        delete ghJoin;
+        ASSERT_EQ(glob("").size(), numFiles) << "GHJoin should clean after itself.";
+    }
+
+    TEST_F(QE_Test, ghjoin_single_partition_over_build_memory) {
+        // 1. GHJoin -- a single partition larger than the build memory is not partitioned again,
+        //    its build side is joined block by block
+
+        inBuffer = malloc(bufSize);
+        outBuffer = malloc(bufSize);
+
+        unsigned numOfTuples = 2000;
+
+        createAndPopulateTable("left", {}, numOfTuples);
+        createAndPopulateTable("right", {}, numOfTuples);
+
+        PeterDB::TableScan leftIn(rm, "left");
+        PeterDB::TableScan rightIn(rm, "right");
+        PeterDB::Condition cond{"left.B", PeterDB::EQ_OP, true, "right.B"};
+
+        int numFiles = (int) glob("").size();
+        auto *ghJoin = new PeterDB::GHJoin(&leftIn, &rightIn, cond, 1, 1);
+
+        std::vector<std::string> printed;
+        ASSERT_EQ(ghJoin->getAttributes(attrs), success) << "GHJoin.getAttributes() should succeed.";
+        while (ghJoin->getNextTuple(outBuffer) != QE_EOF) {
+            std::stringstream stream;
+            ASSERT_EQ(rm.printTuple(attrs, outBuffer, stream), success)
+                                        << "RelationManager.printTuple() should succeed.";
+            printed.emplace_back(stream.str());
+            memset(outBuffer, 0, bufSize);
+        }
+        ASSERT_EQ(glob("").size(), numFiles + 2) << "A single partition should not be split.";
+
+        std::vector<std::string> expected = expectedJoinOnB(numOfTuples);
+        sort(expected.begin(), expected.end());
+        sort(printed.begin(), printed.end());
+
+        ASSERT_EQ(expected.size(), printed.size()) << "The number of returned tuple is not correct.";
+        for (int i = 0; i < expected.size(); ++i) {
+            checkPrintRecord(expected[i], printed[i], false, {}, i % 5000 == 0);
+        }
+
+        delete ghJoin;
+        ASSERT_EQ(glob("").size(), numFiles) << "GHJoin should clean after itself.";
+    }
+
+} // namespace PeterDBTesting
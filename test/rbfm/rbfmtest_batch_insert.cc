@@ -0,0 +1,61 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, insert_records_in_batch) {
+        // Functions tested
+        // 1. Insert one record, then a batch of records with insertRecords
+        // 2. The batch tops up the last page, then every new page is appended once
+        // 3. Every record can be read back at the returned rid
+
+        const unsigned numRecords = 5000;
+        PeterDB::RID rid;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        insertRecord(recordDescriptor, rid, "first");
+        ASSERT_EQ(fileHandle.getNumberOfPages(), 1);
+
+        std::vector<std::string> names;
+        std::vector<std::vector<uint8_t>> records(numRecords);
+        std::vector<const void *> data;
+        for (unsigned i = 0; i < numRecords; i++) {
+            names.push_back("batch" + std::to_string(i) + std::string(i % 17, 'b'));
+            size_t recordSize;
+            prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) names[i].length(), names[i], 25, 177.8,
+                          6200, inBuffer, recordSize);
+            records[i].assign((uint8_t *) inBuffer, (uint8_t *) inBuffer + recordSize);
+            data.push_back(records[i].data());
+        }
+
+        unsigned readBefore, writeBefore, appendBefore, readAfter, writeAfter, appendAfter;
+        ASSERT_EQ(fileHandle.collectCounterValues(readBefore, writeBefore, appendBefore), success);
+        std::vector<PeterDB::RID> rids;
+        ASSERT_EQ(rbfm.insertRecords(fileHandle, recordDescriptor, data, rids), success)
+                                    << "Inserting a batch of records should succeed.";
+        ASSERT_EQ(fileHandle.collectCounterValues(readAfter, writeAfter, appendAfter), success);
+        ASSERT_EQ(rids.size(), numRecords);
+
+        unsigned numPages = fileHandle.getNumberOfPages();
+        GTEST_LOG_(INFO) << numRecords << " records on " << numPages << " pages: " << writeAfter - writeBefore
+                         << " writes, " << appendAfter - appendBefore << " appends";
+        EXPECT_GT(numPages, 10);
+        EXPECT_EQ(rids[0].pageNum, 0) << "The batch should fill the last page first.";
+        EXPECT_EQ(writeAfter - writeBefore, 1) << "Only the last page should be written over.";
+        EXPECT_EQ(appendAfter - appendBefore, numPages - 1) << "Every new page should be appended once.";
+
+        ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rid, "first"));
+        for (unsigned i = 0; i < numRecords; i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+        // the free-space map knows about the new pages
+        unsigned freeBytes;
+        ASSERT_EQ(fileHandle.getPageFreeSpace(numPages - 1, freeBytes), success);
+        EXPECT_GT(freeBytes, 0);
+    }
+
+} // namespace PeterDBTesting
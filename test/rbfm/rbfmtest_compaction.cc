@@ -0,0 +1,82 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, lazy_page_compaction) {
+        // Functions tested
+        // 1. Fill one page, delete and shrink records: the other records stay where they are
+        // 2. The dead bytes are counted as free space of the page
+        // 3. Grow records until the page has to be compacted, then insert the deleted records again
+        // 4. Every remaining record can be read back, before and after reopening the file
+
+        PeterDB::RID rid;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::vector<PeterDB::RID> rids;
+        std::vector<std::string> names;
+        unsigned freeBytes = PAGE_SIZE;
+        while (freeBytes > 200) {
+            std::string name(100 + rids.size() % 7, 'a' + rids.size() % 26);
+            insertRecord(recordDescriptor, rid, name);
+            rids.push_back(rid);
+            names.push_back(name);
+            ASSERT_EQ(fileHandle.getPageFreeSpace(0, freeBytes), success);
+        }
+        ASSERT_EQ(fileHandle.getNumberOfPages(), 1);
+
+        std::vector<int32_t> offsets;
+        {
+            PeterDB::PageHelper page(fileHandle, 0);
+            for (unsigned i = 0; i < rids.size(); i++) offsets.push_back(page.getRecordBeginPos(rids[i].slotNum));
+        }
+
+        for (unsigned i = 0; i < rids.size(); i += 2) {
+            ASSERT_EQ(rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]), success);
+        }
+        for (unsigned i = 1; i < rids.size(); i += 4) {
+            names[i].resize(10);
+            ASSERT_NO_FATAL_FAILURE(updateRecord(recordDescriptor, rids[i], names[i]));
+        }
+        {
+            PeterDB::PageHelper page(fileHandle, 0);
+            EXPECT_GT(page.fragmentedBytes, PAGE_SIZE / 2) << "Deleted bytes should be left in place.";
+            for (unsigned i = 1; i < rids.size(); i += 2) {
+                EXPECT_EQ(page.getRecordBeginPos(rids[i].slotNum), offsets[i])
+                                    << "A delete or shrink should not move the other records.";
+            }
+            EXPECT_GE(page.getFreeSpaceForRecord(), page.getContiguousFreeSpace() + page.fragmentedBytes - 8);
+        }
+
+        // the page has no contiguous room left for the grown records, they only stay by compacting it
+        for (unsigned i = 3; i < rids.size(); i += 4) {
+            names[i].resize(250, 'z');
+            ASSERT_NO_FATAL_FAILURE(updateRecord(recordDescriptor, rids[i], names[i]));
+        }
+        {
+            PeterDB::PageHelper page(fileHandle, 0);
+            for (unsigned i = 3; i < rids.size(); i += 4) {
+                EXPECT_TRUE(page.isRecordData(rids[i].slotNum)) << "A grown record should stay on its page.";
+            }
+            EXPECT_LT(page.fragmentedBytes, PAGE_SIZE / 4) << "The page should have been compacted.";
+        }
+        EXPECT_EQ(fileHandle.getNumberOfPages(), 1);
+
+        for (unsigned i = 0; i < rids.size(); i += 2) {
+            insertRecord(recordDescriptor, rids[i], names[i]);
+        }
+        for (unsigned i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        for (unsigned i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+    }
+
+} // namespace PeterDBTesting
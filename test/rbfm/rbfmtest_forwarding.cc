@@ -0,0 +1,109 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class RBFM_Forwarding_Test : public RBFM_Test {
+    protected:
+        std::vector<PeterDB::RID> rids;
+        std::vector<std::string> names;
+
+        // insert small records until the file has numPages pages, the page before the last one is then full
+        void fillUntil(const std::vector<PeterDB::Attribute> &recordDescriptor, unsigned numPages) {
+            PeterDB::RID rid;
+            while (fileHandle.getNumberOfPages() < numPages) {
+                names.push_back(std::string(20, 'a' + rids.size() % 26));
+                insertRecord(recordDescriptor, rid, names.back());
+                rids.push_back(rid);
+            }
+        }
+
+        // the original slot should point straight at a data record on the given page
+        void expectOneHop(const PeterDB::RID &rid, unsigned pageNum) {
+            uint32_t targetPage;
+            uint16_t targetSlot;
+            PeterDB::PageHelper homePage(fileHandle, rid.pageNum);
+            ASSERT_TRUE(homePage.isRecordPointer(rid.slotNum)) << "The moved record should leave a pointer.";
+            ASSERT_EQ(homePage.getRecordPointer(rid.slotNum, targetPage, targetSlot), success);
+            EXPECT_EQ(targetPage, pageNum);
+            PeterDB::PageHelper targetPageHelper(fileHandle, targetPage);
+            EXPECT_TRUE(targetPageHelper.isRecordData(targetSlot)) << "The pointer should lead to the data.";
+        }
+    };
+
+    TEST_F(RBFM_Forwarding_Test, update_keeps_one_hop) {
+        // Functions tested
+        // 1. Grow a record until it leaves its page, then grow it again on two more pages
+        // 2. The original slot always points straight at the record and the old copies are deleted
+        // 3. Once its page has room again the record goes back to its rid
+        // 4. Every record can be read back
+
+        PeterDB::RID rid;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::string moved(10, 'm');
+        PeterDB::RID movedRid;
+        insertRecord(recordDescriptor, movedRid, moved);
+        ASSERT_NO_FATAL_FAILURE(fillUntil(recordDescriptor, 2));
+
+        moved.assign(1500, 'm');
+        ASSERT_NO_FATAL_FAILURE(updateRecord(recordDescriptor, movedRid, moved));
+        ASSERT_NO_FATAL_FAILURE(expectOneHop(movedRid, 1));
+        ASSERT_NO_FATAL_FAILURE(fillUntil(recordDescriptor, 3));
+
+        uint32_t oldPage;
+        uint16_t oldSlot;
+        {
+            PeterDB::PageHelper homePage(fileHandle, movedRid.pageNum);
+            homePage.getRecordPointer(movedRid.slotNum, oldPage, oldSlot);
+        }
+        moved.assign(2500, 'n');
+        ASSERT_NO_FATAL_FAILURE(updateRecord(recordDescriptor, movedRid, moved));
+        ASSERT_NO_FATAL_FAILURE(expectOneHop(movedRid, 2));
+        {
+            PeterDB::PageHelper oldCopyPage(fileHandle, oldPage);
+            EXPECT_TRUE(oldCopyPage.isRecordDeleted(oldSlot)) << "The previous copy should be deleted.";
+        }
+        ASSERT_NO_FATAL_FAILURE(fillUntil(recordDescriptor, 4));
+        ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, movedRid, moved));
+
+        // free the original page, the next move takes the record home
+        std::vector<PeterDB::RID> kept;
+        std::vector<std::string> keptNames;
+        for (unsigned i = 0; i < rids.size(); i++) {
+            if (rids[i].pageNum == movedRid.pageNum) {
+                ASSERT_EQ(rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]), success);
+            } else {
+                kept.push_back(rids[i]);
+                keptNames.push_back(names[i]);
+            }
+        }
+        moved.assign(3000, 'o');
+        ASSERT_NO_FATAL_FAILURE(updateRecord(recordDescriptor, movedRid, moved));
+        {
+            PeterDB::PageHelper homePage(fileHandle, movedRid.pageNum);
+            EXPECT_TRUE(homePage.isRecordData(movedRid.slotNum)) << "The record should be back at its rid.";
+            EXPECT_TRUE(homePage.isOriginal(movedRid.slotNum));
+        }
+
+        ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, movedRid, moved));
+        for (unsigned i = 0; i < kept.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, kept[i], keptNames[i]));
+        }
+
+        // a scan returns the moved record once
+        PeterDB::RBFM_ScanIterator scanIterator;
+        std::vector<std::string> attrNames{"EmpName"};
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, "", PeterDB::NO_OP, nullptr, attrNames, scanIterator),
+                  success);
+        unsigned count = 0;
+        while (scanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) count++;
+        EXPECT_EQ(count, kept.size() + 1);
+        scanIterator.close();
+    }
+
+} // namespace PeterDBTesting
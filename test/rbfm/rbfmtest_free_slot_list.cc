@@ -0,0 +1,49 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, reuse_deleted_slots) {
+        // Functions tested
+        // 1. Insert records into one page and delete a few of them
+        // 2. New records take the deleted slots, the last deleted one first
+        // 3. Once the chain is empty a new slot is added
+        // 4. The records that were not deleted keep their rids
+
+        PeterDB::RID rid;
+        inBuffer = malloc(1000);
+        outBuffer = malloc(1000);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::vector<PeterDB::RID> rids;
+        std::vector<std::string> names;
+        for (unsigned i = 0; i < 20; i++) {
+            names.push_back(std::string(20 + i, 'a' + i));
+            insertRecord(recordDescriptor, rid, names.back());
+            ASSERT_EQ(rid.pageNum, 0);
+            ASSERT_EQ(rid.slotNum, i + 1);
+            rids.push_back(rid);
+        }
+
+        const std::vector<unsigned> deleted{3, 17, 8};
+        for (unsigned i: deleted) {
+            ASSERT_EQ(rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]), success);
+        }
+        for (auto it = deleted.rbegin(); it != deleted.rend(); it++) {
+            names[*it] = std::string(30, 'z');
+            insertRecord(recordDescriptor, rid, names[*it]);
+            EXPECT_EQ(rid.pageNum, 0);
+            EXPECT_EQ(rid.slotNum, rids[*it].slotNum) << "Deleted slots should be reused in LIFO order.";
+        }
+        insertRecord(recordDescriptor, rid, "tail");
+        EXPECT_EQ(rid.slotNum, rids.size() + 1) << "A new slot should be added when none is free.";
+
+        for (unsigned i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+        ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rid, "tail"));
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,59 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, reuse_space_from_free_space_map) {
+        // Functions tested
+        // 1. Insert records over several pages
+        // 2. Delete every record of the first page
+        // 3. Insert again, the first page should be picked without growing the file
+        // 4. The free-space map survives reopening the file
+
+        PeterDB::RID rid;
+        inBuffer = malloc(1000);
+        outBuffer = malloc(1000);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        const std::string name(200, 'a');
+        std::vector<PeterDB::RID> firstPageRids;
+        while (fileHandle.getNumberOfPages() < 3) {
+            insertRecord(recordDescriptor, rid, name);
+            if (rid.pageNum == 0) firstPageRids.push_back(rid);
+        }
+        unsigned numPages = fileHandle.getNumberOfPages();
+
+        unsigned freeBytes = 0;
+        ASSERT_EQ(fileHandle.getPageFreeSpace(0, freeBytes), success);
+        EXPECT_LT(freeBytes, 300) << "The first page should be almost full.";
+
+        for (const PeterDB::RID &r: firstPageRids) {
+            ASSERT_EQ(rbfm.deleteRecord(fileHandle, recordDescriptor, r), success)
+                                        << "Deleting a record should succeed.";
+        }
+        ASSERT_EQ(fileHandle.getPageFreeSpace(0, freeBytes), success);
+        EXPECT_GT(freeBytes, PAGE_SIZE / 2) << "The free-space map should track deletions.";
+
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        unsigned freeBytesAfterReopen = 0;
+        ASSERT_EQ(fileHandle.getPageFreeSpace(0, freeBytesAfterReopen), success);
+        EXPECT_EQ(freeBytesAfterReopen, freeBytes) << "The free-space map should be persisted.";
+
+        // last page is full as well, so the map has to point back to page 0
+        while (true) {
+            unsigned lastFree = 0;
+            ASSERT_EQ(fileHandle.getPageFreeSpace(numPages - 1, lastFree), success);
+            if (lastFree < 300) break;
+            insertRecord(recordDescriptor, rid, name);
+            ASSERT_EQ(fileHandle.getNumberOfPages(), numPages);
+        }
+        insertRecord(recordDescriptor, rid, name);
+        EXPECT_EQ(rid.pageNum, 0) << "The freed page should be reused.";
+        EXPECT_EQ(fileHandle.getNumberOfPages(), numPages) << "No page should be appended.";
+        ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rid, name));
+    }
+
+} // namespace PeterDBTesting
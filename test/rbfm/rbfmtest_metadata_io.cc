@@ -0,0 +1,104 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    // Number of write syscalls issued by this process so far, read from /proc/self/io
+    static bool getWriteSyscalls(unsigned long long &count) {
+        std::ifstream io("/proc/self/io");
+        std::string key;
+        unsigned long long value;
+        while (io >> key >> value) {
+            if (key == "syscw:") {
+                count = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    class RBFM_Metadata_IO_Test : public RBFM_Test {
+    protected:
+        const int numRecords = 2000;
+        std::vector<PeterDB::Attribute> recordDescriptor;
+
+        void insertRecords() {
+            PeterDB::RID rid;
+            inBuffer = malloc(1000);
+            outBuffer = malloc(1000);
+            rids.clear();
+            sizes.clear();
+            createLargeRecordDescriptor(recordDescriptor);
+            nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+            for (int i = 0; i < numRecords; i++) {
+                int size = 0;
+                memset(inBuffer, 0, 1000);
+                prepareLargeRecord((int) recordDescriptor.size(), nullsIndicator, i, inBuffer, &size);
+                ASSERT_EQ(rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid), success)
+                                            << "Inserting a record should succeed.";
+                rids.push_back(rid);
+                sizes.push_back(size);
+            }
+            // nothing dirty is left behind, the read pass below should not have to write anything
+            ASSERT_EQ(fileHandle.checkpoint(), success) << "Checkpoint should succeed.";
+        }
+
+        // read every record once, return the write syscalls and time spent
+        void readRecords(unsigned long long &writes, long long &micros) {
+            unsigned long long before = 0, after = 0;
+            ASSERT_TRUE(getWriteSyscalls(before));
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < numRecords; i++) {
+                ASSERT_EQ(rbfm.readRecord(fileHandle, recordDescriptor, rids[i], outBuffer), success)
+                                            << "Reading a record should succeed.";
+            }
+            auto end = std::chrono::steady_clock::now();
+            ASSERT_TRUE(getWriteSyscalls(after));
+            writes = after - before;
+            micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        }
+    };
+
+    TEST_F(RBFM_Metadata_IO_Test, read_workload_write_syscalls) {
+        // Functions tested
+        // 1. Insert Multiple Records
+        // 2. Read them with deferred metadata (default)
+        // 3. Read them again persisting the header on every page operation
+        // 4. Counters survive reopening the file
+
+        unsigned long long probe;
+        if (!getWriteSyscalls(probe)) GTEST_SKIP() << "/proc/self/io is not available.";
+
+        ASSERT_NO_FATAL_FAILURE(insertRecords());
+
+        unsigned long long deferredWrites = 0, eagerWrites = 0;
+        long long deferredMicros = 0, eagerMicros = 0;
+
+        ASSERT_NO_FATAL_FAILURE(readRecords(deferredWrites, deferredMicros));
+
+        fileHandle.setMetadataFlushInterval(1);
+        ASSERT_NO_FATAL_FAILURE(readRecords(eagerWrites, eagerMicros));
+        fileHandle.setMetadataFlushInterval(PeterDB::DEFAULT_METADATA_FLUSH_INTERVAL);
+
+        GTEST_LOG_(INFO) << "Reading " << numRecords << " records, deferred metadata: " << deferredWrites
+                         << " write syscalls in " << deferredMicros << " us";
+        GTEST_LOG_(INFO) << "Reading " << numRecords << " records, flush on every page: " << eagerWrites
+                         << " write syscalls in " << eagerMicros << " us";
+
+        EXPECT_EQ(deferredWrites, 0) << "A read-only workload should not write.";
+        EXPECT_GE(eagerWrites, (unsigned long long) numRecords);
+
+        // the counters are persisted on close
+        unsigned readCount, writeCount, appendCount;
+        ASSERT_EQ(fileHandle.collectCounterValues(readCount, writeCount, appendCount), success);
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        unsigned readCountAfter, writeCountAfter, appendCountAfter;
+        ASSERT_EQ(fileHandle.collectCounterValues(readCountAfter, writeCountAfter, appendCountAfter), success);
+        EXPECT_EQ(readCountAfter, readCount);
+        EXPECT_EQ(writeCountAfter, writeCount);
+        EXPECT_EQ(appendCountAfter, appendCount);
+    }
+
+} // namespace PeterDBTesting
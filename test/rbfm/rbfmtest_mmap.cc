@@ -0,0 +1,67 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, mapped_file_insert_update_scan) {
+        // Functions tested
+        // 1. Map the file, insert records over several pages and read them back
+        // 2. Grow some records so that they move to another page
+        // 3. Scan the mapped file
+        // 4. Unmap, the records are read back through the buffer pool
+
+        PeterDB::RID rid;
+        inBuffer = malloc(1000);
+        outBuffer = malloc(1000);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        ASSERT_EQ(fileHandle.setMapped(true), success) << "Mapping the file should succeed.";
+        ASSERT_TRUE(fileHandle.isMapped());
+
+        std::vector<PeterDB::RID> rids;
+        std::vector<std::string> names;
+        while (fileHandle.getNumberOfPages() < 8) {
+            std::string name = std::to_string(rids.size());
+            name.resize(60, 'a');
+            insertRecord(recordDescriptor, rid, name);
+            rids.push_back(rid);
+            names.push_back(name);
+        }
+
+        unsigned rc, wc, ac, hit, miss, evict, hitAfter, missAfter;
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hit, miss, evict), success);
+        for (size_t i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+        ASSERT_EQ(fileHandle.collectCounterValues(rc, wc, ac, hitAfter, missAfter, evict), success);
+        EXPECT_EQ(hitAfter, hit) << "Mapped pages should not go through the buffer pool.";
+        EXPECT_EQ(missAfter, miss);
+
+        // the first page is full, a grown record has to move
+        for (size_t i = 0; i < rids.size(); i += 7) {
+            names[i].resize(400, 'b');
+            ASSERT_NO_FATAL_FAILURE(updateRecord(recordDescriptor, rids[i], names[i]));
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+
+        PeterDB::RBFM_ScanIterator rbfmScanIterator;
+        std::vector<std::string> attributes{"EmpName"};
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, "", PeterDB::NO_OP, nullptr, attributes,
+                            rbfmScanIterator), success) << "RecordBasedFileManager::scan() should succeed.";
+        unsigned numReturned = 0;
+        while (rbfmScanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) numReturned++;
+        EXPECT_EQ(numReturned, rids.size());
+        ASSERT_EQ(rbfmScanIterator.close(), success);
+
+        ASSERT_EQ(fileHandle.setMapped(false), success);
+        ASSERT_FALSE(fileHandle.isMapped());
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        for (size_t i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+    }
+
+} // namespace PeterDBTesting
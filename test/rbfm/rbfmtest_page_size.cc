@@ -0,0 +1,76 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, large_page_insert_update_scan) {
+        // Functions tested
+        // 1. Create File with an unsupported page size fails, 64 KB pages are fine
+        // 2. Insert records that would not fit into a default page, read them back
+        // 3. Grow some records so that they move to another page
+        // 4. Scan, then reopen the file and read every record again
+
+        const unsigned pageSize = 65536;
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        ASSERT_EQ(rbfm.destroyFile(fileName), success);
+        ASSERT_NE(rbfm.createFile(fileName, 3000), success) << "A page size that is not a power of two should fail.";
+        ASSERT_NE(rbfm.createFile(fileName, 2 * MAX_PAGE_SIZE), success) << "A page size above the max should fail.";
+        ASSERT_EQ(rbfm.createFile(fileName, pageSize), success);
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        ASSERT_EQ(fileHandle.getPageSize(), pageSize);
+
+        PeterDB::RID rid;
+        inBuffer = malloc(pageSize);
+        outBuffer = malloc(pageSize);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::vector<PeterDB::RID> rids;
+        std::vector<std::string> names;
+        for (unsigned i = 0; i < 300; i++) {
+            std::string name = std::to_string(i);
+            name.resize(i % 10 == 0 ? 6000 : 500, 'a' + i % 26);
+            insertRecord(recordDescriptor, rid, name);
+            rids.push_back(rid);
+            names.push_back(name);
+        }
+        EXPECT_GT(fileHandle.getNumberOfPages(), 1);
+        EXPECT_LT(fileHandle.getNumberOfPages(), 8) << "Records should be packed into the large pages.";
+        for (size_t i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+
+        size_t recordSize;
+        std::string tooLarge(40000, 'z');
+        prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) tooLarge.length(), tooLarge, 25, 177.8,
+                      6200, inBuffer, recordSize);
+        EXPECT_NE(rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid), success)
+                            << "A record above the max record size should be rejected.";
+
+        for (size_t i = 0; i < rids.size(); i += 9) {
+            names[i].resize(20000, 'b');
+            ASSERT_NO_FATAL_FAILURE(updateRecord(recordDescriptor, rids[i], names[i]));
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+
+        PeterDB::RBFM_ScanIterator rbfmScanIterator;
+        std::vector<std::string> attributes{"EmpName", "Salary"};
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, "", PeterDB::NO_OP, nullptr, attributes,
+                            rbfmScanIterator), success) << "RecordBasedFileManager::scan() should succeed.";
+        unsigned numReturned = 0;
+        while (rbfmScanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) numReturned++;
+        EXPECT_EQ(numReturned, rids.size());
+        ASSERT_EQ(rbfmScanIterator.close(), success);
+
+        unsigned numPages = fileHandle.getNumberOfPages();
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        EXPECT_EQ(getFileSize(fileName), (numPages + 1) * pageSize) << "Every page, header included, is 64 KB.";
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        ASSERT_EQ(fileHandle.getPageSize(), pageSize);
+        for (size_t i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,276 @@
+#include <map>
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class RBFM_Pax_Test : public RBFM_Test {
+    protected:
+        void SetUp() override {
+            RBFM_Test::SetUp();
+            // the same file, laid out in PAX pages
+            ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+            ASSERT_EQ(rbfm.destroyFile(fileName), success);
+            ASSERT_EQ(rbfm.createFile(fileName, PAGE_SIZE, PeterDB::PAGE_LAYOUT_PAX), success);
+            ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+            ASSERT_EQ(rbfm.getPageLayout(fileHandle), PeterDB::PAGE_LAYOUT_PAX);
+        }
+
+        void prepare(const std::vector<PeterDB::Attribute> &recordDescriptor, unsigned i, const std::string &name,
+                     void *buffer, size_t &recordSize) {
+            nullsIndicator[0] = i % 10 == 0 ? 0x40 : 0;
+            prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) name.length(), name, (int) i,
+                          150.0f + i % 50, (int) i * 10, buffer, recordSize);
+        }
+    };
+
+    TEST_F(RBFM_Pax_Test, insert_read_scan) {
+        // Functions tested
+        // 1. Insert records one by one and in a batch into a PAX file, every tenth one without an age
+        // 2. readRecord and readAttribute return them in the usual format
+        // 3. A projected scan with conditions returns exactly the matching records
+        // 4. Deleted slots are reused, and updates that fit their page keep their rid
+
+        const unsigned numRecords = 2000;
+        size_t recordSize;
+        PeterDB::RID rid;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::vector<std::string> names;
+        std::vector<PeterDB::RID> rids;
+        for (unsigned i = 0; i < numRecords / 2; i++) {
+            names.push_back("pax" + std::to_string(i) + std::string(i % 13, 'p'));
+            prepare(recordDescriptor, i, names[i], inBuffer, recordSize);
+            ASSERT_EQ(rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid), success)
+                                        << "Inserting a record should succeed.";
+            rids.push_back(rid);
+        }
+        std::vector<std::vector<uint8_t>> records;
+        std::vector<const void *> data;
+        for (unsigned i = numRecords / 2; i < numRecords; i++) {
+            names.push_back("pax" + std::to_string(i) + std::string(i % 13, 'p'));
+            prepare(recordDescriptor, i, names[i], inBuffer, recordSize);
+            records.emplace_back((uint8_t *) inBuffer, (uint8_t *) inBuffer + recordSize);
+        }
+        for (const std::vector<uint8_t> &record: records) data.push_back(record.data());
+        std::vector<PeterDB::RID> batchRids;
+        ASSERT_EQ(rbfm.insertRecords(fileHandle, recordDescriptor, data, batchRids), success);
+        rids.insert(rids.end(), batchRids.begin(), batchRids.end());
+
+        for (unsigned i = 0; i < numRecords; i++) {
+            prepare(recordDescriptor, i, names[i], inBuffer, recordSize);
+            ASSERT_EQ(rbfm.readRecord(fileHandle, recordDescriptor, rids[i], outBuffer), success);
+            ASSERT_EQ(memcmp(inBuffer, outBuffer, recordSize), 0) << "Record " << i << " should read back.";
+        }
+        int salary;
+        ASSERT_EQ(rbfm.readAttribute(fileHandle, recordDescriptor, rids[7], "Salary", outBuffer), success);
+        memcpy(&salary, (uint8_t *) outBuffer + 1, sizeof(int));
+        EXPECT_EQ(*(uint8_t *) outBuffer, 0);
+        EXPECT_EQ(salary, 70);
+        ASSERT_EQ(rbfm.readAttribute(fileHandle, recordDescriptor, rids[20], "Age", outBuffer), success);
+        EXPECT_EQ(*(uint8_t *) outBuffer, 0x80) << "The age of record 20 is null.";
+
+        // Age in (100, 1500] and Height < 160, projected to Salary and EmpName
+        int minAge = 100, maxAge = 1500;
+        float maxHeight = 160.0;
+        std::vector<PeterDB::ScanCondition> conditions{
+                {"Age",    PeterDB::GT_OP, &minAge},
+                {"Age",    PeterDB::LE_OP, &maxAge},
+                {"Height", PeterDB::LT_OP, &maxHeight}};
+        std::map<int, std::string> expected;
+        for (unsigned i = 0; i < numRecords; i++) {
+            if (i % 10 != 0 && (int) i > minAge && (int) i <= maxAge && 150.0f + i % 50 < maxHeight) {
+                expected[(int) i * 10] = names[i];
+            }
+        }
+        std::vector<std::string> attrNames{"Salary", "EmpName"};
+        PeterDB::RBFM_ScanIterator scanIterator;
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, conditions, attrNames, scanIterator), success);
+        unsigned count = 0;
+        while (scanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) {
+            int nameLen;
+            memcpy(&salary, (uint8_t *) outBuffer + 1, sizeof(int));
+            memcpy(&nameLen, (uint8_t *) outBuffer + 1 + sizeof(int), sizeof(int));
+            ASSERT_EQ(expected.count(salary), 1) << "Record " << salary / 10 << " does not meet the conditions.";
+            EXPECT_EQ(std::string((char *) outBuffer + 1 + 2 * sizeof(int), nameLen), expected[salary]);
+            count++;
+        }
+        EXPECT_EQ(count, expected.size());
+        scanIterator.close();
+
+        // empty the last page, its first slot is taken by the next insert
+        unsigned first = numRecords - 1;
+        while (first > 0 && rids[first - 1].pageNum == rids.back().pageNum) first--;
+        PeterDB::RID deleted = rids[first];
+        ASSERT_EQ(deleted.slotNum, 1);
+        for (unsigned i = first; i < numRecords; i++) {
+            ASSERT_EQ(rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]), success);
+        }
+        EXPECT_NE(rbfm.readRecord(fileHandle, recordDescriptor, deleted, outBuffer), success);
+        names[first] = "reinserted";
+        prepare(recordDescriptor, first, names[first], inBuffer, recordSize);
+        ASSERT_EQ(rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid), success);
+        EXPECT_EQ(rid.pageNum, deleted.pageNum);
+        EXPECT_EQ(rid.slotNum, deleted.slotNum);
+
+        // the emptied page has room for a grown record
+        names[first].assign(1000, 'g');
+        prepare(recordDescriptor, first, names[first], inBuffer, recordSize);
+        ASSERT_EQ(rbfm.updateRecord(fileHandle, recordDescriptor, inBuffer, rid), success);
+        ASSERT_EQ(rbfm.readRecord(fileHandle, recordDescriptor, rid, outBuffer), success);
+        EXPECT_EQ(memcmp(inBuffer, outBuffer, recordSize), 0);
+
+        PeterDB::RecordView view;
+        EXPECT_NE(rbfm.readRecordView(fileHandle, rid, view), success) << "Views read row pages only.";
+    }
+
+    TEST_F(RBFM_Pax_Test, records_near_page_size) {
+        // Functions tested
+        // 1. Records with a VarChar almost as long as the page go to new pages sized for them
+        // 2. Short and full records are mixed, inserted one by one and in a batch
+        // 3. All of them read back and scan back
+
+        const unsigned numRecords = 40, textLength = 3000;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor{{"Id",   PeterDB::TypeInt,     4},
+                                                         {"Text", PeterDB::TypeVarChar, textLength}};
+        auto prepareText = [](unsigned i, std::vector<uint8_t> &record) {
+            std::string text(i % 3 == 0 ? 10 : textLength, (char) ('a' + i % 26));
+            int id = (int) i, length = (int) text.size();
+            record.assign(1 + 2 * sizeof(int) + text.size(), 0);
+            memcpy(record.data() + 1, &id, sizeof(int));
+            memcpy(record.data() + 1 + sizeof(int), &length, sizeof(int));
+            memcpy(record.data() + 1 + 2 * sizeof(int), text.data(), text.size());
+        };
+
+        std::vector<std::vector<uint8_t>> records(numRecords);
+        std::vector<PeterDB::RID> rids;
+        PeterDB::RID rid;
+        for (unsigned i = 0; i < numRecords / 2; i++) {
+            prepareText(i, records[i]);
+            ASSERT_EQ(rbfm.insertRecord(fileHandle, recordDescriptor, records[i].data(), rid), success)
+                                        << "Record " << i << " should fit a page of its own.";
+            rids.push_back(rid);
+        }
+        std::vector<const void *> data;
+        for (unsigned i = numRecords / 2; i < numRecords; i++) {
+            prepareText(i, records[i]);
+            data.push_back(records[i].data());
+        }
+        std::vector<PeterDB::RID> batchRids;
+        ASSERT_EQ(rbfm.insertRecords(fileHandle, recordDescriptor, data, batchRids), success);
+        rids.insert(rids.end(), batchRids.begin(), batchRids.end());
+        ASSERT_EQ(rids.size(), numRecords);
+
+        for (unsigned i = 0; i < numRecords; i++) {
+            ASSERT_EQ(rbfm.readRecord(fileHandle, recordDescriptor, rids[i], outBuffer), success);
+            EXPECT_EQ(memcmp(records[i].data(), outBuffer, records[i].size()), 0)
+                                << "Record " << i << " should read back.";
+        }
+
+        std::vector<std::string> attrNames{"Id"};
+        PeterDB::RBFM_ScanIterator scanIterator;
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, {}, attrNames, scanIterator), success);
+        unsigned count = 0;
+        while (scanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) count++;
+        scanIterator.close();
+        EXPECT_EQ(count, numRecords);
+    }
+
+    TEST_F(RBFM_Pax_Test, update_grows_past_page) {
+        // Functions tested
+        // 1. Records grown past their full page move to other pages and keep their rids
+        // 2. readRecord, readAttribute and a scan with a condition find them through their home slots,
+        //    the moved records are not returned twice
+        // 3. Moved records grow again, shrink back home and get deleted
+
+        const unsigned numRecords = 64, textLength = 1000;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor{{"Id",   PeterDB::TypeInt,     4},
+                                                         {"Text", PeterDB::TypeVarChar, textLength}};
+        auto prepareText = [](unsigned i, unsigned length, std::vector<uint8_t> &record) {
+            std::string text(length, (char) ('a' + i % 26));
+            int id = (int) i, textLen = (int) text.size();
+            record.assign(1 + 2 * sizeof(int) + text.size(), 0);
+            memcpy(record.data() + 1, &id, sizeof(int));
+            memcpy(record.data() + 1 + sizeof(int), &textLen, sizeof(int));
+            memcpy(record.data() + 1 + 2 * sizeof(int), text.data(), text.size());
+        };
+        auto readBack = [&](const std::vector<std::vector<uint8_t>> &records, const std::vector<PeterDB::RID> &rids,
+                            unsigned i) {
+            ASSERT_EQ(rbfm.readRecord(fileHandle, recordDescriptor, rids[i], outBuffer), success)
+                                        << "Record " << i << " should be read through its rid.";
+            EXPECT_EQ(memcmp(records[i].data(), outBuffer, records[i].size()), 0)
+                                << "Record " << i << " should read back.";
+        };
+
+        std::vector<std::vector<uint8_t>> records(numRecords);
+        std::vector<PeterDB::RID> rids(numRecords);
+        for (unsigned i = 0; i < numRecords; i++) {
+            prepareText(i, 10, records[i]);
+            ASSERT_EQ(rbfm.insertRecord(fileHandle, recordDescriptor, records[i].data(), rids[i]), success);
+        }
+        unsigned numPages = fileHandle.getNumberOfPages();
+
+        // every record grows to the full VarChar, a page holds a few of them
+        for (unsigned i = 0; i < numRecords; i++) {
+            prepareText(i, textLength, records[i]);
+            ASSERT_EQ(rbfm.updateRecord(fileHandle, recordDescriptor, records[i].data(), rids[i]), success)
+                                        << "Record " << i << " should move to another page.";
+        }
+        EXPECT_GT(fileHandle.getNumberOfPages(), numPages) << "Grown records should take new pages.";
+        for (unsigned i = 0; i < numRecords; i++) readBack(records, rids, i);
+        int id;
+        ASSERT_EQ(rbfm.readAttribute(fileHandle, recordDescriptor, rids[numRecords - 1], "Id", outBuffer), success);
+        memcpy(&id, (uint8_t *) outBuffer + 1, sizeof(int));
+        EXPECT_EQ(id, (int) numRecords - 1);
+
+        auto scanIds = [&](int minId, std::map<int, PeterDB::RID> &found) {
+            found.clear();
+            std::vector<PeterDB::ScanCondition> conditions{{"Id", PeterDB::GE_OP, &minId}};
+            std::vector<std::string> attrNames{"Id", "Text"};
+            PeterDB::RBFM_ScanIterator scanIterator;
+            ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, conditions, attrNames, scanIterator), success);
+            PeterDB::RID rid;
+            while (scanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) {
+                memcpy(&id, (uint8_t *) outBuffer + 1, sizeof(int));
+                ASSERT_GE(id, minId);
+                ASSERT_EQ(found.count(id), 0) << "Record " << id << " should be returned once.";
+                found[id] = rid;
+                EXPECT_EQ(memcmp(records[id].data(), outBuffer, records[id].size()), 0);
+            }
+            scanIterator.close();
+        };
+        std::map<int, PeterDB::RID> found;
+        scanIds(numRecords / 2, found);
+        EXPECT_EQ(found.size(), numRecords / 2);
+        for (const auto &entry: found) {
+            EXPECT_EQ(entry.second.pageNum, rids[entry.first].pageNum) << "The scan returns home rids.";
+            EXPECT_EQ(entry.second.slotNum, rids[entry.first].slotNum);
+        }
+
+        // moved records change size again: a bit smaller, back to a few bytes, full again
+        for (unsigned i = 0; i < numRecords; i++) {
+            prepareText(i, i % 3 == 0 ? textLength - 100 : i % 3 == 1 ? 5 : textLength, records[i]);
+            ASSERT_EQ(rbfm.updateRecord(fileHandle, recordDescriptor, records[i].data(), rids[i]), success);
+        }
+        for (unsigned i = 0; i < numRecords; i++) readBack(records, rids, i);
+
+        // deleting a forwarded record drops the moved one too
+        for (unsigned i = 0; i < numRecords; i += 2) {
+            ASSERT_EQ(rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]), success);
+            EXPECT_NE(rbfm.readRecord(fileHandle, recordDescriptor, rids[i], outBuffer), success);
+        }
+        scanIds(0, found);
+        EXPECT_EQ(found.size(), numRecords / 2);
+        for (const auto &entry: found) EXPECT_EQ(entry.first % 2, 1) << "Deleted records should be gone.";
+        for (unsigned i = 1; i < numRecords; i += 2) readBack(records, rids, i);
+    }
+
+} // namespace PeterDBTesting
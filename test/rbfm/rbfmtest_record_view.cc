@@ -0,0 +1,101 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, read_record_view) {
+        // Functions tested
+        // 1. Insert records, every tenth one without an age, and move one of them to another page
+        // 2. readRecordView reads every field in place, including the moved record, and null fields read as empty
+        // 3. A scan with a condition returns the same records through getNextRecordView and getNextRecord
+
+        const unsigned numRecords = 400;
+        size_t recordSize;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::vector<PeterDB::RID> rids(numRecords);
+        std::vector<std::string> names;
+        for (unsigned i = 0; i < numRecords; i++) {
+            names.push_back("view" + std::to_string(i));
+            nullsIndicator[0] = i % 10 == 0 ? 0x40 : 0;
+            prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) names[i].length(), names[i], (int) i,
+                          170.5, (int) i * 10, inBuffer, recordSize);
+            ASSERT_EQ(rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rids[i]), success)
+                                        << "Inserting a record should succeed.";
+        }
+        ASSERT_GT(fileHandle.getNumberOfPages(), 1);
+
+        // grow the first record until it leaves its full page
+        names[1].assign(2000, 'm');
+        nullsIndicator[0] = 0;
+        prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) names[1].length(), names[1], 1, 170.5, 10,
+                      inBuffer, recordSize);
+        ASSERT_EQ(rbfm.updateRecord(fileHandle, recordDescriptor, inBuffer, rids[1]), success);
+        {
+            PeterDB::PageHelper homePage(fileHandle, rids[1].pageNum);
+            ASSERT_TRUE(homePage.isRecordPointer(rids[1].slotNum)) << "The record should have moved.";
+        }
+
+        PeterDB::RecordView view;
+        for (unsigned i = 0; i < numRecords; i++) {
+            ASSERT_EQ(rbfm.readRecordView(fileHandle, rids[i], view), success) << "Reading a view should succeed.";
+            ASSERT_TRUE(view.isOpen());
+            EXPECT_EQ(view.getAttrNum(), recordDescriptor.size());
+            EXPECT_EQ(view.getField<std::string>(0), names[i]);
+            EXPECT_EQ(view.getFieldLength(0), names[i].length());
+            if (i % 10 == 0) {
+                EXPECT_TRUE(view.isNull(1));
+                EXPECT_EQ(view.getFieldPtr(1), nullptr);
+                EXPECT_EQ(view.getField<int>(1), 0) << "A null field should read as zero.";
+            } else {
+                EXPECT_FALSE(view.isNull(1));
+                EXPECT_EQ(view.getField<int>(1), (int) i);
+            }
+            EXPECT_FLOAT_EQ(view.getField<float>(2), 170.5);
+            EXPECT_EQ(view.getField<int>(3), (int) i * 10);
+            // an attribute the record does not have reads as null
+            EXPECT_TRUE(view.isNull(recordDescriptor.size()));
+            EXPECT_EQ(view.getField<std::string>(recordDescriptor.size()), "");
+            ASSERT_EQ(view.release(), success);
+            EXPECT_FALSE(view.isOpen());
+        }
+
+        // the view and the copy agree
+        ASSERT_EQ(rbfm.readRecordView(fileHandle, rids[7], view), success);
+        std::vector<uint16_t> allAttrs{0, 1, 2, 3};
+        ASSERT_EQ(view.toRawData(recordDescriptor, allAttrs, inBuffer), success);
+        ASSERT_EQ(rbfm.readRecord(fileHandle, recordDescriptor, rids[7], outBuffer), success);
+        EXPECT_EQ(memcmp(inBuffer, outBuffer, 1 + sizeof(int) + names[7].length() + 3 * sizeof(int)), 0);
+        view.release();
+
+        int minAge = 200;
+        std::vector<std::string> attrNames{"Age"};
+        PeterDB::RBFM_ScanIterator viewIterator, copyIterator;
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, "Age", PeterDB::GE_OP, &minAge, attrNames, viewIterator),
+                  success);
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, "Age", PeterDB::GE_OP, &minAge, attrNames, copyIterator),
+                  success);
+        PeterDB::RID viewRid, rid;
+        unsigned count = 0;
+        while (viewIterator.getNextRecordView(viewRid, view) != RBFM_EOF) {
+            ASSERT_NE(copyIterator.getNextRecord(rid, outBuffer), RBFM_EOF);
+            EXPECT_EQ(viewRid.pageNum, rid.pageNum);
+            EXPECT_EQ(viewRid.slotNum, rid.slotNum);
+            int age;
+            memcpy(&age, (uint8_t *) outBuffer + 1, sizeof(int));
+            EXPECT_EQ(view.getField<int>(1), age);
+            EXPECT_GE(age, minAge);
+            count++;
+        }
+        EXPECT_EQ(copyIterator.getNextRecord(rid, outBuffer), RBFM_EOF);
+        EXPECT_FALSE(view.isOpen()) << "The end of the scan should release the view.";
+        EXPECT_EQ(count, numRecords - minAge - (numRecords - minAge) / 10);
+        viewIterator.close();
+        copyIterator.close();
+    }
+
+} // namespace PeterDBTesting
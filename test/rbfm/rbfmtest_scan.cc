@@ -0,0 +1,58 @@
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, scan_with_read_ahead) {
+        // Functions tested
+        // 1. Insert records over several pages
+        // 2. Scan them with read-ahead
+        // 3. Delete a record of the page being scanned, the scan should not return it
+
+        PeterDB::RID rid;
+        inBuffer = malloc(1000);
+        outBuffer = malloc(1000);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::vector<PeterDB::RID> insertedRids;
+        while (fileHandle.getNumberOfPages() < 6) {
+            std::string name = std::to_string(insertedRids.size());
+            name.resize(100, 'a');
+            insertRecord(recordDescriptor, rid, name);
+            insertedRids.push_back(rid);
+        }
+
+        PeterDB::RBFM_ScanIterator rbfmScanIterator;
+        rbfmScanIterator.setReadAhead(2);
+        std::vector<std::string> attributes{"EmpName"};
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, "", PeterDB::NO_OP, nullptr, attributes,
+                            rbfmScanIterator), success) << "RecordBasedFileManager::scan() should succeed.";
+
+        ASSERT_NE(rbfmScanIterator.getNextRecord(rid, outBuffer), RBFM_EOF);
+        EXPECT_EQ(rid.pageNum, 0);
+        EXPECT_EQ(rid.slotNum, insertedRids[0].slotNum);
+
+        // the iterator holds page 0 at this point
+        PeterDB::RID deletedRid = insertedRids[2];
+        ASSERT_EQ(deletedRid.pageNum, 0);
+        ASSERT_EQ(rbfm.deleteRecord(fileHandle, recordDescriptor, deletedRid), success)
+                                    << "Deleting a record should succeed.";
+
+        unsigned numReturned = 1;
+        PeterDB::RID lastRid = rid;
+        while (rbfmScanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) {
+            EXPECT_FALSE(rid.pageNum == deletedRid.pageNum && rid.slotNum == deletedRid.slotNum)
+                                << "A deleted record should not be returned.";
+            EXPECT_TRUE(rid.pageNum > lastRid.pageNum ||
+                        (rid.pageNum == lastRid.pageNum && rid.slotNum > lastRid.slotNum))
+                                << "Records should be returned in page order.";
+            lastRid = rid;
+            numReturned++;
+        }
+        EXPECT_EQ(numReturned, insertedRids.size() - 1);
+        ASSERT_EQ(rbfmScanIterator.close(), success);
+    }
+
+} // namespace PeterDBTesting
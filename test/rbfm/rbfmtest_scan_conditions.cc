@@ -0,0 +1,73 @@
+#include <map>
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RBFM_Test, scan_with_conditions) {
+        // Functions tested
+        // 1. Insert records with short names that share prefixes, some without an age
+        // 2. Scan with a conjunction over an Int, a Real and a VarChar attribute
+        // 3. Exactly the records meeting every condition are returned, a null attribute meets none
+
+        const unsigned numRecords = 1000;
+        size_t recordSize;
+        PeterDB::RID rid;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> recordDescriptor;
+        createRecordDescriptor(recordDescriptor);
+        nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+
+        std::string bound = "bb";
+        int minAge = 50, maxAge = 800;
+        float height = 180.0;
+        std::map<unsigned, std::string> expected;
+        for (unsigned i = 0; i < numRecords; i++) {
+            std::string name(1 + i % 5, 'a' + i % 3);
+            float recordHeight = i % 4 == 0 ? height : 170.5f;
+            nullsIndicator[0] = i % 7 == 0 ? 0x40 : 0;
+            prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) name.length(), name, (int) i,
+                          recordHeight, (int) i, inBuffer, recordSize);
+            ASSERT_EQ(rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid), success)
+                                        << "Inserting a record should succeed.";
+            if (i % 7 != 0 && (int) i > minAge && (int) i <= maxAge && recordHeight != height && name < bound) {
+                expected[i] = name;
+            }
+        }
+
+        uint8_t boundValue[sizeof(int) + 2];
+        int boundLen = (int) bound.length();
+        memcpy(boundValue, &boundLen, sizeof(int));
+        memcpy(boundValue + sizeof(int), bound.c_str(), boundLen);
+        std::vector<PeterDB::ScanCondition> conditions{
+                {"EmpName", PeterDB::LT_OP, boundValue},
+                {"Age",     PeterDB::GT_OP, &minAge},
+                {"Height",  PeterDB::NE_OP, &height},
+                {"Age",     PeterDB::LE_OP, &maxAge}};
+        std::vector<std::string> attrNames{"Salary", "EmpName"};
+        PeterDB::RBFM_ScanIterator scanIterator;
+        ASSERT_EQ(rbfm.scan(fileHandle, recordDescriptor, conditions, attrNames, scanIterator), success)
+                                    << "Scanning with conditions should succeed.";
+
+        unsigned count = 0;
+        while (scanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) {
+            int salary, nameLen;
+            memcpy(&salary, (uint8_t *) outBuffer + 1, sizeof(int));
+            memcpy(&nameLen, (uint8_t *) outBuffer + 1 + sizeof(int), sizeof(int));
+            std::string name((char *) outBuffer + 1 + 2 * sizeof(int), nameLen);
+            ASSERT_EQ(expected.count(salary), 1) << "Record " << salary << " does not meet the conditions.";
+            EXPECT_EQ(name, expected[salary]);
+            count++;
+        }
+        EXPECT_EQ(count, expected.size());
+        EXPECT_GT(count, 0);
+        scanIterator.close();
+
+        // an unknown attribute is rejected when the scan begins
+        conditions.push_back({"Unknown", PeterDB::EQ_OP, &minAge});
+        EXPECT_NE(rbfm.scan(fileHandle, recordDescriptor, conditions, attrNames, scanIterator), success);
+        scanIterator.close();
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,254 @@
+#include <chrono>
+#include <set>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "src/include/rbfm.h"
+#include "test/utils/rbfm_test_utils.h"
+
+namespace PeterDBTesting {
+
+    class RBFM_WAL_Test : public RBFM_Test {
+    protected:
+        std::string logFileName = "rbfm_test_wal_log";
+        std::vector<PeterDB::Attribute> recordDescriptor;
+
+        void SetUp() override {
+            RBFM_Test::SetUp();
+            remove(logFileName.c_str());
+            inBuffer = malloc(PAGE_SIZE);
+            outBuffer = malloc(PAGE_SIZE);
+            createRecordDescriptor(recordDescriptor);
+            nullsIndicator = initializeNullFieldsIndicator(recordDescriptor);
+        }
+
+        void TearDown() override {
+            PeterDB::LogManager::instance().close();
+            PeterDB::BufferPool::instance().setIOEngine(PeterDB::DEFAULT_IO_ENGINE);
+            remove(logFileName.c_str());
+            RBFM_Test::TearDown();
+        }
+
+        // names of the records a scan returns
+        std::multiset<std::string> scanNames() {
+            std::multiset<std::string> names;
+            PeterDB::RBFM_ScanIterator rbfmScanIterator;
+            std::vector<std::string> attributes{"EmpName"};
+            EXPECT_EQ(rbfm.scan(fileHandle, recordDescriptor, "", PeterDB::NO_OP, nullptr, attributes,
+                                rbfmScanIterator), success);
+            PeterDB::RID rid;
+            while (rbfmScanIterator.getNextRecord(rid, outBuffer) != RBFM_EOF) {
+                int length;
+                memcpy(&length, (char *) outBuffer + 1, sizeof(int));
+                names.emplace((char *) outBuffer + 1 + sizeof(int), length);
+            }
+            EXPECT_EQ(rbfmScanIterator.close(), success);
+            return names;
+        }
+    };
+
+    TEST_F (RBFM_WAL_Test, recover_after_crash) {
+        // Functions tested
+        // 1. A child process logs committed inserts and updates that are never written back
+        // 2. Its last operation writes pages back but never commits, then the process dies
+        // 3. Opening the log replays it: committed changes are redone, the unfinished one is undone
+
+        const unsigned numRecords = 200;
+        std::multiset<std::string> committed;
+        for (unsigned i = 0; i < numRecords; i++) {
+            committed.insert(std::string(100 + i % 50, 'a' + i % 26) + std::to_string(i));
+        }
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        // the child must not share an io_uring instance with the parent
+        ASSERT_EQ(PeterDB::BufferPool::instance().setIOEngine(PeterDB::IO_ENGINE_SYNC), success);
+        ASSERT_EQ(PeterDB::BufferPool::instance().flushAll(), success);
+
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+            if (logManager.open(logFileName) != success || rbfm.openFile(fileName, fileHandle) != success) _exit(1);
+            PeterDB::RID rid, firstRid;
+            size_t recordSize;
+            unsigned i = 0;
+            for (const std::string &name: committed) {
+                prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) name.length(), name, 25, 177.8,
+                              6200, inBuffer, recordSize);
+                if (rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid) != success) _exit(2);
+                if (i++ == 0) firstRid = rid;
+            }
+            // the same record updated twice, the second time without a commit
+            const std::string &first = *committed.begin();
+            prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) first.length(), first, 30, 160.5,
+                          7000, inBuffer, recordSize);
+            if (rbfm.updateRecord(fileHandle, recordDescriptor, inBuffer, firstRid) != success) _exit(3);
+
+            logManager.beginOperation(PeterDB::LOG_OP_RBFM_INSERT);
+            std::string lost(1500, 'z');
+            prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) lost.length(), lost, 25, 177.8,
+                          6200, inBuffer, recordSize);
+            for (unsigned j = 0; j < 10; j++) {
+                if (rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid) != success) _exit(4);
+            }
+            if (rbfm.updateRecord(fileHandle, recordDescriptor, inBuffer, firstRid) != success) _exit(5);
+            if (PeterDB::BufferPool::instance().flushAll() != success) _exit(6);
+            _exit(0);
+        }
+        int status;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0) << "The child process failed.";
+
+        PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+        ASSERT_EQ(logManager.open(logFileName), success);
+        unsigned redoCount, undoCount;
+        logManager.getRecoveryCounts(redoCount, undoCount);
+        EXPECT_GT(redoCount, 0);
+        EXPECT_GT(undoCount, 0);
+        EXPECT_EQ(getFileSize(logFileName), 0) << "The log should start over after recovery.";
+
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        EXPECT_EQ(scanNames(), committed);
+    }
+
+    TEST_F (RBFM_WAL_Test, abort_then_commit_same_page) {
+        // Functions tested
+        // 1. An aborted insert is rolled back at once, a committed insert then goes to the same page
+        // 2. A checkpoint keeps the rollback, the aborted record does not come back
+        // 3. After a crash, recovery neither redoes the aborted insert nor undoes it over the committed one
+
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        // the child must not share an io_uring instance with the parent
+        ASSERT_EQ(PeterDB::BufferPool::instance().setIOEngine(PeterDB::IO_ENGINE_SYNC), success);
+        ASSERT_EQ(PeterDB::BufferPool::instance().flushAll(), success);
+
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+            if (logManager.open(logFileName) != success || rbfm.openFile(fileName, fileHandle) != success) _exit(1);
+            logManager.setCheckpointInterval(0);
+            PeterDB::RID firstRid, abortedRid, rid;
+            size_t recordSize;
+            auto insert = [&](const std::string &name, PeterDB::RID &rid) {
+                prepareRecord((int) recordDescriptor.size(), nullsIndicator, (int) name.length(), name, 25, 177.8,
+                              6200, inBuffer, recordSize);
+                return rbfm.insertRecord(fileHandle, recordDescriptor, inBuffer, rid);
+            };
+            if (insert("first", firstRid) != success) _exit(2);
+            {
+                // the insert commits into the outer operation, which ends without a commit
+                PeterDB::LogOperation operation(PeterDB::LOG_OP_RBFM_INSERT);
+                if (insert("aborted", abortedRid) != success || abortedRid.pageNum != firstRid.pageNum) _exit(3);
+            }
+            if (rbfm.readRecord(fileHandle, recordDescriptor, abortedRid, outBuffer) == success) _exit(4);
+            if (scanNames() != std::multiset<std::string>{"first"}) _exit(5);
+            if (logManager.checkpoint() != success) _exit(6);
+            if (scanNames() != std::multiset<std::string>{"first"}) _exit(7);
+
+            // the same once more, this time the log still holds it when the process dies
+            {
+                PeterDB::LogOperation operation(PeterDB::LOG_OP_RBFM_INSERT);
+                if (insert("aborted", abortedRid) != success) _exit(8);
+            }
+            if (insert("second", rid) != success || rid.pageNum != firstRid.pageNum) _exit(9);
+            if (PeterDB::BufferPool::instance().flushAll() != success) _exit(10);
+            _exit(0);
+        }
+        int status;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0) << "The child process failed.";
+
+        PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+        ASSERT_EQ(logManager.open(logFileName), success);
+        unsigned redoCount, undoCount;
+        logManager.getRecoveryCounts(redoCount, undoCount);
+        EXPECT_GT(redoCount, 0);
+        EXPECT_EQ(undoCount, 0) << "The aborted operation has been rolled back already.";
+
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        EXPECT_EQ(scanNames(), (std::multiset<std::string>{"first", "second"}));
+    }
+
+    TEST_F (RBFM_WAL_Test, checkpoint_bounds_the_log) {
+        // Functions tested
+        // 1. Once the log outgrows the limit, a commit checkpoints and the log starts over
+        // 2. A checkpoint inside an operation is refused
+        // 3. Records survive closing the log and reopening the file
+
+        const size_t checkpointLogSize = 64 * 1024;
+        PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+        ASSERT_EQ(logManager.open(logFileName), success);
+        // the committer checkpoints itself
+        logManager.setCheckpointInterval(0);
+        logManager.setCheckpointLogSize(checkpointLogSize);
+
+        std::vector<PeterDB::RID> rids;
+        std::vector<std::string> names;
+        PeterDB::RID rid;
+        for (unsigned i = 0; i < 1000; i++) {
+            std::string name = std::to_string(i) + std::string(200, 'a' + i % 26);
+            insertRecord(recordDescriptor, rid, name);
+            rids.push_back(rid);
+            names.push_back(name);
+            EXPECT_LT(logManager.getLogSize(), checkpointLogSize) << "Record " << i;
+        }
+        unsigned commitCount, syncCount, checkpointCount;
+        ASSERT_EQ(logManager.collectCounterValues(commitCount, syncCount, checkpointCount), success);
+        EXPECT_GT(checkpointCount, 0);
+        {
+            PeterDB::LogOperation operation(PeterDB::LOG_OP_RBFM_INSERT);
+            EXPECT_EQ(logManager.checkpoint(), PeterDB::RC(PeterDB::LOG_ERROR::OPERATION_IN_PROGRESS))
+                                << "A checkpoint inside an operation would wait for itself.";
+        }
+        EXPECT_EQ(logManager.checkpoint(), success);
+        EXPECT_EQ(logManager.getLogSize(), 0);
+
+        logManager.setCheckpointLogSize(PeterDB::DEFAULT_CHECKPOINT_LOG_SIZE);
+        logManager.setCheckpointInterval(PeterDB::DEFAULT_CHECKPOINT_INTERVAL);
+        ASSERT_EQ(logManager.close(), success);
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        ASSERT_EQ(rbfm.openFile(fileName, fileHandle), success);
+        for (size_t i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+    }
+
+    TEST_F (RBFM_WAL_Test, background_checkpoint) {
+        // Functions tested
+        // 1. The checkpointer thread empties the log every interval while records are inserted
+        // 2. A log past the size limit wakes it up, the committers do not checkpoint themselves
+
+        PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+        ASSERT_EQ(logManager.open(logFileName), success);
+        logManager.setCheckpointInterval(20);
+        logManager.setCheckpointLogSize(32 * 1024);
+
+        std::vector<PeterDB::RID> rids;
+        std::vector<std::string> names;
+        PeterDB::RID rid;
+        unsigned commitCount, syncCount, checkpointCount;
+        for (unsigned i = 0; i < 500; i++) {
+            std::string name = std::to_string(i) + std::string(100, 'a' + i % 26);
+            insertRecord(recordDescriptor, rid, name);
+            rids.push_back(rid);
+            names.push_back(name);
+        }
+        for (unsigned i = 0; i < 100; i++) {
+            ASSERT_EQ(logManager.collectCounterValues(commitCount, syncCount, checkpointCount), success);
+            if (checkpointCount > 0 && logManager.getLogSize() == 0) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_GT(checkpointCount, 0);
+        EXPECT_EQ(logManager.getLogSize(), 0) << "The checkpointer should have caught up.";
+
+        logManager.setCheckpointInterval(PeterDB::DEFAULT_CHECKPOINT_INTERVAL);
+        logManager.setCheckpointLogSize(PeterDB::DEFAULT_CHECKPOINT_LOG_SIZE);
+        ASSERT_EQ(logManager.close(), success);
+        for (size_t i = 0; i < rids.size(); i++) {
+            ASSERT_NO_FATAL_FAILURE(readRecord(recordDescriptor, rids[i], names[i]));
+        }
+    }
+
+} // namespace PeterDBTesting
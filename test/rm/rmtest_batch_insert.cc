@@ -0,0 +1,65 @@
+#include "test/utils/rm_test_util.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RM_Tuple_Test, insert_tuples_in_batch) {
+        // Functions tested
+        // 1. Create an index, then insert a batch of tuples with insertTuples, the empty index is bulk loaded
+        // 2. Insert a second batch with descending keys into the index that now has entries
+        // 3. Every tuple can be read back at the returned rid
+        // 4. The index holds an entry for every tuple of both batches, in key order
+
+        const unsigned numTuples = 3000;
+        size_t tupleSize;
+        inBuffer = malloc(200);
+        outBuffer = malloc(200);
+        ASSERT_EQ(rm.getAttributes(tableName, attrs), success);
+        nullsIndicator = initializeNullFieldsIndicator(attrs);
+        ASSERT_EQ(rm.createIndex(tableName, "age"), success) << "RelationManager::createIndex() should succeed.";
+
+        std::vector<std::vector<uint8_t>> tuples(numTuples);
+        std::vector<const void *> data;
+        for (unsigned i = 0; i < numTuples; i++) {
+            std::string name = "emp" + std::to_string(i);
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, i, 170.0, 5000.0, inBuffer, tupleSize);
+            tuples[i].assign((uint8_t *) inBuffer, (uint8_t *) inBuffer + tupleSize);
+            data.push_back(tuples[i].data());
+        }
+        std::vector<PeterDB::RID> rids;
+        ASSERT_EQ(rm.insertTuples(tableName, data, rids), success) << "RelationManager::insertTuples() should succeed.";
+        ASSERT_EQ(rids.size(), numTuples);
+
+        tuples.resize(2 * numTuples);
+        data.clear();
+        for (unsigned i = 2 * numTuples - 1; i >= numTuples; i--) {
+            std::string name = "emp" + std::to_string(i);
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, i, 170.0, 5000.0, inBuffer, tupleSize);
+            tuples[i].assign((uint8_t *) inBuffer, (uint8_t *) inBuffer + tupleSize);
+            data.push_back(tuples[i].data());
+        }
+        std::vector<PeterDB::RID> moreRids;
+        ASSERT_EQ(rm.insertTuples(tableName, data, moreRids), success);
+        ASSERT_EQ(moreRids.size(), numTuples);
+        rids.insert(rids.end(), moreRids.rbegin(), moreRids.rend());
+
+        for (unsigned i = 0; i < 2 * numTuples; i++) {
+            ASSERT_EQ(rm.readTuple(tableName, rids[i], outBuffer), success);
+            ASSERT_EQ(memcmp(outBuffer, tuples[i].data(), tuples[i].size()), 0) << "Tuple " << i << " differs.";
+        }
+
+        PeterDB::RM_IndexScanIterator rmisi;
+        ASSERT_EQ(rm.indexScan(tableName, "age", nullptr, nullptr, true, true, rmisi), success);
+        int key;
+        unsigned count = 0;
+        while (rmisi.getNextEntry(rid, &key) != RM_EOF) {
+            ASSERT_EQ(key, count) << "Entries should come back in key order.";
+            EXPECT_EQ(rid.pageNum, rids[key].pageNum);
+            EXPECT_EQ(rid.slotNum, rids[key].slotNum);
+            count++;
+        }
+        ASSERT_EQ(rmisi.close(), success);
+        EXPECT_EQ(count, 2 * numTuples);
+        ASSERT_EQ(rm.destroyIndex(tableName, "age"), success);
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <random>
+#include "test/utils/rm_test_util.h"
+
+namespace PeterDBTesting {
+
+    class RM_Bulk_Load_Test : public RM_Tuple_Test {
+    protected:
+        PeterDB::RM_IndexScanIterator rmisi;
+
+        // build the index, then return its page counters and the time spent
+        void buildIndex(const std::string &attrName, unsigned &writes, unsigned &appends, long long &micros) {
+            auto start = std::chrono::steady_clock::now();
+            ASSERT_EQ(rm.createIndex(tableName, attrName), success) << "RelationManager::createIndex() should succeed.";
+            micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            PeterDB::IndexManager &ix = PeterDB::IndexManager::instance();
+            PeterDB::IXFileHandle ixFileHandle;
+            unsigned reads;
+            ASSERT_EQ(ix.openFile(tableName + "_" + attrName + ".idx", ixFileHandle), success);
+            ASSERT_EQ(ixFileHandle.collectCounterValues(reads, writes, appends), success);
+            ASSERT_EQ(ix.closeFile(ixFileHandle), success);
+        }
+
+        void scanIndex(const std::string &attrName, std::vector<std::pair<int, std::pair<unsigned, unsigned>>> &out) {
+            ASSERT_EQ(rm.indexScan(tableName, attrName, nullptr, nullptr, true, true, rmisi), success)
+                                        << "RelationManager::indexScan() should succeed.";
+            int key;
+            while (rmisi.getNextEntry(rid, &key) != RM_EOF) {
+                out.push_back({key, {rid.pageNum, rid.slotNum}});
+            }
+            ASSERT_EQ(rmisi.close(), success) << "RM_IndexScanIterator::close() should succeed.";
+        }
+    };
+
+    TEST_F(RM_Bulk_Load_Test, create_index_bulk_load_vs_insert) {
+        // Functions tested
+        // 1. Insert tuples with random ages
+        // 2. Create the index with bulk loading and with one insert per tuple
+        // 3. Both indexes return the same entries, bulk loading writes fewer pages
+
+        const unsigned numTuples = 20000;
+        size_t tupleSize;
+        inBuffer = malloc(200);
+        ASSERT_EQ(rm.getAttributes(tableName, attrs), success);
+        nullsIndicator = initializeNullFieldsIndicator(attrs);
+        std::mt19937 gen(20230307);
+        for (unsigned i = 0; i < numTuples; i++) {
+            std::string name = "emp" + std::to_string(i);
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, gen() % 10000, 170.0, 5000.0, inBuffer,
+                         tupleSize);
+            ASSERT_EQ(rm.insertTuple(tableName, inBuffer, rid), success) << "RelationManager::insertTuple() should succeed.";
+        }
+
+        unsigned bulkWrites, bulkAppends, insertWrites, insertAppends;
+        long long bulkMicros, insertMicros;
+        std::vector<std::pair<int, std::pair<unsigned, unsigned>>> bulkEntries, insertEntries;
+
+        rm.setIndexBulkLoad(true);
+        ASSERT_NO_FATAL_FAILURE(buildIndex("age", bulkWrites, bulkAppends, bulkMicros));
+        ASSERT_NO_FATAL_FAILURE(scanIndex("age", bulkEntries));
+        ASSERT_EQ(rm.destroyIndex(tableName, "age"), success) << "RelationManager::destroyIndex() should succeed.";
+
+        rm.setIndexBulkLoad(false);
+        ASSERT_NO_FATAL_FAILURE(buildIndex("age", insertWrites, insertAppends, insertMicros));
+        ASSERT_NO_FATAL_FAILURE(scanIndex("age", insertEntries));
+        rm.setIndexBulkLoad(true);
+
+        GTEST_LOG_(INFO) << "bulk load: " << bulkMicros << " us, " << bulkWrites << " writes, " << bulkAppends
+                         << " appends";
+        GTEST_LOG_(INFO) << "insert per tuple: " << insertMicros << " us, " << insertWrites << " writes, "
+                         << insertAppends << " appends";
+
+        ASSERT_EQ(bulkEntries.size(), numTuples);
+        // entries with the same key may come back in a different order
+        std::sort(bulkEntries.begin(), bulkEntries.end());
+        std::sort(insertEntries.begin(), insertEntries.end());
+        EXPECT_TRUE(bulkEntries == insertEntries) << "Both indexes should hold the same entries.";
+        EXPECT_LT(bulkWrites + bulkAppends, insertWrites + insertAppends);
+        EXPECT_LE(bulkAppends, insertAppends) << "Packed leaves should not take more pages than split ones.";
+    }
+
+} // namespace PeterDBTesting
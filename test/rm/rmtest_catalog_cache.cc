@@ -0,0 +1,66 @@
+#include "test/utils/rm_test_util.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RM_Tuple_Test, catalog_cache_on_tuple_path) {
+        // Functions tested
+        // 1. Insert and read tuples, the catalog should be read once
+        // 2. createIndex invalidates the cached index map, new tuples go into the index
+        // 3. DDL on another table keeps the cached entry of this one
+        // 4. Recreating the table with another schema is picked up
+
+        size_t tupleSize;
+        inBuffer = malloc(200);
+        outBuffer = malloc(200);
+        ASSERT_EQ(rm.getAttributes(tableName, attrs), success);
+        nullsIndicator = initializeNullFieldsIndicator(attrs);
+
+        unsigned hit, miss, hitAfter, missAfter;
+        rm.collectCatalogCacheCounters(hit, miss);
+        uint64_t version = rm.getCatalogVersion();
+        for (unsigned i = 0; i < 500; i++) {
+            prepareTuple(attrs.size(), nullsIndicator, 6, "Peters", i, 170.0, 5000.0, inBuffer, tupleSize);
+            ASSERT_EQ(rm.insertTuple(tableName, inBuffer, rid), success) << "RelationManager::insertTuple() should succeed.";
+            ASSERT_EQ(rm.readTuple(tableName, rid, outBuffer), success) << "RelationManager::readTuple() should succeed.";
+        }
+        rm.collectCatalogCacheCounters(hitAfter, missAfter);
+        EXPECT_EQ(missAfter, miss) << "The tuple path should not read the catalog.";
+        EXPECT_GE(hitAfter - hit, 1000);
+        EXPECT_EQ(rm.getCatalogVersion(), version);
+
+        ASSERT_EQ(rm.createIndex(tableName, "age"), success) << "RelationManager::createIndex() should succeed.";
+        EXPECT_GT(rm.getCatalogVersion(), version);
+        int age = 1000;
+        prepareTuple(attrs.size(), nullsIndicator, 6, "Peters", age, 170.0, 5000.0, inBuffer, tupleSize);
+        ASSERT_EQ(rm.insertTuple(tableName, inBuffer, rid), success) << "RelationManager::insertTuple() should succeed.";
+
+        PeterDB::RM_IndexScanIterator rmisi;
+        ASSERT_EQ(rm.indexScan(tableName, "age", &age, &age, true, true, rmisi), success);
+        PeterDB::RID indexedRid;
+        int key;
+        ASSERT_EQ(rmisi.getNextEntry(indexedRid, &key), success) << "The new tuple should be in the index.";
+        EXPECT_EQ(indexedRid.pageNum, rid.pageNum);
+        EXPECT_EQ(indexedRid.slotNum, rid.slotNum);
+        ASSERT_EQ(rmisi.close(), success);
+        ASSERT_EQ(rm.destroyIndex(tableName, "age"), success) << "RelationManager::destroyIndex() should succeed.";
+
+        std::vector<PeterDB::Attribute> otherAttrs = parseDDL("CREATE TABLE catalog_cache_other (id INT)");
+        ASSERT_EQ(rm.getAttributes(tableName, attrs), success);
+        ASSERT_EQ(rm.createTable("catalog_cache_other", otherAttrs), success);
+        ASSERT_EQ(rm.deleteTable("catalog_cache_other"), success);
+        rm.collectCatalogCacheCounters(hit, miss);
+        ASSERT_EQ(rm.getAttributes(tableName, attrs), success);
+        rm.collectCatalogCacheCounters(hitAfter, missAfter);
+        EXPECT_EQ(missAfter, miss) << "DDL on another table should not invalidate this one.";
+
+        ASSERT_EQ(rm.deleteTable(tableName), success);
+        std::vector<PeterDB::Attribute> newAttrs = parseDDL("CREATE TABLE " + tableName + " (id INT, score REAL)");
+        ASSERT_EQ(rm.createTable(tableName, newAttrs), success);
+        std::vector<PeterDB::Attribute> readAttrs;
+        ASSERT_EQ(rm.getAttributes(tableName, readAttrs), success);
+        ASSERT_EQ(readAttrs.size(), 2) << "The recreated schema should be returned.";
+        EXPECT_EQ(readAttrs[0].name, "id");
+        EXPECT_EQ(readAttrs[1].name, "score");
+    }
+
+} // namespace PeterDBTesting
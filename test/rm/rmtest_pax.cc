@@ -0,0 +1,70 @@
+#include <map>
+#include "test/utils/rm_test_util.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RM_Tuple_Test, pax_table) {
+        // Functions tested
+        // 1. Create a table laid out in PAX pages and insert tuples, deleting every third one
+        // 2. readTuple and a projected scan with a condition return the tuples as with a row table
+        // 3. Reorganizing the table keeps its layout and every remaining tuple
+
+        const std::string paxTableName = "rm_test_pax_table";
+        const unsigned numTuples = 1500;
+        size_t tupleSize;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        std::vector<PeterDB::Attribute> paxAttrs = parseDDL(
+                "CREATE TABLE " + paxTableName + " (emp_name VARCHAR(50), age INT, height REAL, salary REAL)");
+        rm.deleteTable(paxTableName);
+        ASSERT_EQ(rm.createTable(paxTableName, paxAttrs, PeterDB::PAGE_LAYOUT_PAX), success)
+                                    << "Creating a PAX table should succeed.";
+        ASSERT_EQ(rm.getAttributes(paxTableName, attrs), success);
+        nullsIndicator = initializeNullFieldsIndicator(attrs);
+
+        std::map<int, std::string> expected;
+        std::vector<PeterDB::RID> rids;
+        for (unsigned i = 0; i < numTuples; i++) {
+            std::string name = "pax" + std::to_string(i);
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, i, 170.0, 10.0f * i, inBuffer, tupleSize);
+            ASSERT_EQ(rm.insertTuple(paxTableName, inBuffer, rid), success)
+                                        << "RelationManager::insertTuple() should succeed.";
+            rids.push_back(rid);
+            expected[i] = name;
+        }
+        for (unsigned i = 0; i < numTuples; i += 3) {
+            ASSERT_EQ(rm.deleteTuple(paxTableName, rids[i]), success);
+            expected.erase(i);
+        }
+        std::string name = "pax7";
+        prepareTuple(attrs.size(), nullsIndicator, name.size(), name, 7, 170.0, 70.0, inBuffer, tupleSize);
+        ASSERT_EQ(rm.readTuple(paxTableName, rids[7], outBuffer), success);
+        EXPECT_EQ(memcmp(inBuffer, outBuffer, tupleSize), 0);
+
+        PeterDB::RecordBasedFileManager &rbfm = PeterDB::RecordBasedFileManager::instance();
+        ASSERT_EQ(rm.reorganizeTable(paxTableName), success) << "RelationManager::reorganizeTable() should succeed.";
+        ASSERT_EQ(rbfm.openFile(paxTableName, fileHandle), success);
+        EXPECT_EQ(rbfm.getPageLayout(fileHandle), PeterDB::PAGE_LAYOUT_PAX);
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+
+        int minAge = 500;
+        PeterDB::RM_ScanIterator rmsi;
+        std::vector<std::string> attrNames{"age", "emp_name"};
+        ASSERT_EQ(rm.scan(paxTableName, "age", PeterDB::GE_OP, &minAge, attrNames, rmsi), success);
+        unsigned count = 0;
+        while (rmsi.getNextTuple(rid, outBuffer) != RM_EOF) {
+            int age, nameLen;
+            memcpy(&age, (uint8_t *) outBuffer + 1, sizeof(int));
+            memcpy(&nameLen, (uint8_t *) outBuffer + 1 + sizeof(int), sizeof(int));
+            ASSERT_EQ(expected.count(age), 1) << "Tuple " << age << " should have been deleted.";
+            EXPECT_GE(age, minAge);
+            EXPECT_EQ(std::string((char *) outBuffer + 1 + 2 * sizeof(int), nameLen), expected[age]);
+            count++;
+        }
+        ASSERT_EQ(rmsi.close(), success);
+        EXPECT_EQ(count, (unsigned) std::distance(expected.lower_bound(minAge), expected.end()));
+
+        ASSERT_EQ(rm.deleteTable(paxTableName), success);
+    }
+
+} // namespace PeterDBTesting
@@ -0,0 +1,90 @@
+#include <map>
+#include "test/utils/rm_test_util.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RM_Tuple_Test, reorganize_table) {
+        // Functions tested
+        // 1. Insert tuples, create an index, then grow some tuples until they move and delete others
+        // 2. Reorganize the table: it takes fewer pages and has no forwarding pointers left
+        // 3. A scan returns every remaining tuple, and the rebuilt index finds each one at its new rid
+
+        const unsigned numTuples = 2000;
+        size_t tupleSize;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        ASSERT_EQ(rm.getAttributes(tableName, attrs), success);
+        nullsIndicator = initializeNullFieldsIndicator(attrs);
+
+        std::vector<PeterDB::RID> rids;
+        for (unsigned i = 0; i < numTuples; i++) {
+            std::string name = "emp" + std::to_string(i);
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, i, 170.0, 5000.0, inBuffer, tupleSize);
+            ASSERT_EQ(rm.insertTuple(tableName, inBuffer, rid), success) << "RelationManager::insertTuple() should succeed.";
+            rids.push_back(rid);
+        }
+        ASSERT_EQ(rm.createIndex(tableName, "age"), success) << "RelationManager::createIndex() should succeed.";
+
+        std::map<int, std::string> expected;
+        for (unsigned i = 0; i < numTuples; i++) {
+            if (i % 3 == 0) {
+                ASSERT_EQ(rm.deleteTuple(tableName, rids[i]), success) << "RelationManager::deleteTuple() should succeed.";
+                continue;
+            }
+            std::string name = "emp" + std::to_string(i);
+            if (i % 3 == 1) {
+                name.resize(300, 'x');
+                prepareTuple(attrs.size(), nullsIndicator, name.size(), name, i, 170.0, 5000.0, inBuffer, tupleSize);
+                ASSERT_EQ(rm.updateTuple(tableName, inBuffer, rids[i]), success)
+                                            << "RelationManager::updateTuple() should succeed.";
+            }
+            expected[i] = name;
+        }
+
+        PeterDB::RecordBasedFileManager &rbfm = PeterDB::RecordBasedFileManager::instance();
+        unsigned pagesBefore, pagesAfter;
+        ASSERT_EQ(rbfm.openFile(tableName, fileHandle), success);
+        pagesBefore = fileHandle.getNumberOfPages();
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+
+        ASSERT_EQ(rm.reorganizeTable(tableName), success) << "RelationManager::reorganizeTable() should succeed.";
+        EXPECT_TRUE(glob(PeterDB::REORGANIZE_FILE_SUFFIX).empty()) << "No scratch file should be left behind.";
+
+        ASSERT_EQ(rbfm.openFile(tableName, fileHandle), success);
+        pagesAfter = fileHandle.getNumberOfPages();
+        for (PeterDB::PageNum pageNum = 0; pageNum < pagesAfter; pageNum++) {
+            PeterDB::PageHelper page(fileHandle, pageNum);
+            for (int16_t slot = 1; slot <= page.slotCounter; slot++) {
+                if (page.isRecordDeleted(slot)) continue;
+                ASSERT_TRUE(page.isRecordData(slot)) << "A reorganized table should have no forwarding pointers.";
+            }
+        }
+        ASSERT_EQ(rbfm.closeFile(fileHandle), success);
+        GTEST_LOG_(INFO) << "pages before: " << pagesBefore << ", after: " << pagesAfter;
+        EXPECT_LT(pagesAfter, pagesBefore);
+
+        PeterDB::RM_ScanIterator rmsi;
+        std::vector<std::string> attrNames{"age"};
+        ASSERT_EQ(rm.scan(tableName, "", PeterDB::NO_OP, nullptr, attrNames, rmsi), success);
+        unsigned count = 0;
+        while (rmsi.getNextTuple(rid, outBuffer) != RM_EOF) count++;
+        ASSERT_EQ(rmsi.close(), success);
+        EXPECT_EQ(count, expected.size());
+
+        PeterDB::RM_IndexScanIterator rmisi;
+        ASSERT_EQ(rm.indexScan(tableName, "age", nullptr, nullptr, true, true, rmisi), success);
+        int key;
+        count = 0;
+        while (rmisi.getNextEntry(rid, &key) != RM_EOF) {
+            ASSERT_EQ(expected.count(key), 1) << "A deleted tuple should not be in the index.";
+            prepareTuple(attrs.size(), nullsIndicator, expected[key].size(), expected[key], key, 170.0, 5000.0,
+                         inBuffer, tupleSize);
+            ASSERT_EQ(rm.readTuple(tableName, rid, outBuffer), success) << "The index should hold the new rid.";
+            ASSERT_EQ(memcmp(inBuffer, outBuffer, tupleSize), 0);
+            count++;
+        }
+        ASSERT_EQ(rmisi.close(), success);
+        EXPECT_EQ(count, expected.size());
+    }
+
+} // namespace PeterDBTesting
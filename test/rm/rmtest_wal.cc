@@ -0,0 +1,120 @@
+#include <map>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "test/utils/rm_test_util.h"
+
+namespace PeterDBTesting {
+
+    TEST_F(RM_Tuple_Test, wal_recover_after_crash_before_index_step) {
+        // Functions tested
+        // 1. A child process commits inserts, a delete and an update of indexed tuples
+        // 2. It dies in the middle of a tuple insert, after the record reached the disk and before its index entry
+        // 3. Opening the log replays it, the table and the index agree on exactly the committed tuples
+
+        const std::string logFileName = "rm_test_wal_log";
+        const unsigned numTuples = 300, numCommitted = 50;
+        size_t tupleSize;
+        inBuffer = malloc(PAGE_SIZE);
+        outBuffer = malloc(PAGE_SIZE);
+        remove(logFileName.c_str());
+        ASSERT_EQ(rm.getAttributes(tableName, attrs), success);
+        nullsIndicator = initializeNullFieldsIndicator(attrs);
+        ASSERT_EQ(rm.createIndex(tableName, "age"), success);
+
+        // age -> name of the tuples that have to survive
+        std::map<int, std::string> expected;
+        std::vector<PeterDB::RID> rids;
+        for (unsigned i = 0; i < numTuples; i++) {
+            std::string name = "emp" + std::to_string(i);
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, i, 170.0, 5000.0, inBuffer, tupleSize);
+            ASSERT_EQ(rm.insertTuple(tableName, inBuffer, rid), success);
+            rids.push_back(rid);
+            expected[i] = name;
+        }
+        // the child must not share an io_uring instance with the parent
+        ASSERT_EQ(PeterDB::BufferPool::instance().setIOEngine(PeterDB::IO_ENGINE_SYNC), success);
+        ASSERT_EQ(PeterDB::PagedFileManager::instance().flushAll(), success);
+        ASSERT_EQ(PeterDB::BufferPool::instance().flushAll(), success);
+        for (unsigned i = 0; i < numCommitted; i++) {
+            expected[numTuples + i] = "new" + std::to_string(i);
+        }
+        expected.erase(7);
+        expected.erase(11);
+        expected[numTuples + numCommitted] = "updated11";
+
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            if (PeterDB::LogManager::instance().open(logFileName) != success) _exit(1);
+            for (unsigned i = 0; i < numCommitted; i++) {
+                std::string name = "new" + std::to_string(i);
+                prepareTuple(attrs.size(), nullsIndicator, name.size(), name, numTuples + i, 170.0, 5000.0, inBuffer,
+                             tupleSize);
+                if (rm.insertTuple(tableName, inBuffer, rid) != success) _exit(2);
+            }
+            if (rm.deleteTuple(tableName, rids[7]) != success) _exit(3);
+            std::string name = "updated11";
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, numTuples + numCommitted, 170.0, 5000.0,
+                         inBuffer, tupleSize);
+            if (rm.updateTuple(tableName, inBuffer, rids[11]) != success) _exit(4);
+
+            // die the way insertTuple would between its two steps: the record is written back
+            // inside the operation, its index entry is never made
+            PeterDB::RecordBasedFileManager &rbfm = PeterDB::RecordBasedFileManager::instance();
+            PeterDB::FileHandle fileHandle;
+            if (rbfm.openFile(tableName, fileHandle) != success) _exit(5);
+            PeterDB::LogOperation operation(PeterDB::LOG_OP_RM_INSERT);
+            name = "lost";
+            prepareTuple(attrs.size(), nullsIndicator, name.size(), name, -1, 170.0, 5000.0, inBuffer, tupleSize);
+            if (rbfm.insertRecord(fileHandle, attrs, inBuffer, rid) != success) _exit(6);
+            PeterDB::BufferPool::instance().flushAll();
+            _exit(0);
+        }
+        int status;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0) << "The child process failed.";
+
+        PeterDB::LogManager &logManager = PeterDB::LogManager::instance();
+        ASSERT_EQ(logManager.open(logFileName), success);
+        unsigned redoCount, undoCount;
+        logManager.getRecoveryCounts(redoCount, undoCount);
+        EXPECT_GT(redoCount, 0);
+        EXPECT_GT(undoCount, 0) << "The unfinished insert should be undone.";
+
+        // tuples in the table
+        std::map<int, PeterDB::RID> tableRids;
+        PeterDB::RM_ScanIterator rmsi;
+        std::vector<std::string> attrNames{"age", "emp_name"};
+        ASSERT_EQ(rm.scan(tableName, "", PeterDB::NO_OP, nullptr, attrNames, rmsi), success);
+        while (rmsi.getNextTuple(rid, outBuffer) != RM_EOF) {
+            int age, nameLen;
+            memcpy(&age, (uint8_t *) outBuffer + 1, sizeof(int));
+            memcpy(&nameLen, (uint8_t *) outBuffer + 1 + sizeof(int), sizeof(int));
+            ASSERT_EQ(expected.count(age), 1) << "Tuple " << age << " should not be in the table.";
+            EXPECT_EQ(std::string((char *) outBuffer + 1 + 2 * sizeof(int), nameLen), expected[age]);
+            tableRids[age] = rid;
+        }
+        ASSERT_EQ(rmsi.close(), success);
+        EXPECT_EQ(tableRids.size(), expected.size());
+
+        // entries in the index
+        PeterDB::RM_IndexScanIterator rmisi;
+        ASSERT_EQ(rm.indexScan(tableName, "age", nullptr, nullptr, true, true, rmisi), success);
+        int key;
+        unsigned count = 0;
+        while (rmisi.getNextEntry(rid, &key) != RM_EOF) {
+            ASSERT_EQ(tableRids.count(key), 1) << "Entry " << key << " should not be in the index.";
+            EXPECT_EQ(rid.pageNum, tableRids[key].pageNum);
+            EXPECT_EQ(rid.slotNum, tableRids[key].slotNum);
+            count++;
+        }
+        ASSERT_EQ(rmisi.close(), success);
+        EXPECT_EQ(count, expected.size());
+
+        ASSERT_EQ(logManager.close(), success);
+        PeterDB::BufferPool::instance().setIOEngine(PeterDB::DEFAULT_IO_ENGINE);
+        remove(logFileName.c_str());
+    }
+
+} // namespace PeterDBTesting